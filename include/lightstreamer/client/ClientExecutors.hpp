@@ -0,0 +1,79 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_CLIENTEXECUTORS_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_CLIENTEXECUTORS_HPP
+
+#include <memory>
+#include <lightstreamer/client/events/EventsThread.hpp>
+#include <lightstreamer/util/threads/EmbeddedEventLoop.hpp>
+#include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
+#include <lightstreamer/util/threads/providers/JoinableScheduler.hpp>
+
+namespace lightstreamer::client {
+
+    /**
+     * The executors a LightstreamerClient runs on, in place of the threads the library would start.
+     *
+     * Null members keep the library's own threads for that part: the session thread selected by the
+     * SessionThreadPolicy and a shard of the EventsThreadPool.
+     */
+    struct ClientExecutors {
+        /**
+         * Runs the session logic. Its tasks are serialized by the client, so it may be multi-threaded.
+         * It requires sessionScheduler too.
+         */
+        std::shared_ptr<util::threads::providers::JoinableExecutor> sessionExecutor;
+
+        /**
+         * Times the delayed session tasks (retries, heartbeats, timeouts), which then run on sessionExecutor.
+         */
+        std::shared_ptr<util::threads::providers::JoinableScheduler> sessionScheduler;
+
+        /**
+         * Delivers the client events to the listeners, e.g. events::EventsThread::onExecutor() over an
+         * executor of the application. Passing the same instance to the Subscriptions of the client
+         * delivers their events on it too.
+         */
+        std::shared_ptr<events::EventsThread> eventsThread;
+
+        /**
+         * Set by embedded(): the loop driven by LightstreamerClient::poll().
+         */
+        std::shared_ptr<util::threads::EmbeddedEventLoop> loop;
+
+        /**
+         * Runs the session logic, the timers and the event deliveries of the client on the given loop, so
+         * that they all happen inside LightstreamerClient::poll() on the application thread. The sockets
+         * are served by the default transport factories, which must be created over the same loop to run
+         * there too (see LightstreamerClient::poll()).
+         */
+        static ClientExecutors embedded(const std::shared_ptr<util::threads::EmbeddedEventLoop> &loop) {
+            return ClientExecutors{loop, loop, events::EventsThread::onExecutor(loop), loop};
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_CLIENTEXECUTORS_HPP
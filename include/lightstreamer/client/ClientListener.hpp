@@ -24,6 +24,7 @@
 #ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_CLIENTLISTENER_HPP
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_CLIENTLISTENER_HPP
 
+#include <cstddef>
 #include <lightstreamer/client/LightstreamerClient.hpp>
 
 // TODO: subclasses and methods
@@ -39,6 +40,22 @@ namespace lightstreamer::client {
         virtual void onStatusChange(const std::string &status) = 0;
 
         virtual void onPropertyChange(const std::string &property) = 0;
+
+        /**
+         * Called when the number of events waiting to be delivered to the listeners reaches the high watermark
+         * set through ConnectionOptions::setEventQueueWatermarks. Unlike the other events, it is invoked
+         * synchronously on the thread that detected the crossing, so that it is not delayed by the backlog
+         * itself; implementations must return quickly and must not block.
+         * @param depth The current number of pending events.
+         */
+        virtual void onEventQueueHighWatermark(std::size_t depth) {}
+
+        /**
+         * Called, after onEventQueueHighWatermark, when the number of pending events drops back to the
+         * low watermark. Invoked synchronously on the events thread; it must return quickly.
+         * @param depth The current number of pending events.
+         */
+        virtual void onEventQueueLowWatermark(std::size_t depth) {}
     };
 }
 
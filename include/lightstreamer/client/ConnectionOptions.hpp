@@ -628,6 +628,113 @@ namespace lightstreamer::client {
             internal->setProxy(proxy);
         }
 
+        /**
+         * @brief Configures the watermarks of the queue of events waiting to be delivered to the listeners.
+         *
+         * When the number of pending events reaches the high watermark, ClientListener::onEventQueueHighWatermark
+         * is invoked; when it drops back to the low watermark, ClientListener::onEventQueueLowWatermark follows.
+         * Use them to shed load when listeners fall behind, e.g. by unsubscribing non-critical items.
+         * The queue of the client and those of its subscriptions pinned to other events threads are watched
+         * separately, each notifying its own crossings with its own depth, which includes the item updates
+         * batched in queued events.
+         *
+         * @b Lifecycle: Can be set and changed at any time.
+         *
+         * @b Notifications: Changes are notified through ClientListener::onPropertyChange with "eventQueueWatermarks".
+         *
+         * @b Default: 0 (no notifications).
+         *
+         * @throws std::invalid_argument If high is not 0 and low is not lower than high.
+         */
+        void setEventQueueWatermarks(std::size_t high, std::size_t low) {
+            std::lock_guard<std::mutex> lock(mtx);
+            internal->setEventQueueWatermarks(high, low);
+        }
+
+        std::size_t getEventQueueHighWatermark() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return internal->getEventQueueHighWatermark();
+        }
+
+        std::size_t getEventQueueLowWatermark() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return internal->getEventQueueLowWatermark();
+        }
+
+        /**
+         * @brief Sets the number of item updates of this client waiting for their listeners above which further
+         * updates are subject to the overflow policy. Only the Subscriptions of this client count, even when
+         * other clients share its events threads.
+         *
+         * @b Lifecycle: Applies to the Subscriptions subscribed after the change.
+         *
+         * @b Notifications: Changes are notified through ClientListener::onPropertyChange with "eventQueueCapacity".
+         *
+         * @b Default: 0 (unbounded).
+         */
+        void setEventQueueCapacity(std::size_t value) {
+            std::lock_guard<std::mutex> lock(mtx);
+            internal->setEventQueueCapacity(value);
+        }
+
+        std::size_t getEventQueueCapacity() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return internal->getEventQueueCapacity();
+        }
+
+        /**
+         * @brief Sets what happens to item updates while the updates of this client waiting for their
+         * listeners are at capacity (see setEventQueueCapacity()).
+         *
+         * - BLOCK: the session thread waits for the listeners to catch up, which in turn slows down
+         *   the reading of the stream.
+         * - DROP: updates are discarded and SubscriptionListener::onItemLostUpdates reports how many.
+         * - CONFLATE: updates for an item still waiting in the queue are merged into the newest one;
+         *   only for MERGE Subscriptions, the other modes behave as DROP.
+         *
+         * @b Lifecycle: Applies to the Subscriptions subscribed after the change.
+         *
+         * @b Notifications: Changes are notified through ClientListener::onPropertyChange with "eventQueueOverflowPolicy".
+         *
+         * @b Default: BLOCK.
+         */
+        void setEventQueueOverflowPolicy(events::EventQueueOverflowPolicy value) {
+            std::lock_guard<std::mutex> lock(mtx);
+            internal->setEventQueueOverflowPolicy(value);
+        }
+
+        events::EventQueueOverflowPolicy getEventQueueOverflowPolicy() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return internal->getEventQueueOverflowPolicy();
+        }
+
+        /**
+         * @brief Sets how many batches of control requests may be waiting for their responses at the same time
+         * when the session runs over HTTP.
+         *
+         * With 1, a batch is only sent once the response to the previous one has arrived, so that subscribing
+         * to many items costs a round-trip per batch. Higher values let further batches travel on other
+         * keep-alive connections meanwhile. Requests concerning the same subscription are still sent one at a
+         * time, and so are batches of messages. WebSocket sessions are not affected.
+         *
+         * @b Lifecycle: Can be set and changed at any time.
+         *
+         * @b Notifications: Changes are notified through ClientListener::onPropertyChange with "maxConcurrentControlBatches".
+         *
+         * @b Default: 1.
+         *
+         * @throws std::invalid_argument If the value is 0.
+         */
+        void setMaxConcurrentControlBatches(std::size_t value) {
+            std::lock_guard<std::mutex> lock(mtx);
+            internal->setMaxConcurrentControlBatches(value);
+        }
+
+        std::size_t getMaxConcurrentControlBatches() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return internal->getMaxConcurrentControlBatches();
+        }
+
     };
 
 }
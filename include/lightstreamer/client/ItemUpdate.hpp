@@ -138,6 +138,16 @@ namespace lightstreamer::client {
             return changedFields.find(pos) != changedFields.end();
         }
 
+        /**
+         * Folds a newer update for the same item into this one: the field values become the newer ones and a
+         * field is reported as changed if it changed in either update. Used to conflate MERGE updates that are
+         * still waiting to be delivered.
+         */
+        void conflate(ItemUpdate &&newer) {
+            updates = std::move(newer.updates);
+            changedFields.insert(newer.changedFields.begin(), newer.changedFields.end());
+        }
+
         // Add remaining methods and private helpers as needed.
 
     private:
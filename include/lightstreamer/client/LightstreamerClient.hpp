@@ -24,6 +24,7 @@
 #ifndef LIGHTSTREAMERCLIENT_HPP
 #define LIGHTSTREAMERCLIENT_HPP
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 #include <regex>
@@ -33,6 +34,7 @@
 #include <thread>
 #include <future>
 #include <map>
+#include <chrono>
 #include <functional>
 #include <Logger.hpp>
 
@@ -40,6 +42,8 @@
 #include <lightstreamer/client/events/ClientListenerStartEvent.hpp>
 #include <lightstreamer/client/events/ClientListenerEndEvent.hpp>
 #include <lightstreamer/client/events/EventsThread.hpp>
+#include <lightstreamer/client/events/EventsThreadPool.hpp>
+#include <lightstreamer/client/events/ItemUpdateBatcher.hpp>
 #include <lightstreamer/client/events/EventDispatcher.hpp>
 #include <lightstreamer/client/events/Event.hpp>
 
@@ -56,6 +60,8 @@
 #include <lightstreamer/client/Subscription.hpp>
 #include <lightstreamer/client/ConnectionDetails.hpp>
 #include <lightstreamer/client/ClientListener.hpp>
+#include <lightstreamer/client/ClientExecutors.hpp>
+#include <lightstreamer/client/async/ClientAwaitables.hpp>
 
 #include <lightstreamer/client/transport/providers/WebSocketProvider.hpp>
 #include <lightstreamer/client/transport/providers/HttpCookie.hpp>
@@ -78,7 +84,6 @@ namespace lightstreamer::client {
         mutable std::mutex mutex;
         std::string lastStatus;
         std::vector<std::shared_ptr<Subscription>> subscriptionArray;
-        std::unique_ptr<events::EventsThread> eventsThread;
         std::unique_ptr<SubscriptionManager> subscriptions;
         bool instanceFieldsInitialized = false;
 
@@ -166,6 +171,8 @@ namespace lightstreamer::client {
                     outerInstance.eventsThread->queue([this] {
                         outerInstance.engine->onForcedTransportChanged();
                     });
+                } else if (property == "eventQueueWatermarks") {
+                    outerInstance.applyEventQueueWatermarks();
                 } else {
                     outerInstance.log->error("Unexpected call to internal onPropertyChange");
                 }
@@ -173,6 +180,73 @@ namespace lightstreamer::client {
         };
 
 
+        /**
+         * Forwards the watermark crossings of the events queue to the ClientListeners, synchronously.
+         */
+        class EventQueueWatermarkListener : public events::EventQueueListener {
+        private:
+            LightstreamerClient& outerInstance;
+
+        public:
+            explicit EventQueueWatermarkListener(LightstreamerClient& outerInstance)
+                    : outerInstance(outerInstance) {}
+
+            void onHighWatermark(std::size_t depth) override {
+                for (const auto& listener : outerInstance.dispatcher->getListeners()) {
+                    listener->onEventQueueHighWatermark(depth);
+                }
+            }
+
+            void onLowWatermark(std::size_t depth) override {
+                for (const auto& listener : outerInstance.dispatcher->getListeners()) {
+                    listener->onEventQueueLowWatermark(depth);
+                }
+            }
+        };
+
+        std::shared_ptr<EventQueueWatermarkListener> eventQueueWatermarkListener =
+                std::make_shared<EventQueueWatermarkListener>(*this);
+
+        // Created by the first connectAsync() call.
+        std::shared_ptr<async::ClientStateBridge> asyncBridge;
+
+        static std::shared_ptr<session::SessionThread> makeSessionThread(const ClientExecutors &executors) {
+            if (!executors.sessionExecutor && !executors.sessionScheduler) {
+                return std::make_shared<session::SessionThread>();
+            }
+            if (!executors.sessionExecutor || !executors.sessionScheduler) {
+                throw std::invalid_argument("The session executor and scheduler must be given together");
+            }
+            return std::make_shared<session::SessionThread>(
+                    std::make_shared<util::threads::InjectedExecutorMultiplexer<session::SessionThread>>(
+                            executors.sessionExecutor, executors.sessionScheduler));
+        }
+
+        void applyEventQueueWatermarks(const std::shared_ptr<events::EventsThread> &thread) {
+            std::size_t high = internalConnectionOptions->getEventQueueHighWatermark();
+            if (high == 0) {
+                thread->removeWatermarks(eventQueueWatermarkListener);
+            } else {
+                thread->setWatermarks(eventQueueWatermarkListener, high,
+                                      internalConnectionOptions->getEventQueueLowWatermark());
+            }
+        }
+
+        /**
+         * Applies the watermarks to the events thread of this client and to those of its active subscriptions,
+         * which may be pinned to other shards. Each queue is watched on its own: a shard shared with other
+         * clients reports its whole depth.
+         */
+        void applyEventQueueWatermarks() {
+            std::lock_guard<std::mutex> lock(mutex);
+            applyEventQueueWatermarks(eventsThread);
+            for (const auto &subscription: subscriptionArray) {
+                if (subscription->getEventsThread() != eventsThread) {
+                    applyEventQueueWatermarks(subscription->getEventsThread());
+                }
+            }
+        }
+
     public:
         static constexpr char const* LIB_NAME = "Lightstreamer.DotNetStandard.Client";
         static constexpr char const* LIB_VERSION = "5.1.10";
@@ -209,7 +283,11 @@ namespace lightstreamer::client {
             LogManager::setLoggerProvider(provider);
         }
 
-        static std::shared_ptr<events::EventsThread> eventsThread = events::EventsThread::instance();
+        // The events thread of the shared pool this client is pinned to, unless one was injected.
+        std::shared_ptr<events::EventsThread> eventsThread;
+        // The item updates of the Subscriptions of this client waiting for their listeners, to which the
+        // overflow policy applies whatever else their events threads carry.
+        std::shared_ptr<events::UpdateBacklog> updateBacklog = std::make_shared<events::UpdateBacklog>();
 
         std::unique_ptr<events::EventDispatcher<ClientListener>> dispatcher;
         std::shared_ptr<ILogger> log = LogManager::getLogger(Constants::ACTIONS_LOG);
@@ -217,7 +295,9 @@ namespace lightstreamer::client {
         std::unique_ptr<InternalListener> internalListener;
         std::unique_ptr<session::InternalConnectionDetails> internalConnectionDetails;
         std::unique_ptr<session::InternalConnectionOptions> internalConnectionOptions;
-        static std::shared_ptr<session::SessionThread> sessionThread = std::make_shared<session::SessionThread>();
+        std::shared_ptr<session::SessionThread> sessionThread;
+        // Set for a client created with ClientExecutors::embedded().
+        std::shared_ptr<util::threads::EmbeddedEventLoop> loop;
 
         std::unique_ptr<session::SessionManager> manager;
 
@@ -256,6 +336,24 @@ namespace lightstreamer::client {
          *                   or to specify it later by using nullptr here. See ConnectionDetails::AdapterSet for details.
          */
         LightstreamerClient(std::string serverAddress, std::string adapterSet)
+                : LightstreamerClient(std::move(serverAddress), std::move(adapterSet), ClientExecutors{})
+        {
+        }
+
+        /**
+         * Creates a client running its session logic and its event deliveries on the given executors, so that
+         * no session or events thread is started for it. Members left null fall back to the library's threads.
+         *
+         * @param serverAddress See LightstreamerClient(std::string, std::string).
+         * @param adapterSet See LightstreamerClient(std::string, std::string).
+         * @param executors The executors of the client.
+         * @throws std::invalid_argument if only one of the session executor and scheduler is given.
+         */
+        LightstreamerClient(std::string serverAddress, std::string adapterSet, ClientExecutors executors)
+                : eventsThread(executors.eventsThread ? std::move(executors.eventsThread)
+                                                      : events::EventsThreadPool::getInstance().nextShard()),
+                  sessionThread(makeSessionThread(executors)),
+                  loop(std::move(executors.loop))
         {
             if (!instanceFieldsInitialized) {
                 initializeInstanceFields();
@@ -320,7 +418,12 @@ namespace lightstreamer::client {
         std::vector<std::shared_ptr<ClientListener>> listeners() const
         {
             std::lock_guard<std::mutex> lock(mutex);
-            return dispatcher->getListeners();
+            auto result = dispatcher->getListeners();
+            if (asyncBridge) {
+                result.erase(std::remove(result.begin(), result.end(),
+                                         std::static_pointer_cast<ClientListener>(asyncBridge)), result.end());
+            }
+            return result;
         }
 
         /**
@@ -350,6 +453,27 @@ namespace lightstreamer::client {
             });
         }
 
+        /**
+         * Awaitable counterpart of connect():
+         *
+         *     std::string status = co_await client.connectAsync();
+         *
+         * requests the connection and resumes once a session is established, yielding the CONNECTED status;
+         * it throws async::AsyncError if the Server refuses the connection or the client goes back to
+         * DISCONNECTED first. It completes at once if the client is already connected.
+         *
+         * @param executor The executor the coroutine is resumed on; null to resume it on the events thread.
+         */
+        async::ConnectAwaitable<LightstreamerClient> connectAsync(std::shared_ptr<util::threads::providers::JoinableExecutor> executor = nullptr)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!asyncBridge) {
+                asyncBridge = std::make_shared<async::ClientStateBridge>(lastStatus);
+                dispatcher->addListener(asyncBridge, std::make_shared<events::ClientListenerStartEvent>(this));
+            }
+            return async::ConnectAwaitable<LightstreamerClient>(*this, asyncBridge, std::move(executor));
+        }
+
         /**
          * Operation method that requests to close the Session opened against the configured Lightstreamer Server (if any).
          * When disconnect() is called, the "Stream-Sense" mechanism is stopped.
@@ -391,6 +515,43 @@ namespace lightstreamer::client {
             });
         }
 
+        /**
+         * Runs the work of a client created with ClientExecutors::embedded() that is ready: protocol handling,
+         * timers and listener callbacks all run inside this call, on the calling thread. It never blocks.
+         *
+         * The transports are process-wide and are not moved onto the loop by embedded(): socket reads run
+         * here too only if the default transport factories were set up on the same loop, e.g.
+         *
+         *     TransportFactory<WebSocketProvider>::setDefaultWebSocketFactory(
+         *             std::make_unique<epoll::EpollWebSocketProviderFactory>(loop));
+         *     TransportFactory<HttpProvider>::setDefaultHttpFactory(
+         *             std::make_unique<epoll::EpollHttpProviderFactory>(loop));
+         *
+         * Otherwise the sockets are served by the transport threads, which hand their data over to the loop.
+         *
+         * @param budget The maximum number of socket callbacks and tasks to run.
+         * @return The number of socket callbacks and tasks run.
+         * @throws std::logic_error if the client is not embedded.
+         */
+        std::size_t poll(std::size_t budget = util::threads::EmbeddedEventLoop::UNLIMITED)
+        {
+            if (!loop) {
+                throw std::logic_error("The client was not created with ClientExecutors::embedded()");
+            }
+            return loop->poll(budget);
+        }
+
+        /**
+         * The descriptor of an embedded client, readable whenever poll() has work to do, to be added to the
+         * application's epoll set.
+         *
+         * @return The descriptor, or -1 if the client is not embedded or the platform has no epoll.
+         */
+        int getPollFd() const
+        {
+            return loop ? loop->getFd() : -1;
+        }
+
         /** Destructor for LightstreamerClient, ensures proper cleanup and logging. */
         ~LightstreamerClient()
         {
@@ -438,7 +599,11 @@ namespace lightstreamer::client {
         {
             std::lock_guard<std::mutex> lock(mutex);
             subscription->setActive();
+            subscription->setEventQueueOverflow(internalConnectionOptions->getEventQueueCapacity(),
+                                                internalConnectionOptions->getEventQueueOverflowPolicy(),
+                                                updateBacklog);
             subscriptionArray.push_back(subscription);
+            applyEventQueueWatermarks(subscription->getEventsThread());
             eventsThread->queue([this, subscription] {
                 subscriptions->add(subscription);
             });
@@ -460,11 +625,36 @@ namespace lightstreamer::client {
             std::lock_guard<std::mutex> lock(mutex);
             subscription->setInactive();
             subscriptionArray.erase(std::remove(subscriptionArray.begin(), subscriptionArray.end(), subscription), subscriptionArray.end());
+            auto thread = subscription->getEventsThread();
+            if (thread != eventsThread &&
+                std::none_of(subscriptionArray.begin(), subscriptionArray.end(),
+                             [&](const auto &other) { return other->getEventsThread() == thread; })) {
+                thread->removeWatermarks(eventQueueWatermarkListener);
+            }
             eventsThread->queue([this, subscription] {
                 subscriptions->remove(subscription);
             });
         }
 
+        /**
+         * Inquiry method that returns the number of events queued for the listeners of this client and not yet
+         * delivered. Subscriptions may be pinned to other events threads; see Subscription for theirs.
+         * @return The depth of the events queue of this client.
+         */
+        std::size_t getEventQueueDepth() const
+        {
+            return eventsThread->getQueueDepth();
+        }
+
+        /**
+         * Inquiry method that returns how long the oldest pending event of this client has been waiting.
+         * @return The age of the oldest pending event, or zero if the queue is idle.
+         */
+        std::chrono::nanoseconds getOldestEventAge() const
+        {
+            return eventsThread->getOldestEventAge();
+        }
+
         /**
          * Inquiry method that returns a list containing all the Subscription instances that are
          * currently "active" on this LightstreamerClient. Internal second-level Subscription are not included.
@@ -513,6 +703,28 @@ namespace lightstreamer::client {
             });
         }
 
+        /**
+         * Awaitable counterpart of sendMessage() with a ClientMessageListener:
+         *
+         *     auto result = co_await client.sendMessageAsync("buy", "orders");
+         *
+         * resumes with the outcome of the message. The message must not be abandoned while pending: the
+         * coroutine must not be destroyed before it resumes.
+         *
+         * @param message A text message, whose interpretation is entirely demanded to the Metadata Adapter.
+         * @param sequence An alphanumeric identifier for the message sequence; if empty, "UNORDERED_MESSAGES" is assumed.
+         * @param delayTimeout A timeout in milliseconds, with server default used if negative.
+         * @param enqueueWhileDisconnected If true, the message is queued during a disconnected state, waiting for a new session.
+         * @param executor The executor the coroutine is resumed on; null to resume it on the events thread.
+         */
+        async::MessageAwaitable<LightstreamerClient> sendMessageAsync(std::string message, std::string sequence = "",
+                                                                      int delayTimeout = -1, bool enqueueWhileDisconnected = false,
+                                                                      std::shared_ptr<util::threads::providers::JoinableExecutor> executor = nullptr)
+        {
+            return async::MessageAwaitable<LightstreamerClient>(*this, std::move(message), std::move(sequence), delayTimeout,
+                                                                enqueueWhileDisconnected, std::move(executor));
+        }
+
         /**
          * Static method that allows sharing cookies between connections to the Server and other sites by the application.
          * @param uri The URI from which the supplied cookies were received.
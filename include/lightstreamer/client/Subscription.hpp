@@ -30,7 +30,12 @@
 #include <lightstreamer/client/ItemUpdate.hpp>
 #include <lightstreamer/client/Constants.hpp>
 #include <lightstreamer/client/SubscriptionListener.hpp>
+#include <lightstreamer/client/async/SubscriptionAwaitables.hpp>
 #include <lightstreamer/client/events/EventDispatcher.hpp>
+#include <lightstreamer/client/events/EventsThreadPool.hpp>
+#include <lightstreamer/client/events/InlineListeners.hpp>
+#include <lightstreamer/client/events/ItemUpdateBatcher.hpp>
+#include <lightstreamer/client/events/SubscriptionListenerItemUpdatesEvent.hpp>
 #include "Logger.hpp" // Assuming existence of a Logger class
 #include <lightstreamer/client/session/SessionManager.hpp>
 #include <lightstreamer/client/session/SessionThread.hpp>
@@ -39,6 +44,10 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <algorithm>
 #include <set>
@@ -141,12 +150,62 @@ namespace lightstreamer::client {
         std::shared_ptr<Logger> log = LogManager::getLogger("ACTIONS_LOG");
         std::shared_ptr<Logger> logStats = LogManager::getLogger("STATS_LOG");
 
-        events::EventDispatcher<SubscriptionListener> dispatcher;
+        // Each Subscription is pinned to one events thread, which keeps its events in order.
+        std::shared_ptr<events::EventsThread> eventsThread;
+        // Shared with the batcher; the tasks it queues on the events thread do not refer to it.
+        std::shared_ptr<events::EventDispatcher<SubscriptionListener>> dispatcher =
+                std::make_shared<events::EventDispatcher<SubscriptionListener>>(eventsThread);
+
+        // Batches the item updates for the listeners and applies the overflow policy of the events queue.
+        events::ItemUpdateBatcher<SubscriptionListener, ItemUpdate> updateBatcher{
+                dispatcher, eventsThread, [this](int item, int lost) {
+                    return std::shared_ptr<const events::Event<SubscriptionListener>>(
+                            std::make_shared<const SubscriptionListenerItemLostUpdatesEvent>(
+                                    itemDescriptor ? itemDescriptor->getName(item) : "", item, lost));
+                }};
+
+        /**
+         * Forwards every event but the item updates to an inline listener, through the events thread as usual.
+         */
+        class InlineListenerAdapter : public SubscriptionListener {
+        public:
+            std::shared_ptr<SubscriptionListener> target;
+
+            explicit InlineListenerAdapter(std::shared_ptr<SubscriptionListener> target) : target(std::move(target)) {}
+
+            void onClearSnapshot(const std::string& itemName, int itemPos) override { target->onClearSnapshot(itemName, itemPos); }
+            void onCommandSecondLevelItemLostUpdates(int lostUpdates, const std::string& key) override {
+                target->onCommandSecondLevelItemLostUpdates(lostUpdates, key);
+            }
+            void onCommandSecondLevelSubscriptionError(int code, const std::string& message, const std::string& key) override {
+                target->onCommandSecondLevelSubscriptionError(code, message, key);
+            }
+            void onEndOfSnapshot(const std::string& itemName, int itemPos) override { target->onEndOfSnapshot(itemName, itemPos); }
+            void onItemLostUpdates(const std::string& itemName, int itemPos, int lostUpdates) override {
+                target->onItemLostUpdates(itemName, itemPos, lostUpdates);
+            }
+            void onItemUpdate(const ItemUpdate&) override {}
+            void onItemUpdates(std::span<const ItemUpdate>) override {}
+            void onListenEnd(const Subscription& subscription) override { target->onListenEnd(subscription); }
+            void onListenStart(const Subscription& subscription) override { target->onListenStart(subscription); }
+            void onSubscription() override { target->onSubscription(); }
+            void onSubscriptionError(int code, const std::string& message) override { target->onSubscriptionError(code, message); }
+            void onUnsubscription() override { target->onUnsubscription(); }
+            void onRealMaxFrequency(const std::string& frequency) override { target->onRealMaxFrequency(frequency); }
+        };
+
+        events::InlineListeners<SubscriptionListener, ItemUpdate> inlineListeners;
+        // Created by the first subscribedAsync() call.
+        std::shared_ptr<async::SubscriptionStateBridge> asyncBridge;
+        // Listeners of the dispatcher that ignore item updates: the adapters of the inline listeners and the
+        // async bridge. Updates are queued only when the dispatcher has other listeners.
+        std::atomic<int> updatelessListeners{0};
 
         bool isActive = false;
 
         std::unique_ptr<util::Descriptor> itemDescriptor;
-        std::unique_ptr<util::Descriptor> fieldDescriptor;
+        // Shared with the ItemUpdate objects handed to the listeners.
+        std::shared_ptr<util::Descriptor> fieldDescriptor;
         int commandCode = -1;
         int keyCode = -1;
 
@@ -207,9 +266,13 @@ namespace lightstreamer::client {
          * @param items A vector of items to be subscribed to through Lightstreamer server.
          * It is also possible specify the "Item List" or "Item Group" later.
          * @param fields A vector of fields for the items to be subscribed to through Lightstreamer Server.
+         * @param eventsThread The events thread delivering the events of this Subscription, e.g. the one given
+         * to its client through ClientExecutors; nullptr for a shard of the EventsThreadPool.
          */
         Subscription(const std::string &subscriptionMode, const std::vector<std::string> &items,
-                     const std::vector<std::string> &fields) {
+                     const std::vector<std::string> &fields,
+                     std::shared_ptr<events::EventsThread> eventsThread = nullptr)
+                : eventsThread(orSharedShard(std::move(eventsThread))) {
             init(subscriptionMode, items, fields);
         }
 
@@ -219,9 +282,13 @@ namespace lightstreamer::client {
          * @param subscriptionMode The subscription mode for the items, required by Lightstreamer Server.
          * @param item The item name to be subscribed to through Lightstreamer Server.
          * @param fields A vector of fields for the item to be subscribed to through Lightstreamer Server.
+         * @param eventsThread The events thread delivering the events of this Subscription, e.g. the one given
+         * to its client through ClientExecutors; nullptr for a shard of the EventsThreadPool.
          */
         Subscription(const std::string &subscriptionMode, const std::string &item,
-                     const std::vector<std::string> &fields) {
+                     const std::vector<std::string> &fields,
+                     std::shared_ptr<events::EventsThread> eventsThread = nullptr)
+                : eventsThread(orSharedShard(std::move(eventsThread))) {
             init(subscriptionMode, std::vector<std::string>{item}, fields);
         }
 
@@ -229,12 +296,19 @@ namespace lightstreamer::client {
          * @brief Creates an object to be used to describe a Subscription without specifying items or fields.
          *
          * @param subscriptionMode The subscription mode for the items, required by Lightstreamer Server.
+         * @param eventsThread The events thread delivering the events of this Subscription, e.g. the one given
+         * to its client through ClientExecutors; nullptr for a shard of the EventsThreadPool.
          */
-        Subscription(const std::string &subscriptionMode) {
+        Subscription(const std::string &subscriptionMode, std::shared_ptr<events::EventsThread> eventsThread = nullptr)
+                : eventsThread(orSharedShard(std::move(eventsThread))) {
             init(subscriptionMode, {}, {});
         }
 
     private:
+        static std::shared_ptr<events::EventsThread> orSharedShard(std::shared_ptr<events::EventsThread> eventsThread) {
+            return eventsThread ? std::move(eventsThread) : events::EventsThreadPool::getInstance().nextShard();
+        }
+
         void init(const std::string &subscriptionMode, const std::vector<std::string> &items,
                   const std::vector<std::string> &fields) {
             if (subscriptionMode.empty()) {
@@ -269,17 +343,127 @@ namespace lightstreamer::client {
     public:
         void addListener(std::shared_ptr<SubscriptionListener> listener) {
             std::lock_guard<std::mutex> guard(mtx);
-            dispatcher.addListener(listener);
+            dispatcher->addListener(listener);
+        }
+
+        /**
+         * Adds a listener whose events are delivered on the given events thread instead of the one this
+         * Subscription is pinned to. Events for the listener keep their order.
+         */
+        void addListener(std::shared_ptr<SubscriptionListener> listener, std::shared_ptr<events::EventsThread> executor) {
+            std::lock_guard<std::mutex> guard(mtx);
+            dispatcher->addListener(listener, nullptr, std::move(executor));
+        }
+
+        /**
+         * Adds a listener whose item updates are delivered inline: onItemUpdate is called directly on the
+         * session thread, right after the update is parsed, with an ItemUpdate that is neither copied nor
+         * queued. The other events still reach the listener through the events thread, so an inline listener
+         * may see updates before the onSubscription event.
+         *
+         * The session thread cannot read from the network while an inline listener runs: the callback must
+         * not block, wait for locks held by other threads or call back into the client. Calls lasting longer
+         * than the budget are logged as warnings and counted (see getInlineBudgetOverruns()); exceptions
+         * thrown by the listener are logged and swallowed.
+         *
+         * @param listener The listener.
+         * @param budget The time a single call is expected to take at most.
+         */
+        void addInlineListener(std::shared_ptr<SubscriptionListener> listener,
+                               std::chrono::nanoseconds budget = std::chrono::microseconds(50)) {
+            std::lock_guard<std::mutex> guard(mtx);
+            auto adapter = std::make_shared<InlineListenerAdapter>(listener);
+            if (inlineListeners.add(std::move(listener), adapter, budget)) {
+                // Counted once in the dispatcher, so that a regular listener never sees its updates skipped.
+                dispatcher->addListener(adapter);
+                updatelessListeners.fetch_add(1, std::memory_order_release);
+            }
         }
 
         void removeListener(std::shared_ptr<SubscriptionListener> listener) {
             std::lock_guard<std::mutex> guard(mtx);
-            dispatcher.removeListener(listener);
+            if (auto adapter = inlineListeners.remove(listener)) {
+                updatelessListeners.fetch_sub(1, std::memory_order_release);
+                dispatcher->removeListener(adapter);
+                return;
+            }
+            dispatcher->removeListener(listener);
+        }
+
+        /**
+         * @return The number of inline listener calls that exceeded their time budget.
+         */
+        std::uint64_t getInlineBudgetOverruns() const {
+            return inlineListeners.getBudgetOverruns();
+        }
+
+        /**
+         * Awaitable counterpart of the onSubscription event:
+         *
+         *     co_await subscription->subscribedAsync();
+         *
+         * resumes once the Server has confirmed the subscription, at once if it is already subscribed, and
+         * throws async::AsyncError if the Server rejects it (see SubscriptionListener::onSubscriptionError).
+         *
+         * @param executor The executor the coroutine is resumed on; null to resume it on the events thread.
+         */
+        async::SubscribedAwaitable subscribedAsync(std::shared_ptr<util::threads::providers::JoinableExecutor> executor = nullptr) {
+            std::lock_guard<std::mutex> guard(mtx);
+            if (!asyncBridge) {
+                asyncBridge = std::make_shared<async::SubscriptionStateBridge>(tablePhaseType == "PUSHING");
+                dispatcher->addListener(asyncBridge);
+                updatelessListeners.fetch_add(1, std::memory_order_release);
+            }
+            // The awaiter shares the ownership of the bridge through its waiter list.
+            return async::SubscribedAwaitable(
+                    std::shared_ptr<async::WaiterList<async::SubscriptionState>>(asyncBridge, &asyncBridge->getWaiters()),
+                    std::move(executor));
+        }
+
+        /**
+         * Returns an asynchronous sequence of the updates of this Subscription, to be consumed by a coroutine:
+         *
+         *     auto stream = subscription->updates();
+         *     while (auto update = co_await stream->next()) { ... }
+         *
+         * The stream is added as a listener; remove it with removeListener() to end the sequence.
+         *
+         * @param capacity The number of updates buffered for a slow consumer before the oldest are dropped.
+         * @param executor The executor the coroutine is resumed on; null to resume it on the events thread.
+         */
+        std::shared_ptr<async::ItemUpdateStream> updates(std::size_t capacity = 1024,
+                                                         std::shared_ptr<util::threads::providers::JoinableExecutor> executor = nullptr) {
+            auto stream = std::make_shared<async::ItemUpdateStream>(capacity, std::move(executor));
+            addListener(stream);
+            return stream;
+        }
+
+        /**
+         * Applies the events queue overflow settings of the client this Subscription is being subscribed to.
+         */
+        void setEventQueueOverflow(std::size_t capacity, events::EventQueueOverflowPolicy policy,
+                                   std::shared_ptr<events::UpdateBacklog> clientBacklog) {
+            updateBatcher.setOverflow(capacity, policy, std::move(clientBacklog));
+        }
+
+        /**
+         * The events thread delivering the events of this Subscription.
+         */
+        const std::shared_ptr<events::EventsThread> &getEventsThread() const {
+            return eventsThread;
         }
 
         std::vector<std::shared_ptr<SubscriptionListener>> getListeners() {
             std::lock_guard<std::mutex> guard(mtx);
-            return dispatcher.getListeners();
+            auto result = dispatcher->getListeners();
+            if (asyncBridge) {
+                result.erase(std::remove(result.begin(), result.end(),
+                                         std::static_pointer_cast<SubscriptionListener>(asyncBridge)), result.end());
+            }
+            for (const auto& entry : *inlineListeners.snapshot()) {
+                std::replace(result.begin(), result.end(), entry.adapter, entry.listener);
+            }
+            return result;
         }
 
         /**
@@ -907,7 +1091,7 @@ namespace lightstreamer::client {
             bool wasSubscribed = is("PUSHING");
             logDebug("set OFF sub on Remove.");
             setPhase("OFF");
-            // Assume dispatcher.dispatchEvent is handled elsewhere.
+            // Assume dispatcher->dispatchEvent is handled elsewhere.
             // if (wasSubscribed) { ... }
             // if (behavior == "MULTIMETAPUSH") { ... }
             // cleanData();
@@ -924,7 +1108,7 @@ namespace lightstreamer::client {
             bool wasSubscribed = is("PUSHING");
             setPhase("PAUSED");
 
-            // Assume dispatcher.dispatchEvent and other necessary operations are handled
+            // Assume dispatcher->dispatchEvent and other necessary operations are handled
             log("Subscription " + std::to_string(subscriptionId) + " is now on hold");
         }
 
@@ -1024,7 +1208,8 @@ namespace lightstreamer::client {
 
             std::string name = itemDescriptor->getName(item);
             snapshotByItem[item].endOfSnapshot();
-            dispatcher.dispatchEvent(SubscriptionListenerEndOfSnapshotEvent(name, item));
+            updateBatcher.seal();
+            dispatcher->dispatchEvent(SubscriptionListenerEndOfSnapshotEvent(name, item));
         }
 
         // Method to clear the snapshot for a specific item
@@ -1041,7 +1226,8 @@ namespace lightstreamer::client {
                 // Additional second-level handling if required
             }
 
-            dispatcher.dispatchEvent(SubscriptionListenerClearSnapshotEvent(name, item));
+            updateBatcher.seal();
+            dispatcher->dispatchEvent(SubscriptionListenerClearSnapshotEvent(name, item));
         }
 
         // Method to notify about lost updates for a specific item
@@ -1050,7 +1236,8 @@ namespace lightstreamer::client {
                 return;
             }
             std::string name = itemDescriptor->getName(item);
-            dispatcher.dispatchEvent(SubscriptionListenerItemLostUpdatesEvent(name, item, lostUpdates));
+            updateBatcher.seal();
+            dispatcher->dispatchEvent(SubscriptionListenerItemLostUpdatesEvent(name, item, lostUpdates));
         }
 
         // Method to configure the subscription based on server-sent frequency settings
@@ -1066,20 +1253,23 @@ namespace lightstreamer::client {
             }
 
             // Handle behavior-specific configuration updates
-            dispatcher.dispatchEvent(SubscriptionListenerConfigurationEvent(frequency));
+            updateBatcher.seal();
+            dispatcher->dispatchEvent(SubscriptionListenerConfigurationEvent(frequency));
         }
         void onLostUpdates(const std::string& relKey, int lostUpdates) {
             if (!checkStatusForUpdate()) {
                 return;
             }
-            dispatcher.dispatchEvent(SubscriptionListenerCommandSecondLevelItemLostUpdatesEvent(lostUpdates, relKey));
+            updateBatcher.seal();
+            dispatcher->dispatchEvent(SubscriptionListenerCommandSecondLevelItemLostUpdatesEvent(lostUpdates, relKey));
         }
 
         void onServerError(int code, const std::string& message, const std::string& relKey) {
             if (!checkStatusForUpdate()) {
                 return;
             }
-            dispatcher.dispatchEvent(SubscriptionListenerCommandSecondLevelSubscriptionErrorEvent(code, message, relKey));
+            updateBatcher.seal();
+            dispatcher->dispatchEvent(SubscriptionListenerCommandSecondLevelSubscriptionErrorEvent(code, message, relKey));
         }
 
         void update(const std::vector<std::string>& args, int item, bool fromMultison) {
@@ -1104,7 +1294,17 @@ namespace lightstreamer::client {
             }
 
             // Additional handling for MULTIMETAPUSH behavior not shown for brevity
-            // Dispatch update event to listeners
+            std::string name = itemDescriptor ? itemDescriptor->getName(item) : "";
+            bool snapshot = item < static_cast<int>(snapshotByItem.size()) && snapshotByItem[item] &&
+                            snapshotByItem[item]->isSnapshot();
+            ItemUpdate itemUpdate(name, item, snapshot, args, changedFields, fieldDescriptor);
+            if (inlineListeners.size() > 0) {
+                inlineListeners.dispatch(itemUpdate);
+            }
+            // Nothing to queue when every listener is inline: the update would only fill the events queue.
+            if (dispatcher->size() > updatelessListeners.load(std::memory_order_acquire)) {
+                updateBatcher.dispatch(std::move(itemUpdate), mode == "MERGE");
+            }
         }
 
         void cleanData() {
@@ -1210,7 +1410,8 @@ namespace lightstreamer::client {
                 } else {
                     frequency = std::to_string(aggregatedRealMaxFrequency);
                 }
-                this->dispatcher.dispatchEvent(std::make_unique<SubscriptionListenerConfigurationEvent>(frequency));
+                this->updateBatcher.seal();
+                this->dispatcher->dispatchEvent(std::make_unique<SubscriptionListenerConfigurationEvent>(frequency));
             }
         }
 
@@ -24,6 +24,7 @@
 #ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_SUBSCRIPTIONLISTENER_HPP
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_SUBSCRIPTIONLISTENER_HPP
 
+#include <span>
 #include <string>
 #include <lightstreamer/client/ItemUpdate.hpp>
 #include <lightstreamer/client/Subscription.hpp>
@@ -164,6 +165,19 @@ namespace lightstreamer::client {
          */
         virtual void onItemUpdate(const ItemUpdate& itemUpdate) = 0;
 
+        /**
+         * Event handler that receives, in a single call, all the updates accumulated for this listener since the
+         * previous call, in order of arrival. Batches are typically large during snapshot delivery.
+         * The default implementation calls `onItemUpdate` once for each update; override it to process a whole batch
+         * at once. The updates are only valid for the duration of the call.
+         * @param itemUpdates The updates, in the order they were received from the Server.
+         */
+        virtual void onItemUpdates(std::span<const ItemUpdate> itemUpdates) {
+            for (const auto& itemUpdate : itemUpdates) {
+                onItemUpdate(itemUpdate);
+            }
+        }
+
         /**
          * Event handler that receives a notification when the SubscriptionListener instance is removed from a Subscription
          * through `Subscription.removeListener`. This is the last event to be fired on the listener.
@@ -0,0 +1,255 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_CLIENTAWAITABLES_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_CLIENTAWAITABLES_HPP
+
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <lightstreamer/client/Constants.hpp>
+#include <lightstreamer/client/ClientListener.hpp>
+#include <lightstreamer/client/ClientMessageListener.hpp>
+#include <lightstreamer/client/async/StateWaiters.hpp>
+
+namespace lightstreamer::client::async {
+
+    /**
+     * The connection state of a client, as seen by its listeners.
+     */
+    struct ClientState {
+        std::string status = Constants::DISCONNECTED;
+        // Transitions to DISCONNECTED and server errors seen so far, so that a waiter can tell whether one
+        // happened after it started waiting.
+        std::uint64_t disconnections = 0;
+        std::uint64_t serverErrors = 0;
+        int errorCode = 0;
+        std::string errorMessage;
+    };
+
+    /**
+     * A listener added once to a client, which keeps its ClientState and resumes the coroutines waiting
+     * for it.
+     */
+    class ClientStateBridge : public ClientListener {
+    private:
+        WaiterList<ClientState> waiters;
+
+    public:
+        explicit ClientStateBridge(std::string status) : waiters(ClientState{std::move(status)}) {}
+
+        WaiterList<ClientState> &getWaiters() {
+            return waiters;
+        }
+
+        void onListenEnd(std::shared_ptr<LightstreamerClient> client) override {}
+
+        void onListenStart(std::shared_ptr<LightstreamerClient> client) override {}
+
+        void onServerError(int errorCode, const std::string &errorMessage) override {
+            waiters.update([&](ClientState &state) {
+                ++state.serverErrors;
+                state.errorCode = errorCode;
+                state.errorMessage = errorMessage;
+            });
+        }
+
+        void onStatusChange(const std::string &status) override {
+            waiters.update([&](ClientState &state) {
+                if (status == Constants::DISCONNECTED && state.status != Constants::DISCONNECTED) {
+                    ++state.disconnections;
+                }
+                state.status = status;
+            });
+        }
+
+        void onPropertyChange(const std::string &property) override {}
+    };
+
+    /**
+     * The awaiter of LightstreamerClient::connectAsync(): requests the connection and resumes once a
+     * session is established, i.e. the status is CONNECTED with a transport other than STREAM-SENSING.
+     * co_await yields that status, or throws AsyncError if the Server refuses the connection or the client
+     * goes back to DISCONNECTED first. It completes at once if the client is already connected.
+     */
+    template<typename Client>
+    class ConnectAwaitable : private Waiter<ClientState> {
+    private:
+        Client &client;
+        std::shared_ptr<ClientStateBridge> bridge;
+        std::shared_ptr<JoinableExecutor> executor;
+        ClientState baseline;
+        std::string status;
+        bool failed = false;
+        int errorCode = 0;
+        std::string errorMessage;
+
+        static bool isEstablished(const std::string &status) {
+            return status.rfind("CONNECTED:", 0) == 0 && status != "CONNECTED:STREAM-SENSING";
+        }
+
+        bool complete(const ClientState &state) override {
+            if (state.serverErrors != baseline.serverErrors) {
+                failed = true;
+                errorCode = state.errorCode;
+                errorMessage = state.errorMessage;
+                return true;
+            }
+            if (state.disconnections != baseline.disconnections) {
+                failed = true;
+                errorMessage = "Disconnected before a session was established";
+                return true;
+            }
+            if (isEstablished(state.status)) {
+                status = state.status;
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        ConnectAwaitable(Client &client, std::shared_ptr<ClientStateBridge> bridge,
+                         std::shared_ptr<JoinableExecutor> executor)
+                : client(client), bridge(std::move(bridge)), executor(std::move(executor)) {}
+
+        bool await_ready() {
+            baseline = bridge->getWaiters().snapshot();
+            if (isEstablished(baseline.status)) {
+                status = baseline.status;
+                return true;
+            }
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            client.connect();
+            return bridge->getWaiters().suspend(*this, handle, executor);
+        }
+
+        std::string await_resume() {
+            if (failed) {
+                throw AsyncError(errorCode, errorMessage);
+            }
+            return std::move(status);
+        }
+    };
+
+    /**
+     * How the Server handled a message sent with sendMessageAsync().
+     */
+    enum class MessageOutcome {
+        PROCESSED,
+        DENIED,
+        DISCARDED,
+        ERROR,
+        ABORTED
+    };
+
+    struct MessageResult {
+        MessageOutcome outcome = MessageOutcome::PROCESSED;
+        /** The code of a DENIED outcome. */
+        int code = 0;
+        /** The message of a DENIED outcome. */
+        std::string error;
+        /** For an ABORTED outcome, whether the message had been sent on the network. */
+        bool sentOnNetwork = false;
+    };
+
+    /**
+     * The awaiter of LightstreamerClient::sendMessageAsync(): sends the message and resumes with its
+     * outcome.
+     *
+     * The awaiter is itself the ClientMessageListener of the message, passed to the client through a
+     * non-owning shared_ptr, so a round-trip allocates no listener. The message must not be abandoned
+     * while pending: the coroutine must not be destroyed before it resumes.
+     */
+    template<typename Client>
+    class MessageAwaitable : private ClientMessageListener {
+    private:
+        Client &client;
+        std::string message;
+        std::string sequence;
+        int delayTimeout;
+        bool enqueueWhileDisconnected;
+        std::shared_ptr<JoinableExecutor> executor;
+        std::coroutine_handle<> handle;
+        MessageResult result;
+
+        void finish(MessageResult outcome) {
+            std::shared_ptr<JoinableExecutor> resumer = std::move(executor);
+            std::coroutine_handle<> suspended = handle;
+            result = std::move(outcome);
+            resumeOn(resumer, suspended);
+        }
+
+        void onAbort(const std::string &originalMessage, bool sentOnNetwork) override {
+            finish({MessageOutcome::ABORTED, 0, "", sentOnNetwork});
+        }
+
+        void onDeny(const std::string &originalMessage, int code, const std::string &error) override {
+            finish({MessageOutcome::DENIED, code, error, true});
+        }
+
+        void onDiscarded(const std::string &originalMessage) override {
+            finish({MessageOutcome::DISCARDED, 0, "", true});
+        }
+
+        void onError(const std::string &originalMessage) override {
+            finish({MessageOutcome::ERROR, 0, "", true});
+        }
+
+        void onProcessed(const std::string &originalMessage) override {
+            finish({MessageOutcome::PROCESSED, 0, "", true});
+        }
+
+    public:
+        MessageAwaitable(Client &client, std::string message, std::string sequence, int delayTimeout,
+                         bool enqueueWhileDisconnected, std::shared_ptr<JoinableExecutor> executor)
+                : client(client), message(std::move(message)), sequence(std::move(sequence)),
+                  delayTimeout(delayTimeout), enqueueWhileDisconnected(enqueueWhileDisconnected),
+                  executor(std::move(executor)) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> suspended) {
+            handle = suspended;
+            // Aliasing constructor with an empty owner: points to the awaiter without owning it.
+            std::shared_ptr<ClientMessageListener> listener(std::shared_ptr<void>(),
+                                                            static_cast<ClientMessageListener *>(this));
+            // The outcome may resume the coroutine on another thread before this call returns: the
+            // awaiter must not be touched afterwards.
+            client.sendMessage(message, sequence, delayTimeout, std::move(listener), enqueueWhileDisconnected);
+        }
+
+        MessageResult await_resume() {
+            return std::move(result);
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_CLIENTAWAITABLES_HPP
@@ -0,0 +1,211 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_STATEWAITERS_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_STATEWAITERS_HPP
+
+#include <coroutine>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
+
+namespace lightstreamer::client::async {
+
+    using util::threads::providers::JoinableExecutor;
+
+    /**
+     * Thrown by co_await when the awaited operation fails, e.g. a connection refused by the Server or a
+     * subscription error.
+     */
+    class AsyncError : public std::runtime_error {
+    private:
+        int code;
+
+    public:
+        AsyncError(int code, const std::string &message) : std::runtime_error(message), code(code) {}
+
+        /**
+         * @return The error code sent by the Server, or 0 for errors raised by the client.
+         */
+        int getCode() const noexcept {
+            return code;
+        }
+    };
+
+    /**
+     * Resumes a coroutine on the given executor, or inline on the calling thread if there is none. The
+     * task wrapping the handle fits in the InlineTask buffer, so resuming allocates nothing.
+     */
+    inline void resumeOn(const std::shared_ptr<JoinableExecutor> &executor, std::coroutine_handle<> handle) {
+        if (executor) {
+            executor->execute([handle] { handle.resume(); });
+        } else {
+            handle.resume();
+        }
+    }
+
+    template<typename State>
+    class WaiterList;
+
+    /**
+     * A coroutine waiting for a State to satisfy a condition.
+     *
+     * Waiters are the awaiters themselves, which live in the frame of the suspended coroutine, and are
+     * linked into their WaiterList intrusively: waiting allocates nothing.
+     */
+    template<typename State>
+    class Waiter {
+    private:
+        friend class WaiterList<State>;
+
+        WaiterList<State> *list = nullptr;
+        Waiter *prev = nullptr;
+        Waiter *next = nullptr;
+        std::coroutine_handle<> handle;
+        std::shared_ptr<JoinableExecutor> executor;
+
+    protected:
+        /**
+         * Called with the list lock held, whenever the state changes. Records the outcome of the wait.
+         *
+         * @return true if the wait is over.
+         */
+        virtual bool complete(const State &state) = 0;
+
+    public:
+        Waiter() = default;
+        Waiter(const Waiter &) = delete;
+        Waiter &operator=(const Waiter &) = delete;
+
+        /**
+         * Unlinks the waiter if its coroutine is destroyed while suspended.
+         */
+        virtual ~Waiter() {
+            if (list) {
+                list->remove(*this);
+            }
+        }
+    };
+
+    /**
+     * A State guarded by a lock, together with the coroutines waiting for it to change.
+     */
+    template<typename State>
+    class WaiterList {
+    private:
+        mutable std::mutex mutex;
+        State state;
+        Waiter<State> *head = nullptr;
+
+        // Requires mutex.
+        void unlink(Waiter<State> &waiter) {
+            if (waiter.prev) {
+                waiter.prev->next = waiter.next;
+            } else {
+                head = waiter.next;
+            }
+            if (waiter.next) {
+                waiter.next->prev = waiter.prev;
+            }
+            waiter.prev = waiter.next = nullptr;
+            waiter.list = nullptr;
+        }
+
+    public:
+        explicit WaiterList(State initial = State()) : state(std::move(initial)) {}
+
+        WaiterList(const WaiterList &) = delete;
+        WaiterList &operator=(const WaiterList &) = delete;
+
+        State snapshot() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return state;
+        }
+
+        /**
+         * Links the waiter, unless it is already complete for the current state. Meant to be called by
+         * await_suspend, whose return value it is.
+         *
+         * @return true if the waiter was linked and the coroutine must stay suspended.
+         */
+        bool suspend(Waiter<State> &waiter, std::coroutine_handle<> handle, std::shared_ptr<JoinableExecutor> executor) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (waiter.complete(state)) {
+                return false;
+            }
+            waiter.handle = handle;
+            waiter.executor = std::move(executor);
+            waiter.list = this;
+            waiter.prev = nullptr;
+            waiter.next = head;
+            if (head) {
+                head->prev = &waiter;
+            }
+            head = &waiter;
+            return true;
+        }
+
+        void remove(Waiter<State> &waiter) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (waiter.list == this) {
+                unlink(waiter);
+            }
+        }
+
+        /**
+         * Applies the change to the state and resumes the waiters it completes. They are resumed after the
+         * lock is released, so a resumed coroutine may wait again on the same list.
+         */
+        template<typename F>
+        void update(F &&change) {
+            Waiter<State> *ready = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                change(state);
+                for (Waiter<State> *waiter = head; waiter;) {
+                    Waiter<State> *next = waiter->next;
+                    if (waiter->complete(state)) {
+                        unlink(*waiter);
+                        waiter->next = ready;
+                        ready = waiter;
+                    }
+                    waiter = next;
+                }
+            }
+            while (ready) {
+                // The waiter belongs to the coroutine frame: read it all before resuming.
+                Waiter<State> *waiter = ready;
+                ready = waiter->next;
+                std::coroutine_handle<> handle = waiter->handle;
+                std::shared_ptr<JoinableExecutor> executor = std::move(waiter->executor);
+                resumeOn(executor, handle);
+            }
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_STATEWAITERS_HPP
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_SUBSCRIBEDAWAITABLE_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_SUBSCRIBEDAWAITABLE_HPP
+
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <lightstreamer/client/async/StateWaiters.hpp>
+
+namespace lightstreamer::client::async {
+
+    /**
+     * The state of a subscription, as seen by its listeners.
+     */
+    struct SubscriptionState {
+        bool subscribed = false;
+        // Subscription errors seen so far, so that a waiter can tell whether one happened after it
+        // started waiting.
+        std::uint64_t errors = 0;
+        int errorCode = 0;
+        std::string errorMessage;
+    };
+
+    /**
+     * The awaiter of Subscription::subscribedAsync(): resumes once the Server has confirmed the
+     * subscription, or throws AsyncError if it rejects it. It completes at once if the subscription is
+     * already subscribed.
+     */
+    class SubscribedAwaitable : private Waiter<SubscriptionState> {
+    private:
+        std::shared_ptr<WaiterList<SubscriptionState>> waiters;
+        std::shared_ptr<JoinableExecutor> executor;
+        std::uint64_t baselineErrors = 0;
+        bool failed = false;
+        int errorCode = 0;
+        std::string errorMessage;
+
+        bool complete(const SubscriptionState &state) override {
+            if (state.errors != baselineErrors) {
+                failed = true;
+                errorCode = state.errorCode;
+                errorMessage = state.errorMessage;
+                return true;
+            }
+            return state.subscribed;
+        }
+
+    public:
+        /**
+         * @param waiters The state of the subscription, kept up to date by its SubscriptionStateBridge.
+         * @param executor The executor the coroutine is resumed on; null to resume it on the events thread.
+         */
+        SubscribedAwaitable(std::shared_ptr<WaiterList<SubscriptionState>> waiters,
+                            std::shared_ptr<JoinableExecutor> executor)
+                : waiters(std::move(waiters)), executor(std::move(executor)) {}
+
+        bool await_ready() {
+            SubscriptionState state = waiters->snapshot();
+            baselineErrors = state.errors;
+            return state.subscribed;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return waiters->suspend(*this, handle, executor);
+        }
+
+        void await_resume() const {
+            if (failed) {
+                throw AsyncError(errorCode, errorMessage);
+            }
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_SUBSCRIBEDAWAITABLE_HPP
@@ -0,0 +1,145 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_SUBSCRIPTIONAWAITABLES_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_SUBSCRIPTIONAWAITABLES_HPP
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <lightstreamer/client/ItemUpdate.hpp>
+#include <lightstreamer/client/SubscriptionListener.hpp>
+#include <lightstreamer/client/async/StateWaiters.hpp>
+#include <lightstreamer/client/async/SubscribedAwaitable.hpp>
+#include <lightstreamer/client/async/UpdateStream.hpp>
+
+namespace lightstreamer::client::async {
+
+    /**
+     * A listener added once to a Subscription, which keeps its SubscriptionState and resumes the
+     * coroutines waiting for it.
+     */
+    class SubscriptionStateBridge : public SubscriptionListener {
+    private:
+        WaiterList<SubscriptionState> waiters;
+
+    public:
+        explicit SubscriptionStateBridge(bool subscribed) : waiters(SubscriptionState{subscribed}) {}
+
+        WaiterList<SubscriptionState> &getWaiters() {
+            return waiters;
+        }
+
+        void onClearSnapshot(const std::string &itemName, int itemPos) override {}
+
+        void onCommandSecondLevelItemLostUpdates(int lostUpdates, const std::string &key) override {}
+
+        void onCommandSecondLevelSubscriptionError(int code, const std::string &message, const std::string &key) override {}
+
+        void onEndOfSnapshot(const std::string &itemName, int itemPos) override {}
+
+        void onItemLostUpdates(const std::string &itemName, int itemPos, int lostUpdates) override {}
+
+        void onItemUpdate(const ItemUpdate &itemUpdate) override {}
+
+        void onItemUpdates(std::span<const ItemUpdate> itemUpdates) override {}
+
+        void onListenEnd(const Subscription &subscription) override {}
+
+        void onListenStart(const Subscription &subscription) override {}
+
+        void onSubscription() override {
+            waiters.update([](SubscriptionState &state) { state.subscribed = true; });
+        }
+
+        void onSubscriptionError(int code, const std::string &message) override {
+            waiters.update([&](SubscriptionState &state) {
+                ++state.errors;
+                state.errorCode = code;
+                state.errorMessage = message;
+            });
+        }
+
+        void onUnsubscription() override {
+            waiters.update([](SubscriptionState &state) { state.subscribed = false; });
+        }
+
+        void onRealMaxFrequency(const std::string &frequency) override {}
+    };
+
+    /**
+     * An asynchronous sequence of the updates of a Subscription, obtained from Subscription::updates():
+     *
+     *     while (auto update = co_await stream->next()) { ... }
+     *
+     * The stream is a listener of the Subscription, buffering its updates as described in UpdateStream. The
+     * sequence also ends when the stream is removed from the Subscription.
+     */
+    class ItemUpdateStream : public SubscriptionListener, public UpdateStream<ItemUpdate> {
+    public:
+        /**
+         * @param capacity The number of updates buffered for a slow consumer.
+         * @param executor The executor the consumer is resumed on; null to resume it on the events thread.
+         * @throws std::invalid_argument if capacity is zero.
+         */
+        explicit ItemUpdateStream(std::size_t capacity, std::shared_ptr<JoinableExecutor> executor = nullptr)
+                : UpdateStream<ItemUpdate>(capacity, std::move(executor)) {}
+
+        void onItemUpdate(const ItemUpdate &itemUpdate) override {
+            push(std::span<const ItemUpdate>(&itemUpdate, 1));
+        }
+
+        void onItemUpdates(std::span<const ItemUpdate> itemUpdates) override {
+            push(itemUpdates);
+        }
+
+        void onListenEnd(const Subscription &subscription) override {
+            close();
+        }
+
+        void onClearSnapshot(const std::string &itemName, int itemPos) override {}
+
+        void onCommandSecondLevelItemLostUpdates(int lostUpdates, const std::string &key) override {}
+
+        void onCommandSecondLevelSubscriptionError(int code, const std::string &message, const std::string &key) override {}
+
+        void onEndOfSnapshot(const std::string &itemName, int itemPos) override {}
+
+        void onItemLostUpdates(const std::string &itemName, int itemPos, int lostUpdates) override {}
+
+        void onListenStart(const Subscription &subscription) override {}
+
+        void onSubscription() override {}
+
+        void onSubscriptionError(int code, const std::string &message) override {}
+
+        void onUnsubscription() override {}
+
+        void onRealMaxFrequency(const std::string &frequency) override {}
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_SUBSCRIPTIONAWAITABLES_HPP
@@ -0,0 +1,198 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_UPDATESTREAM_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_UPDATESTREAM_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <lightstreamer/client/async/StateWaiters.hpp>
+
+namespace lightstreamer::client::async {
+
+    /**
+     * An asynchronous sequence of updates, consumed by a coroutine:
+     *
+     *     while (auto update = co_await stream.next()) { ... }
+     *
+     * The updates are buffered in a ring of fixed capacity, allocated once; when the consumer falls behind,
+     * the oldest updates are dropped and counted (see getDroppedCount()). Only one coroutine may consume a
+     * stream. The sequence ends, with an empty optional, after close().
+     */
+    template<typename Update>
+    class UpdateStream {
+    private:
+        std::mutex mutex;
+        std::vector<std::optional<Update>> ring;
+        std::size_t first = 0;
+        std::size_t count = 0;
+        std::uint64_t dropped = 0;
+        bool closed = false;
+        std::coroutine_handle<> consumer;
+        std::shared_ptr<JoinableExecutor> consumerExecutor;
+        std::shared_ptr<JoinableExecutor> executor;
+
+        // Requires mutex. Returns the consumer to resume, if any.
+        std::coroutine_handle<> takeConsumer() {
+            std::coroutine_handle<> handle = consumer;
+            consumer = nullptr;
+            return handle;
+        }
+
+        void resume(std::coroutine_handle<> handle, std::shared_ptr<JoinableExecutor> resumer) {
+            if (handle) {
+                resumeOn(resumer, handle);
+            }
+        }
+
+        // Requires mutex.
+        void append(const Update &update) {
+            if (closed) {
+                return;
+            }
+            if (count == ring.size()) {
+                ring[first].reset();
+                first = (first + 1) % ring.size();
+                --count;
+                ++dropped;
+            }
+            ring[(first + count) % ring.size()].emplace(update);
+            ++count;
+        }
+
+    public:
+        class NextAwaitable {
+        private:
+            UpdateStream &stream;
+
+        public:
+            explicit NextAwaitable(UpdateStream &stream) : stream(stream) {}
+
+            bool await_ready() {
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                return stream.count > 0 || stream.closed;
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle) {
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                if (stream.count > 0 || stream.closed) {
+                    return false;
+                }
+                if (stream.consumer) {
+                    throw std::logic_error("An update stream can be consumed by one coroutine only");
+                }
+                stream.consumer = handle;
+                stream.consumerExecutor = stream.executor;
+                return true;
+            }
+
+            std::optional<Update> await_resume() {
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                if (stream.count == 0) {
+                    return std::nullopt;
+                }
+                std::optional<Update> update = std::move(stream.ring[stream.first]);
+                stream.ring[stream.first].reset();
+                stream.first = (stream.first + 1) % stream.ring.size();
+                --stream.count;
+                return update;
+            }
+        };
+
+        /**
+         * @param capacity The number of updates buffered for a slow consumer.
+         * @param executor The executor the consumer is resumed on; null to resume it on the producing thread.
+         * @throws std::invalid_argument if capacity is zero.
+         */
+        explicit UpdateStream(std::size_t capacity, std::shared_ptr<JoinableExecutor> executor = nullptr)
+                : ring(capacity), executor(std::move(executor)) {
+            if (capacity == 0) {
+                throw std::invalid_argument("The stream needs room for at least one update");
+            }
+        }
+
+        UpdateStream(const UpdateStream &) = delete;
+        UpdateStream &operator=(const UpdateStream &) = delete;
+
+        /**
+         * @return An awaitable yielding the next update, or an empty optional once the stream is closed
+         * and drained.
+         */
+        NextAwaitable next() {
+            return NextAwaitable(*this);
+        }
+
+        /**
+         * Buffers the updates and resumes the consumer. Updates pushed after close() are ignored.
+         */
+        void push(std::span<const Update> updates) {
+            std::coroutine_handle<> handle;
+            std::shared_ptr<JoinableExecutor> resumer;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const auto &update: updates) {
+                    append(update);
+                }
+                if (count > 0) {
+                    handle = takeConsumer();
+                    resumer = std::move(consumerExecutor);
+                }
+            }
+            resume(handle, std::move(resumer));
+        }
+
+        /**
+         * Ends the sequence once the buffered updates are consumed. Further updates are ignored.
+         */
+        void close() {
+            std::coroutine_handle<> handle;
+            std::shared_ptr<JoinableExecutor> resumer;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+                handle = takeConsumer();
+                resumer = std::move(consumerExecutor);
+            }
+            resume(handle, std::move(resumer));
+        }
+
+        /**
+         * @return The number of updates dropped because the buffer was full.
+         */
+        std::uint64_t getDroppedCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return dropped;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_UPDATESTREAM_HPP
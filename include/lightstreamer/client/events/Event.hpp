@@ -31,6 +31,12 @@ namespace lightstreamer::client::events {
     public:
         virtual ~Event() = default;
         virtual void applyTo(T& listener) const = 0;
+
+        /**
+         * Called on the events thread after each queue entry carrying the event has been run, whether or not
+         * a listener was still there to receive it.
+         */
+        virtual void onDequeued() const {}
     };
 
 }
@@ -25,10 +25,12 @@
 #define EVENTDISPATCHER_H
 
 
-#include <unordered_map>
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <thread>
 #include <mutex>
+#include <type_traits>
 #include <lightstreamer/client/events/Event.hpp>
 #include <lightstreamer/client/events/EventsThread.hpp>
 #include <Logger.hpp>
@@ -38,89 +40,189 @@
 
 namespace lightstreamer::client::events {
 
+    /**
+     * How EventDispatcher::dispatchEvent hands an event over to the events thread.
+     */
+    enum class DispatchMode {
+        /**
+         * A single queue entry carries the event and the current listener snapshot; the events thread
+         * iterates the listeners itself.
+         */
+        FAN_OUT,
+        /**
+         * One queue entry per listener.
+         */
+        PER_LISTENER
+    };
 
     template<typename T>
     class EventDispatcher {
 
         class ListenerWrapper {
         public:
-            T listener;
-            bool alive = true;
+            std::shared_ptr<T> listener;
+            // The events thread chosen by the user for this listener, or nullptr for the dispatcher's own.
+            std::shared_ptr<EventsThread> executor;
+            std::atomic<bool> alive{true};
 
-            explicit ListenerWrapper(T listener) : listener(listener) {}
+            ListenerWrapper(std::shared_ptr<T> listener, std::shared_ptr<EventsThread> executor)
+                    : listener(std::move(listener)), executor(std::move(executor)) {}
         };
 
-        std::unordered_map<T, std::shared_ptr<ListenerWrapper>> listeners;
-        std::unique_ptr<EventsThread> eventThread;
+        using Snapshot = std::vector<std::shared_ptr<ListenerWrapper>>;
+
+        /**
+         * Immutable copy-on-write list of the current listeners. Readers load it without locking;
+         * addListener/removeListener publish a modified copy.
+         */
+        std::atomic<std::shared_ptr<const Snapshot>> listeners{std::make_shared<const Snapshot>()};
+        std::shared_ptr<EventsThread> eventThread;
+        DispatchMode mode;
 
         std::shared_ptr<Logger::ConsoleLogger> log = Logger::ConsoleLogger::getInstance(ConsoleLogLevel::Level::TRACE,
                                                                                         Constants::THREADS_LOG);
 
 
     public:
-        explicit EventDispatcher(std::unique_ptr<EventsThread> thread) : eventThread(std::move(thread)) {
+        explicit EventDispatcher(std::shared_ptr<EventsThread> thread, DispatchMode mode = DispatchMode::FAN_OUT)
+                : eventThread(std::move(thread)), mode(mode) {
             if (!eventThread) {
                 throw std::runtime_error("An EventThread is required");
             }
         }
 
-        void addListener(const T &listener, const Event<T> &startEvent) {
+        /**
+         * Adds a listener. Its events are delivered on the dispatcher's events thread, unless an executor is
+         * given, in which case they are delivered, still in order, on that events thread.
+         */
+        void addListener(const std::shared_ptr<T> &listener, std::shared_ptr<const Event<T>> startEvent = nullptr,
+                         std::shared_ptr<EventsThread> executor = nullptr) {
             std::lock_guard<std::mutex> lock(mutex);
-            if (listeners.find(listener) != listeners.end()) {
+            auto current = listeners.load(std::memory_order_acquire);
+            if (find(*current, listener) != nullptr) {
                 return;
             }
 
-            auto wrapper = std::make_shared<ListenerWrapper>(listener);
-            listeners[listener] = wrapper;
-            dispatchEventToListener(startEvent, wrapper, true);
+            auto wrapper = std::make_shared<ListenerWrapper>(listener, std::move(executor));
+            auto updated = std::make_shared<Snapshot>(*current);
+            updated->push_back(wrapper);
+            listeners.store(std::move(updated), std::memory_order_release);
+            if (startEvent) {
+                dispatchEventToListener(std::move(startEvent), wrapper, true);
+            }
         }
 
-        void removeListener(const T &listener, const Event<T> &endEvent) {
+        void removeListener(const std::shared_ptr<T> &listener, std::shared_ptr<const Event<T>> endEvent = nullptr) {
             std::lock_guard<std::mutex> lock(mutex);
-            auto it = listeners.find(listener);
-            if (it == listeners.end()) {
+            auto current = listeners.load(std::memory_order_acquire);
+            auto wrapper = find(*current, listener);
+            if (wrapper == nullptr) {
                 return;
             }
 
-            auto wrapper = it->second;
-            listeners.erase(it);
-            wrapper->alive = false;
-            dispatchEventToListener(endEvent, wrapper, true);
+            auto updated = std::make_shared<Snapshot>();
+            updated->reserve(current->size() - 1);
+            for (const auto &w: *current) {
+                if (w != wrapper) {
+                    updated->push_back(w);
+                }
+            }
+            listeners.store(std::move(updated), std::memory_order_release);
+            wrapper->alive.store(false, std::memory_order_release);
+            if (endEvent) {
+                dispatchEventToListener(std::move(endEvent), wrapper, true);
+            }
         }
 
-        void dispatchEvent(const Event<T> &event) {
-            std::lock_guard<std::mutex> lock(mutex);
-            for (auto &[key, wrapper]: listeners) {
-                dispatchEventToListener(event, wrapper, false);
+        /**
+         * Queues the event for the current listeners.
+         *
+         * @return false if there was no listener, in which case the event is dropped.
+         */
+        bool dispatchEvent(std::shared_ptr<const Event<T>> event) {
+            auto snapshot = listeners.load(std::memory_order_acquire);
+            if (snapshot->empty()) {
+                return false;
             }
+            if (mode == DispatchMode::PER_LISTENER) {
+                for (const auto &wrapper: *snapshot) {
+                    dispatchEventToListener(event, wrapper, false);
+                }
+                return true;
+            }
+            bool shared = false;
+            for (const auto &wrapper: *snapshot) {
+                if (wrapper->executor) {
+                    dispatchEventToListener(event, wrapper, false);
+                } else {
+                    shared = true;
+                }
+            }
+            if (!shared) {
+                return true;
+            }
+            // The events thread may be shared and outlive the dispatcher: the task must not refer to it.
+            eventThread->queue([event = std::move(event), snapshot = std::move(snapshot), log = log]() {
+                for (const auto &wrapper: *snapshot) {
+                    if (!wrapper->executor) {
+                        deliver(*event, *wrapper, false, *log);
+                    }
+                }
+                event->onDequeued();
+            });
+            return true;
+        }
+
+        /**
+         * Dispatches an event passed by value, e.g. dispatchEvent(SubscriptionListenerEndOfSnapshotEvent(name, item)).
+         */
+        template<typename E, typename = std::enable_if_t<std::is_base_of_v<Event<T>, std::decay_t<E>>>>
+        bool dispatchEvent(E &&event) {
+            return dispatchEvent(std::shared_ptr<const Event<T>>(std::make_shared<const std::decay_t<E>>(std::forward<E>(event))));
         }
 
         int size() const {
-            std::lock_guard<std::mutex> lock(mutex);
-            return listeners.size();
+            return static_cast<int>(listeners.load(std::memory_order_acquire)->size());
         }
 
-        std::vector<T> getListeners() const {
-            std::lock_guard<std::mutex> lock(mutex);
-            std::vector<T> result;
-            for (const auto &[key, wrapper]: listeners) {
+        std::vector<std::shared_ptr<T>> getListeners() const {
+            auto snapshot = listeners.load(std::memory_order_acquire);
+            std::vector<std::shared_ptr<T>> result;
+            result.reserve(snapshot->size());
+            for (const auto &wrapper: *snapshot) {
                 result.push_back(wrapper->listener);
             }
             return result;
         }
 
     private:
+        // Serializes writers only; dispatchEvent never takes it.
         mutable std::mutex mutex;
 
-        void dispatchEventToListener(const Event<T> &event, std::shared_ptr<ListenerWrapper> wrapper, bool forced) {
-            eventThread->queue([event, wrapper, forced, this]() {
-                if (wrapper->alive || forced) {
-                    try {
-                        event.applyTo(wrapper->listener);
-                    } catch (const std::exception &e) {
-                        log->Error("Exception caught while executing event on custom code", e);
-                    }
+        static std::shared_ptr<ListenerWrapper> find(const Snapshot &snapshot, const std::shared_ptr<T> &listener) {
+            for (const auto &wrapper: snapshot) {
+                if (wrapper->listener == listener) {
+                    return wrapper;
                 }
+            }
+            return nullptr;
+        }
+
+        static void deliver(const Event<T> &event, ListenerWrapper &wrapper, bool forced, Logger::ConsoleLogger &log) {
+            if (wrapper.alive.load(std::memory_order_acquire) || forced) {
+                try {
+                    event.applyTo(*wrapper.listener);
+                } catch (const std::exception &e) {
+                    log.Error("Exception caught while executing event on custom code", e);
+                }
+            }
+        }
+
+        void dispatchEventToListener(std::shared_ptr<const Event<T>> event, std::shared_ptr<ListenerWrapper> wrapper, bool forced) {
+            EventsThread &thread = wrapper->executor ? *wrapper->executor : *eventThread;
+            thread.queue([event = std::move(event), wrapper = std::move(wrapper), forced, log = log]() {
+                deliver(*event, *wrapper, forced, *log);
+                event->onDequeued();
             });
         }
     };
@@ -26,54 +26,369 @@
 
 
 #include <functional>
-#include <queue>
 #include <thread>
-#include <mutex>
-#include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
 #include <Logger.hpp>
 #include <ConsoleLogLevel.hpp>
+#include <lightstreamer/util/threads/MpscQueue.hpp>
+#include <lightstreamer/util/threads/InlineTask.hpp>
+#include <lightstreamer/util/threads/WaitStrategy.hpp>
+#include <lightstreamer/util/threads/ThreadConfig.hpp>
+#include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
 
 
 namespace lightstreamer::client::events {
-class EventsThread {
-    std::queue<std::function<void()>> tasks;
-    std::mutex queue_mutex;
-    std::condition_variable condition;
+
+/**
+ * What a client does with item updates when its events queue is over capacity.
+ */
+enum class EventQueueOverflowPolicy {
+    /**
+     * The producing thread waits until the queue drains below capacity.
+     */
+    BLOCK,
+    /**
+     * Updates are discarded and the listeners are told through onItemLostUpdates.
+     */
+    DROP,
+    /**
+     * Updates for an item still waiting in the queue are merged into the newest one (MERGE mode only;
+     * other modes behave as DROP).
+     */
+    CONFLATE
+};
+
+/**
+ * Receives watermark crossings of an EventsThread queue. Callbacks run synchronously on the thread that
+ * observed the crossing (a producer for the high watermark, the events thread for the low one) and must
+ * not block. No lock of the queue is held meanwhile, so they may change the watermarks.
+ */
+class EventQueueListener {
+public:
+    virtual ~EventQueueListener() = default;
+
+    virtual void onHighWatermark(std::size_t depth) = 0;
+
+    virtual void onLowWatermark(std::size_t depth) = 0;
+};
+
+/**
+ * Single consumer thread delivering events to user listeners.
+ *
+ * Tasks are enqueued on a lock-free MPSC queue and drained in batches. When the queue is empty the worker
+ * waits according to its WaitStrategy (parking at once by default); producers issue a wake-up (futex)
+ * only when the worker is actually parked, so while it is busy or spinning queue() is a single atomic
+ * exchange.
+ *
+ * The thread keeps a queue depth gauge and the enqueue time of the oldest pending event, and notifies
+ * registered EventQueueListeners when the depth crosses their watermarks.
+ *
+ * An instance created by onExecutor() owns no thread: the queue is drained by tasks submitted to an
+ * executor of the application (e.g. a handler posted to its event loop), still one at a time and in order.
+ */
+class EventsThread : public std::enable_shared_from_this<EventsThread> {
+public:
+    static constexpr std::size_t DEFAULT_POOL_SIZE = 4096;
+    static constexpr std::size_t MAX_BATCH = 256;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t NO_WATERMARK = std::numeric_limits<std::size_t>::max();
+
+    struct QueuedTask {
+        util::threads::InlineTask task;
+        Clock::rep enqueued;
+    };
+
+    struct Watermarks {
+        std::shared_ptr<EventQueueListener> listener;
+        std::size_t high;
+        std::size_t low;
+        bool above = false;
+    };
+
+    util::threads::MpscQueue<QueuedTask> tasks;
+    util::threads::IdleWaiter idle;
     std::atomic<bool> stop;
+
+    // Tasks queued and not yet completed, plus the backlog they carry (see addBacklog()).
+    std::atomic<std::size_t> depth{0};
+    // Tasks queued and not yet completed: the drain tasks rely on this count to find a task to pop.
+    std::atomic<std::size_t> pendingTasks{0};
+    // Enqueue time of the task being run or about to run; 0 when idle.
+    std::atomic<Clock::rep> oldestEnqueued{0};
+    std::atomic<std::size_t> blockedProducers{0};
+
+    std::mutex watermarksMutex;
+    std::vector<Watermarks> watermarks;
+    std::atomic<std::size_t> lowestHigh{NO_WATERMARK};
+    std::atomic<std::size_t> aboveCount{0};
+
     std::thread worker_thread;
+    // Set by onExecutor(): the executor running the drain tasks instead of worker_thread.
+    std::shared_ptr<util::threads::providers::JoinableExecutor> executor;
+    // The thread running a drain task, if any.
+    std::atomic<std::thread::id> drainingThread{};
     std::shared_ptr<Logger::ConsoleLogger> logger = Logger::ConsoleLogger::getInstance(ConsoleLogLevel::Level::TRACE, "category");
 
 
     void worker() {
-        while (!stop) {
-            std::function<void()> task;
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex);
-                condition.wait(lock, [this] { return stop || !tasks.empty(); });
-                if (stop && tasks.empty()) return;
-                task = std::move(tasks.front());
-                tasks.pop();
+        if (!util::threads::ThreadConfig::getInstance().applyToCurrentThread(util::threads::ThreadRole::EVENTS)) {
+            logger->Warn("Could not apply the thread settings of the events thread");
+        }
+        auto run = [this](QueuedTask&& queued) {
+            oldestEnqueued.store(queued.enqueued, std::memory_order_relaxed);
+            queued.task.run();
+            pendingTasks.fetch_sub(1, std::memory_order_seq_cst);
+            onDequeued(depth.fetch_sub(1, std::memory_order_seq_cst) - 1);
+        };
+        while (true) {
+            if (tasks.drain(run, MAX_BATCH) > 0) {
+                continue;
+            }
+            oldestEnqueued.store(0, std::memory_order_relaxed);
+            if (stop.load(std::memory_order_acquire)) {
+                // Queued tasks are delivered before the thread exits.
+                if (tasks.empty()) return;
+                continue;
             }
-            task();
+            idle.await([this] { return !tasks.empty() || stop.load(std::memory_order_seq_cst); });
         }
     }
 
+    void wakeUp() {
+        idle.wake();
+    }
+
+    /**
+     * Submits a drain task to the executor. There is exactly one drain task submitted or running while
+     * tasks are pending: the producer queueing the first one submits it, and a drain task that stops with
+     * tasks still pending submits the next one. The task keeps the instance alive.
+     */
+    void submitDrain() {
+        executor->execute([self = shared_from_this()] { self->drain(); });
+    }
+
+    // Runs up to MAX_BATCH tasks, then yields the executor thread to the application's own tasks.
+    void drain() {
+        std::thread::id self = std::this_thread::get_id();
+        drainingThread.store(self, std::memory_order_relaxed);
+        std::size_t remaining = 1;
+        Clock::rep enqueued = 0;
+        for (std::size_t n = 0; n < MAX_BATCH && remaining > 0; ++n) {
+            // pendingTasks counts completed pushes only, so a task is there to be popped.
+            std::optional<QueuedTask> queued = tasks.tryPop();
+            enqueued = queued->enqueued;
+            oldestEnqueued.store(enqueued, std::memory_order_relaxed);
+            queued->task.run();
+            remaining = pendingTasks.fetch_sub(1, std::memory_order_seq_cst) - 1;
+            onDequeued(depth.fetch_sub(1, std::memory_order_seq_cst) - 1);
+        }
+        // A drain task submitted meanwhile may already be running elsewhere: leave its values alone.
+        oldestEnqueued.compare_exchange_strong(enqueued, 0, std::memory_order_relaxed);
+        drainingThread.compare_exchange_strong(self, std::thread::id(), std::memory_order_relaxed);
+        if (remaining > 0) {
+            submitDrain();
+        }
+    }
+
+    bool isEventsThread() const {
+        std::thread::id self = std::this_thread::get_id();
+        return self == worker_thread.get_id() || self == drainingThread.load(std::memory_order_relaxed);
+    }
+
+    explicit EventsThread(std::shared_ptr<util::threads::providers::JoinableExecutor> executor, std::size_t poolSize)
+            : tasks(poolSize), stop(false), executor(std::move(executor)) {}
+
+    // The callbacks run after watermarksMutex is released, so that they may change the watermarks.
+    void onEnqueued(std::size_t newDepth) {
+        if (newDepth < lowestHigh.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::vector<std::shared_ptr<EventQueueListener>> crossed;
+        {
+            std::lock_guard<std::mutex> lock(watermarksMutex);
+            for (auto& w : watermarks) {
+                if (!w.above && newDepth >= w.high) {
+                    w.above = true;
+                    aboveCount.fetch_add(1, std::memory_order_relaxed);
+                    crossed.push_back(w.listener);
+                }
+            }
+        }
+        for (const auto& listener : crossed) {
+            listener->onHighWatermark(newDepth);
+        }
+    }
+
+    void onDequeued(std::size_t newDepth) {
+        if (blockedProducers.load(std::memory_order_seq_cst) > 0) {
+            depth.notify_all();
+        }
+        if (aboveCount.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        std::vector<std::shared_ptr<EventQueueListener>> crossed;
+        {
+            std::lock_guard<std::mutex> lock(watermarksMutex);
+            for (auto& w : watermarks) {
+                if (w.above && newDepth <= w.low) {
+                    w.above = false;
+                    aboveCount.fetch_sub(1, std::memory_order_relaxed);
+                    crossed.push_back(w.listener);
+                }
+            }
+        }
+        for (const auto& listener : crossed) {
+            listener->onLowWatermark(newDepth);
+        }
+    }
+
+    void updateLowestHigh() {
+        std::size_t lowest = NO_WATERMARK;
+        for (const auto& w : watermarks) {
+            lowest = std::min(lowest, w.high);
+        }
+        lowestHigh.store(lowest, std::memory_order_relaxed);
+    }
+
 public:
-    EventsThread() : stop(false), worker_thread(&EventsThread::worker, this) {}
+    explicit EventsThread(std::size_t poolSize = DEFAULT_POOL_SIZE,
+                          util::threads::WaitStrategy waitStrategy = util::threads::WaitStrategy::blocking())
+            : tasks(poolSize), idle(waitStrategy), stop(false), worker_thread(&EventsThread::worker, this) {}
+
+    /**
+     * Creates an events queue drained on the given executor, starting no thread. Events are delivered in
+     * batches of at most MAX_BATCH, each batch being one task of the executor, so a single-threaded event
+     * loop keeps serving its other work between batches.
+     *
+     * The executor may run tasks on any number of threads: the batches never overlap.
+     *
+     * @param executor The executor running the deliveries.
+     * @param poolSize The number of preallocated queue nodes.
+     * @throws std::invalid_argument if executor is null.
+     */
+    static std::shared_ptr<EventsThread> onExecutor(std::shared_ptr<util::threads::providers::JoinableExecutor> executor,
+                                                    std::size_t poolSize = DEFAULT_POOL_SIZE) {
+        if (!executor) {
+            throw std::invalid_argument("Specify an executor");
+        }
+        return std::shared_ptr<EventsThread>(new EventsThread(std::move(executor), poolSize));
+    }
 
     ~EventsThread() {
-        stop = true;
-        condition.notify_all();
+        stop.store(true, std::memory_order_seq_cst);
+        wakeUp();
         if (worker_thread.joinable()) worker_thread.join();
     }
 
-    void queue(const std::function<void()>& task) {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex);
-            tasks.emplace(task);
+    void queue(util::threads::InlineTask task) {
+        tasks.push(QueuedTask{std::move(task), Clock::now().time_since_epoch().count()});
+        std::size_t previous = pendingTasks.fetch_add(1, std::memory_order_seq_cst);
+        onEnqueued(depth.fetch_add(1, std::memory_order_seq_cst) + 1);
+        if (executor) {
+            if (previous == 0) {
+                submitDrain();
+            }
+        } else {
+            wakeUp();
+        }
+    }
+
+    /**
+     * Counts n more events carried by a task already queued, e.g. item updates appended to a queued batch,
+     * so that they weigh on the depth (and on the watermarks and the capacity checks) like separate tasks.
+     * Each call must be matched by releaseBacklog(), at the latest when the task runs.
+     */
+    void addBacklog(std::size_t n) {
+        onEnqueued(depth.fetch_add(n, std::memory_order_seq_cst) + n);
+    }
+
+    void releaseBacklog(std::size_t n) {
+        onDequeued(depth.fetch_sub(n, std::memory_order_seq_cst) - n);
+    }
+
+    /**
+     * The number of tasks queued and not yet completed, plus the backlog they carry.
+     */
+    std::size_t getQueueDepth() const {
+        return depth.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * How long the oldest pending task has been waiting, or zero when the queue is idle.
+     */
+    std::chrono::nanoseconds getOldestEventAge() const {
+        Clock::rep enqueued = oldestEnqueued.load(std::memory_order_relaxed);
+        if (enqueued == 0) {
+            return std::chrono::nanoseconds::zero();
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Clock::time_point(Clock::duration(enqueued)));
+    }
+
+    /**
+     * Registers (or updates) a listener notified when the depth reaches high and, afterwards, when it
+     * drops back to low.
+     */
+    void setWatermarks(const std::shared_ptr<EventQueueListener>& listener, std::size_t high, std::size_t low) {
+        if (low >= high) {
+            throw std::invalid_argument("The low watermark must be lower than the high watermark");
+        }
+        std::lock_guard<std::mutex> lock(watermarksMutex);
+        for (auto& w : watermarks) {
+            if (w.listener == listener) {
+                w.high = high;
+                w.low = low;
+                updateLowestHigh();
+                return;
+            }
+        }
+        watermarks.push_back(Watermarks{listener, high, low});
+        updateLowestHigh();
+    }
+
+    void removeWatermarks(const std::shared_ptr<EventQueueListener>& listener) {
+        std::lock_guard<std::mutex> lock(watermarksMutex);
+        for (auto it = watermarks.begin(); it != watermarks.end(); ++it) {
+            if (it->listener == listener) {
+                if (it->above) {
+                    aboveCount.fetch_sub(1, std::memory_order_relaxed);
+                }
+                watermarks.erase(it);
+                break;
+            }
+        }
+        updateLowestHigh();
+    }
+
+    /**
+     * Blocks the calling thread while the depth is at least capacity. Does nothing when called from the
+     * events thread itself (or from a drain task), which would otherwise deadlock.
+     */
+    void awaitDepthBelow(std::size_t capacity) {
+        if (isEventsThread()) {
+            return;
+        }
+        std::size_t current = depth.load(std::memory_order_acquire);
+        if (current < capacity) {
+            return;
+        }
+        blockedProducers.fetch_add(1, std::memory_order_seq_cst);
+        current = depth.load(std::memory_order_seq_cst);
+        while (current >= capacity && !stop.load(std::memory_order_acquire)) {
+            depth.wait(current, std::memory_order_seq_cst);
+            current = depth.load(std::memory_order_seq_cst);
         }
-        condition.notify_one();
+        blockedProducers.fetch_sub(1, std::memory_order_acq_rel);
     }
 };
 }
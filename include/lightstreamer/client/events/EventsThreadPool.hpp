@@ -0,0 +1,133 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_EVENTSTHREADPOOL_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_EVENTSTHREADPOOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <lightstreamer/client/events/EventsThread.hpp>
+
+namespace lightstreamer::client::events {
+
+    /**
+     * Process-wide pool of events threads (shards).
+     *
+     * Every LightstreamerClient and every Subscription is pinned to one shard when it is created, so
+     * the events of a single client or subscription keep their order, while unrelated subscriptions
+     * are delivered in parallel. With the default size of 1 all events go through one thread, as in
+     * previous versions.
+     */
+    class EventsThreadPool {
+    private:
+        std::mutex mutex;
+        std::vector<std::shared_ptr<EventsThread>> shards;
+        std::size_t size = 1;
+        util::threads::WaitStrategy waitStrategy = util::threads::WaitStrategy::blocking();
+        std::atomic<std::size_t> nextIndex{0};
+
+        EventsThreadPool() = default;
+
+        void ensureStarted() {
+            if (shards.empty()) {
+                shards.reserve(size);
+                for (std::size_t i = 0; i < size; ++i) {
+                    shards.push_back(std::make_shared<EventsThread>(EventsThread::DEFAULT_POOL_SIZE, waitStrategy));
+                }
+            }
+        }
+
+    public:
+        EventsThreadPool(const EventsThreadPool &) = delete;
+        EventsThreadPool &operator=(const EventsThreadPool &) = delete;
+
+        static EventsThreadPool &getInstance() {
+            static EventsThreadPool instance;
+            return instance;
+        }
+
+        /**
+         * Sets the number of events threads. It must be called before the library is actually used,
+         * i.e. before the first LightstreamerClient or Subscription is created.
+         *
+         * @param nThreads The number of shards, at least 1.
+         * @throws std::invalid_argument if nThreads is 0.
+         * @throws std::logic_error if the pool has already been started.
+         */
+        void setSize(std::size_t nThreads) {
+            if (nThreads == 0) {
+                throw std::invalid_argument("At least one events thread is required");
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!shards.empty()) {
+                throw std::logic_error("The events thread pool has already been started");
+            }
+            size = nThreads;
+        }
+
+        /**
+         * Sets how the events threads wait for new events. Like setSize(), it must be called before the
+         * pool is started.
+         *
+         * @throws std::logic_error if the pool has already been started.
+         */
+        void setWaitStrategy(util::threads::WaitStrategy strategy) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!shards.empty()) {
+                throw std::logic_error("The events thread pool has already been started");
+            }
+            waitStrategy = strategy;
+        }
+
+        std::size_t getSize() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return size;
+        }
+
+        /**
+         * Returns the next shard in round-robin order. Used to pin a new client or subscription.
+         */
+        std::shared_ptr<EventsThread> nextShard() {
+            std::lock_guard<std::mutex> lock(mutex);
+            ensureStarted();
+            return shards[nextIndex.fetch_add(1, std::memory_order_relaxed) % shards.size()];
+        }
+
+        /**
+         * Returns the shard associated with the given key, so that the same key always lands on the same thread.
+         */
+        std::shared_ptr<EventsThread> shardFor(const void *key) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ensureStarted();
+            return shards[std::hash<const void *>{}(key) % shards.size()];
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_EVENTSTHREADPOOL_HPP
@@ -0,0 +1,148 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_INLINELISTENERS_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_INLINELISTENERS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <Logger.hpp>
+#include <lightstreamer/client/Constants.hpp>
+
+namespace lightstreamer::client::events {
+
+    /**
+     * The listeners of a Subscription whose item updates are delivered inline, on the thread producing them.
+     *
+     * Each listener is registered with the adapter that stands for it in the EventDispatcher, which delivers
+     * its other events. The list is copy-on-write: dispatch() reads it without locking.
+     */
+    template<typename Listener, typename Update>
+    class InlineListeners {
+    public:
+        struct Entry {
+            std::shared_ptr<Listener> listener;
+            std::shared_ptr<Listener> adapter;
+            std::chrono::nanoseconds budget;
+        };
+
+    private:
+        using Snapshot = std::vector<Entry>;
+
+        // Serializes writers only.
+        std::mutex mutex;
+        std::atomic<std::shared_ptr<const Snapshot>> entries{std::make_shared<const Snapshot>()};
+        std::atomic<std::uint64_t> budgetOverruns{0};
+
+        inline static std::shared_ptr<Logger::ConsoleLogger> log =
+                Logger::ConsoleLogger::getInstance(ConsoleLogLevel::Level::TRACE, Constants::ACTIONS_LOG);
+
+    public:
+        /**
+         * @return false if the listener was already there.
+         */
+        bool add(std::shared_ptr<Listener> listener, std::shared_ptr<Listener> adapter, std::chrono::nanoseconds budget) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto current = entries.load(std::memory_order_acquire);
+            for (const auto &entry: *current) {
+                if (entry.listener == listener) {
+                    return false;
+                }
+            }
+            auto updated = std::make_shared<Snapshot>(*current);
+            updated->push_back({std::move(listener), std::move(adapter), budget});
+            entries.store(std::move(updated), std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @return The adapter of the listener, or null if it is not an inline listener.
+         */
+        std::shared_ptr<Listener> remove(const std::shared_ptr<Listener> &listener) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto current = entries.load(std::memory_order_acquire);
+            std::shared_ptr<Listener> adapter;
+            auto updated = std::make_shared<Snapshot>();
+            for (const auto &entry: *current) {
+                if (entry.listener == listener) {
+                    adapter = entry.adapter;
+                } else {
+                    updated->push_back(entry);
+                }
+            }
+            if (adapter) {
+                entries.store(std::move(updated), std::memory_order_release);
+            }
+            return adapter;
+        }
+
+        std::shared_ptr<const Snapshot> snapshot() const {
+            return entries.load(std::memory_order_acquire);
+        }
+
+        std::size_t size() const {
+            return entries.load(std::memory_order_acquire)->size();
+        }
+
+        /**
+         * Calls the listeners on the current thread, timing each call against its budget. An exception thrown
+         * by a listener is logged and does not keep the update from the others.
+         */
+        void dispatch(const Update &update) {
+            auto current = entries.load(std::memory_order_acquire);
+            for (const auto &entry: *current) {
+                auto start = std::chrono::steady_clock::now();
+                try {
+                    entry.listener->onItemUpdate(update);
+                } catch (const std::exception &e) {
+                    log->Error("Exception caught while executing inline listener", e);
+                }
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                if (elapsed > entry.budget) {
+                    budgetOverruns.fetch_add(1, std::memory_order_relaxed);
+                    log->Warn("Inline listener exceeded its budget: " +
+                              std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()) +
+                              "us spent on the session thread for item " + std::to_string(update.getItemPos()));
+                }
+            }
+        }
+
+        /**
+         * @return The number of calls that exceeded their budget.
+         */
+        std::uint64_t getBudgetOverruns() const {
+            return budgetOverruns.load(std::memory_order_relaxed);
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_INLINELISTENERS_HPP
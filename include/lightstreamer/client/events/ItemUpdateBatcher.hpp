@@ -0,0 +1,311 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_ITEMUPDATEBATCHER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_ITEMUPDATEBATCHER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+#include <lightstreamer/client/events/Event.hpp>
+#include <lightstreamer/client/events/EventDispatcher.hpp>
+#include <lightstreamer/client/events/EventsThread.hpp>
+
+namespace lightstreamer::client::events {
+
+    /**
+     * The number of item updates of a client waiting for its listeners, shared by the batchers of all its
+     * Subscriptions. The overflow policy of the client applies to it rather than to the depth of the events
+     * threads, which other clients may share.
+     */
+    class UpdateBacklog {
+    private:
+        mutable std::mutex mutex;
+        std::condition_variable released;
+        std::size_t depth = 0;
+
+    public:
+        std::size_t getDepth() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return depth;
+        }
+
+        void add(std::size_t count) {
+            std::lock_guard<std::mutex> lock(mutex);
+            depth += count;
+        }
+
+        void release(std::size_t count) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                depth -= count;
+            }
+            released.notify_all();
+        }
+
+        /**
+         * Waits until fewer than limit updates are waiting.
+         */
+        void awaitBelow(std::size_t limit) {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [&] { return depth < limit; });
+        }
+    };
+
+    /**
+     * Carries the item updates accumulated by a Subscription while this event was waiting in the events queue.
+     *
+     * The Subscription keeps appending to the event until it is sealed, which happens when the first listener
+     * receives it, when its queue entry has been run (even if no listener was left to receive it) or when the
+     * Subscription dispatches any other event, so that the ordering with respect to onEndOfSnapshot,
+     * onClearSnapshot and the like is preserved. After sealing, the updates are immutable and shared by all
+     * the listeners.
+     *
+     * The event takes one entry of the events queue; every further update is counted as backlog of the queue
+     * until the entry has been run, so that the depth seen by the watermarks is the number of updates waiting.
+     * Every update is also counted in the UpdateBacklog of the client, to which the overflow policy applies.
+     */
+    template<typename Listener, typename Update>
+    class ItemUpdatesEvent : public Event<Listener> {
+    private:
+        mutable std::mutex mutex;
+        mutable bool sealed = false;
+        std::vector<Update> itemUpdates;
+        std::shared_ptr<EventsThread> thread;
+        std::shared_ptr<UpdateBacklog> clientBacklog;
+        // Updates counted as backlog of the events queue and not yet released.
+        mutable std::size_t backlog = 0;
+        // Updates counted in the client backlog and not yet released.
+        mutable std::size_t counted = 0;
+
+        void append(Update &&itemUpdate) {
+            if (!itemUpdates.empty()) {
+                ++backlog;
+                thread->addBacklog(1);
+            }
+            ++counted;
+            clientBacklog->add(1);
+            itemUpdates.push_back(std::move(itemUpdate));
+        }
+
+    public:
+        ItemUpdatesEvent(std::shared_ptr<EventsThread> thread, std::shared_ptr<UpdateBacklog> clientBacklog)
+                : thread(std::move(thread)), clientBacklog(std::move(clientBacklog)) {}
+
+        /**
+         * Appends an update, unless the event has already been sealed.
+         *
+         * @return false if the event is sealed and a new one must be dispatched.
+         */
+        bool tryAppend(Update &&itemUpdate) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (sealed) {
+                return false;
+            }
+            append(std::move(itemUpdate));
+            return true;
+        }
+
+        /**
+         * Like tryAppend, but an update for an item that already has one in this event replaces it
+         * (see ItemUpdate::conflate) instead of being appended.
+         */
+        bool tryConflate(Update &&itemUpdate) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (sealed) {
+                return false;
+            }
+            for (auto it = itemUpdates.rbegin(); it != itemUpdates.rend(); ++it) {
+                if (it->getItemPos() == itemUpdate.getItemPos()) {
+                    it->conflate(std::move(itemUpdate));
+                    return true;
+                }
+            }
+            append(std::move(itemUpdate));
+            return true;
+        }
+
+        void seal() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            sealed = true;
+        }
+
+        std::size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return itemUpdates.size();
+        }
+
+        void applyTo(Listener &listener) const override {
+            seal();
+            listener.onItemUpdates(std::span<const Update>(itemUpdates));
+        }
+
+        void onDequeued() const override {
+            std::size_t released;
+            std::size_t releasedUpdates;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                sealed = true;
+                released = std::exchange(backlog, 0);
+                releasedUpdates = std::exchange(counted, 0);
+            }
+            if (released > 0) {
+                thread->releaseBacklog(released);
+            }
+            if (releasedUpdates > 0) {
+                clientBacklog->release(releasedUpdates);
+            }
+        }
+    };
+
+    /**
+     * Turns the item updates of a Subscription into ItemUpdatesEvents for its dispatcher, applying the
+     * overflow policy of the events queue.
+     *
+     * Consecutive updates share the pending event until it is sealed (see ItemUpdatesEvent), each still
+     * counting towards the UpdateBacklog of the client. When the backlog is at capacity, updates are discarded
+     * (DROP, reported later through the lost updates event), merged into the pending event (CONFLATE, for
+     * MERGE subscriptions only) or the producer waits (BLOCK).
+     */
+    template<typename Listener, typename Update>
+    class ItemUpdateBatcher {
+    public:
+        using Batch = ItemUpdatesEvent<Listener, Update>;
+        // Builds the event reporting the updates dropped for an item.
+        using LostEventFactory = std::function<std::shared_ptr<const Event<Listener>>(int itemPos, int lost)>;
+
+    private:
+        std::shared_ptr<EventDispatcher<Listener>> dispatcher;
+        std::shared_ptr<EventsThread> thread;
+        LostEventFactory lostEvent;
+        std::mutex mutex;
+        // The event still open for appending, if any.
+        std::shared_ptr<Batch> pending;
+        // Shared with the other Subscriptions of the same client.
+        std::shared_ptr<UpdateBacklog> backlog = std::make_shared<UpdateBacklog>();
+        // 0 for an unbounded queue.
+        std::size_t capacity = 0;
+        EventQueueOverflowPolicy policy = EventQueueOverflowPolicy::BLOCK;
+        // Updates discarded by the DROP policy and not yet reported, by item position.
+        std::map<int, int> dropped;
+
+        void closePending() {
+            if (pending) {
+                pending->seal();
+                pending.reset();
+            }
+        }
+
+    public:
+        ItemUpdateBatcher(std::shared_ptr<EventDispatcher<Listener>> dispatcher, std::shared_ptr<EventsThread> thread,
+                          LostEventFactory lostEvent)
+                : dispatcher(std::move(dispatcher)), thread(std::move(thread)), lostEvent(std::move(lostEvent)) {}
+
+        /**
+         * @param clientBacklog The backlog of the client the Subscription is subscribed to; null to keep the
+         * current one.
+         */
+        void setOverflow(std::size_t queueCapacity, EventQueueOverflowPolicy overflowPolicy,
+                         std::shared_ptr<UpdateBacklog> clientBacklog = nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            capacity = queueCapacity;
+            policy = overflowPolicy;
+            if (clientBacklog && clientBacklog != backlog) {
+                // The pending event counts its updates in the previous backlog.
+                closePending();
+                backlog = std::move(clientBacklog);
+            }
+        }
+
+        /**
+         * Queues an update for the listeners.
+         *
+         * @param conflatable Whether the update may replace an older one of the same item (MERGE mode).
+         */
+        void dispatch(Update &&itemUpdate, bool conflatable) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (capacity > 0 && policy == EventQueueOverflowPolicy::BLOCK && backlog->getDepth() >= capacity) {
+                std::shared_ptr<UpdateBacklog> blocking = backlog;
+                std::size_t limit = capacity;
+                lock.unlock();
+                blocking->awaitBelow(limit);
+                lock.lock();
+            }
+            if (capacity > 0 && backlog->getDepth() >= capacity) {
+                if (policy == EventQueueOverflowPolicy::CONFLATE && conflatable) {
+                    if (pending && pending->tryConflate(std::move(itemUpdate))) {
+                        return;
+                    }
+                } else if (policy != EventQueueOverflowPolicy::BLOCK) {
+                    ++dropped[itemUpdate.getItemPos()];
+                    return;
+                }
+            }
+            if (!dropped.empty()) {
+                // Report what was dropped before resuming the flow of updates.
+                closePending();
+                for (const auto &[item, lost]: dropped) {
+                    dispatcher->dispatchEvent(lostEvent(item, lost));
+                }
+                dropped.clear();
+            }
+            if (pending && pending->tryAppend(std::move(itemUpdate))) {
+                return;
+            }
+            pending = std::make_shared<Batch>(thread, backlog);
+            pending->tryAppend(std::move(itemUpdate));
+            if (!dispatcher->dispatchEvent(std::shared_ptr<const Event<Listener>>(pending))) {
+                // No listener: nothing would ever pick the event up, so it must not keep collecting updates
+                // nor keep them counted.
+                pending->onDequeued();
+                pending.reset();
+            }
+        }
+
+        /**
+         * Closes the pending event, so that updates received after a different event are delivered after it.
+         * Must be called before dispatching any event other than an item update.
+         */
+        void seal() {
+            std::lock_guard<std::mutex> lock(mutex);
+            closePending();
+        }
+
+        /**
+         * @return The number of updates in the event still open for appending.
+         */
+        std::size_t getPendingCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return pending ? pending->size() : 0;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_ITEMUPDATEBATCHER_HPP
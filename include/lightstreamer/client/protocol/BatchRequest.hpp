@@ -24,12 +24,12 @@
 #ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_BATCHREQUEST_HPP
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_BATCHREQUEST_HPP
 
-#include <unordered_map>
-#include <vector>
+#include <utility>
 #include <string>
 #include <memory>
 #include <iostream> // For simplified logging purposes; replace with your logging library if needed.
 #include <lightstreamer/client/requests/RequestTutor.hpp>
+#include <lightstreamer/client/protocol/OrderedRequestQueue.hpp>
 #include <lightstreamer/client/protocol/RequestObjects.hpp>
 #include <lightstreamer/client/transport/RequestListener.hpp>
 #include <lightstreamer/client/requests/MessageRequest.hpp>
@@ -53,11 +53,10 @@ namespace lightstreamer::client::protocol {
     private:
         static constexpr const char *CONSTRAINT_KEY = "C";
         static constexpr const char *FORCE_REBIND_KEY = "F";
-        static constexpr const char *CHANGE_SUB_KEY = "X";
+        static constexpr const char *CHANGE_SUB_KEY = OrderedRequestQueue<std::shared_ptr<RequestObjects>>::CHANGE_SUB_KEY;
         static constexpr const char *MPN_KEY = "M";
 
-        std::unordered_map<std::string, std::shared_ptr<RequestObjects>> keys{};
-        std::vector<std::string> queue{};
+        OrderedRequestQueue<std::shared_ptr<RequestObjects>> queue{};
 
         // Simplified logger; use your actual logging system
         static void logError(const std::string &message) {
@@ -75,43 +74,71 @@ namespace lightstreamer::client::protocol {
         explicit BatchRequest(int type) : batchType(type) {}
 
         int getLength() const {
-            return queue.size();
+            return static_cast<int>(queue.size());
         }
 
         std::string getRequestName() const {
             if (getLength() <= 0) {
                 return "";
             }
-            return keys.at(queue[0])->request->getRequestName();
+            return queue.front()->request->getRequestName();
         }
 
         long getNextRequestLength() const {
             if (getLength() <= 0) {
                 return 0;
             }
-            return keys.at(queue[0])->request->getTransportUnawareQueryString().length();
+            return queue.front()->request->getTransportUnawareQueryString().length();
         }
 
         std::shared_ptr<RequestObjects> shift() {
-            if (getLength() <= 0) {
-                return nullptr;
+            return queue.shift().second;
+        }
+
+        /**
+         * @return Whether a request can be shifted by shiftReady().
+         */
+        bool hasReady() const {
+            return queue.hasReady();
+        }
+
+        long getNextReadyLength() const {
+            const auto *ready = queue.peekReady();
+            if (!ready) {
+                return 0;
             }
+            return (*ready)->request->getTransportUnawareQueryString().length();
+        }
+
+        /**
+         * Removes the first request whose key has no request in flight, and marks the key as in flight
+         * until complete() is called for it.
+         *
+         * Requests for the same Subscription (its subscription, changes of frequency and unsubscription)
+         * must reach the Server in order: when several batches travel at the same time, this keeps a
+         * request behind the one before it, while requests for other keys go ahead.
+         *
+         * @return The key and the request; a null request if none is ready.
+         */
+        std::pair<std::string, std::shared_ptr<RequestObjects>> shiftReady() {
+            return queue.shiftReady();
+        }
 
-            std::string key = queue.front();
-            queue.erase(queue.begin());
-            auto k = keys[key];
-            keys.erase(key);
-            return k;
+        /**
+         * Releases a key marked by shiftReady(), once the response to its request has arrived (or it
+         * was not sent).
+         */
+        void complete(const std::string &key) {
+            queue.complete(key);
         }
 
     private:
         void addRequestInternal(const std::string &key, std::shared_ptr<RequestObjects> request) {
-            keys[key] = request;
-            queue.push_back(key);
+            queue.put(key, std::move(request));
         }
 
         void substituteRequest(const std::string &key, std::shared_ptr<RequestObjects> newRequest) {
-            keys[key] = newRequest;
+            queue.put(key, std::move(newRequest));
         }
 
     public:
@@ -151,9 +178,9 @@ namespace lightstreamer::client::protocol {
             std::string key = CONSTRAINT_KEY;
 
             auto requestObj = std::make_shared<RequestObjects>(request, tutor, listener);
-            auto it = keys.find(key);
-            if (it != keys.end()) {
-                it->second->tutor->notifyAbort();
+            auto it = queue.find(key);
+            if (it) {
+                (*it)->tutor->notifyAbort();
                 substituteRequest(key, requestObj);
             } else {
                 addRequestInternal(key, requestObj);
@@ -173,9 +200,9 @@ namespace lightstreamer::client::protocol {
             std::string key = FORCE_REBIND_KEY;
 
             auto requestObj = std::make_shared<RequestObjects>(request, tutor, listener);
-            auto it = keys.find(key);
-            if (it != keys.end()) {
-                it->second->tutor->notifyAbort();
+            auto it = queue.find(key);
+            if (it) {
+                (*it)->tutor->notifyAbort();
                 substituteRequest(key, requestObj);
             } else {
                 addRequestInternal(key, requestObj);
@@ -195,11 +222,11 @@ namespace lightstreamer::client::protocol {
             std::string key = std::to_string(request->getSubscriptionId());
 
             auto requestObj = std::make_shared<RequestObjects>(request, tutor, listener);
-            auto it = keys.find(key);
-            if (it != keys.end()) {
+            auto it = queue.find(key);
+            if (it) {
                 // Assuming SubscribeRequest can be checked through dynamic_pointer_cast or similar mechanism
                 logDebug("Substituting SUBSCRIBE request with UNSUBSCRIBE");
-                it->second->tutor->notifyAbort();
+                (*it)->tutor->notifyAbort();
                 substituteRequest(key, requestObj);
             } else {
                 addRequestInternal(key, requestObj);
@@ -218,10 +245,10 @@ namespace lightstreamer::client::protocol {
             std::string key = std::to_string(request->getSubscriptionId());
 
             auto requestObj = std::make_shared<RequestObjects>(request, tutor, listener);
-            auto it = keys.find(key);
-            if (it != keys.end()) {
+            auto it = queue.find(key);
+            if (it) {
                 logDebug("Handling unexpected case for SUBSCRIBE request");
-                it->second->tutor->notifyAbort();
+                (*it)->tutor->notifyAbort();
                 substituteRequest(key, requestObj);
             } else {
                 addRequestInternal(key, requestObj);
@@ -241,10 +268,10 @@ namespace lightstreamer::client::protocol {
             std::string key = CHANGE_SUB_KEY + std::to_string(request->getSubscriptionId());
 
             auto requestObj = std::make_shared<RequestObjects>(request, tutor, listener);
-            auto it = keys.find(key);
-            if (it != keys.end()) {
+            auto it = queue.find(key);
+            if (it) {
                 logDebug("Replacing old CHANGE SUBSCRIPTION request");
-                it->second->tutor->notifyAbort();
+                (*it)->tutor->notifyAbort();
                 substituteRequest(key, requestObj);
             } else {
                 addRequestInternal(key, requestObj);
@@ -263,10 +290,10 @@ namespace lightstreamer::client::protocol {
             std::string key = request->getSession();
 
             auto requestObj = std::make_shared<RequestObjects>(request, tutor, listener);
-            auto it = keys.find(key);
-            if (it != keys.end()) {
+            auto it = queue.find(key);
+            if (it) {
                 logDebug("Substituting DESTROY request");
-                it->second->tutor->notifyAbort();
+                (*it)->tutor->notifyAbort();
                 substituteRequest(key, requestObj);
             } else {
                 addRequestInternal(key, requestObj);
@@ -33,6 +33,7 @@
 #include <lightstreamer/client/session/InternalConnectionOptions.hpp>
 #include <lightstreamer/client/protocol/TextProtocol.hpp>
 #include "Logger.hpp" // Placeholder for Logger class
+#include <algorithm>
 #include <array>
 #include <list>
 #include <string>
@@ -97,6 +98,14 @@ namespace lightstreamer::client::protocol {
      * and waits for such notifications on the stream connection).
      * IMPLEMENTATION NOTE: the HTML might not have the chance to read the synchronous
      * responses (control.html cases and JSONP cases).
+     *
+     * @section control_request_concurrency Concurrent Batches
+     * Up to InternalConnectionOptions::getMaxConcurrentControlBatches() batches may be waiting for their
+     * responses at the same time (1 by default, which is the behavior described above); with keep-alive
+     * providers each one travels on its own pooled connection. The status is WAITING only while all of
+     * them are in use. Ordering is preserved where it matters: BatchRequest holds back a request while
+     * another one with the same key is in flight, and only the control queue has several batches in
+     * flight, so that messages and heartbeats are still sent one batch at a time.
      */
     class HttpRequestManager : public RequestManager {
         bool instanceFieldsInitialized = false;
@@ -129,10 +138,16 @@ namespace lightstreamer::client::protocol {
         Protocol *protocol;
         session::InternalConnectionOptions *options;
 
-        transport::RequestHandle *activeConnection;
+        // A batch that the manager has sent but whose response has not arrived yet.
+        struct ActiveBatch {
+            BatchRequest *queue = nullptr;
+            std::vector<std::string> keys;
+            std::vector<std::shared_ptr<RequestObjects>> requests;
+            std::shared_ptr<transport::RequestHandle> connection;
+        };
 
         FatalErrorListener *errorListener;
-        std::list<RequestObjects> ongoingRequests; // List of requests that the manager has sent but no response has still arrived
+        std::list<std::shared_ptr<ActiveBatch>> activeBatches;
 
       static constexpr long SYNC_DEQUEUE = -1;
         static constexpr long ASYNC_DEQUEUE = 0;
@@ -173,10 +188,10 @@ namespace lightstreamer::client::protocol {
         }
 
         void close(bool waitPending) override {
-            if (!waitPending || this->activeConnection == nullptr) {
-                if (this->activeConnection != nullptr) {
-                    if (requestQueues[this->nextQueue] != &destroyQueue) {
-                        this->activeConnection->close(false);
+            if (!waitPending || this->activeBatches.empty()) {
+                for (auto &batch: this->activeBatches) {
+                    if (batch->queue != &destroyQueue && batch->connection) {
+                        batch->connection->close(false);
                     } // else do not bother destroy requests
                 }
                 this->changeStatus(END);
@@ -210,11 +225,11 @@ namespace lightstreamer::client::protocol {
         void copyTo(std::shared_ptr<ControlRequestHandler> newHandler) override {
             // Skip destroy requests logic here
 
-            if (!ongoingRequests.empty()) {
-                for (auto &req: ongoingRequests) {
-                    newHandler.addRequest(std::move(req.request), std::move(req.tutor), std::move(req.listener));
+            for (auto &batch: activeBatches) {
+                for (auto &req: batch->requests) {
+                    newHandler.addRequest(req->request, req->tutor, req->listener);
                 }
-                ongoingRequests.clear();
+                batch->requests.clear();
             }
 
             for (auto *queue: requestQueues) {
@@ -249,11 +264,11 @@ namespace lightstreamer::client::protocol {
             return transport->sendRequest(protocol, std::move(request), std::move(reqListener), options->getHttpExtraHeaders(), options->getProxy(), tcpConnectTimeout, tcpReadTimeout);
         }
 
-        std::unique_ptr<transport::RequestHandle> bindSession(std::unique_ptr<BindSessionRequest> request, std::unique_ptr<StreamListener> reqListener, long tcpConnectTimeout, long tcpReadTimeout, std::promise<void>& requestFuture) {
+        std::shared_ptr<transport::RequestHandle> bindSession(std::shared_ptr<BindSessionRequest> request, std::shared_ptr<StreamListener> reqListener, long tcpConnectTimeout, long tcpReadTimeout, std::shared_ptr<util::ListenableFuture> requestFuture) override {
             auto handle = transport->sendRequest(protocol.get(), std::move(request), std::move(reqListener),
                                                  options->getHttpExtraHeadersOnSessionCreationOnly() ? nullptr : options->getHttpExtraHeaders(),
                                                  options->getProxy(), tcpConnectTimeout, tcpReadTimeout);
-            requestFuture.set_value();
+            requestFuture->fulfill();
             return handle;
         }
 
@@ -287,10 +302,7 @@ namespace lightstreamer::client::protocol {
                     sessionThread->queue(task);
                 } else {
                     // Schedule the task for execution after a delay
-                    std::thread([task, delay]() {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
-                        task();
-                    }).detach(); // Detach the thread to let it run independently
+                    sessionThread->schedule(task, delay);
                 }
             }
         }
@@ -314,22 +326,38 @@ namespace lightstreamer::client::protocol {
                 }
             }
 
-            int c = 0;
-            while (c < this->requestQueues.size()) {
-                // Switch the flag to change turn
-                nextQueue = (nextQueue < requestQueues.size() - 1) ? nextQueue + 1 : 0;
+            std::size_t limit = options->getMaxConcurrentControlBatches();
+            bool sent = true;
+            while (sent && activeBatches.size() < limit) {
+                sent = false;
+                int c = 0;
+                while (c < this->requestQueues.size() && activeBatches.size() < limit) {
+                    // Switch the flag to change turn
+                    nextQueue = (nextQueue < requestQueues.size() - 1) ? nextQueue + 1 : 0;
 
-                if (!requestQueues[nextQueue]->isEmpty()) {
-                    bool sent = sendBatch(*requestQueues[nextQueue]);
-                    if (sent) {
-                        changeStatus("WAITING");
-                        return;
+                    if (isReady(*requestQueues[nextQueue]) && sendBatch(*requestQueues[nextQueue])) {
+                        sent = true;
                     }
+                    ++c;
                 }
-                ++c;
             }
 
-            // Nothing to send, we're still IDLE
+            if (activeBatches.size() >= limit) {
+                changeStatus("WAITING");
+            }
+            // Otherwise there are free slots but nothing to send (or only requests held back), we're still IDLE
+        }
+
+        // Whether a batch can be taken from the queue now (see control_request_concurrency).
+        bool isReady(BatchRequest &queue) const {
+            if (!queue.hasReady()) {
+                return false;
+            }
+            if (&queue == &controlQueue || &queue == &destroyQueue) {
+                return true;
+            }
+            return std::none_of(activeBatches.begin(), activeBatches.end(),
+                                [&queue](const auto &batch) { return batch->queue == &queue; });
         }
 
         bool sendBatch(BatchRequest& batch) {
@@ -338,60 +366,77 @@ namespace lightstreamer::client::protocol {
                 return false; // Early exit if batch is empty
             }
 
-            BatchedListener combinedRequestListener(*this);
-            BatchedRequest combinedRequest(*this);
+            auto active = std::make_shared<ActiveBatch>();
+            active->queue = &batch;
+            auto combinedRequestListener = std::make_shared<BatchedListener>(*this, active);
+            auto combinedRequest = std::make_shared<BatchedRequest>(*this);
 
-            RequestObjects* first = nullptr;
-            while (first == nullptr && !batch.isEmpty()) {
-                first = batch.shift();
-                if (first && first->tutor->shouldBeSent()) {
-                    combinedRequest.setServer(first->request->getTargetServer());
-                    combinedRequest.setRequestName(first->request->getRequestName());
+            while (combinedRequest->length() == 0 && batch.hasReady()) {
+                auto [key, first] = batch.shiftReady();
+                if (first->tutor->shouldBeSent()) {
+                    combinedRequest->setServer(first->request->getTargetServer());
+                    combinedRequest->setRequestName(first->request->getRequestName());
 
-                    combinedRequest.add(*first->request);
-                    combinedRequestListener.add(*first->listener);
-                    ongoingRequests.push_back(std::move(*first)); // Assuming move semantics are properly handled
-                } else if (first) {
-                    first->tutor->notifyAbort();
-                    first = nullptr; // Continue looking for a valid first request
+                    combinedRequest->add(*first->request);
+                    combinedRequestListener->add(first->listener);
+                    active->keys.push_back(std::move(key));
+                    active->requests.push_back(std::move(first));
+                } else {
+                    batch.complete(key);
+                    first->tutor->notifyAbort(); // Continue looking for a valid first request
                 }
             }
 
-            if (combinedRequest.length() == 0) {
+            if (combinedRequest->length() == 0) {
                 return false; // Nothing to send
             }
 
-            while ((requestLimit == 0 || (combinedRequest.length() + batch.nextRequestLength()) < requestLimit) && !batch.isEmpty()) {
-                auto next = batch.shift();
-                if (next && next->tutor->shouldBeSent()) {
-                    combinedRequest.add(*next->request);
-                    combinedRequestListener.add(*next->listener);
-                    ongoingRequests.push_back(std::move(*next));
-                } else if (next) {
+            while ((requestLimit == 0 || (combinedRequest->length() + batch.getNextReadyLength()) < requestLimit) && batch.hasReady()) {
+                auto [key, next] = batch.shiftReady();
+                if (next->tutor->shouldBeSent()) {
+                    combinedRequest->add(*next->request);
+                    combinedRequestListener->add(next->listener);
+                    active->keys.push_back(std::move(key));
+                    active->requests.push_back(std::move(next));
+                } else {
+                    batch.complete(key);
                     next->tutor->notifyAbort();
                 }
             }
 
-            activeConnection = transport->sendRequest(*protocol, combinedRequest, combinedRequestListener, options->httpExtraHeadersOnSessionCreationOnly() ? nullptr : options->httpExtraHeaders(), options->proxy(), options->tcpConnectTimeout(), options->tcpReadTimeout());
+            // Registered before sending: the provider may report a failure synchronously.
+            activeBatches.push_back(active);
+            active->connection = transport->sendRequest(*protocol, combinedRequest, combinedRequestListener, options->httpExtraHeadersOnSessionCreationOnly() ? nullptr : options->httpExtraHeaders(), options->proxy(), options->tcpConnectTimeout(), options->tcpReadTimeout());
 
             return true;
         }
 
+        // Forgets a batch whose response has arrived (or failed), letting the requests held back behind it go.
+        void clearOngoingRequests(const std::shared_ptr<ActiveBatch>& batch) {
+            auto it = std::find(activeBatches.begin(), activeBatches.end(), batch);
+            if (it == activeBatches.end()) {
+                return;
+            }
+            activeBatches.erase(it);
+            for (const auto &key: batch->keys) {
+                batch->queue->complete(key);
+            }
+            batch->requests.clear();
+            batch->connection = nullptr;
+        }
+
         bool onComplete(const std::string& why) {
             if (is("END")) {
                 return false; // Ignore if already ended
             } else if (is("ENDING")) {
-                changeStatus("END");
-            } else {
-                if (is("IDLE")) {
-                    log.error("Unexpected batch manager status at connection end");
+                if (activeBatches.empty()) {
+                    changeStatus("END");
                 }
-
+            } else {
                 log.info("Batch completed");
                 changeStatus("IDLE");
                 dequeue(ASYNC_DEQUEUE, "closed"); // Prepare for future operations
             }
-            activeConnection = nullptr; // Clear the active connection
             return true;
         }
 
@@ -458,12 +503,14 @@ namespace lightstreamer::client::protocol {
 
         class BatchedListener : public RequestListener {
             HttpRequestManager& outerInstance;
+            std::shared_ptr<ActiveBatch> batch;
             bool completed = false;
             std::vector<std::string> messages;
             std::vector<std::shared_ptr<RequestListener>> listeners;
 
         public:
-            BatchedListener(HttpRequestManager& outer) : outerInstance(outer) {}
+            BatchedListener(HttpRequestManager& outer, std::shared_ptr<ActiveBatch> batch)
+                    : outerInstance(outer), batch(std::move(batch)) {}
 
             size_t size() const {
                 return listeners.size();
@@ -495,7 +542,7 @@ namespace lightstreamer::client::protocol {
             }
 
             void onClosed() override {
-                outerInstance.clearOngoingRequests();
+                outerInstance.clearOngoingRequests(batch);
                 if (outerInstance.is("END")) {
                     return; // Don't care
                 }
@@ -514,7 +561,7 @@ namespace lightstreamer::client::protocol {
             }
 
             void onBroken() override {
-                outerInstance.ongoingRequests.Clear();
+                outerInstance.clearOngoingRequests(batch);
                 if (outerInstance.is("END")) {
                     return; // Don't care
                 }
@@ -0,0 +1,168 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_ORDEREDREQUESTQUEUE_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_ORDEREDREQUESTQUEUE_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace lightstreamer::client::protocol {
+
+    /**
+     * The requests of a BatchRequest, by key, in the order they were added.
+     *
+     * Requests can be taken either from the front or with shiftReady(), which keeps a request behind an
+     * earlier one of the same Subscription still waiting for its response.
+     */
+    template<typename Value>
+    class OrderedRequestQueue {
+    public:
+        // Prefix of the key of a change of frequency, followed by the id of its Subscription.
+        static constexpr const char *CHANGE_SUB_KEY = "X";
+
+        /**
+         * The key deciding which requests must not overtake each other: a change of frequency shares it with
+         * the subscription and the unsubscription of the same Subscription, whose key is the id.
+         */
+        static std::string orderingKey(const std::string &key) {
+            if (key.size() > 1 && key[0] == CHANGE_SUB_KEY[0] &&
+                std::all_of(key.begin() + 1, key.end(), [](unsigned char c) { return std::isdigit(c) != 0; })) {
+                return key.substr(1);
+            }
+            return key;
+        }
+
+    private:
+        std::unordered_map<std::string, Value> values;
+        std::vector<std::string> order;
+        // Ordering keys of the requests shifted by shiftReady() whose responses have not arrived yet.
+        std::unordered_set<std::string> inFlight;
+
+        std::size_t nextReady() const {
+            std::size_t i = 0;
+            while (i < order.size() && inFlight.count(orderingKey(order[i])) != 0) {
+                ++i;
+            }
+            return i;
+        }
+
+        std::pair<std::string, Value> take(std::size_t i) {
+            std::string key = std::move(order[i]);
+            order.erase(order.begin() + static_cast<std::ptrdiff_t>(i));
+            auto it = values.find(key);
+            Value value = std::move(it->second);
+            values.erase(it);
+            return {std::move(key), std::move(value)};
+        }
+
+    public:
+        std::size_t size() const {
+            return order.size();
+        }
+
+        /**
+         * @return The request queued with the key, or null.
+         */
+        Value *find(const std::string &key) {
+            auto it = values.find(key);
+            return it == values.end() ? nullptr : &it->second;
+        }
+
+        /**
+         * Queues a request with a new key, or replaces the request of a queued key, keeping its place.
+         */
+        void put(const std::string &key, Value value) {
+            auto [it, added] = values.insert_or_assign(key, std::move(value));
+            if (added) {
+                order.push_back(key);
+            }
+        }
+
+        /**
+         * @return The first request. The queue must not be empty.
+         */
+        const Value &front() const {
+            return values.at(order.front());
+        }
+
+        /**
+         * Removes the first request, regardless of the requests in flight.
+         *
+         * @return The key and the request; a default request if the queue is empty.
+         */
+        std::pair<std::string, Value> shift() {
+            if (order.empty()) {
+                return {"", Value()};
+            }
+            return take(0);
+        }
+
+        /**
+         * @return Whether a request can be shifted by shiftReady().
+         */
+        bool hasReady() const {
+            return nextReady() < order.size();
+        }
+
+        /**
+         * @return The request shiftReady() would remove, or null.
+         */
+        const Value *peekReady() const {
+            std::size_t i = nextReady();
+            return i == order.size() ? nullptr : &values.at(order[i]);
+        }
+
+        /**
+         * Removes the first request whose ordering key has no request in flight, and marks the key as in
+         * flight until complete() is called for it.
+         *
+         * @return The key and the request; a default request if none is ready.
+         */
+        std::pair<std::string, Value> shiftReady() {
+            std::size_t i = nextReady();
+            if (i == order.size()) {
+                return {"", Value()};
+            }
+            auto shifted = take(i);
+            inFlight.insert(orderingKey(shifted.first));
+            return shifted;
+        }
+
+        /**
+         * Releases a key marked by shiftReady().
+         */
+        void complete(const std::string &key) {
+            inFlight.erase(orderingKey(key));
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_ORDEREDREQUESTQUEUE_HPP
@@ -24,13 +24,13 @@
 #ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_REQUESTMANAGER_HPP
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_REQUESTMANAGER_HPP
 
-#include <future>
 #include <memory>
 #include <vector>
 #include <lightstreamer/client/protocol/ControlRequestHandler.hpp>
 #include <lightstreamer/client/requests/BindSessionRequest.hpp>
 #include <lightstreamer/client/transport/RequestHandle.hpp>
 #include <lightstreamer/client/protocol/TextProtocol.hpp>
+#include <lightstreamer/util/ListenableFuture.hpp>
 
 namespace lightstreamer::client::protocol {
 
@@ -39,11 +39,11 @@ namespace lightstreamer::client::protocol {
         // Destructor should be virtual since this class is intended to be a base class
         ~RequestManager() override = default;
 
-        // bindSession abstract method
-        virtual std::unique_ptr<transport::RequestHandle>
-        bindSession(std::unique_ptr<requests::BindSessionRequest> request,
+        // bindSession abstract method: bindFuture is fulfilled once the bind request has been sent
+        virtual std::shared_ptr<transport::RequestHandle>
+        bindSession(std::shared_ptr<requests::BindSessionRequest> request,
                     std::shared_ptr<TextProtocol::StreamListener> reqListener,
-                    long tcpConnectTimeout, long tcpReadTimeout, std::future<void> bindFuture) = 0;
+                    long tcpConnectTimeout, long tcpReadTimeout, std::shared_ptr<util::ListenableFuture> bindFuture) = 0;
     };
 
 }
@@ -34,6 +34,7 @@
 #include "lightstreamer/client/session/InternalConnectionOptions.hpp" // Placeholder for actual options class
 #include "lightstreamer/client/requests/ReverseHeartbeatRequest.hpp"
 #include <lightstreamer/client/requests/VoidTutor.hpp>
+#include <lightstreamer/util/Clock.hpp>
 #include "Logger.hpp"
 
 namespace lightstreamer::client::protocol {
@@ -48,7 +49,7 @@ namespace lightstreamer::client::protocol {
         long currentIntervalMs = -1; // It is the minimum between LS_inactivity_millis and the interval chosen by the user.
         bool disableHeartbeats = false;
         bool closed = false;
-        std::chrono::steady_clock::time_point lastSentTime = std::chrono::steady_clock::now(); // Last time a request has been sent to the server.
+        util::Clock::time_point lastSentTime = util::Clock::now(); // Last time a request has been sent to the server.
         /*
         * The timer assures that there is at most one scheduled task by keeping a phase counter
         * (there is no scheduled task when heartbeats are disabled).
@@ -72,7 +73,7 @@ namespace lightstreamer::client::protocol {
         */
         void onBindSession(bool bindAsControl) {
             if (bindAsControl) {
-                lastSentTime = std::chrono::steady_clock::now();
+                lastSentTime = util::Clock::now();
             }
             if (!bindSent) {
                 bindSent = true;
@@ -88,7 +89,7 @@ namespace lightstreamer::client::protocol {
 
         // Must be called when a control request is sent.
         void onControlRequest() {
-            lastSentTime = std::chrono::steady_clock::now();
+            lastSentTime = util::Clock::now();
         }
 
         // Must be called when the session is closed.
@@ -118,7 +119,7 @@ namespace lightstreamer::client::protocol {
         long getTimeLeftMs() const {
             assert(lastSentTime.time_since_epoch().count() != -1);
             assert(currentIntervalMs != -1);
-            auto now = std::chrono::steady_clock::now();
+            auto now = util::Clock::now();
             auto timeElapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSentTime).count();
             long timeLeftMs = currentIntervalMs - timeElapsedMs;
             return timeLeftMs;
@@ -195,10 +196,7 @@ namespace lightstreamer::client::protocol {
                 this->schedule();
             };
 
-            std::thread([task, scheduleTimeMs]() {
-                std::this_thread::sleep_for(std::chrono::milliseconds(scheduleTimeMs));
-                task();
-            }).detach(); // Detach the thread to let it run independently
+            sessionThread.schedule(task, scheduleTimeMs);
         }
     };
 
@@ -36,7 +36,7 @@
 
 #include <string>
 #include <memory>
-#include <future> // For ListenableFuture equivalent
+#include <lightstreamer/util/ListenableFuture.hpp>
 
 namespace lightstreamer::client::protocol {
 
@@ -53,7 +53,7 @@ namespace lightstreamer::client::protocol {
             return wsRequestManager;
         }
 
-        std::future<void> openWebSocketConnection(const std::string& serverAddress) {
+        std::shared_ptr<util::ListenableFuture> openWebSocketConnection(const std::string& serverAddress) {
             return wsRequestManager.openWS(*this, serverAddress, BindSessionListener(*this));
         }
 
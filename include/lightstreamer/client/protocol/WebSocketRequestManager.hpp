@@ -36,6 +36,7 @@
 #include <lightstreamer/client/requests/RequestTutor.hpp>
 #include <lightstreamer/client/requests/BindSessionRequest.hpp>
 #include <lightstreamer/client/transport/RequestHandle.hpp>
+#include <lightstreamer/util/ListenableFuture.hpp>
 
 
 
@@ -47,7 +48,7 @@ namespace lightstreamer::client::protocol {
      *
      * Note 1:
      * The method `openSocket(std::string, StreamListener*)` is used when the flag `isEarlyWSOpenEnabled` is set. If the method is not called explicitly,
-     * the method `bindSession(SessionRequest*, transport::RequestListener*, long, long, std::future<void>*)` will call it.
+     * the method `bindSession(SessionRequest*, transport::RequestListener*, long, long, std::shared_ptr<ListenableFuture>)` will call it.
      *
      * Note 2:
      * If the method `openSocket(std::string, StreamListener*)` is called twice in a row (this can happen if the server sends a control-link),
@@ -92,15 +93,18 @@ namespace lightstreamer::client::protocol {
 
 
         /**
-         * @brief A request that the manager has sent but has not yet been written to the WebSocket.
-         * This must be cleared when transport::RequestListener::onOpen() is called, assuming that the WebSocket is reliable.
+         * @brief The requests that the manager has sent but have not yet been written to the WebSocket, in
+         * sending order. There can be several, since the transport coalesces the requests sent during a
+         * SessionThread task (see transport::WebSocket::sendRequest()).
+         * Each is removed when its transport::RequestListener::onOpen() is called, assuming that the WebSocket is reliable.
          */
-        PendingRequest ongoingRequest;
+        std::list<PendingRequest> ongoingRequests;
+        long requestLimit = 0;
         /**
          * @brief Maps the LS_reqId of a request to the request's listener.
          */
         std::unordered_map<long, std::shared_ptr<transport::RequestListener>> pendingRequestMap;
-        util::ListenableFuture openWsFuture;
+        std::shared_ptr<util::ListenableFuture> openWsFuture;
 
         class MyRunnableError {
             std::shared_ptr<TextProtocol::StreamListener> reqListener;
@@ -134,7 +138,7 @@ namespace lightstreamer::client::protocol {
         void
         sendControlRequest(const requests::LightstreamerRequest &request, std::shared_ptr<transport::RequestListener> reqListener,
                            const requests::RequestTutor &tutor) {
-            ongoingRequest = PendingRequest(request, reqListener, tutor);
+            ongoingRequests.emplace_back(request, reqListener, tutor);
             wsTransport->sendRequest(*protocol, request,
                                      std::make_shared<ListenerWrapperAnonymousInnerClass>(*this, reqListener), nullptr,
                                      nullptr, 0, 0);
@@ -151,13 +155,15 @@ namespace lightstreamer::client::protocol {
 
             // Implementación de doOpen
             void doOpen() override {
-                // La solicitud se ha enviado: limpiar el campo
-                outerInstance->ongoingRequest = nullptr;
+                // The requests are written in sending order: this is the oldest one
+                if (!outerInstance->ongoingRequests.empty()) {
+                    outerInstance->ongoingRequests.pop_front();
+                }
             }
         };
 
         void sendBindRequest(requests::LightstreamerRequest *request, transport::RequestListener *reqListener,
-                             util::ListenableFuture *bindFuture) {
+                             const std::shared_ptr<util::ListenableFuture> &bindFuture) {
             wsTransport.sendRequest(protocol, request, new ListenerWrapper(this, reqListener), nullptr, nullptr, 0, 0);
             bindFuture->fulfill();
         }
@@ -173,7 +179,7 @@ namespace lightstreamer::client::protocol {
 
             // Implementation of onOpen
             void onOpen() override {
-                outerInstance->openWsFuture.fulfill();
+                outerInstance->openWsFuture->fulfill();
                 // Send bind_session
                 if (outerInstance->bindRequest != nullptr) {
                     // Bind request takes precedence over control requests
@@ -181,7 +187,7 @@ namespace lightstreamer::client::protocol {
                                                    outerInstance->bindRequest->reqListener,
                                                    outerInstance->bindRequest->bindFuture);
                 }
-                // Send control requests
+                // Send control requests: the transport writes them in as few frames as it can
                 for (const auto &controlRequest: outerInstance->controlRequestQueue) {
                     outerInstance->sendControlRequest(controlRequest.request, controlRequest.reqListener,
                                                       controlRequest.tutor);
@@ -194,7 +200,7 @@ namespace lightstreamer::client::protocol {
             // Implementation of onBroken
             void onBroken() override {
                 // NB: The callback caller must ensure execution on SessionThread
-                outerInstance->openWsFuture.reject();
+                outerInstance->openWsFuture->reject();
             }
         };
 
@@ -243,7 +249,7 @@ namespace lightstreamer::client::protocol {
                                 std::shared_ptr<session::InternalConnectionOptions> opts)
                 : options(opts), sessionThread(thread), protocol(prot) {}
 
-        std::future<void> openWS(std::shared_ptr<Protocol> prot, const std::string &serverAddress,
+        std::shared_ptr<util::ListenableFuture> openWS(std::shared_ptr<Protocol> prot, const std::string &serverAddress,
                                  std::shared_ptr<TextProtocol::BindSessionListener::StreamListener> streamListener) {
             if (wsTransport) {
                 // Close old connection
@@ -254,17 +260,19 @@ namespace lightstreamer::client::protocol {
                                                       std::make_unique<MyConnectionListener>(*this));
 
             assert(wsTransport->getState() ==  transport::InternalState::CONNECTING);
+            wsTransport->setRequestLimit(requestLimit);
 
-            auto future = openWsPromise.get_future();
+            auto future = std::make_shared<util::ListenableFuture>();
+            openWsFuture = future;
             // Abort connection if opening takes too long
             auto wsTransportCopy = wsTransport.get();
             auto timeout = options->getCurrentConnectTimeout();
 
-            sessionThread->schedule([wsTransportCopy, timeout, this]() {
+            sessionThread->schedule([wsTransportCopy, future, this]() {
                 if (wsTransportCopy->getState() == transport::InternalState::CONNECTING ||
                     wsTransportCopy->getState() == transport::InternalState::UNEXPECTED_ERROR) {
                     this->log->Debug("WS connection: aborted");
-                    openWsPromise.set_value();
+                    future->reject();
                     wsTransportCopy->close();
                     options->increaseConnectTimeout();
                 }
@@ -286,14 +294,14 @@ namespace lightstreamer::client::protocol {
          */
         std::shared_ptr<transport::RequestHandle>
         bindSession(std::shared_ptr<requests::BindSessionRequest> request, std::shared_ptr<TextProtocol::StreamListener> reqListener,
-                    long tcpConnectTimeout, long tcpReadTimeout, std::promise<void> &bindFuture) {
+                    long tcpConnectTimeout, long tcpReadTimeout, std::shared_ptr<util::ListenableFuture> bindFuture) override {
             if (!wsTransport) {
                 // No transport: this can occur when transport is in polling mode
                 bindRequest = std::make_unique<PendingBind>(request, reqListener, bindFuture);
                 log->info("WebSocket Manager .. bindSession p2: " +
                           std::to_string(reinterpret_cast<std::uintptr_t>(wsTransport.get())));
                 auto future = openWS(*protocol, request->getTargetServer(), reqListener);
-                future.onRejected([reqListener, this]() {
+                future->onRejected([reqListener, this]() {
                     MyRunnableError errorAction(reqListener, log);
                     errorAction();
                 });
@@ -368,16 +376,24 @@ namespace lightstreamer::client::protocol {
             }
         }
 
+        void setRequestLimit(long limit) override {
+            requestLimit = limit;
+            if (wsTransport) {
+                wsTransport->setRequestLimit(limit);
+            }
+        }
+
         void copyTo(std::shared_ptr<ControlRequestHandler> newHandler) override {
-            if (ongoingRequest != nullptr) {
-                newHandler->addRequest(ongoingRequest->request, ongoingRequest->tutor, ongoingRequest->reqListener);
+            for (const auto &ongoingRequest: ongoingRequests) {
+                newHandler->addRequest(ongoingRequest.request, ongoingRequest.tutor, ongoingRequest.reqListener);
             }
             for (const auto &pendingRequest: controlRequestQueue) {
                 newHandler->addRequest(pendingRequest.request, pendingRequest.tutor, pendingRequest.reqListener);
             }
             // Liberar memoria
-            ongoingRequest = nullptr;
+            ongoingRequests.clear();
             controlRequestQueue.clear();
+            newHandler->setRequestLimit(requestLimit);
         }
 
         /* Method to set the default session ID of a WebSocket connection.
@@ -84,7 +84,7 @@ namespace lightstreamer::client::requests {
         void StartTimeout() {
             if (!timeoutIsRunning) {
                 timeoutIsRunning = true;
-                sessionThread->Schedule([this]() { OnTimeout(); }, std::chrono::milliseconds(timeoutMs));
+                sessionThread->schedule([this]() { OnTimeout(); }, timeoutMs);
             }
         }
 
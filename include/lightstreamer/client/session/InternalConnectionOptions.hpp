@@ -69,6 +69,11 @@ namespace lightstreamer::client::session {
         long long sessionRecoveryTimeout = 15000;
         long long switchCheckTimeout = 4000; // Not exposed
         std::unique_ptr<Proxy> proxy;
+        std::size_t eventQueueHighWatermark = 0; // 0 = disabled
+        std::size_t eventQueueLowWatermark = 0;
+        std::size_t eventQueueCapacity = 0; // 0 = unbounded
+        events::EventQueueOverflowPolicy eventQueueOverflowPolicy = events::EventQueueOverflowPolicy::BLOCK;
+        std::size_t maxConcurrentControlBatches = 1;
 
         std::shared_ptr<ILogger> log = LogManager::GetLogger(Constants::ACTIONS_LOG);
         std::shared_ptr<events::EventDispatcher<ClientListener>> eventDispatcher;
@@ -438,6 +443,74 @@ namespace lightstreamer::client::session {
                     std::make_shared<events::ClientListenerPropertyChangeEvent>("requestedMaxBandwidth"));
         }
 
+        std::size_t getEventQueueHighWatermark() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return eventQueueHighWatermark;
+        }
+
+        std::size_t getEventQueueLowWatermark() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return eventQueueLowWatermark;
+        }
+
+        void setEventQueueWatermarks(std::size_t high, std::size_t low) {
+            if (high != 0 && low >= high) {
+                throw std::invalid_argument("The low watermark must be lower than the high watermark");
+            }
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                eventQueueHighWatermark = high;
+                eventQueueLowWatermark = low;
+            }
+            // The internal listener reads the watermarks back through the getters.
+            eventDispatcher->dispatchEvent(
+                    std::make_shared<events::ClientListenerPropertyChangeEvent>("eventQueueWatermarks"));
+            internalListener->onPropertyChange("eventQueueWatermarks");
+            log->Info(std::format("Event queue watermarks changed to {}/{}", high, low));
+        }
+
+        std::size_t getEventQueueCapacity() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return eventQueueCapacity;
+        }
+
+        void setEventQueueCapacity(std::size_t value) {
+            std::lock_guard<std::mutex> guard(mutex);
+            eventQueueCapacity = value;
+            eventDispatcher->dispatchEvent(
+                    std::make_shared<events::ClientListenerPropertyChangeEvent>("eventQueueCapacity"));
+            log->Info(std::format("Event queue capacity changed to {}", value));
+        }
+
+        events::EventQueueOverflowPolicy getEventQueueOverflowPolicy() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return eventQueueOverflowPolicy;
+        }
+
+        void setEventQueueOverflowPolicy(events::EventQueueOverflowPolicy value) {
+            std::lock_guard<std::mutex> guard(mutex);
+            eventQueueOverflowPolicy = value;
+            eventDispatcher->dispatchEvent(
+                    std::make_shared<events::ClientListenerPropertyChangeEvent>("eventQueueOverflowPolicy"));
+            log->Info("Event queue overflow policy changed");
+        }
+
+        std::size_t getMaxConcurrentControlBatches() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return maxConcurrentControlBatches;
+        }
+
+        void setMaxConcurrentControlBatches(std::size_t value) {
+            util::Number::verifyPositive(static_cast<double>(value), util::Number::DONT_ACCEPT_ZERO);
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                maxConcurrentControlBatches = value;
+            }
+            eventDispatcher->dispatchEvent(
+                    std::make_shared<events::ClientListenerPropertyChangeEvent>("maxConcurrentControlBatches"));
+            log->Info(std::format("Max concurrent control batches changed to {}", value));
+        }
+
         long long getRetryDelay() const {
             // Implementación que retorna el valor actual de retry delay
             return currentRetryDelay->getRetryDelay();
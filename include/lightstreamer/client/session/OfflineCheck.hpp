@@ -65,10 +65,9 @@ namespace lightstreamer::client::session {
 
                         log.Debug("Offline check 0.");
 
-                        std::thread([this, ph]() {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(MAYBE_ONLINE_TIMEOUT));
+                        thread.schedule([this, ph]() {
                             resetMaybeOnline(ph);
-                        }).detach(); // TODO: check if detach is the best option
+                        }, MAYBE_ONLINE_TIMEOUT);
                     }
                 }
             }
@@ -27,6 +27,7 @@
 #include <cassert>
 #include "Logger.hpp"
 #include <lightstreamer/client/Constants.hpp>
+#include <lightstreamer/util/Clock.hpp>
 
 namespace lightstreamer::client::session {
 
@@ -87,7 +88,7 @@ namespace lightstreamer::client::session {
             } else {
                 if (startRecovery) {
                     recovery = true;
-                    recoveryStartTime = std::chrono::steady_clock::now();
+                    recoveryStartTime = util::Clock::now();
                 } else {
                     recovery = false;
                     recoveryDuration = std::chrono::steady_clock::duration::zero();
@@ -113,7 +114,7 @@ namespace lightstreamer::client::session {
         // When zero or a negative value, the session must be discarded.
         long timeLeftMs(long maxTimeMs) {
             if (recovery) {
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - recoveryStartTime).count();
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(util::Clock::now() - recoveryStartTime).count();
                 return maxTimeMs - elapsed;
             } else {
                 return maxTimeMs;
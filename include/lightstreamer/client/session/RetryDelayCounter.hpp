@@ -25,7 +25,10 @@
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_RETRYDELAYCOUNTER_HPP
 #include <algorithm>
 #include <cmath>
+#include <memory>
+#include <string>
 #include <Logger.hpp>
+#include <lightstreamer/client/Constants.hpp>
 
 namespace lightstreamer::client::session {
 
@@ -34,7 +37,8 @@ namespace lightstreamer::client::session {
      */
     class RetryDelayCounter {
     private:
-        static inline Logger log = Logger::getLogger("SessionLog"); // Assumption: Logger class and getLogger method are defined elsewhere
+        inline static std::shared_ptr<Logger::ConsoleLogger> log =
+                Logger::ConsoleLogger::getInstance(ConsoleLogLevel::Level::TRACE, Constants::SESSION_LOG);
 
         int attempt = 0;
         long minDelay = 0;
@@ -47,8 +51,8 @@ namespace lightstreamer::client::session {
             this->maxDelay = std::max(60000L, delay); // Ensure max delay is at least 60 seconds
             this->attempt = 0;
 
-            if (log.isDebugEnabled()) {
-                log.debug("Reset currentRetryDelay: " + std::to_string(currentDelay));
+            if (log->IsDebugEnabled()) {
+                log->Debug("Reset currentRetryDelay: " + std::to_string(currentDelay));
             }
         }
 
@@ -74,8 +78,8 @@ namespace lightstreamer::client::session {
                     currentDelay = maxDelay;
                 }
 
-                if (log.isDebugEnabled()) {
-                    log.debug("Increase currentRetryDelay: " + std::to_string(currentDelay));
+                if (log->IsDebugEnabled()) {
+                    log->Debug("Increase currentRetryDelay: " + std::to_string(currentDelay));
                 }
             }
             attempt++;
@@ -43,6 +43,8 @@
 #include <lightstreamer/client/session/RecoveryBean.hpp>
 #include <lightstreamer/client/session/OfflineCheck.hpp>
 #include <lightstreamer/util/mdc/MDC.hpp>
+#include <lightstreamer/util/Clock.hpp>
+#include <lightstreamer/util/threads/Cancellable.hpp>
 
 namespace lightstreamer::client::session {
 
@@ -99,7 +101,8 @@ namespace lightstreamer::client::session {
 
         int workedBefore = 0;
         long long sentTime = 0;
-        static std::shared_ptr<CancellationTokenSource> lastKATask;
+        // The pending keepalive timeout, replaced whenever data arrives.
+        std::shared_ptr<util::threads::Cancellable> lastKATask;
         long long reconnectTimeout = 0;
 
         std::string phase = OFF;
@@ -536,25 +539,23 @@ namespace lightstreamer::client::session {
             return isPolling;
         }
 
-        std::future<void>
+        std::shared_ptr<util::threads::Cancellable>
         launchTimeout(const std::string &timeoutType, long pauseToUse, const std::string &cause, bool startRecovery) {
             int pc = phaseCount;
             log.debug("Status timeout in " + std::to_string(pauseToUse) + " [" + timeoutType + "] due to " + cause);
 
-            return std::async(std::launch::async, [this, pc, pauseToUse, timeoutType, cause, startRecovery] {
-                std::this_thread::sleep_for(std::chrono::milliseconds(pauseToUse + 50));
-
+            return thread->schedule([this, pc, pauseToUse, timeoutType, cause, startRecovery] {
                 if (pc != phaseCount) {
                     return;
                 }
 
                 onTimeout(timeoutType, pc, pauseToUse, cause, startRecovery);
-            });
+            }, pauseToUse + 50);
         }
 
         void timeoutForStalling() {
             if (options.keepaliveInterval > 0) {
-                if (lastKATask != nullptr && !lastKATask->isCanceled()) {
+                if (lastKATask != nullptr) {
                     lastKATask->cancel();
                 }
 
@@ -601,18 +602,14 @@ namespace lightstreamer::client::session {
             if (is("FIRST_PAUSE")) {
                 return options.pollingInterval;
             } else {
-                auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-                        std::chrono::system_clock::now().time_since_epoch()
-                );
+                auto now = std::chrono::milliseconds(util::Clock::currentTimeMillis());
                 long spent = (now - sentTime).count();
                 return spent > options.pollingInterval ? 0 : options.pollingInterval - spent;
             }
         }
 
         long calculateRetryDelay() const {
-            auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()
-            );
+            auto now = std::chrono::milliseconds(util::Clock::currentTimeMillis());
             long spent = (now - sentTime).count();
             long currentRetryDelay = options.currentRetryDelay;
             return spent > currentRetryDelay ? 0 : currentRetryDelay - spent;
@@ -849,8 +846,7 @@ namespace lightstreamer::client::session {
                 }
             } else if (is("PAUSE")) {
                 if (isPolling) {
-                    slowing.testPollSync(usedTimeout, std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::system_clock::now().time_since_epoch()).count());
+                    slowing.testPollSync(usedTimeout, util::Clock::currentTimeMillis());
                 }
                 bindSession("loop");
             } else if (is("FIRST_PAUSE")) {
@@ -871,8 +867,7 @@ namespace lightstreamer::client::session {
         }
 
         void createSent() {
-            sentTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count();
+            sentTime = util::Clock::currentTimeMillis();
             if (isNot("OFF") && isNot("SLEEP")) {
                 log.error("Unexpected phase after create request sent: " + phase);
                 shutdown(GO_TO_OFF);
@@ -885,8 +880,7 @@ namespace lightstreamer::client::session {
         }
 
         void bindSent() {
-            sentTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count();
+            sentTime = util::Clock::currentTimeMillis();
             if (isNot("PAUSE") && isNot("FIRST_PAUSE")) {
                 log.error("Unexpected phase after bind request sent: " + phase);
                 shutdown(GO_TO_OFF);
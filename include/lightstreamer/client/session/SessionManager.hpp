@@ -321,10 +321,9 @@ namespace lightstreamer::client::session {
             long timeout = options->getSwitchCheckTimeout() + delay;
             int ph = statusPhase;
 
-            std::thread([this, ph, reason, timeout]() {
-                std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            thread.schedule([this, ph, reason]() {
                 switchTimeout(ph, reason);
-            }).detach();
+            }, timeout);
         }
 
         /**
@@ -37,12 +37,29 @@
 #include <lightstreamer/util/threads/ThreadMultiplexer.hpp>
 #include <lightstreamer/client/session/SessionManager.hpp>
 #include <lightstreamer/util/threads/SingleThreadMultiplexer.hpp>
+#include <lightstreamer/util/threads/StaticAssignmentMultiplexer.hpp>
+#include <lightstreamer/util/threads/ReactorPoolMultiplexer.hpp>
+#include <lightstreamer/util/threads/InjectedExecutorMultiplexer.hpp>
 
 
 namespace lightstreamer::client::session {
     using namespace util::threads;
 
-    class SessionThread {
+    /**
+     * How session threads are shared among the LightstreamerClient instances of the process.
+     */
+    enum class SessionThreadPolicy {
+        /** All clients share a single session thread (default). */
+        SHARED,
+        /** Every client gets its own session thread. */
+        DEDICATED,
+        /** Clients are spread over a fixed pool of one thread per core, each keeping its thread. */
+        PER_CORE,
+        /** Clients are spread over a pool of a configured number of threads (see setReactorPool()). */
+        REACTOR_POOL
+    };
+
+    class SessionThread : public UncaughtExceptionHandler {
     private:
         static ILogger *log;
         std::shared_ptr<ThreadMultiplexer<SessionThread>> threads;
@@ -55,12 +72,18 @@ namespace lightstreamer::client::session {
         class SessionThreadFactory {
         private:
             static SessionThreadFactory INSTANCE;
-            bool dedicatedSessionThread;
+            SessionThreadPolicy policy;
             std::shared_ptr<ThreadMultiplexer<SessionThread>> singletonSessionThread;
+            std::shared_ptr<ThreadMultiplexer<SessionThread>> perCoreSessionThreads;
+            std::size_t reactorThreads;
+            ReactorAssignment reactorAssignment;
+            std::shared_ptr<ReactorPoolMultiplexer<SessionThread>> reactorPool;
             std::mutex mutex;
 
             // Private constructor for the singleton pattern
-            SessionThreadFactory() : dedicatedSessionThread(false) {
+            SessionThreadFactory() : policy(SessionThreadPolicy::SHARED),
+                                     reactorThreads(std::max(1u, std::thread::hardware_concurrency())),
+                                     reactorAssignment(ReactorAssignment::LEAST_LOAD) {
                 // Optionally load the configuration for dedicatedSessionThread from system properties or a configuration file
                 // dedicatedSessionThread = readConfiguration("com.lightstreamer.client.session.thread") == "dedicated";
             }
@@ -75,11 +98,43 @@ namespace lightstreamer::client::session {
                 return INSTANCE;
             }
 
+            void setPolicy(SessionThreadPolicy newPolicy) {
+                std::lock_guard<std::mutex> lock(mutex);
+                policy = newPolicy;
+            }
+
+            void setReactorPool(std::size_t threads, ReactorAssignment assignment) {
+                if (threads == 0) {
+                    throw std::invalid_argument("The reactor pool needs at least one thread");
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                policy = SessionThreadPolicy::REACTOR_POOL;
+                reactorThreads = threads;
+                reactorAssignment = assignment;
+            }
+
+            std::vector<ReactorLoad> getReactorLoad() {
+                std::lock_guard<std::mutex> lock(mutex);
+                return reactorPool ? reactorPool->getLoad() : std::vector<ReactorLoad>();
+            }
+
             // Method to get the ThreadMultiplexer instance
             std::shared_ptr<ThreadMultiplexer<SessionThread>> getSessionThread() {
                 std::lock_guard<std::mutex> lock(mutex);
-                if (dedicatedSessionThread) {
+                if (policy == SessionThreadPolicy::DEDICATED) {
                     return std::make_shared<SingleThreadMultiplexer<SessionThread>>();
+                } else if (policy == SessionThreadPolicy::PER_CORE) {
+                    // The workers are static; the instance only tracks the assignment of its sources.
+                    if (!perCoreSessionThreads) {
+                        perCoreSessionThreads = std::make_shared<StaticAssignmentMultiplexer<SessionThread>>();
+                    }
+                    return perCoreSessionThreads;
+                } else if (policy == SessionThreadPolicy::REACTOR_POOL) {
+                    if (!reactorPool) {
+                        reactorPool = std::make_shared<ReactorPoolMultiplexer<SessionThread>>(reactorThreads,
+                                                                                              reactorAssignment);
+                    }
+                    return reactorPool;
                 } else {
                     if (!singletonSessionThread) {
                         singletonSessionThread = std::make_shared<SingleThreadMultiplexer<SessionThread>>();
@@ -99,6 +154,47 @@ namespace lightstreamer::client::session {
             clientId = std::to_string(reinterpret_cast<std::uintptr_t>(this));
         }
 
+        /**
+         * Runs the session logic on the given multiplexer instead of the one selected by the policy, e.g. an
+         * InjectedExecutorMultiplexer over the application's executors, or a VirtualTimeMultiplexer for tests
+         * and benchmarks in simulated time.
+         */
+        explicit SessionThread(std::shared_ptr<ThreadMultiplexer<SessionThread>> multiplexer)
+                : threads(std::move(multiplexer)) {
+            clientId = std::to_string(reinterpret_cast<std::uintptr_t>(this));
+        }
+
+        ~SessionThread() override {
+            threads->release(this);
+        }
+
+        /**
+         * Sets how the session threads of the clients created afterwards are allocated. It must be called
+         * before the first LightstreamerClient is created.
+         */
+        static void setPolicy(SessionThreadPolicy policy) {
+            SessionThreadFactory::getInstance().setPolicy(policy);
+        }
+
+        /**
+         * Selects the REACTOR_POOL policy, spreading the clients over the given number of session threads.
+         * It must be called before the first LightstreamerClient is created.
+         *
+         * @param threads The number of session threads.
+         * @param assignment How clients are assigned to the threads.
+         * @throws std::invalid_argument if threads is zero.
+         */
+        static void setReactorPool(std::size_t threads, ReactorAssignment assignment = ReactorAssignment::LEAST_LOAD) {
+            SessionThreadFactory::getInstance().setReactorPool(threads, assignment);
+        }
+
+        /**
+         * @return The load of each thread of the reactor pool; empty if the pool is not in use.
+         */
+        static std::vector<ReactorLoad> getReactorLoad() {
+            return SessionThreadFactory::getInstance().getReactorLoad();
+        }
+
         void registerShutdownHook(ThreadShutdownHook *shutdownHook) {
             shutdownHookReference.CompareAndSet(nullptr, shutdownHook); // TODO: fix this
         }
@@ -123,30 +219,35 @@ namespace lightstreamer::client::session {
             }
         }
 
-        void queue(std::function<void()> task) {
-            threads->execute(this, decorateTask(task));
+        void queue(InlineTask task) {
+            task.setExceptionHandler(this);
+            threads->execute(this, std::move(task));
         }
 
-        std::chrono::milliseconds schedule(std::function<void()> task, long delayMillis) {
-            return threads->schedule(this, decorateTask(task), delayMillis);
+        /**
+         * Runs the task on this session thread after the given delay. Timers are kept in a timer wheel,
+         * so they cost no thread.
+         *
+         * @return A handle cancelling the task.
+         */
+        std::shared_ptr<Cancellable> schedule(InlineTask task, long delayMillis) {
+            task.setExceptionHandler(this);
+            return threads->schedule(this, std::move(task), delayMillis);
         }
 
         void setSessionManager(SessionManager *sessionManager) {
             this->sessionManager = sessionManager;
         }
 
-    private:
-        std::function<void()> decorateTask(std::function<void()> task) {
-            return [this, task]() {
-                try {
-                    task();
-                } catch (const std::exception &e) {
-                    log->Error("Uncaught exception", e);
-                    sessionManager->onFatalError(e);
-                }
-            };
+        /**
+         * Called by the executor run loop when a task of this session thread throws.
+         */
+        void onUncaughtException(const std::exception &e) override {
+            log->Error("Uncaught exception", e);
+            sessionManager->onFatalError(e);
         }
 
+    private:
         void queueCompleted() {
             // Do nothing
         }
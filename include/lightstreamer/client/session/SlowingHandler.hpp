@@ -28,6 +28,7 @@
 #include "Logger.hpp"
 #include <lightstreamer/client/session/InternalConnectionOptions.hpp>
 #include <lightstreamer/client/Constants.hpp>
+#include <lightstreamer/util/Clock.hpp>
 
 
 namespace lightstreamer::client::session {
@@ -71,7 +72,7 @@ namespace lightstreamer::client::session {
                 meanElaborationDelay = 0;
                 hugeFlag = false;
             }
-            refTime = std::chrono::steady_clock::now();
+            refTime = util::Clock::now();
         }
 
         void testPollSync(long millis, double currTime) {
@@ -96,7 +97,7 @@ namespace lightstreamer::client::session {
 
     private:
         bool testSync(long millis, double currTime) {
-            auto now = std::chrono::steady_clock::now();
+            auto now = util::Clock::now();
             auto diffTime = std::chrono::duration_cast<std::chrono::milliseconds>(now - refTime).count() - millis;
             if (!firstMeanCalculated) {
                 setMeanElaborationDelay(diffTime);
@@ -113,6 +113,24 @@ namespace lightstreamer::client::transport {
                 });
             }
 
+            void onLine(std::string_view line) override {
+                // The only copy of the line, moved into the task.
+                sessionThread->queue([this, message = std::string(line)]() {
+                    listener->onMessage(message);
+                });
+            }
+
+            void onLines(LineBatch lines) override {
+                // One task for the whole batch; its buffers are released when the task is done.
+                sessionThread->queue([this, lines = std::move(lines)]() {
+                    std::string message;
+                    for (std::string_view line: lines) {
+                        message.assign(line);
+                        listener->onMessage(message);
+                    }
+                });
+            }
+
             void onOpen() override {
                 sessionThread->queue([this]() {
                     listener->onOpen();
@@ -0,0 +1,432 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_LINEASSEMBLER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_LINEASSEMBLER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lightstreamer::client::transport {
+
+    /**
+     * A fixed-size receive buffer handed out by a ReceiveBufferPool.
+     */
+    class ReceiveBuffer {
+    private:
+        std::unique_ptr<char[]> storage;
+        std::size_t capacity;
+
+    public:
+        explicit ReceiveBuffer(std::size_t capacity) : storage(new char[capacity]), capacity(capacity) {}
+
+        char *data() const {
+            return storage.get();
+        }
+
+        std::size_t getCapacity() const {
+            return capacity;
+        }
+
+        /**
+         * @return Whether the bytes lie within the buffer.
+         */
+        bool contains(std::string_view bytes) const {
+            std::less_equal<const char *> notAfter;
+            return notAfter(storage.get(), bytes.data()) && notAfter(bytes.data() + bytes.size(), storage.get() + capacity);
+        }
+    };
+
+    /**
+     * Recycles receive buffers of one size.
+     *
+     * acquire() hands out buffers that go back to the pool when their last reference is released, on
+     * whichever thread that happens (typically the session thread, once it has consumed the lines of a
+     * LineBatch). The pool must be owned by a shared_ptr; buffers outliving it are simply freed.
+     */
+    class ReceiveBufferPool : public std::enable_shared_from_this<ReceiveBufferPool> {
+    public:
+        static constexpr std::size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    private:
+        std::size_t bufferSize;
+        std::size_t maxPooled;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ReceiveBuffer>> pooled;
+
+        void recycle(std::unique_ptr<ReceiveBuffer> buffer) noexcept {
+            std::lock_guard<std::mutex> lock(mutex);
+            // The capacity was reserved up front: this never allocates.
+            if (pooled.size() < maxPooled) {
+                pooled.push_back(std::move(buffer));
+            }
+        }
+
+    public:
+        /**
+         * @param bufferSize The size of the buffers.
+         * @param maxPooled How many released buffers are kept for reuse; further ones are freed.
+         */
+        explicit ReceiveBufferPool(std::size_t bufferSize = DEFAULT_BUFFER_SIZE, std::size_t maxPooled = 8)
+                : bufferSize(bufferSize), maxPooled(maxPooled) {
+            pooled.reserve(maxPooled);
+        }
+
+        std::shared_ptr<ReceiveBuffer> acquire() {
+            std::unique_ptr<ReceiveBuffer> buffer;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!pooled.empty()) {
+                    buffer = std::move(pooled.back());
+                    pooled.pop_back();
+                }
+            }
+            if (!buffer) {
+                buffer = std::make_unique<ReceiveBuffer>(bufferSize);
+            }
+            std::weak_ptr<ReceiveBufferPool> weak = weak_from_this();
+            return {buffer.release(), [weak](ReceiveBuffer *released) {
+                std::unique_ptr<ReceiveBuffer> owned(released);
+                if (auto pool = weak.lock()) {
+                    pool->recycle(std::move(owned));
+                }
+            }};
+        }
+
+        std::size_t getBufferSize() const {
+            return bufferSize;
+        }
+
+        std::size_t getPooledCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return pooled.size();
+        }
+    };
+
+    /**
+     * Lines of a stream, mostly as views on the receive buffers they arrived in.
+     *
+     * The batch keeps those buffers alive, so it can be handed to another thread (e.g. in a single
+     * session thread task) and the lines read there without having been copied; the buffers return to
+     * their pool when the batch is destroyed. The few lines that were not contiguous in a buffer are
+     * copied into storage of the batch.
+     */
+    class LineBatch {
+    private:
+        std::vector<std::string_view> lines;
+        std::vector<std::shared_ptr<ReceiveBuffer>> buffers;
+        std::vector<std::unique_ptr<char[]>> spilled;
+
+    public:
+        LineBatch() = default;
+        LineBatch(LineBatch &&) noexcept = default;
+        LineBatch &operator=(LineBatch &&) noexcept = default;
+        LineBatch(const LineBatch &) = delete;
+        LineBatch &operator=(const LineBatch &) = delete;
+
+        /**
+         * Adds a line lying in the given buffer, without copying it.
+         */
+        void add(std::string_view line, const std::shared_ptr<ReceiveBuffer> &owner) {
+            if (buffers.empty() || buffers.back() != owner) {
+                buffers.push_back(owner);
+            }
+            lines.push_back(line);
+        }
+
+        /**
+         * Adds a line made of two parts, copying them. A trailing CR is dropped.
+         */
+        void addCopy(std::string_view head, std::string_view tail) {
+            std::size_t size = head.size() + tail.size();
+            std::unique_ptr<char[]> storage(new char[size == 0 ? 1 : size]);
+            std::memcpy(storage.get(), head.data(), head.size());
+            std::memcpy(storage.get() + head.size(), tail.data(), tail.size());
+            if (size > 0 && storage[size - 1] == '\r') {
+                --size;
+            }
+            lines.emplace_back(storage.get(), size);
+            spilled.push_back(std::move(storage));
+        }
+
+        std::size_t size() const {
+            return lines.size();
+        }
+
+        bool empty() const {
+            return lines.empty();
+        }
+
+        std::string_view operator[](std::size_t i) const {
+            return lines[i];
+        }
+
+        std::vector<std::string_view>::const_iterator begin() const {
+            return lines.begin();
+        }
+
+        std::vector<std::string_view>::const_iterator end() const {
+            return lines.end();
+        }
+
+        /**
+         * @return The number of lines that had to be copied.
+         */
+        std::size_t getCopiedCount() const {
+            return spilled.size();
+        }
+    };
+
+    /**
+     * Splits a byte stream into CRLF-terminated lines, in place.
+     *
+     * The stream arrives as segments lying in pooled receive buffers (e.g. WebSocket frame payloads
+     * parsed where the socket read them). Every line contained in a segment is added to the current
+     * LineBatch as a view; segments that follow each other in the same buffer are joined without
+     * copying. Only a line spanning segments that are not contiguous (a buffer boundary, a frame header
+     * in between) is copied. Bytes that do not lie in a pooled buffer are first copied into one; a producer
+     * such as an inflater can instead write straight into that buffer (see stagingRoom()).
+     *
+     * take() hands the complete lines over; the unterminated tail stays here until its end arrives.
+     * Not thread-safe: the assembler is used by the thread reading the stream.
+     */
+    class LineAssembler {
+    private:
+        std::shared_ptr<ReceiveBufferPool> pool;
+        LineBatch batch;
+        // The unterminated tail of the last segment, in place...
+        std::shared_ptr<ReceiveBuffer> pendingOwner;
+        std::string_view pending;
+        // ...or, once it spans non-contiguous segments, copied here.
+        std::string carry;
+        // The buffer receiving the bytes given by copy.
+        std::shared_ptr<ReceiveBuffer> staging;
+        std::size_t stagingUsed = 0;
+
+        void clearPending() {
+            pending = {};
+            pendingOwner.reset();
+        }
+
+    public:
+        /**
+         * @param pool The pool of the buffers receiving the bytes given by copy; null for a private one.
+         */
+        explicit LineAssembler(std::shared_ptr<ReceiveBufferPool> pool = nullptr)
+                : pool(pool ? std::move(pool) : std::make_shared<ReceiveBufferPool>()) {}
+
+        /**
+         * Appends a segment lying in a pooled buffer. The bytes of the buffer up to the end of the
+         * segment must not change while lines or batches refer to it; bytes after it may still be written.
+         * A segment that does not lie in the buffer is copied.
+         */
+        void append(const std::shared_ptr<ReceiveBuffer> &owner, std::string_view segment) {
+            if (!owner || !owner->contains(segment)) {
+                append(segment);
+                return;
+            }
+            if (segment.empty()) {
+                return;
+            }
+            std::size_t start = 0;
+            std::size_t from = 0;
+            if (!pending.empty() && pendingOwner == owner && pending.data() + pending.size() == segment.data()) {
+                // Contiguous with the pending tail, which has no terminator: the line keeps growing in place.
+                from = pending.size();
+                segment = std::string_view(pending.data(), pending.size() + segment.size());
+                clearPending();
+            } else if (!pending.empty() || !carry.empty()) {
+                std::size_t end = segment.find('\n');
+                if (end == std::string_view::npos) {
+                    carry.append(pending).append(segment);
+                    clearPending();
+                    return;
+                }
+                // Either the head is still in place, or it was carried (and nothing is pending).
+                batch.addCopy(carry.empty() ? pending : std::string_view(carry), segment.substr(0, end));
+                carry.clear();
+                clearPending();
+                start = from = end + 1;
+            }
+            for (std::size_t end; (end = segment.find('\n', from)) != std::string_view::npos; start = from = end + 1) {
+                std::string_view line = segment.substr(start, end - start);
+                if (!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+                batch.add(line, owner);
+            }
+            if (start < segment.size()) {
+                pending = segment.substr(start);
+                pendingOwner = owner;
+            }
+        }
+
+        /**
+         * Appends bytes from anywhere, copying them into a pooled buffer first.
+         */
+        void append(std::string_view bytes) {
+            while (!bytes.empty()) {
+                std::span<char> room = stagingRoom();
+                std::size_t count = std::min(bytes.size(), room.size());
+                std::memcpy(room.data(), bytes.data(), count);
+                bytes.remove_prefix(count);
+                commitStaged(count);
+            }
+        }
+
+        /**
+         * @return The free part of the pooled buffer receiving the bytes given by copy, never empty. Bytes
+         * written there are appended by commitStaged(); the room is valid until then.
+         */
+        std::span<char> stagingRoom() {
+            if (!staging || stagingUsed == staging->getCapacity()) {
+                staging = pool->acquire();
+                stagingUsed = 0;
+            }
+            return {staging->data() + stagingUsed, staging->getCapacity() - stagingUsed};
+        }
+
+        /**
+         * Appends the first count bytes written into the last stagingRoom().
+         */
+        void commitStaged(std::size_t count) {
+            std::string_view written(staging->data() + stagingUsed, count);
+            stagingUsed += count;
+            append(staging, written);
+        }
+
+        bool hasLines() const {
+            return !batch.empty();
+        }
+
+        /**
+         * @return The complete lines appended since the last call.
+         */
+        LineBatch take() {
+            return std::exchange(batch, LineBatch());
+        }
+
+        /**
+         * Discards everything, e.g. when the stream is restarted.
+         */
+        void reset() {
+            batch = LineBatch();
+            clearPending();
+            carry.clear();
+            staging.reset();
+            stagingUsed = 0;
+        }
+    };
+
+    /**
+     * The receive side of a socket over pooled buffers, keeping the unread bytes contiguous like a
+     * RingBuffer, so that a parser can work in place and hand out views (see LineBatch).
+     *
+     * Consumed bytes are never overwritten while a batch still refers to their buffer: when the room left
+     * gets short, reading moves on to a fresh buffer and only the unread bytes (typically the head of a
+     * line) are copied over. A buffer nobody else refers to is compacted in place instead.
+     */
+    class ReceiveBufferChain {
+    private:
+        std::shared_ptr<ReceiveBufferPool> pool;
+        std::shared_ptr<ReceiveBuffer> current;
+        std::size_t head = 0;
+        std::size_t tail = 0;
+
+    public:
+        explicit ReceiveBufferChain(std::shared_ptr<ReceiveBufferPool> pool) : pool(std::move(pool)) {}
+
+        /**
+         * @return The unread bytes.
+         */
+        char *data() const {
+            return current ? current->data() + head : nullptr;
+        }
+
+        std::size_t size() const {
+            return tail - head;
+        }
+
+        /**
+         * @return Where to receive the next bytes; writableSize() tells how many fit.
+         */
+        char *writable() {
+            if (!current) {
+                current = pool->acquire();
+                head = tail = 0;
+            }
+            std::size_t capacity = current->getCapacity();
+            if (head > 0 && capacity - tail < capacity / 4) {
+                if (current.use_count() == 1) {
+                    std::memmove(current->data(), current->data() + head, tail - head);
+                } else {
+                    auto next = pool->acquire();
+                    std::memcpy(next->data(), current->data() + head, tail - head);
+                    current = std::move(next);
+                }
+                tail -= head;
+                head = 0;
+            }
+            return current->data() + tail;
+        }
+
+        std::size_t writableSize() const {
+            return current ? current->getCapacity() - tail : 0;
+        }
+
+        void commit(std::size_t n) {
+            tail += n;
+        }
+
+        void consume(std::size_t n) {
+            head += n;
+        }
+
+        /**
+         * @return The buffer holding the unread bytes, to be referenced by the lines found in them.
+         */
+        const std::shared_ptr<ReceiveBuffer> &getBuffer() const {
+            return current;
+        }
+
+        std::size_t getCapacity() const {
+            return pool->getBufferSize();
+        }
+
+        const std::shared_ptr<ReceiveBufferPool> &getPool() const {
+            return pool;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_LINEASSEMBLER_HPP
@@ -25,6 +25,7 @@
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_REQUESTLISTENER_HPP
 
 #include <string>
+#include <lightstreamer/client/transport/LineAssembler.hpp>
 
 namespace lightstreamer::client::transport {
 
@@ -35,6 +36,14 @@ namespace lightstreamer::client::transport {
         // Called to notify of new data on the connection.
         virtual void onMessage(const std::string &message) = 0;
 
+        // Called with several lines at once by transports splitting them in place (see LineBatch).
+        // By default, each line is forwarded to onMessage().
+        virtual void onLines(LineBatch lines) {
+            for (std::string_view line: lines) {
+                onMessage(std::string(line));
+            }
+        }
+
         // Called as soon as the socket was opened, and before the request is written on the net.
         virtual void onOpen() = 0;
 
@@ -30,7 +30,9 @@
 #include <cassert>
 #include <iostream>
 #include <functional>
+#include <iterator>
 #include <unordered_map>
+#include <vector>
 #include <lightstreamer/client/transport/providers/WebSocketProvider.hpp>
 #include "lightstreamer/client/session/SessionThread.hpp"
 #include <lightstreamer/client/protocol/TextProtocol.hpp>
@@ -63,6 +65,64 @@ namespace lightstreamer::client::transport {
         InternalState state = InternalState::NOT_CONNECTED;
         std::string defaultSessionId;
 
+        /**
+         * The maximum length of a coalesced frame until the server tells its own limit in CONOK (this is
+         * the default of the server).
+         */
+        static constexpr std::size_t DEFAULT_REQUEST_LIMIT = 50000;
+
+        /**
+         * Requests of the same kind sent one after the other, merged in a single message as TLCP allows:
+         * the request name followed by the query strings, one per line.
+         */
+        struct OutgoingFrame {
+            std::string name;
+            std::string message;
+            std::vector<std::shared_ptr<RequestListener>> listeners;
+        };
+
+        std::vector<OutgoingFrame> outgoing;
+        bool flushQueued = false;
+        // Referenced weakly by the queued flush, which the SessionThread may run after this transport is gone.
+        std::shared_ptr<WebSocket *> liveness = std::make_shared<WebSocket *>(this);
+        std::size_t requestLimit = DEFAULT_REQUEST_LIMIT;
+
+        /**
+         * Notifies the listeners of all the requests of a flush, which are written together.
+         */
+        class CoalescedRequestListener : public RequestListener {
+        private:
+            std::vector<std::shared_ptr<RequestListener>> listeners;
+
+        public:
+            explicit CoalescedRequestListener(std::vector<std::shared_ptr<RequestListener>> listeners)
+                    : listeners(std::move(listeners)) {}
+
+            void onMessage(const std::string &message) override {
+                for (auto &listener: listeners) {
+                    listener->onMessage(message);
+                }
+            }
+
+            void onOpen() override {
+                for (auto &listener: listeners) {
+                    listener->onOpen();
+                }
+            }
+
+            void onClosed() override {
+                for (auto &listener: listeners) {
+                    listener->onClosed();
+                }
+            }
+
+            void onBroken() override {
+                for (auto &listener: listeners) {
+                    listener->onBroken();
+                }
+            }
+        };
+
         /**
  * Interface to capture connection opening events.
  */
@@ -129,6 +189,23 @@ namespace lightstreamer::client::transport {
                 });
             }
 
+            /**
+             * Called with the lines of the stream assembled in place by the provider.
+             */
+            void onLines(LineBatch lines) override {
+                sessionThread.queue([this, lines = std::move(lines)]() {
+                    if (state == InternalState::DISCONNECTED) {
+                        log.debug("onLines event discarded: " + std::to_string(lines.size()) + " lines");
+                        return;
+                    }
+                    std::string message;
+                    for (std::string_view line: lines) {
+                        message.assign(line);
+                        streamListener.onMessage(message);
+                    }
+                });
+            }
+
             /**
              * Called when the WebSocket connection is closed.
              */
@@ -210,6 +287,9 @@ namespace lightstreamer::client::transport {
         MySessionRequestListener sessionListener;
 
     public:
+        WebSocket(const WebSocket &) = delete;
+        WebSocket &operator=(const WebSocket &) = delete;
+
         WebSocket(std::shared_ptr<session::SessionThread> sessionThread,
                   std::shared_ptr<session::InternalConnectionOptions> options,
                   std::string serverAddress, std::shared_ptr<protocol::TextProtocol::StreamListener> streamListener,
@@ -255,6 +335,11 @@ namespace lightstreamer::client::transport {
         /**
          * Sends a request over WebSocket.
          *
+         * The request is not written at once: the requests sent during the current SessionThread task are
+         * written at its end, all together (see WebSocketProvider::sendBatch()). Consecutive requests of
+         * the same kind share a single frame, up to the request limit of the server, so that e.g. the
+         * thousands of subscriptions of a startup take a few frames and system calls.
+         *
          * Note: The parameters protocol, extraHeaders, proxy, tcpConnectTimeout, and tcpReadTimeout
          * have no meaning for WebSocket connections and are therefore ignored.
          *
@@ -278,13 +363,58 @@ namespace lightstreamer::client::transport {
             // Asserting the expected conditions for WebSocket connections.
             assert(extraHeaders.empty() && !proxy && tcpConnectTimeout == 0 && tcpReadTimeout == 0);
 
-            std::string frame =
-                    request->getRequestName() + "\r\n" + request->getTransportAwareQueryString(defaultSessionId, false);
-            wsClient->send(frame, listener);
+            std::string name = request->getRequestName();
+            std::string query = request->getTransportAwareQueryString(defaultSessionId, false);
+            if (outgoing.empty() || outgoing.back().name != name ||
+                outgoing.back().message.size() + 2 + query.size() > requestLimit) {
+                // A request longer than the limit still gets a frame of its own.
+                outgoing.push_back({name, name, {}});
+            }
+            OutgoingFrame &frame = outgoing.back();
+            frame.message.append("\r\n").append(query);
+            if (listener) {
+                frame.listeners.push_back(std::move(listener));
+            }
+            if (!flushQueued) {
+                flushQueued = true;
+                sessionThread->queue([weak = std::weak_ptr<WebSocket *>(liveness)]() {
+                    if (auto alive = weak.lock()) {
+                        (*alive)->flushRequests();
+                    }
+                });
+            }
             return std::make_unique<RequestHandleAnonymousInnerClass>(*this);
         }
 
+        /**
+         * Sets the maximum length of a frame carrying several requests, as told by the server.
+         *
+         * @param limit The request limit; 0 keeps the default.
+         */
+        void setRequestLimit(long limit) {
+            requestLimit = limit > 0 ? static_cast<std::size_t>(limit) : DEFAULT_REQUEST_LIMIT;
+        }
+
     private:
+        // Writes the requests coalesced by sendRequest(). Runs on the SessionThread.
+        void flushRequests() {
+            flushQueued = false;
+            if (outgoing.empty() || sessionListener.state == InternalState::DISCONNECTED) {
+                outgoing.clear();
+                return;
+            }
+            std::vector<std::string> messages;
+            std::vector<std::shared_ptr<RequestListener>> listeners;
+            messages.reserve(outgoing.size());
+            for (auto &frame: outgoing) {
+                messages.push_back(std::move(frame.message));
+                listeners.insert(listeners.end(), std::make_move_iterator(frame.listeners.begin()),
+                                 std::make_move_iterator(frame.listeners.end()));
+            }
+            outgoing.clear();
+            wsClient->sendBatch(std::move(messages), std::make_shared<CoalescedRequestListener>(std::move(listeners)));
+        }
+
         /**
          * A RequestHandle implementation that should not be used to close the connection.
          * To close the connection, the WebSocket::close() method should be used instead.
@@ -314,6 +444,7 @@ namespace lightstreamer::client::transport {
             log.info("Closing wsc ");
 
             sessionListener.close();
+            outgoing.clear();
             wsClient.disconnect();
         }
 
@@ -26,6 +26,7 @@
 
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <lightstreamer/client/requests/LightstreamerRequest.hpp>
 #include <lightstreamer/client/protocol/Protocol.hpp>
@@ -52,6 +53,21 @@ namespace lightstreamer::client::transport::providers {
     };
 
     class HttpProvider_HttpRequestListener : public transport::RequestListener {
+    public:
+        /**
+         * Receives a response line as a view on the provider buffer, valid only during the call.
+         * Providers parsing in place call this instead of onMessage(), so that the listener copies the
+         * line only if and where it needs to.
+         */
+        virtual void onLine(std::string_view line) {
+            onMessage(std::string(line));
+        }
+
+        void onLines(LineBatch lines) override {
+            for (std::string_view line: lines) {
+                onLine(line);
+            }
+        }
     };
 
 } // namespace lightstreamer::client::transport::providers
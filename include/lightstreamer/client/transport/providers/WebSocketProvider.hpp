@@ -27,6 +27,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <lightstreamer/client/transport/SessionRequestListener.hpp>
 #include <lightstreamer/client/Proxy.hpp>
 #include <lightstreamer/util/threads/ThreadShutdownHook.hpp>
@@ -65,6 +66,21 @@ namespace lightstreamer::client::transport::providers {
          */
         virtual void send(const std::string &message, std::shared_ptr<RequestListener> listener) = 0;
 
+        /**
+         * Sends several messages, in order, each as a frame of its own.
+         *
+         * Providers able to write them at once (e.g. with a single system call) override this; by default,
+         * the messages are passed to send() one by one.
+         *
+         * @param messages The messages to be sent.
+         * @param listener Listener to notify, once, when all the messages have been written.
+         */
+        virtual void sendBatch(std::vector<std::string> messages, std::shared_ptr<RequestListener> listener) {
+            for (std::size_t i = 0; i < messages.size(); ++i) {
+                send(messages[i], i + 1 == messages.size() ? listener : nullptr);
+            }
+        }
+
         /**
          * Closes the connection.
          */
@@ -26,6 +26,7 @@
 #include <memory>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <exception>
 #include <unordered_map>
 
@@ -33,6 +34,7 @@
 #include <lightstreamer/client/transport/providers/WebSocketProvider.hpp>
 #include <lightstreamer/client/transport/SessionRequestListener.hpp>
 #include <lightstreamer/client/transport/RequestListener.hpp>
+#include <lightstreamer/client/transport/LineAssembler.hpp>
 #include <lightstreamer/client/transport/providers/cpp/pool/WebSocketPoolManager.hpp>
 #include <lightstreamer/util/LsUtils.hpp>
 #include <lightstreamer/client/transport/providers/cpp/PipelineUtils.hpp>
@@ -160,17 +162,20 @@ namespace lightstreamer::client::transport::providers::cpp {
          * Parses the messages coming from a channel and forwards them to the corresponding RequestListener.
          */
         class WebSocketChannelHandler : public SimpleChannelInboundHandler<IByteBuffer> {
-            std::unique_ptr<LineAssembler> lineAssembler;
+            LineAssembler lineAssembler;
             std::shared_ptr<RequestListenerDecorator> reqListenerDecorator;
 
         public:
             WebSocketChannelHandler(std::shared_ptr<RequestListener> networkListener, std::shared_ptr<MyChannel> ch) {
                 reqListenerDecorator = std::make_shared<RequestListenerDecorator>(networkListener, ch);
-                lineAssembler = std::make_unique<LineAssembler>(reqListenerDecorator);
             }
 
             void channelRead0(std::shared_ptr<IChannelHandlerContext> ctx, std::shared_ptr<IByteBuffer> msg) override {
-                lineAssembler->readBytes(msg);
+                lineAssembler.append(std::string_view(reinterpret_cast<const char*>(msg->data()), msg->size()));
+                if (lineAssembler.hasLines()) {
+                    // The decorator sees each line through onMessage(), where LOOP and END are detected.
+                    reqListenerDecorator->onLines(lineAssembler.take());
+                }
             }
 
             void handlerAdded(std::shared_ptr<IChannelHandlerContext> ctx) {
@@ -0,0 +1,178 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLHTTPPROVIDER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLHTTPPROVIDER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <lightstreamer/client/Constants.hpp>
+#include <lightstreamer/client/transport/providers/HttpProvider.hpp>
+#include <lightstreamer/client/transport/providers/TransportFactory.hpp>
+#include <lightstreamer/client/transport/providers/epoll/HttpConnectionPool.hpp>
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * HttpProvider running HTTP/1.1 streaming and control requests on an EmbeddedEventLoop, through
+     * an HttpConnectionPool: control requests to the same server reuse its keep-alive connections.
+     *
+     * Each request is a POST to <server>lightstreamer/<request name>.txt carrying the TLCP parameters
+     * in the body. The lines of each read are handed to the listener at once, as a LineBatch of views
+     * on the receive buffers (see RequestListener::onLines()).
+     */
+    class EpollHttpProvider : public HttpProvider {
+    private:
+        using EmbeddedEventLoop = util::threads::EmbeddedEventLoop;
+
+        inline static std::shared_ptr<Logger::ConsoleLogger> log =
+                Logger::ConsoleLogger::getInstance(ConsoleLogLevel::Level::TRACE, Constants::TRANSPORT_LOG);
+
+        class ListenerAdapter : public HttpStreamListener {
+        private:
+            std::shared_ptr<RequestListener> listener;
+            HttpProvider_HttpRequestListener *lineListener;
+
+        public:
+            explicit ListenerAdapter(std::shared_ptr<RequestListener> listener)
+                    : listener(std::move(listener)),
+                      lineListener(dynamic_cast<HttpProvider_HttpRequestListener *>(this->listener.get())) {}
+
+            void onOpen() override {
+                listener->onOpen();
+            }
+
+            void onLine(std::string_view line) override {
+                if (lineListener) {
+                    lineListener->onLine(line);
+                } else {
+                    listener->onMessage(std::string(line));
+                }
+            }
+
+            void onLines(LineBatch lines) override {
+                listener->onLines(std::move(lines));
+            }
+
+            void onClosed() override {
+                listener->onClosed();
+            }
+
+            void onBroken() override {
+                listener->onBroken();
+            }
+        };
+
+        class Handle : public RequestHandle {
+        private:
+            std::shared_ptr<EmbeddedEventLoop> loop;
+            std::shared_ptr<HttpConnectionPool::Exchange> exchange;
+
+        public:
+            Handle(std::shared_ptr<EmbeddedEventLoop> loop, std::shared_ptr<HttpConnectionPool::Exchange> exchange)
+                    : loop(std::move(loop)), exchange(std::move(exchange)) {}
+
+            void close(bool forceConnectionClose) override {
+                loop->execute([exchange = exchange] {
+                    exchange->close();
+                });
+            }
+        };
+
+        std::shared_ptr<HttpConnectionPool> pool;
+
+    public:
+        /**
+         * @param loop The loop running the sockets; null for EventLoopThread::sharedLoop().
+         * @param tls The TLS context for https:// addresses; null for one with the default TlsOptions.
+         * @param poolOptions The keep-alive settings of the connections.
+         */
+        explicit EpollHttpProvider(std::shared_ptr<EmbeddedEventLoop> loop = nullptr,
+                                   std::shared_ptr<TlsContext> tls = nullptr, HttpPoolOptions poolOptions = {})
+                : pool(std::make_shared<HttpConnectionPool>(
+                loop ? std::move(loop) : util::threads::EventLoopThread::sharedLoop(), std::move(tls), poolOptions)) {}
+
+        /**
+         * @param pool The connections, possibly shared with other providers.
+         */
+        explicit EpollHttpProvider(std::shared_ptr<HttpConnectionPool> pool) : pool(std::move(pool)) {}
+
+        std::shared_ptr<RequestHandle> createConnection(std::shared_ptr<protocol::Protocol> protocol,
+                                                        std::shared_ptr<requests::LightstreamerRequest> request,
+                                                        std::shared_ptr<RequestListener> httpListener,
+                                                        const std::unordered_map<std::string, std::string> &extraHeaders,
+                                                        long tcpConnectTimeout, long tcpReadTimeout) override {
+            std::string url = request->getTargetServer() + "lightstreamer/" + request->getRequestName() +
+                              ".txt?LS_protocol=" + Constants::TLCP_VERSION;
+            HttpRequest httpRequest;
+            httpRequest.body = request->getTransportAwareQueryString("", true);
+            httpRequest.headers = extraHeaders;
+            try {
+                auto exchange = pool->send(url, std::move(httpRequest), std::make_shared<ListenerAdapter>(httpListener),
+                                           tcpConnectTimeout, tcpReadTimeout);
+                return std::make_shared<Handle>(pool->getLoop(), std::move(exchange));
+            } catch (const std::exception &e) {
+                log->Error("HTTP connection error: " + std::string(e.what()));
+                httpListener->onBroken();
+                return nullptr;
+            }
+        }
+
+        std::shared_ptr<ThreadShutdownHook> getShutdownHook() const override {
+            return nullptr;
+        }
+    };
+
+    /**
+     * Creates EpollHttpProvider instances sharing one loop, one TLS context and one connection pool.
+     *
+     * Install it with TransportFactory<HttpProvider>::setDefaultHttpFactory(). With an embedded client
+     * (see ClientExecutors::embedded()), pass the client loop so that the sockets are served by the
+     * application thread calling poll().
+     */
+    class EpollHttpProviderFactory : public TransportFactory<HttpProvider> {
+    private:
+        std::shared_ptr<HttpConnectionPool> pool;
+
+    public:
+        explicit EpollHttpProviderFactory(std::shared_ptr<util::threads::EmbeddedEventLoop> loop = nullptr,
+                                          const TlsOptions &tlsOptions = {}, HttpPoolOptions poolOptions = {})
+                : pool(std::make_shared<HttpConnectionPool>(
+                loop ? std::move(loop) : util::threads::EventLoopThread::sharedLoop(),
+                std::make_shared<TlsContext>(tlsOptions), poolOptions)) {}
+
+        std::unique_ptr<HttpProvider> getInstance(std::shared_ptr<session::SessionThread> thread) override {
+            return std::make_unique<EpollHttpProvider>(pool);
+        }
+
+        bool isResponseBuffered() const override {
+            return false;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLHTTPPROVIDER_HPP
@@ -0,0 +1,557 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLWEBSOCKETPROVIDER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLWEBSOCKETPROVIDER_HPP
+
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <Logger.hpp>
+#include <lightstreamer/client/Constants.hpp>
+#include <lightstreamer/client/transport/LineAssembler.hpp>
+#include <lightstreamer/client/transport/providers/WebSocketProvider.hpp>
+#include <lightstreamer/client/transport/providers/epoll/PerMessageDeflate.hpp>
+#include <lightstreamer/client/transport/providers/epoll/SocketStream.hpp>
+#include <lightstreamer/client/transport/providers/epoll/WebSocketFraming.hpp>
+#include <lightstreamer/client/transport/providers/epoll/WebSocketHandshake.hpp>
+#include <lightstreamer/util/threads/EmbeddedEventLoop.hpp>
+#include <lightstreamer/util/threads/EventLoopThread.hpp>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * The parts of a ws:// or wss:// address.
+     */
+    struct WebSocketAddress {
+        bool secure = false;
+        std::string host;
+        int port = 80;
+        std::string path = "/";
+
+        /**
+         * @throws std::invalid_argument if the address is not a ws, wss, http or https URL.
+         */
+        static WebSocketAddress parse(const std::string &address) {
+            WebSocketAddress result;
+            auto schemeEnd = address.find("://");
+            if (schemeEnd == std::string::npos) {
+                throw std::invalid_argument("Invalid address: " + address);
+            }
+            std::string scheme = address.substr(0, schemeEnd);
+            for (auto &c: scheme) {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            if (scheme == "wss" || scheme == "https") {
+                result.secure = true;
+            } else if (scheme != "ws" && scheme != "http") {
+                throw std::invalid_argument("Unsupported scheme: " + scheme);
+            }
+            result.port = result.secure ? 443 : 80;
+            std::size_t hostStart = schemeEnd + 3;
+            std::size_t pathStart = address.find('/', hostStart);
+            std::string authority = address.substr(hostStart, pathStart == std::string::npos ? std::string::npos
+                                                                                              : pathStart - hostStart);
+            if (pathStart != std::string::npos) {
+                result.path = address.substr(pathStart);
+            }
+            std::size_t portStart = std::string::npos;
+            if (!authority.empty() && authority.front() == '[') {
+                std::size_t close = authority.find(']');
+                if (close == std::string::npos) {
+                    throw std::invalid_argument("Invalid address: " + address);
+                }
+                result.host = authority.substr(1, close - 1);
+                if (close + 1 < authority.size() && authority[close + 1] == ':') {
+                    portStart = close + 2;
+                }
+            } else {
+                std::size_t colon = authority.rfind(':');
+                result.host = authority.substr(0, colon);
+                if (colon != std::string::npos) {
+                    portStart = colon + 1;
+                }
+            }
+            if (portStart != std::string::npos) {
+                result.port = std::stoi(authority.substr(portStart));
+            }
+            if (result.host.empty()) {
+                throw std::invalid_argument("Invalid address: " + address);
+            }
+            return result;
+        }
+    };
+
+    /**
+     * WebSocket transport running directly on a non-blocking socket driven by an EmbeddedEventLoop.
+     *
+     * All the socket work (TCP connection, TLS and upgrade handshakes, frame parsing and writing) happens
+     * on the loop, which is either the one given at construction (e.g. the embedded loop of the client)
+     * or a loop thread shared by all the providers using the default. The socket is read into pooled
+     * buffers where frames are parsed in place (see WebSocketFrameParser) and split into TLCP lines by a
+     * LineAssembler, so the lines of each read reach RequestListener::onLines() as views on those
+     * buffers. permessage-deflate is offered when the library is built with zlib (see DeflateOptions);
+     * compressed messages are inflated straight into pooled buffers of the LineAssembler.
+     *
+     * Limitations: proxies are not supported (the connection is reported broken) and the host name is
+     * resolved on the thread calling connect().
+     */
+    class EpollWebSocketProvider : public WebSocketProvider {
+    private:
+        using EmbeddedEventLoop = util::threads::EmbeddedEventLoop;
+
+        static constexpr std::size_t READ_BUFFER_SIZE = 16 * 1024;
+        static constexpr std::size_t MAX_RESPONSE_HEAD = 16 * 1024;
+
+        inline static std::shared_ptr<Logger::ConsoleLogger> log =
+                Logger::ConsoleLogger::getInstance(ConsoleLogLevel::Level::TRACE, Constants::TRANSPORT_LOG);
+
+        enum class State {
+            CONNECTING,
+            TLS,
+            UPGRADE,
+            OPEN,
+            CLOSED
+        };
+
+        /**
+         * The connection state. Apart from construction, it is only touched on the loop.
+         */
+        class Connection : public std::enable_shared_from_this<Connection> {
+        private:
+            std::shared_ptr<EmbeddedEventLoop> loop;
+            std::shared_ptr<SessionRequestListener> listener;
+            std::shared_ptr<TlsContext> tls;
+            SocketStream stream;
+            WebSocketAddress address;
+            std::string key;
+            State state = State::CONNECTING;
+            std::uint32_t interest = 0;
+            std::mt19937 random;
+
+            std::string output;
+            // Messages sent before the end of the handshake, which decides whether they are compressed.
+            std::vector<std::string> deferred;
+            std::string head;
+            WebSocketFrameParser parser;
+            ReceiveBufferChain input;
+            LineAssembler assembler;
+            DeflateOptions deflateOptions;
+            std::unique_ptr<PerMessageDeflate> deflate;
+            std::shared_ptr<util::threads::Cancellable> timeout;
+
+        public:
+            Connection(std::shared_ptr<EmbeddedEventLoop> loop, std::shared_ptr<SessionRequestListener> listener,
+                       std::shared_ptr<TlsContext> tls, SocketStream stream, WebSocketAddress address,
+                       const std::unordered_map<std::string, std::string> &extraHeaders, const std::string &cookies,
+                       DeflateOptions deflateOptions)
+                    : loop(std::move(loop)), listener(std::move(listener)), tls(std::move(tls)),
+                      stream(std::move(stream)), address(std::move(address)), random(std::random_device{}()),
+                      input(std::make_shared<ReceiveBufferPool>(READ_BUFFER_SIZE, 4)), assembler(input.getPool()),
+                      deflateOptions(deflateOptions) {
+                key = WebSocketHandshake::generateKey(random);
+                // Queued now, written once the connection (and TLS) is up.
+                head = WebSocketHandshake::buildRequest(this->address.host, this->address.port, this->address.secure,
+                                                        this->address.path, key, extraHeaders, cookies,
+                                                        DeflateParameters::offer(this->deflateOptions));
+            }
+
+            void start(long timeoutMillis) {
+                std::weak_ptr<Connection> weak = weak_from_this();
+                interest = EPOLLOUT;
+                loop->watch(stream.getFd(), interest, [weak](std::uint32_t events) {
+                    if (auto self = weak.lock()) {
+                        self->onEvents(events);
+                    }
+                });
+                if (timeoutMillis > 0) {
+                    timeout = loop->schedule([weak] {
+                        auto self = weak.lock();
+                        if (self && self->state != State::OPEN && self->state != State::CLOSED) {
+                            log->Error("WebSocket connection to " + self->address.host + " timed out");
+                            self->fail();
+                        }
+                    }, timeoutMillis);
+                }
+            }
+
+            // The frames of the messages are written together, with a single write when the socket allows it.
+            void send(std::vector<std::string> &messages, const std::shared_ptr<RequestListener> &requestListener) {
+                if (state == State::CLOSED) {
+                    log->Debug(std::to_string(messages.size()) + " messages discarded because the WebSocket is closed");
+                    return;
+                }
+                if (state == State::OPEN) {
+                    for (const auto &message: messages) {
+                        writeMessage(message);
+                    }
+                    flush();
+                } else {
+                    deferred.insert(deferred.end(), std::make_move_iterator(messages.begin()),
+                                    std::make_move_iterator(messages.end()));
+                }
+                if (requestListener && state != State::CLOSED) {
+                    requestListener->onOpen();
+                }
+            }
+
+            /**
+             * Starts the closing handshake and releases the socket; the listener is not notified.
+             */
+            void close() {
+                if (state == State::OPEN) {
+                    std::string frame;
+                    encodeFrame(frame, WebSocketOpcode::CLOSE, std::string_view("\x03\xE8", 2),
+                                static_cast<std::uint32_t>(random()));
+                    // Best effort: the socket is closed right after.
+                    stream.write(frame.data(), frame.size());
+                }
+                release();
+            }
+
+        private:
+            void writeMessage(std::string_view message) {
+                auto mask = static_cast<std::uint32_t>(random());
+                if (deflate && message.size() >= deflateOptions.minCompressSize) {
+                    encodeFrame(output, WebSocketOpcode::TEXT, deflate->deflate(message), mask, true);
+                } else {
+                    encodeFrame(output, WebSocketOpcode::TEXT, message, mask);
+                }
+            }
+
+            void release() {
+                if (state == State::CLOSED) {
+                    return;
+                }
+                state = State::CLOSED;
+                if (timeout) {
+                    timeout->cancel();
+                    timeout.reset();
+                }
+                loop->unwatch(stream.getFd());
+                stream.close();
+            }
+
+            void flushLines() {
+                if (assembler.hasLines()) {
+                    listener->onLines(assembler.take());
+                }
+            }
+
+            void fail() {
+                if (state != State::CLOSED) {
+                    flushLines();
+                    release();
+                    listener->onBroken();
+                }
+            }
+
+            void onEvents(std::uint32_t events) {
+                switch (state) {
+                    case State::CONNECTING: {
+                        int error = stream.finishConnect();
+                        if (error != 0 || (events & EPOLLERR)) {
+                            log->Error("WebSocket connection to " + address.host + " failed: " +
+                                       std::system_category().message(error));
+                            fail();
+                            return;
+                        }
+                        if (address.secure) {
+                            try {
+                                stream.startTls(*tls, address.host, true);
+                            } catch (const std::exception &e) {
+                                log->Error(std::string("WebSocket TLS setup failed: ") + e.what());
+                                fail();
+                                return;
+                            }
+                            state = State::TLS;
+                            handshakeTls();
+                        } else {
+                            startUpgrade();
+                        }
+                        return;
+                    }
+                    case State::TLS:
+                        handshakeTls();
+                        return;
+                    case State::UPGRADE:
+                    case State::OPEN:
+                        // TLS may have buffered records, or be waiting for writability to read.
+                        if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) || stream.isSecure()) {
+                            readAvailable();
+                        }
+                        if (state != State::CLOSED) {
+                            flush();
+                        }
+                        return;
+                    case State::CLOSED:
+                        return;
+                }
+            }
+
+            void handshakeTls() {
+                auto result = stream.handshake();
+                if (result.status == SocketStream::Status::OK) {
+                    startUpgrade();
+                } else if (result.status == SocketStream::Status::WOULD_BLOCK) {
+                    updateInterest();
+                } else {
+                    log->Error("WebSocket TLS handshake with " + address.host + " failed");
+                    fail();
+                }
+            }
+
+            void startUpgrade() {
+                state = State::UPGRADE;
+                output.swap(head);
+                head.clear();
+                flush();
+            }
+
+            void flush() {
+                while (!output.empty()) {
+                    auto result = stream.write(output.data(), output.size());
+                    if (result.status == SocketStream::Status::OK) {
+                        output.erase(0, result.bytes);
+                    } else if (result.status == SocketStream::Status::WOULD_BLOCK) {
+                        break;
+                    } else {
+                        log->Error("WebSocket write to " + address.host + " failed");
+                        fail();
+                        return;
+                    }
+                }
+                if (output.empty() && !stream.isSecure()) {
+                    stream.clearWantWrite();
+                }
+                updateInterest();
+            }
+
+            void updateInterest() {
+                std::uint32_t wanted = (state == State::TLS || state == State::UPGRADE || state == State::OPEN)
+                                       ? static_cast<std::uint32_t>(EPOLLIN) : 0u;
+                if (!output.empty() || stream.wantsWrite()) {
+                    wanted |= EPOLLOUT;
+                }
+                if (wanted != interest) {
+                    interest = wanted;
+                    loop->modify(stream.getFd(), interest);
+                }
+            }
+
+            void readAvailable() {
+                while (state == State::UPGRADE || state == State::OPEN) {
+                    char *buffer = input.writable();
+                    auto result = stream.read(buffer, input.writableSize());
+                    if (result.status == SocketStream::Status::WOULD_BLOCK) {
+                        return;
+                    }
+                    if (result.status != SocketStream::Status::OK) {
+                        log->Debug("WebSocket to " + address.host + " closed by the peer");
+                        fail();
+                        return;
+                    }
+                    input.commit(result.bytes);
+                    try {
+                        if (state == State::UPGRADE) {
+                            onHandshakeBytes(buffer, result.bytes);
+                        } else {
+                            onFrameBytes(buffer, result.bytes);
+                        }
+                    } catch (const std::exception &e) {
+                        log->Error(std::string("WebSocket protocol error: ") + e.what());
+                        fail();
+                        return;
+                    }
+                    // The parser keeps the bytes of an incomplete frame on its own.
+                    input.consume(result.bytes);
+                    if (state == State::OPEN) {
+                        flushLines();
+                    }
+                }
+            }
+
+            void onHandshakeBytes(char *data, std::size_t size) {
+                std::size_t previous = head.size();
+                head.append(data, size);
+                std::size_t end = head.find("\r\n\r\n", previous < 3 ? 0 : previous - 3);
+                if (end == std::string::npos) {
+                    if (head.size() > MAX_RESPONSE_HEAD) {
+                        throw WebSocketProtocolError("Handshake response too long");
+                    }
+                    return;
+                }
+                std::string extensions = WebSocketHandshake::validateResponse(std::string_view(head).substr(0, end + 4), key);
+                if (auto parameters = DeflateParameters::negotiate(extensions, deflateOptions)) {
+                    deflate = std::make_unique<PerMessageDeflate>(*parameters, deflateOptions.compressionLevel);
+                    parser.setCompressionAllowed(true);
+                }
+                std::size_t consumed = end + 4 - previous;
+                head.clear();
+                state = State::OPEN;
+                if (timeout) {
+                    timeout->cancel();
+                    timeout.reset();
+                }
+                listener->onOpen();
+                for (const auto &message: deferred) {
+                    writeMessage(message);
+                }
+                deferred.clear();
+                if (state == State::OPEN && consumed < size) {
+                    onFrameBytes(data + consumed, size - consumed);
+                }
+            }
+
+            void onFrameBytes(char *data, std::size_t size) {
+                parser.parse(data, size, [this](WebSocketOpcode opcode, std::string_view payload) {
+                    if (state != State::OPEN) {
+                        return;
+                    }
+                    switch (opcode) {
+                        case WebSocketOpcode::TEXT:
+                            if (parser.isCompressed()) {
+                                deflate->inflate(payload, assembler);
+                            } else {
+                                // Copied only if the frame was reassembled by the parser.
+                                assembler.append(input.getBuffer(), payload);
+                            }
+                            break;
+                        case WebSocketOpcode::PING:
+                            encodeFrame(output, WebSocketOpcode::PONG, payload, static_cast<std::uint32_t>(random()));
+                            break;
+                        case WebSocketOpcode::CLOSE:
+                            encodeFrame(output, WebSocketOpcode::CLOSE, payload.substr(0, 2),
+                                        static_cast<std::uint32_t>(random()));
+                            stream.write(output.data(), output.size());
+                            output.clear();
+                            log->Debug("WebSocket to " + address.host + " closed by the server");
+                            flushLines();
+                            release();
+                            listener->onClosed();
+                            break;
+                        default:
+                            break;
+                    }
+                });
+            }
+        };
+
+        std::shared_ptr<EmbeddedEventLoop> loop;
+        std::shared_ptr<TlsContext> tls;
+        DeflateOptions deflateOptions;
+        std::shared_ptr<Connection> connection;
+
+    public:
+        /**
+         * @param loop The loop running the sockets; null for a loop thread shared by all the providers.
+         * @param tls The TLS context for wss:// addresses; null for one with the default TlsOptions.
+         * @param deflateOptions The permessage-deflate settings.
+         */
+        explicit EpollWebSocketProvider(std::shared_ptr<EmbeddedEventLoop> loop = nullptr,
+                                        std::shared_ptr<TlsContext> tls = nullptr, DeflateOptions deflateOptions = {})
+                : loop(loop ? std::move(loop) : util::threads::EventLoopThread::sharedLoop()), tls(std::move(tls)),
+                  deflateOptions(deflateOptions) {}
+
+        EpollWebSocketProvider(const EpollWebSocketProvider &) = delete;
+        EpollWebSocketProvider &operator=(const EpollWebSocketProvider &) = delete;
+
+        ~EpollWebSocketProvider() override {
+            disconnect();
+        }
+
+        void connect(const std::string &address, std::shared_ptr<SessionRequestListener> networkListener,
+                     const std::unordered_map<std::string, std::string> &extraHeaders, const std::string &cookies,
+                     std::shared_ptr<Proxy> proxy, long timeout) override {
+            if (proxy) {
+                log->Error("WebSocket connection through a proxy is not supported by this transport");
+                networkListener->onBroken();
+                return;
+            }
+            try {
+                WebSocketAddress target = WebSocketAddress::parse(address);
+                if (target.secure && !tls) {
+                    tls = std::make_shared<TlsContext>(TlsOptions{});
+                }
+                SocketStream stream = SocketStream::connect(target.host, target.port);
+                connection = std::make_shared<Connection>(loop, networkListener, tls, std::move(stream),
+                                                          std::move(target), extraHeaders, cookies, deflateOptions);
+            } catch (const std::exception &e) {
+                log->Error("WebSocket connection error: " + std::string(e.what()));
+                networkListener->onBroken();
+                return;
+            }
+            loop->execute([connection = connection, timeout] {
+                connection->start(timeout);
+            });
+        }
+
+        void send(const std::string &message, std::shared_ptr<RequestListener> listener) override {
+            if (!connection) {
+                log->Debug("Message discarded because the WebSocket is not connected: " + message);
+                return;
+            }
+            sendBatch({message}, std::move(listener));
+        }
+
+        void sendBatch(std::vector<std::string> messages, std::shared_ptr<RequestListener> listener) override {
+            if (!connection) {
+                log->Debug(std::to_string(messages.size()) + " messages discarded because the WebSocket is not connected");
+                return;
+            }
+            loop->execute([connection = connection, messages = std::move(messages), listener = std::move(listener)]() mutable {
+                connection->send(messages, listener);
+            });
+        }
+
+        void disconnect() override {
+            if (connection) {
+                loop->execute([connection = std::move(connection)] {
+                    connection->close();
+                });
+                connection.reset();
+            }
+        }
+
+        std::shared_ptr<util::threads::ThreadShutdownHook> getThreadShutdownHook() const override {
+            return nullptr;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLWEBSOCKETPROVIDER_HPP
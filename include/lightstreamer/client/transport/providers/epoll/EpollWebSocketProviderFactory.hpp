@@ -0,0 +1,79 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLWEBSOCKETPROVIDERFACTORY_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLWEBSOCKETPROVIDERFACTORY_HPP
+
+#include <memory>
+#include <mutex>
+#include <lightstreamer/client/transport/providers/TransportFactory.hpp>
+#include <lightstreamer/client/transport/providers/epoll/EpollWebSocketProvider.hpp>
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * Creates EpollWebSocketProvider instances sharing one loop and one TLS context.
+     *
+     * Install it with TransportFactory<WebSocketProvider>::setDefaultWebSocketFactory(). With an
+     * embedded client (see ClientExecutors::embedded()), pass the client loop so that the sockets are
+     * served by the application thread calling poll().
+     */
+    class EpollWebSocketProviderFactory : public TransportFactory<WebSocketProvider> {
+    private:
+        std::shared_ptr<util::threads::EmbeddedEventLoop> loop;
+        TlsOptions tlsOptions;
+        DeflateOptions deflateOptions;
+        std::shared_ptr<TlsContext> tls;
+        std::mutex mutex;
+
+    public:
+        /**
+         * @param loop The loop running the sockets; null for the shared transport loop thread.
+         * @param tlsOptions The TLS settings of wss:// connections.
+         * @param deflateOptions The permessage-deflate settings.
+         */
+        explicit EpollWebSocketProviderFactory(std::shared_ptr<util::threads::EmbeddedEventLoop> loop = nullptr,
+                                               TlsOptions tlsOptions = {}, DeflateOptions deflateOptions = {})
+                : loop(std::move(loop)), tlsOptions(std::move(tlsOptions)), deflateOptions(deflateOptions) {}
+
+        std::unique_ptr<WebSocketProvider> getInstance(std::shared_ptr<session::SessionThread> thread) override {
+            std::shared_ptr<TlsContext> context;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!tls) {
+                    tls = std::make_shared<TlsContext>(tlsOptions);
+                }
+                context = tls;
+            }
+            return std::make_unique<EpollWebSocketProvider>(loop, std::move(context), deflateOptions);
+        }
+
+        bool isResponseBuffered() const override {
+            return false;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_EPOLLWEBSOCKETPROVIDERFACTORY_HPP
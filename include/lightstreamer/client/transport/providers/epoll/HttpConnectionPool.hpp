@@ -0,0 +1,328 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPCONNECTIONPOOL_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPCONNECTIONPOOL_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <Logger.hpp>
+#include <lightstreamer/client/Constants.hpp>
+#include <lightstreamer/client/transport/providers/epoll/HttpStreamConnection.hpp>
+#include <lightstreamer/util/threads/EmbeddedEventLoop.hpp>
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * Keep-alive settings of an HttpConnectionPool.
+     */
+    struct HttpPoolOptions {
+        /**
+         * Idle connections kept per endpoint; 0 disables keep-alive (a connection per request).
+         */
+        std::size_t maxIdlePerEndpoint = 4;
+        /**
+         * How long an idle connection is kept, in milliseconds; 0 for no limit. It should be shorter
+         * than the keep-alive timeout of the server.
+         */
+        long idleTimeout = 10000;
+    };
+
+    /**
+     * Keep-alive HTTP/1.1 connections, pooled per endpoint (scheme, host and port) and run on an
+     * EmbeddedEventLoop.
+     *
+     * send() runs a request on an idle connection to the endpoint when there is one, and on a new
+     * connection otherwise. When the response leaves the connection reusable, the connection goes back
+     * to the pool. The pool does not bound the number of connections in use: requests are never queued
+     * behind each other here, concurrency is up to the caller (see HttpRequestManager).
+     *
+     * The server may close an idle connection while a request is being sent on it. When a reused
+     * connection fails before any byte of the response arrives, the request is sent again, once, on a
+     * new connection.
+     */
+    class HttpConnectionPool : public std::enable_shared_from_this<HttpConnectionPool> {
+    public:
+        /**
+         * A request sent through the pool. Its listener receives the outcome, whichever connection
+         * carries it.
+         */
+        class Exchange : public HttpStreamListener, public std::enable_shared_from_this<Exchange> {
+        private:
+            friend class HttpConnectionPool;
+
+            std::weak_ptr<HttpConnectionPool> pool;
+            std::shared_ptr<HttpStreamListener> listener;
+            WebSocketAddress address;
+            HttpRequest request;
+            long connectTimeout;
+            long readTimeout;
+            std::shared_ptr<HttpStreamConnection> connection;
+            std::uint64_t generation = 0;
+            bool reused = false;
+            bool retried = false;
+            bool opened = false;
+            bool cancelled = false;
+
+            // The generation is the exchange count of the connection while it carries this request.
+            void attach(std::shared_ptr<HttpStreamConnection> target, std::uint64_t targetGeneration, bool isReused) {
+                connection = std::move(target);
+                generation = targetGeneration;
+                reused = isReused;
+            }
+
+        public:
+            Exchange(std::weak_ptr<HttpConnectionPool> pool, std::shared_ptr<HttpStreamListener> listener,
+                     WebSocketAddress address, HttpRequest request, long connectTimeout, long readTimeout)
+                    : pool(std::move(pool)), listener(std::move(listener)), address(std::move(address)),
+                      request(std::move(request)), connectTimeout(connectTimeout), readTimeout(readTimeout) {}
+
+            void onOpen() override {
+                if (!opened) {
+                    opened = true;
+                    listener->onOpen();
+                }
+            }
+
+            void onLine(std::string_view line) override {
+                listener->onLine(line);
+            }
+
+            void onLines(LineBatch lines) override {
+                listener->onLines(std::move(lines));
+            }
+
+            void onClosed() override {
+                connection.reset();
+                listener->onClosed();
+            }
+
+            void onBroken() override {
+                bool retry = reused && !retried && !cancelled && connection && !connection->hasReceived();
+                connection.reset();
+                if (retry) {
+                    if (auto owner = pool.lock()) {
+                        log->Debug("Reused HTTP connection to " + address.host + " failed, retrying");
+                        retried = true;
+                        owner->connect(shared_from_this(), std::nullopt);
+                        return;
+                    }
+                }
+                listener->onBroken();
+            }
+
+            /**
+             * Aborts the request, closing its connection if it is still running, without notifying the
+             * listener. Loop thread only.
+             */
+            void close() {
+                cancelled = true;
+                if (connection && connection->getExchangeCount() == generation) {
+                    connection->close();
+                }
+                connection.reset();
+            }
+        };
+
+    private:
+        using EmbeddedEventLoop = util::threads::EmbeddedEventLoop;
+
+        inline static std::shared_ptr<Logger::ConsoleLogger> log =
+                Logger::ConsoleLogger::getInstance(ConsoleLogLevel::Level::TRACE, Constants::TRANSPORT_LOG);
+
+        std::shared_ptr<EmbeddedEventLoop> loop;
+        std::shared_ptr<TlsContext> tls;
+        HttpPoolOptions options;
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::vector<std::shared_ptr<HttpStreamConnection>>> idle;
+
+        static std::string endpointOf(const WebSocketAddress &address) {
+            return (address.secure ? "https://" : "http://") + address.host + ":" + std::to_string(address.port);
+        }
+
+        // The most recently used connection first: it is the least likely to have been closed by the server.
+        std::shared_ptr<HttpStreamConnection> takeIdle(const std::string &endpoint) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = idle.find(endpoint);
+            if (it == idle.end() || it->second.empty()) {
+                return nullptr;
+            }
+            auto connection = std::move(it->second.back());
+            it->second.pop_back();
+            return connection;
+        }
+
+        // Loop thread.
+        void recycle(const std::shared_ptr<HttpStreamConnection> &connection) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto &connections = idle[endpointOf(connection->getAddress())];
+                std::erase_if(connections, [](const auto &c) { return !c->isIdle(); });
+                if (connections.size() < options.maxIdlePerEndpoint) {
+                    connections.push_back(connection);
+                    return;
+                }
+            }
+            connection->close();
+        }
+
+        // Loop thread. Runs the exchange on a new connection, resolving the address here if no socket is given.
+        void connect(const std::shared_ptr<Exchange> &exchange, std::optional<SocketStream> stream) {
+            if (!stream) {
+                try {
+                    stream.emplace(SocketStream::connect(exchange->address.host, exchange->address.port));
+                } catch (const std::exception &e) {
+                    log->Error("HTTP connection error: " + std::string(e.what()));
+                    exchange->listener->onBroken();
+                    return;
+                }
+            }
+            auto connection = std::make_shared<HttpStreamConnection>(loop, tls, std::move(*stream),
+                                                                     exchange->address, exchange);
+            if (options.maxIdlePerEndpoint > 0) {
+                std::weak_ptr<HttpConnectionPool> weak = weak_from_this();
+                connection->setRecycler([weak](const std::shared_ptr<HttpStreamConnection> &c) {
+                    if (auto self = weak.lock()) {
+                        self->recycle(c);
+                    } else {
+                        c->close();
+                    }
+                }, options.idleTimeout);
+            }
+            exchange->attach(connection, 1, false);
+            connection->start(exchange->request, exchange->connectTimeout, exchange->readTimeout);
+        }
+
+        // Loop thread.
+        void dispatch(const std::shared_ptr<Exchange> &exchange, std::shared_ptr<HttpStreamConnection> reusable,
+                      std::optional<SocketStream> stream) {
+            if (exchange->cancelled) {
+                if (reusable && reusable->isIdle()) {
+                    recycle(reusable);
+                }
+                return;
+            }
+            while (reusable) {
+                exchange->attach(reusable, reusable->getExchangeCount() + 1, true);
+                if (reusable->reuse(exchange->request, exchange, exchange->readTimeout)) {
+                    return;
+                }
+                exchange->connection.reset();
+                reusable = takeIdle(endpointOf(exchange->address));
+            }
+            connect(exchange, std::move(stream));
+        }
+
+    public:
+        /**
+         * @param loop The loop running the connections.
+         * @param tls The TLS context for https:// endpoints; null for one with the default TlsOptions.
+         * @param options The keep-alive settings.
+         */
+        explicit HttpConnectionPool(std::shared_ptr<EmbeddedEventLoop> loop, std::shared_ptr<TlsContext> tls = nullptr,
+                                    HttpPoolOptions options = {})
+                : loop(std::move(loop)), tls(tls ? std::move(tls) : std::make_shared<TlsContext>(TlsOptions{})),
+                  options(options) {}
+
+        HttpConnectionPool(const HttpConnectionPool &) = delete;
+        HttpConnectionPool &operator=(const HttpConnectionPool &) = delete;
+
+        ~HttpConnectionPool() {
+            std::vector<std::shared_ptr<HttpStreamConnection>> connections;
+            for (auto &[endpoint, list]: idle) {
+                std::move(list.begin(), list.end(), std::back_inserter(connections));
+            }
+            if (!connections.empty()) {
+                loop->execute([connections = std::move(connections)] {
+                    for (const auto &connection: connections) {
+                        connection->close();
+                    }
+                });
+            }
+        }
+
+        /**
+         * Sends a POST request. When no idle connection to the endpoint is available, the new connection
+         * is started (and its address resolved) on the calling thread.
+         *
+         * @param url The request URL; its path is used when the request has none.
+         * @param request The request.
+         * @param listener The receiver of the response, notified on the loop.
+         * @param connectTimeout Connection (and TLS handshake) timeout in milliseconds; 0 for none.
+         * @param readTimeout Maximum silence of the server once the request is sent; 0 for none.
+         * @return The exchange, whose close() aborts the request.
+         * @throws std::exception if the address is invalid or cannot be resolved.
+         */
+        std::shared_ptr<Exchange> send(const std::string &url, HttpRequest request,
+                                       std::shared_ptr<HttpStreamListener> listener,
+                                       long connectTimeout, long readTimeout) {
+            WebSocketAddress address = WebSocketAddress::parse(url);
+            if (request.path.empty()) {
+                request.path = address.path;
+            }
+            std::string endpoint = endpointOf(address);
+            auto reusable = takeIdle(endpoint);
+            std::optional<SocketStream> stream;
+            if (!reusable) {
+                stream.emplace(SocketStream::connect(address.host, address.port));
+            }
+            auto exchange = std::make_shared<Exchange>(weak_from_this(), std::move(listener), std::move(address),
+                                                       std::move(request), connectTimeout, readTimeout);
+            loop->execute([self = shared_from_this(), exchange, reusable = std::move(reusable),
+                                  stream = std::move(stream)]() mutable {
+                self->dispatch(exchange, std::move(reusable), std::move(stream));
+            });
+            return exchange;
+        }
+
+        /**
+         * @return The number of pooled connections, over all the endpoints. Some of them may have been
+         * closed by the server since they were pooled.
+         */
+        std::size_t getIdleCount() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::size_t count = 0;
+            for (const auto &[endpoint, connections]: idle) {
+                count += connections.size();
+            }
+            return count;
+        }
+
+        const std::shared_ptr<EmbeddedEventLoop> &getLoop() const {
+            return loop;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPCONNECTIONPOOL_HPP
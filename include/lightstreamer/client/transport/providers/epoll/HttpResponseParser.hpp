@@ -0,0 +1,345 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPRESPONSEPARSER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPRESPONSEPARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <lightstreamer/client/transport/providers/epoll/WebSocketHandshake.hpp>
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * A malformed HTTP response; the connection must be dropped.
+     */
+    class HttpProtocolError : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /**
+     * Incremental HTTP/1.1 response parser delivering the body as text lines, working in place on the
+     * receive buffer.
+     *
+     * parse() is given the unread bytes of the buffer (the bytes it left unconsumed last time, followed
+     * by the new ones) and returns how many can be released. The status line, the headers and every
+     * complete body line are delivered as views on the buffer. Chunked bodies are decoded in place: a
+     * line lying entirely within a chunk is delivered as is, while for a line crossing a chunk boundary
+     * only its head (the bytes before the boundary) is moved forward over the chunk header, joining it
+     * to its tail; nothing else is copied.
+     *
+     * The handler must provide:
+     * - bool onHead(int status): called at the end of the headers; returning false stops the parsing;
+     * - void onLine(std::string_view line): called for every body line, without the CRLF;
+     * - void onEnd(): called when the body is complete (Content-Length reached, or last chunk).
+     */
+    class HttpResponseParser {
+    public:
+        static constexpr std::uint64_t UNTIL_CLOSE = std::numeric_limits<std::uint64_t>::max();
+
+    private:
+        enum class State {
+            STATUS,
+            HEADERS,
+            BODY,
+            CHUNK_HEADER,
+            TRAILERS,
+            DONE
+        };
+
+        State state = State::STATUS;
+        int status = 0;
+        bool chunked = false;
+        bool keepAlive = true;
+        bool firstChunk = true;
+        std::uint64_t contentLength = UNTIL_CLOSE;
+        // Body bytes left in the current chunk, or in the whole body when not chunked.
+        std::uint64_t remaining = 0;
+        // Bytes after the start of the unread data that were already decoded (a pending line head).
+        std::size_t pending = 0;
+        std::size_t maxLine;
+
+        void onStatus(std::string_view line) {
+            if (line.size() < 12 || line.substr(0, 5) != "HTTP/" || line[8] != ' ') {
+                throw HttpProtocolError("Invalid status line: " + std::string(line));
+            }
+            status = 0;
+            for (char c: line.substr(9, 3)) {
+                if (c < '0' || c > '9') {
+                    throw HttpProtocolError("Invalid status line: " + std::string(line));
+                }
+                status = status * 10 + (c - '0');
+            }
+            keepAlive = line.substr(5, 3) == "1.1";
+        }
+
+        void onHeader(std::string_view line) {
+            std::size_t colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                throw HttpProtocolError("Invalid header: " + std::string(line));
+            }
+            std::string_view name = line.substr(0, colon);
+            std::string_view value = WebSocketHandshake::trim(line.substr(colon + 1));
+            if (WebSocketHandshake::equalsIgnoreCase(name, "Content-Length")) {
+                contentLength = parseNumber(value, 10);
+            } else if (WebSocketHandshake::equalsIgnoreCase(name, "Transfer-Encoding")) {
+                chunked = WebSocketHandshake::equalsIgnoreCase(value, "chunked");
+            } else if (WebSocketHandshake::equalsIgnoreCase(name, "Connection")) {
+                if (WebSocketHandshake::equalsIgnoreCase(value, "close")) {
+                    keepAlive = false;
+                } else if (WebSocketHandshake::equalsIgnoreCase(value, "keep-alive")) {
+                    keepAlive = true;
+                }
+            }
+        }
+
+        static std::uint64_t parseNumber(std::string_view value, int base) {
+            if (value.empty() || value.size() > 15) {
+                throw HttpProtocolError("Invalid number: " + std::string(value));
+            }
+            std::uint64_t result = 0;
+            for (char c: value) {
+                int digit;
+                if (c >= '0' && c <= '9') {
+                    digit = c - '0';
+                } else if (base == 16 && c >= 'a' && c <= 'f') {
+                    digit = c - 'a' + 10;
+                } else if (base == 16 && c >= 'A' && c <= 'F') {
+                    digit = c - 'A' + 10;
+                } else {
+                    throw HttpProtocolError("Invalid number: " + std::string(value));
+                }
+                result = result * base + digit;
+            }
+            return result;
+        }
+
+        template<typename H>
+        void finish(H &handler) {
+            state = State::DONE;
+            handler.onEnd();
+        }
+
+    public:
+        /**
+         * @param maxLine The longest header or body line accepted.
+         */
+        explicit HttpResponseParser(std::size_t maxLine = 1024 * 1024) : maxLine(maxLine) {}
+
+        /**
+         * Consumes the unread bytes of the receive buffer.
+         *
+         * @param data The unread bytes; they may be rearranged in place.
+         * @param size Their number.
+         * @param handler The receiver of the response parts (see the class description).
+         * @return The number of leading bytes that are no longer needed.
+         * @throws HttpProtocolError if the response is malformed or a line exceeds the maximum length.
+         */
+        template<typename H>
+        std::size_t parse(char *data, std::size_t size, H &handler) {
+            std::size_t lineStart = 0;
+            std::size_t pos = pending;
+            bool stalled = false;
+            while (!stalled && pos < size && state != State::DONE) {
+                switch (state) {
+                    case State::STATUS:
+                    case State::HEADERS:
+                    case State::TRAILERS: {
+                        auto *end = static_cast<char *>(std::memchr(data + pos, '\n', size - pos));
+                        if (!end) {
+                            pos = size;
+                            break;
+                        }
+                        std::size_t stop = static_cast<std::size_t>(end - data);
+                        std::string_view line(data + lineStart, stop - lineStart);
+                        if (!line.empty() && line.back() == '\r') {
+                            line.remove_suffix(1);
+                        }
+                        lineStart = pos = stop + 1;
+                        if (state == State::STATUS) {
+                            onStatus(line);
+                            state = State::HEADERS;
+                        } else if (state == State::TRAILERS) {
+                            if (line.empty()) {
+                                finish(handler);
+                            }
+                        } else if (!line.empty()) {
+                            onHeader(line);
+                        } else if (status >= 100 && status < 200 && status != 101) {
+                            // Interim response: the real one follows.
+                            state = State::STATUS;
+                            chunked = false;
+                            contentLength = UNTIL_CLOSE;
+                        } else {
+                            if (!handler.onHead(status)) {
+                                state = State::DONE;
+                                break;
+                            }
+                            if (chunked) {
+                                state = State::CHUNK_HEADER;
+                            } else if (contentLength == 0) {
+                                finish(handler);
+                            } else {
+                                remaining = contentLength;
+                                state = State::BODY;
+                            }
+                        }
+                        break;
+                    }
+                    case State::BODY: {
+                        std::size_t end = remaining < size - pos ? pos + static_cast<std::size_t>(remaining) : size;
+                        std::size_t scan = pos;
+                        while (scan < end) {
+                            auto *found = static_cast<char *>(std::memchr(data + scan, '\n', end - scan));
+                            if (!found) {
+                                break;
+                            }
+                            std::size_t stop = static_cast<std::size_t>(found - data);
+                            std::size_t lineEnd = stop > lineStart && data[stop - 1] == '\r' ? stop - 1 : stop;
+                            handler.onLine(std::string_view(data + lineStart, lineEnd - lineStart));
+                            lineStart = scan = stop + 1;
+                        }
+                        if (remaining != UNTIL_CLOSE) {
+                            remaining -= end - pos;
+                        }
+                        pos = end;
+                        if (remaining == 0) {
+                            if (chunked) {
+                                state = State::CHUNK_HEADER;
+                            } else {
+                                finish(handler);
+                            }
+                        }
+                        break;
+                    }
+                    case State::CHUNK_HEADER: {
+                        // [CRLF after the previous chunk] size [; extensions] CRLF
+                        std::size_t start = pos;
+                        if (!firstChunk) {
+                            if (size - start < 2) {
+                                stalled = true;
+                                break;
+                            }
+                            if (data[start] != '\r' || data[start + 1] != '\n') {
+                                throw HttpProtocolError("Missing CRLF after a chunk");
+                            }
+                            start += 2;
+                        }
+                        auto *end = static_cast<char *>(std::memchr(data + start, '\n', size - start));
+                        if (!end) {
+                            if (size - start > 64) {
+                                throw HttpProtocolError("Invalid chunk header");
+                            }
+                            stalled = true;
+                            break;
+                        }
+                        std::size_t stop = static_cast<std::size_t>(end - data);
+                        std::string_view sizeField(data + start, stop - start);
+                        if (!sizeField.empty() && sizeField.back() == '\r') {
+                            sizeField.remove_suffix(1);
+                        }
+                        sizeField = WebSocketHandshake::trim(sizeField.substr(0, sizeField.find(';')));
+                        std::uint64_t chunkSize = parseNumber(sizeField, 16);
+                        std::size_t headerLength = stop + 1 - pos;
+                        firstChunk = false;
+                        if (chunkSize == 0) {
+                            lineStart = pos = stop + 1;
+                            state = State::TRAILERS;
+                            break;
+                        }
+                        if (lineStart < pos) {
+                            // Joins the head of the pending line to the chunk payload.
+                            std::memmove(data + lineStart + headerLength, data + lineStart, pos - lineStart);
+                        }
+                        lineStart += headerLength;
+                        pos = stop + 1;
+                        remaining = chunkSize;
+                        state = State::BODY;
+                        break;
+                    }
+                    case State::DONE:
+                        break;
+                }
+            }
+            pending = pos - lineStart;
+            if (pending > maxLine) {
+                throw HttpProtocolError("Line longer than " + std::to_string(maxLine) + " bytes");
+            }
+            return lineStart;
+        }
+
+        /**
+         * Prepares the parser for the next response on the same connection.
+         */
+        void reset() {
+            state = State::STATUS;
+            status = 0;
+            chunked = false;
+            keepAlive = true;
+            firstChunk = true;
+            contentLength = UNTIL_CLOSE;
+            remaining = 0;
+            pending = 0;
+        }
+
+        int getStatus() const {
+            return status;
+        }
+
+        bool isDone() const {
+            return state == State::DONE;
+        }
+
+        bool isChunked() const {
+            return chunked;
+        }
+
+        /**
+         * @return Whether the connection can carry another request once the response is complete.
+         */
+        bool isKeepAlive() const {
+            return keepAlive && (chunked || contentLength != UNTIL_CLOSE);
+        }
+
+        /**
+         * @return Whether the body ends when the server closes the connection.
+         */
+        bool isDelimitedByClose() const {
+            return !chunked && contentLength == UNTIL_CLOSE;
+        }
+
+        std::uint64_t getContentLength() const {
+            return contentLength;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPRESPONSEPARSER_HPP
@@ -0,0 +1,575 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPSTREAMCONNECTION_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPSTREAMCONNECTION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <Logger.hpp>
+#include <lightstreamer/client/Constants.hpp>
+#include <lightstreamer/client/transport/LineAssembler.hpp>
+#include <lightstreamer/client/transport/providers/epoll/EpollWebSocketProvider.hpp>
+#include <lightstreamer/client/transport/providers/epoll/HttpResponseParser.hpp>
+#include <lightstreamer/client/transport/providers/epoll/SocketStream.hpp>
+#include <lightstreamer/util/threads/EmbeddedEventLoop.hpp>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * Receives the outcome of an HTTP exchange, on the loop thread.
+     */
+    class HttpStreamListener {
+    public:
+        virtual ~HttpStreamListener() = default;
+
+        /**
+         * The request has been written.
+         */
+        virtual void onOpen() = 0;
+
+        /**
+         * A line of the response body, without the line terminator. The view is only valid during the call.
+         */
+        virtual void onLine(std::string_view line) = 0;
+
+        /**
+         * The lines received by a read, as views on the receive buffer kept alive by the batch. By
+         * default, each line is passed to onLine().
+         */
+        virtual void onLines(LineBatch lines) {
+            for (std::string_view line: lines) {
+                onLine(line);
+            }
+        }
+
+        /**
+         * The response is complete.
+         */
+        virtual void onClosed() = 0;
+
+        /**
+         * The exchange failed (connection error, timeout, status other than 200 or malformed response).
+         */
+        virtual void onBroken() = 0;
+    };
+
+    /**
+     * An HTTP request to be sent on an HttpStreamConnection.
+     */
+    struct HttpRequest {
+        /**
+         * The path and query; empty for the path of the connection address.
+         */
+        std::string path;
+        std::string body;
+        std::unordered_map<std::string, std::string> headers;
+
+        /**
+         * @return The request bytes, for the given server.
+         */
+        std::string serialize(const WebSocketAddress &address) const {
+            std::string out;
+            out.reserve(256 + body.size());
+            out.append("POST ").append(path.empty() ? address.path : path).append(" HTTP/1.1\r\nHost: ").append(address.host);
+            if (address.port != (address.secure ? 443 : 80)) {
+                out.append(":").append(std::to_string(address.port));
+            }
+            out.append("\r\nContent-Type: text/plain; charset=utf-8\r\nContent-Length: ")
+                    .append(std::to_string(body.size())).append("\r\n");
+            for (const auto &[name, value]: headers) {
+                out.append(name).append(": ").append(value).append("\r\n");
+            }
+            out.append("\r\n").append(body);
+            return out;
+        }
+    };
+
+    /**
+     * An HTTP/1.1 client connection driven by an EmbeddedEventLoop, streaming the response body line
+     * by line.
+     *
+     * The response is read into pooled buffers (see ReceiveBufferChain) and parsed in place by
+     * HttpResponseParser. The lines of each read reach the listener as a LineBatch of views on those
+     * buffers, which can be handed to another thread as is: only the head of a line crossing into the
+     * next buffer is ever copied.
+     * The response ends when its Content-Length is reached, at the last chunk, or when the server closes
+     * a response without either; this is how a TLCP stream ends once the content length requested with
+     * LS_content_length has been sent, before the session rebinds.
+     *
+     * A connection given a recycler (see setRecycler()) survives a response that leaves it usable
+     * (HTTP/1.1 keep-alive, body delimited by length or chunks): it becomes idle, is handed to the
+     * recycler, and can carry another request through reuse(). An idle connection is dropped when the
+     * server closes it or after the idle timeout.
+     *
+     * Apart from construction, the object is only used on the loop.
+     */
+    class HttpStreamConnection : public std::enable_shared_from_this<HttpStreamConnection> {
+    public:
+        static constexpr std::size_t DEFAULT_BUFFER_SIZE = 256 * 1024;
+
+    private:
+        using EmbeddedEventLoop = util::threads::EmbeddedEventLoop;
+
+        enum class State {
+            CONNECTING,
+            TLS,
+            EXCHANGE,
+            IDLE,
+            CLOSED
+        };
+
+        inline static std::shared_ptr<Logger::ConsoleLogger> log =
+                Logger::ConsoleLogger::getInstance(ConsoleLogLevel::Level::TRACE, Constants::TRANSPORT_LOG);
+
+        std::shared_ptr<EmbeddedEventLoop> loop;
+        std::shared_ptr<TlsContext> tls;
+        SocketStream stream;
+        WebSocketAddress address;
+        std::shared_ptr<HttpStreamListener> listener;
+        State state = State::CONNECTING;
+        std::uint32_t interest = 0;
+        std::string output;
+        bool opened = false;
+        ReceiveBufferChain buffer;
+        LineBatch lines;
+        HttpResponseParser parser;
+        long readTimeout = 0;
+        std::chrono::steady_clock::time_point lastRead;
+        std::shared_ptr<util::threads::Cancellable> timer;
+        std::function<void(const std::shared_ptr<HttpStreamConnection> &)> recycler;
+        long idleTimeout = 0;
+        std::uint64_t exchanges = 0;
+        bool ended = false;
+        bool received = false;
+
+        struct Handler {
+            HttpStreamConnection &connection;
+
+            bool onHead(int status) {
+                if (status != 200) {
+                    log->Error("HTTP request to " + connection.address.host + " failed with status " +
+                               std::to_string(status));
+                    connection.fail();
+                    return false;
+                }
+                return true;
+            }
+
+            void onLine(std::string_view line) {
+                if (connection.state != State::CLOSED) {
+                    connection.lines.add(line, connection.buffer.getBuffer());
+                }
+            }
+
+            // Completion is deferred to complete(), after the parser has returned.
+            void onEnd() {
+                connection.ended = true;
+            }
+        };
+
+        void cancelTimer() {
+            if (timer) {
+                timer->cancel();
+                timer.reset();
+            }
+        }
+
+        void release() {
+            if (state == State::CLOSED) {
+                return;
+            }
+            state = State::CLOSED;
+            cancelTimer();
+            loop->unwatch(stream.getFd());
+            stream.close();
+        }
+
+        void flushLines() {
+            if (!lines.empty()) {
+                listener->onLines(std::exchange(lines, LineBatch()));
+            }
+        }
+
+        void fail() {
+            if (state != State::CLOSED) {
+                flushLines();
+                bool notify = state != State::IDLE;
+                release();
+                if (notify) {
+                    listener->onBroken();
+                }
+            }
+        }
+
+        // Ends the exchange after the last byte of the response, keeping the connection if it can be reused.
+        void complete() {
+            ended = false;
+            if (state == State::CLOSED) {
+                return;
+            }
+            if (!recycler || !parser.isKeepAlive() || buffer.size() != 0) {
+                release();
+                listener->onClosed();
+                return;
+            }
+            state = State::IDLE;
+            cancelTimer();
+            parser.reset();
+            updateInterest();
+            if (idleTimeout > 0) {
+                armTimer(idleTimeout);
+            }
+            // Recycled first, so that a request issued by the listener can already find the connection.
+            std::shared_ptr<HttpStreamListener> done = std::move(listener);
+            recycler(shared_from_this());
+            done->onClosed();
+        }
+
+        // Fails the exchange if nothing was received for readTimeout, re-arming itself otherwise.
+        void armTimer(long delayMillis) {
+            std::weak_ptr<HttpStreamConnection> weak = weak_from_this();
+            timer = loop->schedule([weak] {
+                auto self = weak.lock();
+                if (!self || self->state == State::CLOSED) {
+                    return;
+                }
+                if (self->state == State::IDLE) {
+                    log->Debug("Idle HTTP connection to " + self->address.host + " expired");
+                    self->release();
+                    return;
+                }
+                if (self->state != State::EXCHANGE) {
+                    log->Error("HTTP connection to " + self->address.host + " timed out");
+                    self->fail();
+                    return;
+                }
+                auto idle = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - self->lastRead).count();
+                if (self->readTimeout <= 0) {
+                    self->timer.reset();
+                } else if (idle >= self->readTimeout) {
+                    log->Error("HTTP response from " + self->address.host + " timed out");
+                    self->fail();
+                } else {
+                    self->armTimer(self->readTimeout - static_cast<long>(idle));
+                }
+            }, delayMillis);
+        }
+
+        void onEvents(std::uint32_t events) {
+            switch (state) {
+                case State::CONNECTING: {
+                    int error = stream.finishConnect();
+                    if (error != 0 || (events & EPOLLERR)) {
+                        log->Error("HTTP connection to " + address.host + " failed: " +
+                                   std::system_category().message(error));
+                        fail();
+                        return;
+                    }
+                    if (address.secure) {
+                        try {
+                            stream.startTls(*tls, address.host, true);
+                        } catch (const std::exception &e) {
+                            log->Error(std::string("HTTP TLS setup failed: ") + e.what());
+                            fail();
+                            return;
+                        }
+                        state = State::TLS;
+                        handshakeTls();
+                    } else {
+                        startExchange();
+                    }
+                    return;
+                }
+                case State::TLS:
+                    handshakeTls();
+                    return;
+                case State::EXCHANGE:
+                    flush();
+                    if (state == State::EXCHANGE && ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) || stream.isSecure())) {
+                        readAvailable();
+                    }
+                    return;
+                case State::IDLE: {
+                    // Nothing is expected between exchanges: either the server is closing or it misbehaves.
+                    char probe;
+                    if (stream.read(&probe, 1).status != SocketStream::Status::WOULD_BLOCK) {
+                        log->Debug("Idle HTTP connection to " + address.host + " closed by the peer");
+                        release();
+                    }
+                    return;
+                }
+                case State::CLOSED:
+                    return;
+            }
+        }
+
+        void handshakeTls() {
+            auto result = stream.handshake();
+            if (result.status == SocketStream::Status::OK) {
+                startExchange();
+            } else if (result.status == SocketStream::Status::WOULD_BLOCK) {
+                updateInterest();
+            } else {
+                log->Error("HTTP TLS handshake with " + address.host + " failed");
+                fail();
+            }
+        }
+
+        void startExchange() {
+            state = State::EXCHANGE;
+            lastRead = std::chrono::steady_clock::now();
+            cancelTimer();
+            if (readTimeout > 0) {
+                armTimer(readTimeout);
+            }
+            flush();
+        }
+
+        void flush() {
+            while (!output.empty()) {
+                auto result = stream.write(output.data(), output.size());
+                if (result.status == SocketStream::Status::OK) {
+                    output.erase(0, result.bytes);
+                } else if (result.status == SocketStream::Status::WOULD_BLOCK) {
+                    break;
+                } else {
+                    log->Error("HTTP write to " + address.host + " failed");
+                    fail();
+                    return;
+                }
+            }
+            if (output.empty()) {
+                if (!stream.isSecure()) {
+                    stream.clearWantWrite();
+                }
+                if (!opened) {
+                    opened = true;
+                    listener->onOpen();
+                    if (state == State::CLOSED) {
+                        return;
+                    }
+                }
+            }
+            updateInterest();
+        }
+
+        void updateInterest() {
+            std::uint32_t wanted = state == State::CONNECTING ? 0u : static_cast<std::uint32_t>(EPOLLIN);
+            if (!output.empty() || stream.wantsWrite()) {
+                wanted |= EPOLLOUT;
+            }
+            if (wanted != interest) {
+                interest = wanted;
+                loop->modify(stream.getFd(), interest);
+            }
+        }
+
+        void readAvailable() {
+            Handler handler{*this};
+            while (state == State::EXCHANGE) {
+                char *target = buffer.writable();
+                std::size_t space = buffer.writableSize();
+                if (space == 0) {
+                    log->Error("HTTP response line from " + address.host + " exceeds the buffer");
+                    fail();
+                    return;
+                }
+                auto result = stream.read(target, space);
+                if (result.status == SocketStream::Status::WOULD_BLOCK) {
+                    return;
+                }
+                if (result.status != SocketStream::Status::OK) {
+                    if (result.status == SocketStream::Status::CLOSED && parser.isDelimitedByClose() &&
+                        parser.getStatus() == 200) {
+                        release();
+                        listener->onClosed();
+                    } else {
+                        log->Debug("HTTP connection to " + address.host + " closed by the peer");
+                        fail();
+                    }
+                    return;
+                }
+                lastRead = std::chrono::steady_clock::now();
+                received = true;
+                buffer.commit(result.bytes);
+                try {
+                    buffer.consume(parser.parse(buffer.data(), buffer.size(), handler));
+                } catch (const std::exception &e) {
+                    log->Error(std::string("HTTP protocol error: ") + e.what());
+                    fail();
+                    return;
+                }
+                flushLines();
+                if (state == State::CLOSED) {
+                    return;
+                }
+                if (ended) {
+                    complete();
+                    return;
+                }
+            }
+        }
+
+    public:
+        /**
+         * @param loop The loop running the socket.
+         * @param tls The TLS context, required for https:// addresses.
+         * @param stream The socket, whose connection has been started.
+         * @param address The server address.
+         * @param listener The receiver of the response.
+         * @param bufferSize The size of the receive buffers, which bounds the length of a line.
+         */
+        HttpStreamConnection(std::shared_ptr<EmbeddedEventLoop> loop, std::shared_ptr<TlsContext> tls,
+                             SocketStream stream, WebSocketAddress address, std::shared_ptr<HttpStreamListener> listener,
+                             std::size_t bufferSize = DEFAULT_BUFFER_SIZE)
+                : loop(std::move(loop)), tls(std::move(tls)), stream(std::move(stream)), address(std::move(address)),
+                  listener(std::move(listener)), buffer(std::make_shared<ReceiveBufferPool>(bufferSize, 4)),
+                  parser(bufferSize) {}
+
+        /**
+         * Starts watching the socket and sends the request once connected. Loop thread only.
+         *
+         * @param request The request.
+         * @param connectTimeout Connection (and TLS handshake) timeout in milliseconds; 0 for none.
+         * @param readTimeoutMillis Maximum silence of the server once the request is sent; 0 for none.
+         */
+        void start(const HttpRequest &request, long connectTimeout, long readTimeoutMillis) {
+            readTimeout = readTimeoutMillis;
+            exchanges = 1;
+            output = request.serialize(address);
+            interest = EPOLLOUT;
+            // The watch keeps the connection alive until release() removes it, whoever holds the handle.
+            loop->watch(stream.getFd(), interest, [self = shared_from_this()](std::uint32_t events) {
+                self->onEvents(events);
+            });
+            if (connectTimeout > 0) {
+                armTimer(connectTimeout);
+            }
+        }
+
+        /**
+         * Sends another request on an idle connection. Loop thread only.
+         *
+         * @return false if the connection is no longer idle (closed by the server, or expired); the
+         * listener is not notified in that case.
+         */
+        bool reuse(const HttpRequest &request, std::shared_ptr<HttpStreamListener> newListener, long readTimeoutMillis) {
+            if (state != State::IDLE) {
+                return false;
+            }
+            listener = std::move(newListener);
+            readTimeout = readTimeoutMillis;
+            opened = false;
+            received = false;
+            exchanges++;
+            output = request.serialize(address);
+            startExchange();
+            return true;
+        }
+
+        /**
+         * Enables keep-alive: once a response leaves the connection reusable, the connection becomes
+         * idle and is passed to the recycler. Loop thread only.
+         *
+         * @param recyclerCallback Receives the idle connection, before the listener is notified.
+         * @param idleTimeoutMillis How long an idle connection is kept; 0 for no limit.
+         */
+        void setRecycler(std::function<void(const std::shared_ptr<HttpStreamConnection> &)> recyclerCallback,
+                         long idleTimeoutMillis) {
+            recycler = std::move(recyclerCallback);
+            idleTimeout = idleTimeoutMillis;
+        }
+
+        /**
+         * Closes the connection without notifying the listener. Loop thread only.
+         */
+        void close() {
+            release();
+        }
+
+        bool isIdle() const {
+            return state == State::IDLE;
+        }
+
+        /**
+         * @return The number of requests sent so far, the current one included; it identifies the
+         * current exchange.
+         */
+        std::uint64_t getExchangeCount() const {
+            return exchanges;
+        }
+
+        /**
+         * @return Whether any byte of the response to the current request has arrived.
+         */
+        bool hasReceived() const {
+            return received;
+        }
+
+        const WebSocketAddress &getAddress() const {
+            return address;
+        }
+
+        /**
+         * Connects to the server of the address (resolving it on the calling thread) and starts the
+         * exchange on the loop.
+         *
+         * @throws std::exception if the address is invalid or cannot be resolved.
+         */
+        static std::shared_ptr<HttpStreamConnection> open(const std::shared_ptr<EmbeddedEventLoop> &loop,
+                                                          std::shared_ptr<TlsContext> tls, const std::string &url,
+                                                          HttpRequest request,
+                                                          std::shared_ptr<HttpStreamListener> listener,
+                                                          long connectTimeout, long readTimeout) {
+            WebSocketAddress address = WebSocketAddress::parse(url);
+            if (address.secure && !tls) {
+                tls = std::make_shared<TlsContext>(TlsOptions{});
+            }
+            SocketStream stream = SocketStream::connect(address.host, address.port);
+            auto connection = std::make_shared<HttpStreamConnection>(loop, std::move(tls), std::move(stream),
+                                                                     std::move(address), std::move(listener));
+            loop->execute([connection, request = std::move(request), connectTimeout, readTimeout] {
+                connection->start(request, connectTimeout, readTimeout);
+            });
+            return connection;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_HTTPSTREAMCONNECTION_HPP
@@ -0,0 +1,350 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_PERMESSAGEDEFLATE_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_PERMESSAGEDEFLATE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <lightstreamer/client/transport/LineAssembler.hpp>
+#include <lightstreamer/client/transport/providers/epoll/WebSocketFraming.hpp>
+#include <lightstreamer/client/transport/providers/epoll/WebSocketHandshake.hpp>
+
+#if defined(LIGHTSTREAMER_USE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * Client settings of the permessage-deflate extension (RFC 7692).
+     */
+    struct DeflateOptions {
+        /**
+         * Whether the extension is offered; it only is if the library was built with zlib.
+         */
+        bool enabled = true;
+        /**
+         * Asks the server to compress each message on its own. Saves server memory, costs ratio.
+         */
+        bool serverNoContextTakeover = false;
+        /**
+         * Compresses each outgoing message on its own.
+         */
+        bool clientNoContextTakeover = false;
+        /**
+         * The zlib level of outgoing messages, 0-9, or -1 for the zlib default.
+         */
+        int compressionLevel = -1;
+        /**
+         * Outgoing messages shorter than this are sent uncompressed.
+         */
+        std::size_t minCompressSize = 64;
+    };
+
+    /**
+     * The permessage-deflate parameters agreed with the server.
+     */
+    struct DeflateParameters {
+        bool serverNoContextTakeover = false;
+        bool clientNoContextTakeover = false;
+        int serverMaxWindowBits = 15;
+        int clientMaxWindowBits = 15;
+
+        /**
+         * @return The Sec-WebSocket-Extensions offer for the options; empty if nothing is offered.
+         */
+        static std::string offer(const DeflateOptions &options) {
+#if defined(LIGHTSTREAMER_USE_ZLIB)
+            if (!options.enabled) {
+                return "";
+            }
+            std::string result = "permessage-deflate; client_max_window_bits";
+            if (options.serverNoContextTakeover) {
+                result += "; server_no_context_takeover";
+            }
+            if (options.clientNoContextTakeover) {
+                result += "; client_no_context_takeover";
+            }
+            return result;
+#else
+            (void) options;
+            return "";
+#endif
+        }
+
+        /**
+         * Reads the extensions accepted by the server.
+         *
+         * @param extensions The Sec-WebSocket-Extensions of the upgrade response.
+         * @param options The options the offer was built from.
+         * @return The agreed parameters, or nothing if the server declined the extension.
+         * @throws WebSocketProtocolError if the server accepted something that was not offered.
+         */
+        static std::optional<DeflateParameters> negotiate(std::string_view extensions, const DeflateOptions &options) {
+            extensions = WebSocketHandshake::trim(extensions);
+            if (extensions.empty()) {
+                return std::nullopt;
+            }
+            if (offer(options).empty() || extensions.find(',') != std::string_view::npos) {
+                throw WebSocketProtocolError("Unexpected extensions: " + std::string(extensions));
+            }
+            DeflateParameters result;
+            result.clientNoContextTakeover = options.clientNoContextTakeover;
+            bool first = true;
+            while (!extensions.empty()) {
+                std::size_t end = extensions.find(';');
+                std::string_view item = WebSocketHandshake::trim(extensions.substr(0, end));
+                extensions = end == std::string_view::npos ? std::string_view() : extensions.substr(end + 1);
+                if (first) {
+                    if (!WebSocketHandshake::equalsIgnoreCase(item, "permessage-deflate")) {
+                        throw WebSocketProtocolError("Unexpected extension: " + std::string(item));
+                    }
+                    first = false;
+                    continue;
+                }
+                std::size_t equals = item.find('=');
+                std::string_view name = WebSocketHandshake::trim(item.substr(0, equals));
+                std::string_view value = equals == std::string_view::npos
+                                         ? std::string_view() : WebSocketHandshake::trim(item.substr(equals + 1));
+                if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                    value = value.substr(1, value.size() - 2);
+                }
+                if (name == "server_no_context_takeover") {
+                    result.serverNoContextTakeover = true;
+                } else if (name == "client_no_context_takeover") {
+                    result.clientNoContextTakeover = true;
+                } else if (name == "server_max_window_bits" || name == "client_max_window_bits") {
+                    int bits = windowBits(value);
+                    // zlib cannot produce raw deflate with an 8-bit window.
+                    if (name == "client_max_window_bits" && bits < 9) {
+                        throw WebSocketProtocolError("Unsupported client_max_window_bits " + std::string(value));
+                    }
+                    (name == "server_max_window_bits" ? result.serverMaxWindowBits : result.clientMaxWindowBits) = bits;
+                } else {
+                    throw WebSocketProtocolError("Unknown permessage-deflate parameter: " + std::string(name));
+                }
+            }
+            return result;
+        }
+
+    private:
+        static int windowBits(std::string_view value) {
+            if (value.empty() || value.size() > 2 || !std::all_of(value.begin(), value.end(), [](char c) {
+                return c >= '0' && c <= '9';
+            })) {
+                throw WebSocketProtocolError("Invalid window bits: " + std::string(value));
+            }
+            int bits = std::stoi(std::string(value));
+            if (bits < 8 || bits > 15) {
+                throw WebSocketProtocolError("Invalid window bits: " + std::string(value));
+            }
+            return bits;
+        }
+    };
+
+#if defined(LIGHTSTREAMER_USE_ZLIB)
+    /**
+     * The compression contexts of a connection using permessage-deflate.
+     *
+     * The zlib streams live as long as the connection and are reset only when the agreed parameters
+     * forbid context takeover, so repeated field names, item ids and prices compress against the
+     * previous messages. Inflated bytes are written straight into the pooled buffers of a LineAssembler
+     * (or appended to a string), and deflated bytes go to a buffer owned by the object and reused by
+     * every message.
+     */
+    class PerMessageDeflate {
+    private:
+        static constexpr unsigned char TAIL[4] = {0x00, 0x00, 0xFF, 0xFF};
+        static constexpr std::size_t MIN_CHUNK = 4096;
+
+        DeflateParameters parameters;
+        std::size_t maxMessageSize;
+        z_stream inflater{};
+        z_stream deflater{};
+        std::string deflated;
+
+        /**
+         * Inflates the pending input. room() gives the space to inflate into, commit(n) keeps the first
+         * n bytes written there; produced counts the bytes of the message.
+         */
+        template<typename Room, typename Commit>
+        void inflateInto(Room &&room, Commit &&commit, std::size_t &produced) {
+            while (true) {
+                std::span<char> out = room();
+                inflater.next_out = reinterpret_cast<Bytef *>(out.data());
+                inflater.avail_out = static_cast<uInt>(out.size());
+                int result = ::inflate(&inflater, Z_SYNC_FLUSH);
+                std::size_t count = out.size() - inflater.avail_out;
+                commit(count);
+                produced += count;
+                if (produced > maxMessageSize) {
+                    throw WebSocketProtocolError("Inflated message exceeds " + std::to_string(maxMessageSize) + " bytes");
+                }
+                if (result == Z_STREAM_END) {
+                    // The server ended the stream with a final block: the next message starts a new one.
+                    ::inflateReset(&inflater);
+                } else if (result == Z_BUF_ERROR) {
+                    return;
+                } else if (result != Z_OK) {
+                    throw WebSocketProtocolError(std::string("Invalid compressed message: ") +
+                                                 (inflater.msg ? inflater.msg : "inflate failed"));
+                }
+                if (inflater.avail_in == 0 && inflater.avail_out != 0) {
+                    return;
+                }
+            }
+        }
+
+        template<typename Room, typename Commit>
+        void inflateMessage(std::string_view payload, Room &&room, Commit &&commit) {
+            std::size_t produced = 0;
+            inflater.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(payload.data()));
+            inflater.avail_in = static_cast<uInt>(payload.size());
+            inflateInto(room, commit, produced);
+            inflater.next_in = const_cast<Bytef *>(TAIL);
+            inflater.avail_in = sizeof(TAIL);
+            inflateInto(room, commit, produced);
+            if (parameters.serverNoContextTakeover) {
+                ::inflateReset(&inflater);
+            }
+        }
+
+    public:
+        /**
+         * @param parameters The parameters agreed with the server.
+         * @param compressionLevel The zlib level of outgoing messages.
+         * @param maxMessageSize The maximum size of an inflated message.
+         */
+        explicit PerMessageDeflate(DeflateParameters parameters, int compressionLevel = Z_DEFAULT_COMPRESSION,
+                                   std::size_t maxMessageSize = WebSocketFrameParser::DEFAULT_MAX_MESSAGE_SIZE)
+                : parameters(parameters), maxMessageSize(maxMessageSize) {
+            // A 15-bit window inflates whatever window the server uses.
+            if (::inflateInit2(&inflater, -15) != Z_OK) {
+                throw std::runtime_error("Cannot initialize the inflater");
+            }
+            if (::deflateInit2(&deflater, compressionLevel, Z_DEFLATED, -parameters.clientMaxWindowBits, 8,
+                               Z_DEFAULT_STRATEGY) != Z_OK) {
+                ::inflateEnd(&inflater);
+                throw std::runtime_error("Cannot initialize the deflater");
+            }
+        }
+
+        PerMessageDeflate(const PerMessageDeflate &) = delete;
+        PerMessageDeflate &operator=(const PerMessageDeflate &) = delete;
+
+        ~PerMessageDeflate() {
+            ::inflateEnd(&inflater);
+            ::deflateEnd(&deflater);
+        }
+
+        /**
+         * Inflates a compressed message, appending it to out.
+         *
+         * @throws WebSocketProtocolError if the payload is not valid deflate data or inflates beyond the
+         * maximum message size.
+         */
+        void inflate(std::string_view payload, std::string &out) {
+            std::size_t start = 0;
+            inflateMessage(payload, [&]() {
+                start = out.size();
+                std::size_t chunk = std::max<std::size_t>(MIN_CHUNK, inflater.avail_in * 4);
+                out.resize(start + chunk);
+                return std::span<char>(out.data() + start, chunk);
+            }, [&](std::size_t count) {
+                out.resize(start + count);
+            });
+        }
+
+        /**
+         * Inflates a compressed message straight into the pooled buffers of the assembler, which splits
+         * it into lines as usual. If the message turns out to be invalid, the lines inflated before the
+         * error have already been appended.
+         *
+         * @throws WebSocketProtocolError as inflate(std::string_view, std::string &).
+         */
+        void inflate(std::string_view payload, LineAssembler &out) {
+            inflateMessage(payload, [&]() {
+                return out.stagingRoom();
+            }, [&](std::size_t count) {
+                out.commitStaged(count);
+            });
+        }
+
+        /**
+         * Compresses an outgoing message.
+         *
+         * @return The compressed payload, valid until the next call.
+         */
+        std::string_view deflate(std::string_view payload) {
+            deflated.resize(::deflateBound(&deflater, static_cast<uLong>(payload.size())) + 16);
+            deflater.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(payload.data()));
+            deflater.avail_in = static_cast<uInt>(payload.size());
+            std::size_t produced = 0;
+            while (true) {
+                deflater.next_out = reinterpret_cast<Bytef *>(deflated.data() + produced);
+                deflater.avail_out = static_cast<uInt>(deflated.size() - produced);
+                ::deflate(&deflater, Z_SYNC_FLUSH);
+                produced = deflated.size() - deflater.avail_out;
+                if (deflater.avail_out != 0) {
+                    break;
+                }
+                deflated.resize(deflated.size() * 2);
+            }
+            if (parameters.clientNoContextTakeover) {
+                ::deflateReset(&deflater);
+            }
+            // The sync flush ends with the empty stored block the receiver appends back.
+            return std::string_view(deflated.data(), produced - sizeof(TAIL));
+        }
+
+        const DeflateParameters &getParameters() const {
+            return parameters;
+        }
+    };
+#else
+    class PerMessageDeflate {
+    public:
+        explicit PerMessageDeflate(DeflateParameters, int = -1, std::size_t = 0) {
+            throw std::logic_error("The library was built without zlib (LIGHTSTREAMER_USE_ZLIB)");
+        }
+
+        void inflate(std::string_view, std::string &) {}
+
+        void inflate(std::string_view, LineAssembler &) {}
+
+        std::string_view deflate(std::string_view payload) {
+            return payload;
+        }
+    };
+#endif
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_PERMESSAGEDEFLATE_HPP
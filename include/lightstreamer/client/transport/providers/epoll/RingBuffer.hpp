@@ -0,0 +1,182 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_RINGBUFFER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_RINGBUFFER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * A byte ring whose readable and writable regions are always contiguous.
+     *
+     * On Linux the storage is mapped twice, back to back, so a region crossing the end of the ring
+     * continues in the second mapping and nothing is ever moved: a socket reads straight into
+     * writable(), and a parser sees readable() as one array even when it wraps. Elsewhere the ring is
+     * a plain buffer whose unread bytes are moved to the front when the tail runs out of space.
+     */
+    class RingBuffer {
+    private:
+        char *storage = nullptr;
+        std::size_t capacity;
+        std::size_t head = 0;
+        std::size_t count = 0;
+        bool mirrored = false;
+
+        static std::size_t roundToPages(std::size_t size) {
+#if defined(__linux__)
+            auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            return (size + page - 1) / page * page;
+#else
+            return size;
+#endif
+        }
+
+        bool mapMirrored() {
+#if defined(__linux__)
+            int fd = ::memfd_create("ls-ring", MFD_CLOEXEC);
+            if (fd < 0) {
+                return false;
+            }
+            bool ok = false;
+            if (::ftruncate(fd, static_cast<off_t>(capacity)) == 0) {
+                void *base = ::mmap(nullptr, 2 * capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (base != MAP_FAILED) {
+                    char *first = static_cast<char *>(base);
+                    if (::mmap(first, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                        ::mmap(first + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED) {
+                        storage = first;
+                        ok = true;
+                    } else {
+                        ::munmap(base, 2 * capacity);
+                    }
+                }
+            }
+            ::close(fd);
+            return ok;
+#else
+            return false;
+#endif
+        }
+
+    public:
+        /**
+         * @param minCapacity The minimum capacity; rounded up to whole pages where the ring is mirrored.
+         */
+        explicit RingBuffer(std::size_t minCapacity = 64 * 1024) : capacity(roundToPages(minCapacity)) {
+            if (capacity == 0) {
+                throw std::invalid_argument("The capacity must be positive");
+            }
+            mirrored = mapMirrored();
+            if (!mirrored) {
+                storage = new char[capacity];
+            }
+        }
+
+        RingBuffer(const RingBuffer &) = delete;
+        RingBuffer &operator=(const RingBuffer &) = delete;
+
+        ~RingBuffer() {
+#if defined(__linux__)
+            if (mirrored) {
+                ::munmap(storage, 2 * capacity);
+                return;
+            }
+#endif
+            delete[] storage;
+        }
+
+        /**
+         * @return The unread bytes, as one contiguous array.
+         */
+        char *data() const {
+            return storage + head;
+        }
+
+        std::size_t size() const {
+            return count;
+        }
+
+        std::size_t getCapacity() const {
+            return capacity;
+        }
+
+        bool isFull() const {
+            return count == capacity;
+        }
+
+        /**
+         * @return The free space following the unread bytes, as one contiguous array of writableSize()
+         * bytes (to be read after this call).
+         */
+        char *writable() {
+            if (!mirrored && head > 0 && capacity - head - count < capacity / 4) {
+                std::memmove(storage, storage + head, count);
+                head = 0;
+            }
+            // Mirrored, head + capacity never exceeds the double mapping.
+            return storage + head + count;
+        }
+
+        std::size_t writableSize() const {
+            return mirrored ? capacity - count : capacity - head - count;
+        }
+
+        /**
+         * Appends the n bytes written at writable().
+         */
+        void commit(std::size_t n) {
+            count += n;
+        }
+
+        /**
+         * Releases the first n unread bytes.
+         */
+        void consume(std::size_t n) {
+            count -= n;
+            if (count == 0) {
+                head = 0;
+            } else {
+                head = mirrored ? (head + n) % capacity : head + n;
+            }
+        }
+
+        bool isMirrored() const {
+            return mirrored;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_RINGBUFFER_HPP
@@ -0,0 +1,336 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_SOCKETSTREAM_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_SOCKETSTREAM_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#endif
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * TLS settings of the native transports.
+     */
+    struct TlsOptions {
+        /**
+         * Whether the server certificate and host name are verified.
+         */
+        bool verifyPeer = true;
+        /**
+         * A PEM file of trusted CAs; empty for the system default paths.
+         */
+        std::string caFile;
+    };
+
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+    /**
+     * An OpenSSL client context, shared by the connections of a provider factory.
+     */
+    class TlsContext {
+    private:
+        SSL_CTX *context;
+
+    public:
+        explicit TlsContext(const TlsOptions &options) : context(SSL_CTX_new(TLS_client_method())) {
+            if (!context) {
+                throw std::runtime_error("Cannot create the TLS context");
+            }
+            SSL_CTX_set_min_proto_version(context, TLS1_2_VERSION);
+            SSL_CTX_set_mode(context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+            if (options.verifyPeer) {
+                SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+                int loaded = options.caFile.empty() ? SSL_CTX_set_default_verify_paths(context)
+                                                    : SSL_CTX_load_verify_locations(context, options.caFile.c_str(), nullptr);
+                if (loaded != 1) {
+                    SSL_CTX_free(context);
+                    throw std::runtime_error("Cannot load the trusted certificates");
+                }
+            } else {
+                SSL_CTX_set_verify(context, SSL_VERIFY_NONE, nullptr);
+            }
+        }
+
+        TlsContext(const TlsContext &) = delete;
+        TlsContext &operator=(const TlsContext &) = delete;
+
+        ~TlsContext() {
+            SSL_CTX_free(context);
+        }
+
+        SSL_CTX *get() const {
+            return context;
+        }
+    };
+#else
+    class TlsContext {
+    public:
+        explicit TlsContext(const TlsOptions &) {}
+    };
+#endif
+
+    /**
+     * A non-blocking TCP connection, optionally secured by TLS.
+     *
+     * Reads and writes never block: they report WOULD_BLOCK instead, and the owner waits for the socket
+     * readiness given by wantsWrite() (TLS may need to write while reading, and the other way round).
+     */
+    class SocketStream {
+    public:
+        enum class Status {
+            OK,
+            WOULD_BLOCK,
+            CLOSED,
+            FAILED
+        };
+
+        struct Result {
+            Status status;
+            std::size_t bytes;
+        };
+
+    private:
+        int fd;
+        bool wantWrite = false;
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+        SSL *ssl = nullptr;
+
+        Result sslResult(int result) {
+            if (result > 0) {
+                wantWrite = false;
+                return {Status::OK, static_cast<std::size_t>(result)};
+            }
+            switch (SSL_get_error(ssl, result)) {
+                case SSL_ERROR_WANT_READ:
+                    wantWrite = false;
+                    return {Status::WOULD_BLOCK, 0};
+                case SSL_ERROR_WANT_WRITE:
+                    wantWrite = true;
+                    return {Status::WOULD_BLOCK, 0};
+                case SSL_ERROR_ZERO_RETURN:
+                    return {Status::CLOSED, 0};
+                default:
+                    ERR_clear_error();
+                    return {Status::FAILED, 0};
+            }
+        }
+#endif
+
+    public:
+        /**
+         * Starts a non-blocking connection to the first address the host resolves to. Name resolution
+         * happens on the calling thread.
+         *
+         * @throws std::system_error if the host cannot be resolved or the socket cannot be created.
+         */
+        static SocketStream connect(const std::string &host, int port) {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo *addresses = nullptr;
+            int error = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+            if (error != 0) {
+                throw std::system_error(EHOSTUNREACH, std::generic_category(),
+                                        "Cannot resolve " + host + ": " + ::gai_strerror(error));
+            }
+            std::unique_ptr<addrinfo, decltype(&::freeaddrinfo)> guard(addresses, ::freeaddrinfo);
+            int fd = ::socket(addresses->ai_family, addresses->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                              addresses->ai_protocol);
+            if (fd < 0) {
+                throw std::system_error(errno, std::generic_category(), "socket");
+            }
+            SocketStream stream(fd);
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (::connect(fd, addresses->ai_addr, addresses->ai_addrlen) < 0 && errno != EINPROGRESS) {
+                throw std::system_error(errno, std::generic_category(), "connect");
+            }
+            stream.wantWrite = true;
+            return stream;
+        }
+
+        explicit SocketStream(int fd) : fd(fd) {}
+
+        SocketStream(SocketStream &&other) noexcept: fd(other.fd), wantWrite(other.wantWrite) {
+            other.fd = -1;
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+            ssl = other.ssl;
+            other.ssl = nullptr;
+#endif
+        }
+
+        SocketStream &operator=(SocketStream &&) = delete;
+
+        ~SocketStream() {
+            close();
+        }
+
+        int getFd() const {
+            return fd;
+        }
+
+        /**
+         * Completes the TCP connection started by connect(), once the socket is writable.
+         *
+         * @return 0 on success, the connection error otherwise.
+         */
+        int finishConnect() {
+            int error = 0;
+            socklen_t size = sizeof(error);
+            if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) < 0) {
+                error = errno;
+            }
+            wantWrite = false;
+            return error;
+        }
+
+        /**
+         * Sets up the TLS client side; handshake() must then be called until it returns OK.
+         *
+         * @param context The TLS context.
+         * @param host The server name, sent as SNI and checked against the certificate.
+         * @throws std::logic_error if the library was built without OpenSSL.
+         */
+        void startTls(TlsContext &context, const std::string &host, bool verifyHost) {
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+            ssl = SSL_new(context.get());
+            if (!ssl) {
+                throw std::runtime_error("Cannot create the TLS session");
+            }
+            SSL_set_fd(ssl, fd);
+            SSL_set_tlsext_host_name(ssl, host.c_str());
+            if (verifyHost) {
+                SSL_set1_host(ssl, host.c_str());
+            }
+            SSL_set_connect_state(ssl);
+#else
+            (void) context;
+            (void) host;
+            (void) verifyHost;
+            throw std::logic_error("The library was built without TLS support (LIGHTSTREAMER_USE_OPENSSL)");
+#endif
+        }
+
+        bool isSecure() const {
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+            return ssl != nullptr;
+#else
+            return false;
+#endif
+        }
+
+        Result handshake() {
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+            int result = SSL_do_handshake(ssl);
+            if (result == 1) {
+                wantWrite = false;
+                return {Status::OK, 0};
+            }
+            return sslResult(result);
+#else
+            return {Status::OK, 0};
+#endif
+        }
+
+        Result read(char *buffer, std::size_t size) {
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+            if (ssl) {
+                return sslResult(SSL_read(ssl, buffer, static_cast<int>(size)));
+            }
+#endif
+            ssize_t n = ::recv(fd, buffer, size, 0);
+            if (n > 0) {
+                return {Status::OK, static_cast<std::size_t>(n)};
+            }
+            if (n == 0) {
+                return {Status::CLOSED, 0};
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return {Status::WOULD_BLOCK, 0};
+            }
+            return {Status::FAILED, 0};
+        }
+
+        Result write(const char *data, std::size_t size) {
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+            if (ssl) {
+                return sslResult(SSL_write(ssl, data, static_cast<int>(size)));
+            }
+#endif
+            ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+            if (n >= 0) {
+                return {Status::OK, static_cast<std::size_t>(n)};
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                wantWrite = true;
+                return {Status::WOULD_BLOCK, 0};
+            }
+            return {Status::FAILED, 0};
+        }
+
+        /**
+         * Whether the last operation is waiting for the socket to become writable.
+         */
+        bool wantsWrite() const {
+            return wantWrite;
+        }
+
+        void clearWantWrite() {
+            wantWrite = false;
+        }
+
+        void close() {
+#if defined(LIGHTSTREAMER_USE_OPENSSL)
+            if (ssl) {
+                SSL_free(ssl);
+                ssl = nullptr;
+            }
+#endif
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_SOCKETSTREAM_HPP
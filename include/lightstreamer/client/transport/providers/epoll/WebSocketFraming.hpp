@@ -0,0 +1,461 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_WEBSOCKETFRAMING_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_WEBSOCKETFRAMING_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    enum class WebSocketOpcode : std::uint8_t {
+        CONTINUATION = 0x0,
+        TEXT = 0x1,
+        BINARY = 0x2,
+        CLOSE = 0x8,
+        PING = 0x9,
+        PONG = 0xA
+    };
+
+    /**
+     * A violation of RFC 6455 by the peer; the connection must be failed.
+     */
+    class WebSocketProtocolError : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    namespace detail {
+
+        // The key rotated so that its first byte applies to the first byte of data.
+        inline std::uint32_t rotatedKey(const unsigned char key[4], std::size_t offset) {
+            unsigned char rotated[4];
+            for (std::size_t i = 0; i < 4; ++i) {
+                rotated[i] = key[(offset + i) & 3];
+            }
+            std::uint32_t result;
+            std::memcpy(&result, rotated, 4);
+            return result;
+        }
+
+        // Masks the whole buffer, 8 bytes at a time and then byte by byte.
+        inline void maskScalar(char *data, std::size_t size, std::uint32_t key) {
+            std::uint64_t wide = (static_cast<std::uint64_t>(key) << 32) | key;
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, data + i, 8);
+                word ^= wide;
+                std::memcpy(data + i, &word, 8);
+            }
+            unsigned char bytes[4];
+            std::memcpy(bytes, &key, 4);
+            for (; i < size; ++i) {
+                data[i] = static_cast<char>(data[i] ^ bytes[i & 3]);
+            }
+        }
+
+#if defined(__SSE2__)
+        // Masks whole 16-byte blocks; returns the number of bytes done.
+        inline std::size_t maskSse2(char *data, std::size_t size, std::uint32_t key) {
+            __m128i wide = _mm_set1_epi32(static_cast<int>(key));
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                auto *p = reinterpret_cast<__m128i *>(data + i);
+                _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), wide));
+            }
+            return i;
+        }
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LIGHTSTREAMER_MASK_AVX2 1
+        // Masks whole 32-byte blocks; returns the number of bytes done. Only called if the CPU has AVX2.
+        __attribute__((target("avx2")))
+        inline std::size_t maskAvx2(char *data, std::size_t size, std::uint32_t key) {
+            __m256i wide = _mm256_set1_epi32(static_cast<int>(key));
+            std::size_t i = 0;
+            for (; i + 64 <= size; i += 64) {
+                auto *p = reinterpret_cast<__m256i *>(data + i);
+                __m256i a = _mm256_loadu_si256(p);
+                __m256i b = _mm256_loadu_si256(p + 1);
+                _mm256_storeu_si256(p, _mm256_xor_si256(a, wide));
+                _mm256_storeu_si256(p + 1, _mm256_xor_si256(b, wide));
+            }
+            for (; i + 32 <= size; i += 32) {
+                auto *p = reinterpret_cast<__m256i *>(data + i);
+                _mm256_storeu_si256(p, _mm256_xor_si256(_mm256_loadu_si256(p), wide));
+            }
+            return i;
+        }
+
+        inline bool hasAvx2() {
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+        }
+#endif
+
+    }
+
+    /**
+     * XORs data with the 4-byte masking key, starting at the given offset of the payload.
+     *
+     * Masking is its own inverse, so the same call unmasks. The key is rotated once for the offset and
+     * the buffer is then processed in wide blocks: 64/32 bytes with AVX2 when the CPU supports it
+     * (checked at run time), 16 bytes with SSE2, 8 bytes otherwise, with a byte-wise tail. Blocks are a
+     * multiple of the key size, so the key phase never changes between them.
+     */
+    inline void maskPayload(char *data, std::size_t size, const unsigned char key[4], std::size_t offset = 0) {
+        std::uint32_t rotated = detail::rotatedKey(key, offset);
+        std::size_t done = 0;
+#if defined(LIGHTSTREAMER_MASK_AVX2)
+        if (size >= 32 && detail::hasAvx2()) {
+            done = detail::maskAvx2(data, size, rotated);
+        }
+#endif
+#if defined(__SSE2__)
+        done += detail::maskSse2(data + done, size - done, rotated);
+#endif
+        detail::maskScalar(data + done, size - done, rotated);
+    }
+
+    /**
+     * Appends a single (final) frame to out. Client frames must be masked (RFC 6455, 5.3).
+     *
+     * @param out The buffer the frame is appended to.
+     * @param opcode The frame opcode.
+     * @param payload The payload.
+     * @param maskKey The masking key; its bytes are written in network order.
+     * @param compressed Whether to set RSV1, marking a permessage-deflate payload.
+     */
+    inline void encodeFrame(std::string &out, WebSocketOpcode opcode, std::string_view payload, std::uint32_t maskKey,
+                            bool compressed = false) {
+        unsigned char header[14];
+        std::size_t size = 0;
+        header[size++] = static_cast<unsigned char>(0x80 | (compressed ? 0x40 : 0) | static_cast<std::uint8_t>(opcode));
+        std::uint64_t length = payload.size();
+        if (length < 126) {
+            header[size++] = static_cast<unsigned char>(0x80 | length);
+        } else if (length <= 0xFFFF) {
+            header[size++] = 0x80 | 126;
+            header[size++] = static_cast<unsigned char>(length >> 8);
+            header[size++] = static_cast<unsigned char>(length);
+        } else {
+            header[size++] = 0x80 | 127;
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                header[size++] = static_cast<unsigned char>(length >> shift);
+            }
+        }
+        unsigned char *key = header + size;
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            header[size++] = static_cast<unsigned char>(maskKey >> shift);
+        }
+        std::size_t start = out.size();
+        out.resize(start + size + payload.size());
+        std::memcpy(out.data() + start, header, size);
+        std::memcpy(out.data() + start + size, payload.data(), payload.size());
+        maskPayload(out.data() + start + size, payload.size(), key);
+    }
+
+    /**
+     * Incremental RFC 6455 frame parser working on the receive buffer.
+     *
+     * parse() can be given the bytes in chunks of any size. A frame entirely contained in a chunk is
+     * delivered as a view on the chunk itself (unmasked in place if needed); only frames straddling two
+     * chunks, and fragmented messages, are copied into an internal buffer. Messages are delivered whole:
+     * continuation frames are reassembled, while control frames, which may be interleaved with the
+     * fragments, are delivered as they arrive.
+     */
+    class WebSocketFrameParser {
+    public:
+        static constexpr std::size_t DEFAULT_MAX_MESSAGE_SIZE = 16 * 1024 * 1024;
+
+    private:
+        enum class State {
+            HEADER,
+            LENGTH,
+            MASK,
+            PAYLOAD
+        };
+
+        State state = State::HEADER;
+        unsigned char bytes[8];
+        std::size_t filled = 0;
+        std::size_t needed = 2;
+
+        bool fin = false;
+        WebSocketOpcode opcode = WebSocketOpcode::CONTINUATION;
+        bool masked = false;
+        unsigned char mask[4];
+        std::uint64_t length = 0;
+        std::uint64_t received = 0;
+        // The payload of a frame split across chunks.
+        std::string partial;
+
+        // The fragmented message being reassembled.
+        std::string message;
+        WebSocketOpcode messageOpcode = WebSocketOpcode::TEXT;
+        bool inMessage = false;
+        // RSV1 is allowed once permessage-deflate is negotiated, and marks compressed messages.
+        bool compressionAllowed = false;
+        bool frameCompressed = false;
+        bool messageCompressed = false;
+        bool deliveredCompressed = false;
+        std::size_t maxMessageSize;
+
+        static bool isControl(WebSocketOpcode op) {
+            return (static_cast<std::uint8_t>(op) & 0x8) != 0;
+        }
+
+        // Copies header bytes until the current field is complete; returns false if the chunk ran out.
+        bool fill(const char *data, std::size_t size, std::size_t &pos) {
+            std::size_t count = std::min(needed - filled, size - pos);
+            std::memcpy(bytes + filled, data + pos, count);
+            filled += count;
+            pos += count;
+            return filled == needed;
+        }
+
+        void expect(State next, std::size_t count) {
+            state = next;
+            filled = 0;
+            needed = count;
+        }
+
+        void onHeader() {
+            unsigned char b0 = bytes[0];
+            unsigned char b1 = bytes[1];
+            if (b0 & (compressionAllowed ? 0x30 : 0x70)) {
+                throw WebSocketProtocolError("Reserved bits set without a negotiated extension");
+            }
+            fin = (b0 & 0x80) != 0;
+            opcode = static_cast<WebSocketOpcode>(b0 & 0x0F);
+            frameCompressed = (b0 & 0x40) != 0;
+            if (frameCompressed && opcode != WebSocketOpcode::TEXT && opcode != WebSocketOpcode::BINARY) {
+                throw WebSocketProtocolError("RSV1 set on a control or continuation frame");
+            }
+            switch (opcode) {
+                case WebSocketOpcode::CONTINUATION:
+                case WebSocketOpcode::TEXT:
+                case WebSocketOpcode::BINARY:
+                case WebSocketOpcode::CLOSE:
+                case WebSocketOpcode::PING:
+                case WebSocketOpcode::PONG:
+                    break;
+                default:
+                    throw WebSocketProtocolError("Unknown opcode " + std::to_string(b0 & 0x0F));
+            }
+            masked = (b1 & 0x80) != 0;
+            length = b1 & 0x7F;
+            if (isControl(opcode) && (!fin || length > 125)) {
+                throw WebSocketProtocolError("Fragmented or oversized control frame");
+            }
+            if (length == 126) {
+                expect(State::LENGTH, 2);
+            } else if (length == 127) {
+                expect(State::LENGTH, 8);
+            }
+        }
+
+        void onLength() {
+            length = 0;
+            for (std::size_t i = 0; i < needed; ++i) {
+                length = (length << 8) | bytes[i];
+            }
+            if (needed == 8 && (length >> 63) != 0) {
+                throw WebSocketProtocolError("Invalid payload length");
+            }
+        }
+
+        // Called once the header is complete.
+        template<typename F>
+        void startPayload(F &onMessage) {
+            std::uint64_t total = length + (opcode == WebSocketOpcode::CONTINUATION ? message.size() : 0);
+            if (total > maxMessageSize) {
+                throw WebSocketProtocolError("Message exceeds " + std::to_string(maxMessageSize) + " bytes");
+            }
+            received = 0;
+            if (length == 0) {
+                onFrame(std::string_view(), onMessage);
+                expect(State::HEADER, 2);
+            } else {
+                state = State::PAYLOAD;
+            }
+        }
+
+        template<typename F>
+        void onFrame(std::string_view payload, F &onMessage) {
+            if (isControl(opcode)) {
+                deliveredCompressed = false;
+                onMessage(opcode, payload);
+                return;
+            }
+            if (opcode == WebSocketOpcode::CONTINUATION) {
+                if (!inMessage) {
+                    throw WebSocketProtocolError("Continuation frame without a message");
+                }
+                message.append(payload);
+                if (fin) {
+                    inMessage = false;
+                    deliveredCompressed = messageCompressed;
+                    onMessage(messageOpcode, std::string_view(message));
+                    message.clear();
+                }
+                return;
+            }
+            if (inMessage) {
+                throw WebSocketProtocolError("New message before the end of a fragmented one");
+            }
+            if (fin) {
+                deliveredCompressed = frameCompressed;
+                onMessage(opcode, payload);
+            } else {
+                message.assign(payload);
+                messageOpcode = opcode;
+                messageCompressed = frameCompressed;
+                inMessage = true;
+            }
+        }
+
+    public:
+        explicit WebSocketFrameParser(std::size_t maxMessageSize = DEFAULT_MAX_MESSAGE_SIZE)
+                : maxMessageSize(maxMessageSize) {}
+
+        /**
+         * Consumes a chunk of received bytes.
+         *
+         * @param data The chunk; masked payloads are unmasked in place.
+         * @param size The chunk size.
+         * @param onMessage Called as onMessage(WebSocketOpcode, std::string_view) for every complete message
+         * or control frame; the view is only valid during the call.
+         * @throws WebSocketProtocolError if the peer violates the protocol; the parser is then unusable.
+         */
+        template<typename F>
+        void parse(char *data, std::size_t size, F &&onMessage) {
+            std::size_t pos = 0;
+            while (pos < size) {
+                switch (state) {
+                    case State::HEADER:
+                        if (!fill(data, size, pos)) {
+                            return;
+                        }
+                        onHeader();
+                        if (state == State::LENGTH) {
+                            break;
+                        }
+                        if (masked) {
+                            expect(State::MASK, 4);
+                        } else {
+                            startPayload(onMessage);
+                        }
+                        break;
+                    case State::LENGTH:
+                        if (!fill(data, size, pos)) {
+                            return;
+                        }
+                        onLength();
+                        if (masked) {
+                            expect(State::MASK, 4);
+                        } else {
+                            startPayload(onMessage);
+                        }
+                        break;
+                    case State::MASK:
+                        if (!fill(data, size, pos)) {
+                            return;
+                        }
+                        std::memcpy(mask, bytes, 4);
+                        startPayload(onMessage);
+                        break;
+                    case State::PAYLOAD: {
+                        std::size_t available = size - pos;
+                        if (received == 0 && available >= length) {
+                            // The whole payload is in the chunk: deliver it in place.
+                            std::size_t count = static_cast<std::size_t>(length);
+                            if (masked) {
+                                maskPayload(data + pos, count, mask);
+                            }
+                            pos += count;
+                            onFrame(std::string_view(data + pos - count, count), onMessage);
+                        } else {
+                            std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(available, length - received));
+                            std::size_t start = partial.size();
+                            partial.append(data + pos, count);
+                            if (masked) {
+                                maskPayload(partial.data() + start, count, mask, static_cast<std::size_t>(received));
+                            }
+                            pos += count;
+                            received += count;
+                            if (received < length) {
+                                return;
+                            }
+                            onFrame(std::string_view(partial), onMessage);
+                            partial.clear();
+                        }
+                        expect(State::HEADER, 2);
+                        break;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Accepts the RSV1 bit, i.e. compressed messages, once permessage-deflate has been negotiated.
+         */
+        void setCompressionAllowed(bool allowed) {
+            compressionAllowed = allowed;
+        }
+
+        /**
+         * @return Within onMessage, whether the message being delivered is compressed (RSV1 was set on
+         * its first frame).
+         */
+        bool isCompressed() const {
+            return deliveredCompressed;
+        }
+
+        /**
+         * Drops any partial frame or message, e.g. to reuse the parser for a new connection.
+         */
+        void reset() {
+            expect(State::HEADER, 2);
+            partial.clear();
+            message.clear();
+            inMessage = false;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_WEBSOCKETFRAMING_HPP
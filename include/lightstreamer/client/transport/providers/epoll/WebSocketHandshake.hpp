@@ -0,0 +1,249 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_WEBSOCKETHANDSHAKE_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_WEBSOCKETHANDSHAKE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <lightstreamer/client/Constants.hpp>
+#include <lightstreamer/client/transport/providers/epoll/WebSocketFraming.hpp>
+
+namespace lightstreamer::client::transport::providers::epoll {
+
+    /**
+     * The HTTP upgrade of RFC 6455, section 4.1, client side.
+     */
+    class WebSocketHandshake {
+    public:
+        static constexpr std::string_view ACCEPT_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+        /**
+         * @return A random Sec-WebSocket-Key (16 random bytes, base64-encoded).
+         */
+        static std::string generateKey(std::mt19937 &random) {
+            unsigned char nonce[16];
+            for (std::size_t i = 0; i < sizeof(nonce); i += 4) {
+                std::uint32_t value = random();
+                std::memcpy(nonce + i, &value, 4);
+            }
+            return base64(std::string_view(reinterpret_cast<const char *>(nonce), sizeof(nonce)));
+        }
+
+        /**
+         * @return The Sec-WebSocket-Accept value the server must answer for the given key.
+         */
+        static std::string acceptKey(std::string_view key) {
+            std::string input(key);
+            input.append(ACCEPT_GUID);
+            auto digest = sha1(input);
+            return base64(std::string_view(reinterpret_cast<const char *>(digest.data()), digest.size()));
+        }
+
+        /**
+         * Builds the upgrade request, asking for the TLCP subprotocol.
+         *
+         * @param extensions The Sec-WebSocket-Extensions offer; empty for none.
+         */
+        static std::string buildRequest(const std::string &host, int port, bool secure, const std::string &path,
+                                        const std::string &key,
+                                        const std::unordered_map<std::string, std::string> &extraHeaders,
+                                        const std::string &cookies, const std::string &extensions = "") {
+            std::string request;
+            request.reserve(256);
+            request.append("GET ").append(path.empty() ? "/" : path).append(" HTTP/1.1\r\nHost: ").append(host);
+            if (port != (secure ? 443 : 80)) {
+                request.append(":").append(std::to_string(port));
+            }
+            request.append("\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: ").append(key)
+                    .append("\r\nSec-WebSocket-Version: 13\r\nSec-WebSocket-Protocol: ")
+                    .append(Constants::TLCP_VERSION).append(".lightstreamer.com\r\n");
+            for (const auto &[name, value]: extraHeaders) {
+                request.append(name).append(": ").append(value).append("\r\n");
+            }
+            if (!cookies.empty()) {
+                request.append("Cookie: ").append(cookies).append("\r\n");
+            }
+            if (!extensions.empty()) {
+                request.append("Sec-WebSocket-Extensions: ").append(extensions).append("\r\n");
+            }
+            request.append("\r\n");
+            return request;
+        }
+
+        /**
+         * Checks the response head (status line and headers, up to the empty line).
+         *
+         * @return The Sec-WebSocket-Extensions accepted by the server; empty for none.
+         * @throws WebSocketProtocolError if the server did not accept the upgrade.
+         */
+        static std::string validateResponse(std::string_view head, std::string_view key) {
+            std::size_t lineEnd = head.find("\r\n");
+            std::string_view status = head.substr(0, lineEnd);
+            if (status.size() < 12 || status.substr(0, 5) != "HTTP/" || status.substr(9, 3) != "101") {
+                throw WebSocketProtocolError("Upgrade refused: " + std::string(status));
+            }
+            std::string expected = acceptKey(key);
+            bool accepted = false;
+            bool upgraded = false;
+            std::string extensions;
+            while (lineEnd != std::string_view::npos) {
+                std::size_t start = lineEnd + 2;
+                lineEnd = head.find("\r\n", start);
+                std::string_view line = head.substr(start, lineEnd == std::string_view::npos ? std::string_view::npos
+                                                                                             : lineEnd - start);
+                std::size_t colon = line.find(':');
+                if (colon == std::string_view::npos) {
+                    continue;
+                }
+                std::string_view name = line.substr(0, colon);
+                std::string_view value = trim(line.substr(colon + 1));
+                if (equalsIgnoreCase(name, "Sec-WebSocket-Accept")) {
+                    accepted = value == expected;
+                } else if (equalsIgnoreCase(name, "Upgrade")) {
+                    upgraded = equalsIgnoreCase(value, "websocket");
+                } else if (equalsIgnoreCase(name, "Sec-WebSocket-Extensions")) {
+                    extensions.append(extensions.empty() ? "" : ", ").append(value);
+                }
+            }
+            if (!upgraded || !accepted) {
+                throw WebSocketProtocolError("Invalid upgrade response");
+            }
+            return extensions;
+        }
+
+        static std::string base64(std::string_view data) {
+            static constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            std::string out;
+            out.reserve((data.size() + 2) / 3 * 4);
+            std::size_t i = 0;
+            for (; i + 2 < data.size(); i += 3) {
+                std::uint32_t n = (static_cast<unsigned char>(data[i]) << 16) |
+                                  (static_cast<unsigned char>(data[i + 1]) << 8) |
+                                  static_cast<unsigned char>(data[i + 2]);
+                out.push_back(ALPHABET[(n >> 18) & 63]);
+                out.push_back(ALPHABET[(n >> 12) & 63]);
+                out.push_back(ALPHABET[(n >> 6) & 63]);
+                out.push_back(ALPHABET[n & 63]);
+            }
+            if (i < data.size()) {
+                std::uint32_t n = static_cast<unsigned char>(data[i]) << 16;
+                if (i + 1 < data.size()) {
+                    n |= static_cast<unsigned char>(data[i + 1]) << 8;
+                }
+                out.push_back(ALPHABET[(n >> 18) & 63]);
+                out.push_back(ALPHABET[(n >> 12) & 63]);
+                out.push_back(i + 1 < data.size() ? ALPHABET[(n >> 6) & 63] : '=');
+                out.push_back('=');
+            }
+            return out;
+        }
+
+        /**
+         * SHA-1 (FIPS 180-4), only used for the accept key.
+         */
+        static std::array<std::uint8_t, 20> sha1(std::string_view data) {
+            std::uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+            std::string padded(data);
+            std::uint64_t bits = static_cast<std::uint64_t>(data.size()) * 8;
+            padded.push_back(static_cast<char>(0x80));
+            while (padded.size() % 64 != 56) {
+                padded.push_back('\0');
+            }
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                padded.push_back(static_cast<char>(bits >> shift));
+            }
+            auto rotl = [](std::uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+            for (std::size_t block = 0; block < padded.size(); block += 64) {
+                std::uint32_t w[80];
+                for (int t = 0; t < 16; ++t) {
+                    const auto *p = reinterpret_cast<const unsigned char *>(padded.data() + block + t * 4);
+                    w[t] = (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | p[3];
+                }
+                for (int t = 16; t < 80; ++t) {
+                    w[t] = rotl(w[t - 3] ^ w[t - 8] ^ w[t - 14] ^ w[t - 16], 1);
+                }
+                std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+                for (int t = 0; t < 80; ++t) {
+                    std::uint32_t f, k;
+                    if (t < 20) {
+                        f = (b & c) | (~b & d);
+                        k = 0x5A827999;
+                    } else if (t < 40) {
+                        f = b ^ c ^ d;
+                        k = 0x6ED9EBA1;
+                    } else if (t < 60) {
+                        f = (b & c) | (b & d) | (c & d);
+                        k = 0x8F1BBCDC;
+                    } else {
+                        f = b ^ c ^ d;
+                        k = 0xCA62C1D6;
+                    }
+                    std::uint32_t temp = rotl(a, 5) + f + e + k + w[t];
+                    e = d;
+                    d = c;
+                    c = rotl(b, 30);
+                    b = a;
+                    a = temp;
+                }
+                h[0] += a;
+                h[1] += b;
+                h[2] += c;
+                h[3] += d;
+                h[4] += e;
+            }
+            std::array<std::uint8_t, 20> digest{};
+            for (int i = 0; i < 20; ++i) {
+                digest[i] = static_cast<std::uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+            }
+            return digest;
+        }
+
+        static std::string_view trim(std::string_view s) {
+            while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
+                s.remove_prefix(1);
+            }
+            while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
+                s.remove_suffix(1);
+            }
+            return s;
+        }
+
+        static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+            });
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_WEBSOCKETHANDSHAKE_HPP
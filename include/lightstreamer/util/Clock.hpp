@@ -0,0 +1,150 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_CLOCK_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_CLOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lightstreamer::util {
+
+    /**
+     * The source of time of the session logic (timeouts, heartbeats, recovery, sync checks).
+     *
+     * The library reads the time through the static now() and currentTimeMillis(), which delegate to the
+     * installed instance: the real clocks by default, or a VirtualClock in tests and benchmarks, so that
+     * reconnection scenarios can run in simulated time. The instance must be installed before the
+     * library is used.
+     */
+    class Clock {
+    public:
+        using time_point = std::chrono::steady_clock::time_point;
+
+        virtual ~Clock() = default;
+
+        /**
+         * @return The monotonic time.
+         */
+        virtual time_point steadyNow() const = 0;
+
+        /**
+         * @return The wall-clock time, in milliseconds since the epoch.
+         */
+        virtual std::int64_t wallMillis() const = 0;
+
+        static time_point now() {
+            return current().load(std::memory_order_acquire)->steadyNow();
+        }
+
+        static std::int64_t currentTimeMillis() {
+            return current().load(std::memory_order_acquire)->wallMillis();
+        }
+
+        /**
+         * Installs the clock used by the library; null restores the real clocks.
+         */
+        static void setInstance(std::shared_ptr<Clock> clock) {
+            static std::mutex mutex;
+            // Installed clocks are never released: a thread may still be reading a replaced one.
+            static std::vector<std::shared_ptr<Clock>> installed;
+            std::lock_guard<std::mutex> lock(mutex);
+            Clock *target = clock ? clock.get() : &system();
+            if (clock) {
+                installed.push_back(std::move(clock));
+            }
+            current().store(target, std::memory_order_release);
+        }
+
+    private:
+        class SystemClock;
+
+        static Clock &system();
+
+        static std::atomic<Clock *> &current() {
+            static std::atomic<Clock *> instance{&system()};
+            return instance;
+        }
+    };
+
+    class Clock::SystemClock : public Clock {
+    public:
+        time_point steadyNow() const override {
+            return std::chrono::steady_clock::now();
+        }
+
+        std::int64_t wallMillis() const override {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    };
+
+    inline Clock &Clock::system() {
+        static SystemClock instance;
+        return instance;
+    }
+
+    /**
+     * A clock which only moves when told to. Both the monotonic and the wall-clock time start from the
+     * real ones at construction and advance together.
+     */
+    class VirtualClock : public Clock {
+    private:
+        time_point origin = std::chrono::steady_clock::now();
+        std::int64_t wallOrigin = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        std::atomic<std::int64_t> elapsedNanos{0};
+
+    public:
+        time_point steadyNow() const override {
+            return origin + std::chrono::nanoseconds(elapsedNanos.load(std::memory_order_acquire));
+        }
+
+        std::int64_t wallMillis() const override {
+            return wallOrigin + elapsedNanos.load(std::memory_order_acquire) / 1000000;
+        }
+
+        void advance(std::chrono::nanoseconds delta) {
+            if (delta.count() > 0) {
+                elapsedNanos.fetch_add(delta.count(), std::memory_order_acq_rel);
+            }
+        }
+
+        /**
+         * Moves the clock to the given time; a time in the past is ignored.
+         */
+        void advanceTo(time_point target) {
+            std::int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(target - origin).count();
+            std::int64_t current = elapsedNanos.load(std::memory_order_acquire);
+            while (nanos > current && !elapsedNanos.compare_exchange_weak(current, nanos, std::memory_order_acq_rel)) {
+            }
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_CLOCK_HPP
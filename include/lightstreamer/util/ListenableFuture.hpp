@@ -24,9 +24,16 @@
 #ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_LISTENABLEFUTURE_HPP
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_LISTENABLEFUTURE_HPP
 
-#include <vector>
-#include <mutex>
+#include <array>
+#include <cstddef>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <lightstreamer/util/threads/InlineTask.hpp>
+#include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
 
 namespace lightstreamer::util {
 
@@ -36,6 +43,16 @@ namespace lightstreamer::util {
         virtual void run() = 0;
     };
 
+    /**
+     * A future without a value, which is fulfilled, rejected or aborted once and runs the continuations
+     * registered for the outcome.
+     *
+     * Continuations are stored as InlineTasks, the first INLINE_CONTINUATIONS of them inside the future
+     * itself, so registering a small lambda allocates nothing. They always run outside the lock, on the
+     * thread resolving the future (or registering the continuation, if the future is already resolved),
+     * or on the executor given at registration: a continuation may register further continuations or
+     * resolve other futures without risk of deadlock.
+     */
     class ListenableFuture {
     public:
         enum class State {
@@ -45,11 +62,90 @@ namespace lightstreamer::util {
             ABORTED = 3
         };
 
+        using Executor = std::shared_ptr<threads::providers::JoinableExecutor>;
+
+        static constexpr std::size_t INLINE_CONTINUATIONS = 2;
+
     private:
-        std::vector<std::shared_ptr<IRunnable>> onFulfilledListeners;
-        std::vector<std::shared_ptr<IRunnable>> onRejectedListeners;
+        struct Continuation {
+            threads::InlineTask task;
+            State on = State::FULFILLED;
+            Executor executor;
+
+            void run() {
+                if (executor) {
+                    executor->execute(std::move(task));
+                } else {
+                    task.run();
+                }
+            }
+        };
+
+        class Continuations {
+        private:
+            std::array<Continuation, INLINE_CONTINUATIONS> inlined;
+            std::size_t inlinedCount = 0;
+            std::vector<Continuation> overflow;
+
+        public:
+            void add(Continuation continuation) {
+                if (inlinedCount < INLINE_CONTINUATIONS) {
+                    inlined[inlinedCount++] = std::move(continuation);
+                } else {
+                    overflow.push_back(std::move(continuation));
+                }
+            }
+
+            /**
+             * Runs, in registration order, the continuations registered for the given outcome.
+             */
+            void run(State outcome) {
+                for (std::size_t i = 0; i < inlinedCount; ++i) {
+                    if (inlined[i].on == outcome) {
+                        inlined[i].run();
+                    }
+                }
+                for (auto &continuation: overflow) {
+                    if (continuation.on == outcome) {
+                        continuation.run();
+                    }
+                }
+            }
+        };
+
+        Continuations continuations;
         State state = State::NOT_RESOLVED;
-        std::mutex mtx;
+        mutable std::mutex mtx;
+
+        ListenableFuture &on(State outcome, threads::InlineTask task, Executor executor) {
+            Continuation continuation{std::move(task), outcome, std::move(executor)};
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (state == State::NOT_RESOLVED) {
+                    continuations.add(std::move(continuation));
+                    return *this;
+                }
+                if (state != outcome) {
+                    return *this;
+                }
+            }
+            continuation.run();
+            return *this;
+        }
+
+        ListenableFuture &resolve(State outcome) {
+            Continuations pending;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (state != State::NOT_RESOLVED) {
+                    return *this;
+                }
+                state = outcome;
+                pending = std::move(continuations);
+            }
+            pending.run(outcome);
+            return *this;
+        }
 
     public:
         static std::shared_ptr<ListenableFuture> fulfilled() {
@@ -64,49 +160,84 @@ namespace lightstreamer::util {
             return future;
         }
 
-        ListenableFuture& onFulfilled(std::shared_ptr<IRunnable> listener) {
-            std::lock_guard<std::mutex> lock(mtx);
-            onFulfilledListeners.push_back(listener);
-            if (state == State::FULFILLED) {
-                listener->run();
-            }
-            return *this;
+        /**
+         * Runs the task when the future is fulfilled, or at once if it already is.
+         *
+         * @param executor The executor running the task; null to run it on the fulfilling thread.
+         */
+        template<typename F>
+        ListenableFuture &onFulfilled(F &&task, Executor executor = nullptr) {
+            return on(State::FULFILLED, threads::InlineTask(std::forward<F>(task)), std::move(executor));
         }
 
-        ListenableFuture& onRejected(std::shared_ptr<IRunnable> listener) {
-            std::lock_guard<std::mutex> lock(mtx);
-            onRejectedListeners.push_back(listener);
-            if (state == State::REJECTED) {
-                listener->run();
-            }
-            return *this;
+        ListenableFuture &onFulfilled(std::shared_ptr<IRunnable> listener, Executor executor = nullptr) {
+            return on(State::FULFILLED, [listener = std::move(listener)] { listener->run(); }, std::move(executor));
         }
 
-        ListenableFuture& fulfill() {
-            std::lock_guard<std::mutex> lock(mtx);
-            if (state == State::NOT_RESOLVED) {
-                state = State::FULFILLED;
-                for (auto& runnable : onFulfilledListeners) {
-                    runnable->run();
-                }
-            }
-            return *this;
+        /**
+         * Runs the task when the future is rejected, or at once if it already is.
+         *
+         * @param executor The executor running the task; null to run it on the rejecting thread.
+         */
+        template<typename F>
+        ListenableFuture &onRejected(F &&task, Executor executor = nullptr) {
+            return on(State::REJECTED, threads::InlineTask(std::forward<F>(task)), std::move(executor));
         }
 
-        ListenableFuture& reject() {
-            std::lock_guard<std::mutex> lock(mtx);
-            if (state == State::NOT_RESOLVED) {
-                state = State::REJECTED;
-                for (auto& runnable : onRejectedListeners) {
-                    runnable->run();
+        ListenableFuture &onRejected(std::shared_ptr<IRunnable> listener, Executor executor = nullptr) {
+            return on(State::REJECTED, [listener = std::move(listener)] { listener->run(); }, std::move(executor));
+        }
+
+        /**
+         * Chains a step to run when this future is fulfilled.
+         *
+         * The step may return nothing, in which case the returned future is fulfilled once it has run, or a
+         * std::shared_ptr<ListenableFuture>, which the returned future then follows. The returned future is
+         * rejected if this one is rejected or if the step throws.
+         *
+         * @param executor The executor running the step; null to run it on the fulfilling thread.
+         */
+        template<typename F>
+        std::shared_ptr<ListenableFuture> then(F &&step, Executor executor = nullptr) {
+            auto next = std::make_shared<ListenableFuture>();
+            onFulfilled([step = std::forward<F>(step), next]() mutable {
+                try {
+                    if constexpr (std::is_void_v<std::invoke_result_t<F &>>) {
+                        step();
+                        next->fulfill();
+                    } else {
+                        std::shared_ptr<ListenableFuture> inner = step();
+                        if (!inner) {
+                            next->fulfill();
+                            return;
+                        }
+                        inner->onFulfilled([next] { next->fulfill(); });
+                        inner->onRejected([next] { next->reject(); });
+                    }
+                } catch (...) {
+                    next->reject();
                 }
-            }
-            return *this;
+            }, std::move(executor));
+            onRejected([next] { next->reject(); });
+            return next;
+        }
+
+        ListenableFuture &fulfill() {
+            return resolve(State::FULFILLED);
+        }
+
+        ListenableFuture &reject() {
+            return resolve(State::REJECTED);
         }
 
-        ListenableFuture& abort() {
+        /**
+         * Moves the future to the ABORTED state, dropping the continuations not run yet.
+         */
+        ListenableFuture &abort() {
+            Continuations dropped;
             std::lock_guard<std::mutex> lock(mtx);
             state = State::ABORTED;
+            dropped = std::move(continuations);
             return *this;
         }
 
@@ -31,56 +31,117 @@
 #include <condition_variable>
 #include <chrono>
 #include <iostream>
+#include <atomic>
+#include <string>
 #include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
+#include <lightstreamer/util/threads/WaitStrategy.hpp>
+#include <lightstreamer/util/threads/ThreadConfig.hpp>
 
 namespace lightstreamer::util::threads {
 
     struct Task {
-        std::function<void()> func;
+        InlineTask func;
         bool done;
 
-        Task(const std::function<void()>& f) : func(f), done(false) {}
-        void operator()() { func(); done = true; }
+        explicit Task(InlineTask f) : func(std::move(f)), done(false) {}
+        void operator()() { func.run(); done = true; }
     };
 
-    class CSJoinableExecutor  : providers::JoinableExecutor {
+    /**
+     * Single-threaded executor. Before blocking on its condition variable the worker waits according
+     * to the configured WaitStrategy; while it is spinning, execute() skips the notification.
+     */
+    class CSJoinableExecutor : public providers::JoinableExecutor {
     private:
         std::queue<std::shared_ptr<Task>> tasks;
         std::mutex lock;
         std::condition_variable cv;
         long keepAliveTime;
-        bool running;
+        WaitStrategy waitStrategy;
+        ThreadRole role;
+        std::atomic<bool> running{false};
+        // Threads blocked on cv (the worker when idle, join() callers), guarded by lock.
+        int waiters = 0;
+        // Mirror of tasks.size(), polled by the worker while spinning.
+        std::atomic<std::size_t> pending{0};
         std::thread worker;
 
+        /**
+         * Polls for new tasks without taking the lock, for as long as the wait strategy allows.
+         */
+        void spinForTask() {
+            if (waitStrategy.type == WaitStrategy::Type::BLOCKING) {
+                return;
+            }
+            auto deadline = std::chrono::steady_clock::now() + waitStrategy.spinDuration;
+            for (unsigned spins = 0; ; ++spins) {
+                if (pending.load(std::memory_order_acquire) > 0 || !running.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                cpuRelax();
+                if ((spins & 63) == 63 && waitStrategy.type != WaitStrategy::Type::BUSY_SPIN &&
+                    std::chrono::steady_clock::now() >= deadline) {
+                    return;
+                }
+            }
+        }
+
     public:
+        /**
+         * @param threadName Ignored: the worker is named after its role (see ThreadSettings::name).
+         * @param keepAliveTime Milliseconds the idle worker waits for new tasks before terminating.
+         * @param waitStrategy How the idle worker waits before blocking.
+         * @param role The role whose ThreadConfig settings apply to the worker.
+         */
+        CSJoinableExecutor(const std::string &threadName, long keepAliveTime,
+                           WaitStrategy waitStrategy = WaitStrategy::blocking(), ThreadRole role = ThreadRole::SESSION)
+                : keepAliveTime(keepAliveTime), waitStrategy(waitStrategy), role(role) {
+            (void) threadName;
+        }
 
-        void execute(std::function<void()> task) {
+        void execute(InlineTask task) override {
             std::lock_guard<std::mutex> guard(lock);
             if(!running) {
                 running = true;
                 worker = std::thread([this]{ this->work(); });
             }
-            tasks.push(std::make_shared<Task>(task));
-            cv.notify_all();
+            tasks.push(std::make_shared<Task>(std::move(task)));
+            pending.fetch_add(1, std::memory_order_release);
+            if (waiters > 0) {
+                cv.notify_all();
+            }
         }
 
-        void join() {
+        void join() override {
             std::unique_lock<std::mutex> ul(lock);
+            ++waiters;
             cv.wait(ul, [this]{ return tasks.empty(); });
+            --waiters;
             running = false;
+            ul.unlock();
             if(worker.joinable()) worker.join();
         }
 
     private:
         void work() {
+            ThreadConfig::getInstance().applyToCurrentThread(role);
             while(running) {
                 std::shared_ptr<Task> task = nullptr;
+                if (pending.load(std::memory_order_acquire) == 0) {
+                    spinForTask();
+                }
                 {
                     std::unique_lock<std::mutex> ul(lock);
+                    ++waiters;
                     cv.wait_for(ul, std::chrono::milliseconds(keepAliveTime), [&]{ return !tasks.empty(); });
+                    --waiters;
                     if(!tasks.empty() && running) {
                         task = std::move(tasks.front());
                         tasks.pop();
+                        pending.fetch_sub(1, std::memory_order_relaxed);
+                        if (tasks.empty() && waiters > 0) {
+                            cv.notify_all();
+                        }
                     }
                 }
                 if(task) (*task)();
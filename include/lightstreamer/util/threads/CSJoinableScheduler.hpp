@@ -24,65 +24,64 @@
 #ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_CSJOINABLESCHEDULER_HPP
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_CSJOINABLESCHEDULER_HPP
 
-#include <stack>
-#include <lightstreamer/util/threads/CSJoinableScheduler.hpp>
 #include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
 #include <lightstreamer/util/threads/providers/JoinableScheduler.hpp>
+#include <lightstreamer/util/threads/TimerWheel.hpp>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
-#include <map>
+#include <string>
 #include <chrono>
 #include <future>
 
 namespace lightstreamer::util::threads {
+    /**
+     * Scheduler running delayed tasks on its executor. Timers live in a TimerWheel advanced by the shared
+     * TimerDriver thread, so pending timers cost no thread of their own.
+     */
     class CSJoinableScheduler : public providers::JoinableScheduler {
     private:
-//        std::stack<std::future<void>> currentTasks;
-        std::stack<std::shared_ptr<std::future<void>>> currentTasks;
         std::string threadName;
         long keepAliveTime;
-//        providers::JoinableExecutor executor;
         std::shared_ptr<providers::JoinableExecutor> executor;
-        std::map<std::future<void>, std::shared_ptr<std::promise<void>>> cancs;
-        std::mutex m;
+        std::shared_ptr<TimerWheel> timers;
+
+        void createWheel() {
+            if (!executor) {
+                // Without an executor the tasks run on the driver thread: they must be short.
+                timers = TimerDriver::getInstance().createWheel([](InlineTask &&task) { task.run(); });
+                return;
+            }
+            std::weak_ptr<providers::JoinableExecutor> target = executor;
+            timers = TimerDriver::getInstance().createWheel([target](InlineTask &&task) {
+                if (auto alive = target.lock()) {
+                    alive->execute(std::move(task));
+                }
+            });
+        }
 
     public:
         CSJoinableScheduler(std::string threadName, long keepAliveTime) : threadName(threadName),
-                                                                          keepAliveTime(keepAliveTime) {}
+                                                                          keepAliveTime(keepAliveTime) {
+            createWheel();
+        }
 
         CSJoinableScheduler(const std::string& threadName, long keepAliveTime, std::shared_ptr<providers::JoinableExecutor> executor)
                 : threadName(threadName), keepAliveTime(keepAliveTime), executor(executor) {
+            createWheel();
         }
 
+        /**
+         * Cancels all the pending tasks.
+         */
         void join() {
-            std::lock_guard<std::mutex> lock(m);
-            for (auto &entry: cancs) {
-                if (entry.second != nullptr) {
-                    entry.second->set_value();
-                }
-            }
-            cancs.clear();
-        }
-
-        void Dequeue(std::future<void> tsk) {
-            std::lock_guard<std::mutex> lock(m);
-            cancs.erase(tsk);
+            timers->clear();
         }
 
-        std::shared_ptr<std::promise<void>> schedule(std::function<void()> task, long delayInMillis) {
-            std::shared_ptr<std::promise<void>> source = std::make_shared<std::promise<void>>();
-            std::lock_guard<std::mutex> lock(m);
-            std::future<void> tsk_p = std::async(std::launch::async, [=]() {
-                std::this_thread::sleep_for(std::chrono::milliseconds(delayInMillis));
-                if (source->get_future().wait_for(std::chrono::seconds(0)) == std::future_status::timeout) {
-                    executor.execute(task);
-                }
-            });
-            cancs[tsk_p] = source;
-            tsk_p.share().wait();
-            this->Dequeue(tsk_p);
-            return source;
+        std::shared_ptr<Cancellable> schedule(InlineTask task, long delayInMillis) override {
+            auto [guarded, cancel] = makeCancellable(std::move(task));
+            cancel->bind(timers->schedule(std::move(guarded), std::chrono::milliseconds(delayInMillis)));
+            return cancel;
         }
     };
 }
@@ -0,0 +1,48 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_CANCELLABLE_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_CANCELLABLE_HPP
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * Handle of a delayed task, returned by ThreadMultiplexer::schedule and JoinableScheduler::schedule.
+     * Dropping the handle does not cancel the task.
+     */
+    class Cancellable {
+    public:
+        virtual ~Cancellable() = default;
+
+        /**
+         * Cancels the task, if it has not started yet. Calling it again has no effect.
+         */
+        virtual void cancel() = 0;
+
+        virtual bool isCancelled() const = 0;
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_CANCELLABLE_HPP
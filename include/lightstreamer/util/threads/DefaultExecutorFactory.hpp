@@ -26,6 +26,8 @@
 #include <lightstreamer/util/threads/providers/ExecutorFactory.hpp>
 #include <lightstreamer/util/threads/providers/JoinableScheduler.hpp>
 #include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
+#include <lightstreamer/util/threads/WaitStrategy.hpp>
+#include <lightstreamer/util/threads/JoinablePoolExecutor.hpp>
 
 
 
@@ -35,18 +37,32 @@ namespace lightstreamer::util::threads {
      * The default implementation of an ExecutorFactory.
      */
     class DefaultExecutorFactory : public providers::ExecutorFactory {
+    private:
+        WaitStrategy waitStrategy = WaitStrategy::blocking();
+
     public:
+        /**
+         * Sets how the threads of the executors created afterwards (e.g. the session thread) wait for new
+         * tasks. Executors already created keep their strategy.
+         */
+        void setWaitStrategy(WaitStrategy strategy) {
+            waitStrategy = strategy;
+        }
+
         /**
          * Returns a new instance of a JoinableExecutor.
          *
          * @param nThreads Number of threads in the executor pool.
-         * @param threadName Name prefix for threads in the pool.
+         * @param threadName Unused: threads are named after their role by ThreadConfig.
          * @param keepAliveTime Time in milliseconds that threads without tasks will wait for new tasks before terminating.
-         * @return A shared pointer to a JoinableExecutor instance.
+         * @return A shared pointer to a JoinableExecutor instance: a single-threaded executor for nThreads <= 1,
+         * a work-stealing pool otherwise.
          */
         std::shared_ptr<providers::JoinableExecutor> getExecutor(int nThreads, const std::string& threadName, long keepAliveTime) override {
-            // Placeholder for actual CSJoinableExecutor creation
-            return std::make_shared<CSJoinableExecutor>(threadName, keepAliveTime);
+            if (nThreads > 1) {
+                return std::make_shared<JoinablePoolExecutor>(nThreads, threadName, keepAliveTime);
+            }
+            return std::make_shared<CSJoinableExecutor>(threadName, keepAliveTime, waitStrategy);
         }
 
         /**
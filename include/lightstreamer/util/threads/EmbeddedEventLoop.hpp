@@ -0,0 +1,368 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_EMBEDDEDEVENTLOOP_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_EMBEDDEDEVENTLOOP_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <lightstreamer/util/threads/InlineTask.hpp>
+#include <lightstreamer/util/threads/MpscQueue.hpp>
+#include <lightstreamer/util/threads/TimerWheel.hpp>
+#include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
+#include <lightstreamer/util/threads/providers/JoinableScheduler.hpp>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * A run-to-completion event loop owning no thread: everything runs inside poll(), on the thread of
+     * the application calling it.
+     *
+     * It is at the same time the executor and the scheduler of the tasks given to it, and the reactor of
+     * the sockets registered with watch(). Each poll() runs, up to a budget, the callbacks of the ready
+     * sockets, then the expired timers and the queued tasks, in this order, without blocking.
+     *
+     * On Linux getFd() returns an epoll descriptor which is readable whenever poll() has something to
+     * do: a socket is ready, a timer has expired or a task is queued. Applications add it to their own
+     * epoll set (or wait on it) and call poll() when it fires.
+     *
+     * Tasks and timers may be submitted from any thread. poll(), watch() and unwatch() must be called
+     * from one thread at a time, normally always the same one.
+     */
+    class EmbeddedEventLoop : public providers::JoinableExecutor, public providers::JoinableScheduler {
+    public:
+        using IoCallback = std::function<void(std::uint32_t events)>;
+
+        static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+        static constexpr std::size_t MAX_IO_EVENTS = 64;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        MpscQueue<InlineTask> tasks;
+        // Tasks pushed and not yet run; only as many tasks as counted here are sure to be fully pushed.
+        std::atomic<std::size_t> pending{0};
+        std::shared_ptr<TimerWheel> timers;
+        std::atomic<bool> deadlineChanged{true};
+        // Poller side.
+        std::optional<Clock::time_point> deadline;
+        std::optional<Clock::time_point> armedDeadline;
+        std::atomic<std::thread::id> pollingThread{};
+        std::atomic<bool> signaled{false};
+        std::unordered_map<int, std::shared_ptr<IoCallback>> watches;
+        std::atomic<std::uint64_t> tasksRun{0};
+        int epollFd = -1;
+        int ioFd = -1;
+        int wakeFd = -1;
+        int timerFd = -1;
+
+        static void check(int result, const char *what) {
+            if (result < 0) {
+                throw std::system_error(errno, std::generic_category(), what);
+            }
+        }
+
+        bool isPollingThread() const {
+            return pollingThread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+        }
+
+        // Makes the descriptor readable until the next poll().
+        void signal() {
+#if defined(__linux__)
+            if (!signaled.exchange(true, std::memory_order_seq_cst)) {
+                std::uint64_t one = 1;
+                [[maybe_unused]] ssize_t written = ::write(wakeFd, &one, sizeof(one));
+            }
+#endif
+        }
+
+        void clearSignal() {
+#if defined(__linux__)
+            if (signaled.exchange(false, std::memory_order_seq_cst)) {
+                std::uint64_t value;
+                [[maybe_unused]] ssize_t read = ::read(wakeFd, &value, sizeof(value));
+            }
+#endif
+        }
+
+        void push(InlineTask task) {
+            tasks.push(std::move(task));
+            if (pending.fetch_add(1, std::memory_order_seq_cst) == 0 && !isPollingThread()) {
+                signal();
+            }
+        }
+
+        // Called by the wheel, possibly on another thread, when a timer precedes the known deadline.
+        void onEarlierTimer() {
+            deadlineChanged.store(true, std::memory_order_release);
+            if (!isPollingThread()) {
+                signal();
+            }
+        }
+
+        void armTimerFd() {
+#if defined(__linux__)
+            // An expired timer descriptor stays readable until read, whether or not the deadline moves:
+            // consume the expiration, which also disarms it. It cannot expire before the armed deadline.
+            if (armedDeadline && Clock::now() >= *armedDeadline) {
+                std::uint64_t expirations;
+                if (::read(timerFd, &expirations, sizeof(expirations)) > 0) {
+                    armedDeadline.reset();
+                }
+            }
+            if (deadline == armedDeadline) {
+                return;
+            }
+            itimerspec spec{};
+            if (deadline) {
+                auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline->time_since_epoch()).count();
+                // A zero value would disarm the timer.
+                nanos = std::max<long long>(nanos, 1);
+                spec.it_value.tv_sec = static_cast<time_t>(nanos / 1000000000);
+                spec.it_value.tv_nsec = static_cast<long>(nanos % 1000000000);
+            }
+            // Re-arming also clears a previous expiration.
+            check(::timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr), "timerfd_settime");
+            armedDeadline = deadline;
+#endif
+        }
+
+    public:
+        /**
+         * @param poolSize The number of preallocated task queue nodes.
+         * @throws std::system_error if the descriptors cannot be created.
+         */
+        explicit EmbeddedEventLoop(std::size_t poolSize = 4096) : tasks(poolSize) {
+            timers = std::make_shared<TimerWheel>([this] { onEarlierTimer(); });
+#if defined(__linux__)
+            try {
+                check(epollFd = ::epoll_create1(EPOLL_CLOEXEC), "epoll_create1");
+                check(ioFd = ::epoll_create1(EPOLL_CLOEXEC), "epoll_create1");
+                check(wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), "eventfd");
+                // steady_clock is CLOCK_MONOTONIC on Linux.
+                check(timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC), "timerfd_create");
+                for (int fd: {ioFd, wakeFd, timerFd}) {
+                    epoll_event event{};
+                    event.events = EPOLLIN;
+                    event.data.fd = fd;
+                    check(::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event), "epoll_ctl");
+                }
+            } catch (...) {
+                closeAll();
+                throw;
+            }
+#endif
+        }
+
+        EmbeddedEventLoop(const EmbeddedEventLoop &) = delete;
+        EmbeddedEventLoop &operator=(const EmbeddedEventLoop &) = delete;
+
+        /**
+         * Discards the pending timers and tasks.
+         */
+        ~EmbeddedEventLoop() override {
+            timers->clear();
+            closeAll();
+        }
+
+        void execute(InlineTask task) override {
+            if (!task) {
+                throw std::invalid_argument("Specify a task");
+            }
+            push(std::move(task));
+        }
+
+        std::shared_ptr<Cancellable> schedule(InlineTask task, long delayInMillis) override {
+            if (!task) {
+                throw std::invalid_argument("Specify a task");
+            }
+            auto [guarded, cancel] = makeCancellable(std::move(task));
+            cancel->bind(timers->schedule(std::move(guarded), std::chrono::milliseconds(delayInMillis)));
+            return cancel;
+        }
+
+        /**
+         * Runs the queued tasks on the calling thread until none is left. Timers not yet expired are not
+         * waited for.
+         */
+        void join() override {
+            while (pending.load(std::memory_order_acquire) > 0) {
+                poll();
+            }
+        }
+
+        /**
+         * Runs the work that is ready, without blocking.
+         *
+         * @param budget The maximum number of socket callbacks and tasks to run; what is left is run by the
+         * next call, and the descriptor stays readable meanwhile.
+         * @return The number of socket callbacks and tasks run.
+         */
+        std::size_t poll(std::size_t budget = UNLIMITED) {
+            pollingThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            std::size_t done = 0;
+#if defined(__linux__)
+            if (!watches.empty() && budget > 0) {
+                epoll_event events[MAX_IO_EVENTS];
+                int n = ::epoll_wait(ioFd, events, static_cast<int>(std::min(budget, MAX_IO_EVENTS)), 0);
+                for (int i = 0; i < n; ++i) {
+                    auto it = watches.find(events[i].data.fd);
+                    if (it == watches.end()) {
+                        // Unwatched by a previous callback.
+                        continue;
+                    }
+                    std::shared_ptr<IoCallback> callback = it->second;
+                    (*callback)(events[i].events);
+                    ++done;
+                }
+            }
+#endif
+            if (deadlineChanged.exchange(false, std::memory_order_acq_rel)) {
+                deadline = timers->nextDeadline();
+            }
+            if (deadline) {
+                auto now = Clock::now();
+                if (now >= *deadline) {
+                    timers->advance(now, [this](InlineTask &&task) { push(std::move(task)); });
+                    deadline = timers->nextDeadline();
+                }
+            }
+            while (done < budget && pending.load(std::memory_order_acquire) > 0) {
+                std::optional<InlineTask> task = tasks.tryPop();
+                task->run();
+                pending.fetch_sub(1, std::memory_order_seq_cst);
+                ++done;
+            }
+            tasksRun.fetch_add(done, std::memory_order_relaxed);
+            armTimerFd();
+            pollingThread.store(std::thread::id(), std::memory_order_relaxed);
+            clearSignal();
+            if (pending.load(std::memory_order_seq_cst) > 0 || deadlineChanged.load(std::memory_order_acquire)) {
+                signal();
+            }
+            return done;
+        }
+
+        /**
+         * The descriptor to wait on for readability before calling poll(), or -1 where not supported.
+         */
+        int getFd() const {
+            return epollFd;
+        }
+
+        /**
+         * Registers a socket: callback is invoked by poll() with the ready events while the socket is
+         * ready for any of the given events (level-triggered).
+         *
+         * @param fd The socket.
+         * @param events The epoll events of interest, e.g. EPOLLIN.
+         * @param callback The callback; it may call watch(), modify() and unwatch().
+         * @throws std::system_error if the socket cannot be registered.
+         * @throws std::logic_error where sockets cannot be watched.
+         */
+        void watch(int fd, std::uint32_t events, IoCallback callback) {
+#if defined(__linux__)
+            epoll_event event{};
+            event.events = events;
+            event.data.fd = fd;
+            check(::epoll_ctl(ioFd, EPOLL_CTL_ADD, fd, &event), "epoll_ctl");
+            watches[fd] = std::make_shared<IoCallback>(std::move(callback));
+#else
+            throw std::logic_error("Sockets cannot be watched on this platform");
+#endif
+        }
+
+        /**
+         * Changes the events of interest of a watched socket.
+         */
+        void modify(int fd, std::uint32_t events) {
+#if defined(__linux__)
+            epoll_event event{};
+            event.events = events;
+            event.data.fd = fd;
+            check(::epoll_ctl(ioFd, EPOLL_CTL_MOD, fd, &event), "epoll_ctl");
+#endif
+        }
+
+        /**
+         * Stops watching a socket. Must be called before the socket is closed.
+         */
+        void unwatch(int fd) {
+#if defined(__linux__)
+            if (watches.erase(fd) > 0) {
+                ::epoll_ctl(ioFd, EPOLL_CTL_DEL, fd, nullptr);
+            }
+#endif
+        }
+
+        /**
+         * @return The number of tasks queued and not yet run.
+         */
+        std::size_t getPendingCount() const {
+            return pending.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return The number of socket callbacks and tasks run so far.
+         */
+        std::uint64_t getTaskCount() const {
+            return tasksRun.load(std::memory_order_relaxed);
+        }
+
+    private:
+        void closeAll() {
+#if defined(__linux__)
+            for (int *fd: {&timerFd, &wakeFd, &ioFd, &epollFd}) {
+                if (*fd >= 0) {
+                    ::close(*fd);
+                    *fd = -1;
+                }
+            }
+#endif
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_EMBEDDEDEVENTLOOP_HPP
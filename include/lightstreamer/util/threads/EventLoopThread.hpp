@@ -0,0 +1,102 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_EVENTLOOPTHREAD_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_EVENTLOOPTHREAD_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <lightstreamer/util/threads/EmbeddedEventLoop.hpp>
+#include <lightstreamer/util/threads/ThreadConfig.hpp>
+
+#if defined(__linux__)
+#include <poll.h>
+#endif
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * A thread driving an EmbeddedEventLoop: it waits on the loop descriptor and polls the loop when it
+     * becomes readable. It is what runs the loop when no application thread does.
+     */
+    class EventLoopThread {
+    private:
+        std::shared_ptr<EmbeddedEventLoop> loop;
+        std::atomic<bool> stop{false};
+        ThreadRole role;
+        std::thread worker;
+
+        void run() {
+            ThreadConfig::getInstance().applyToCurrentThread(role);
+            while (!stop.load(std::memory_order_acquire)) {
+#if defined(__linux__)
+                pollfd entry{loop->getFd(), POLLIN, 0};
+                ::poll(&entry, 1, -1);
+#else
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+                loop->poll();
+            }
+        }
+
+    public:
+        explicit EventLoopThread(std::shared_ptr<EmbeddedEventLoop> loop, ThreadRole role = ThreadRole::TRANSPORT)
+                : loop(std::move(loop)), role(role), worker(&EventLoopThread::run, this) {}
+
+        EventLoopThread(const EventLoopThread &) = delete;
+        EventLoopThread &operator=(const EventLoopThread &) = delete;
+
+        /**
+         * Stops the thread after the tasks already queued.
+         */
+        ~EventLoopThread() {
+            stop.store(true, std::memory_order_release);
+            // Makes the descriptor readable.
+            loop->execute([] {});
+            worker.join();
+        }
+
+        const std::shared_ptr<EmbeddedEventLoop> &getLoop() const {
+            return loop;
+        }
+
+        /**
+         * @return The loop of a transport thread shared by the native providers not given a loop of their
+         * own. The thread starts on first use and stops when the process exits.
+         */
+        static std::shared_ptr<EmbeddedEventLoop> sharedLoop() {
+            static EventLoopThread thread(std::make_shared<EmbeddedEventLoop>());
+            return thread.getLoop();
+        }
+
+        bool isLoopThread() const {
+            return std::this_thread::get_id() == worker.get_id();
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_EVENTLOOPTHREAD_HPP
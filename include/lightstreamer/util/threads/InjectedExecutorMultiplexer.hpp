@@ -0,0 +1,161 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_INJECTEDEXECUTORMULTIPLEXER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_INJECTEDEXECUTORMULTIPLEXER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <lightstreamer/util/threads/InlineTask.hpp>
+#include <lightstreamer/util/threads/MpscQueue.hpp>
+#include <lightstreamer/util/threads/ThreadMultiplexer.hpp>
+#include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
+#include <lightstreamer/util/threads/providers/JoinableScheduler.hpp>
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * A multiplexer starting no thread: tasks run on an executor and a scheduler supplied by the
+     * application (e.g. adapters over its event loop or its own pool).
+     *
+     * The tasks of all its sources are serialized, as on a single session thread, whatever the number of
+     * threads of the executor: they are queued on a lock-free queue drained by one executor task at a time,
+     * in batches of at most MAX_BATCH so that the executor keeps serving its other work. Delayed tasks are
+     * handed to the scheduler and enter the same queue when they expire.
+     */
+    template<typename S>
+    class InjectedExecutorMultiplexer : public ThreadMultiplexer<S> {
+    public:
+        static constexpr std::size_t MAX_BATCH = 256;
+
+    private:
+        /**
+         * The queue and its drain state, kept alive by the submitted drain task.
+         */
+        struct Strand : std::enable_shared_from_this<Strand> {
+            std::shared_ptr<providers::JoinableExecutor> executor;
+            MpscQueue<InlineTask> tasks;
+            // Tasks pushed and not yet run. The producer taking it from 0 submits the drain task; a drain
+            // task leaving it above 0 submits the next one.
+            std::atomic<std::size_t> pending{0};
+            std::atomic<std::size_t> waiters{0};
+            std::atomic<std::uint64_t> tasksRun{0};
+
+            Strand(std::shared_ptr<providers::JoinableExecutor> executor, std::size_t poolSize)
+                    : executor(std::move(executor)), tasks(poolSize) {}
+
+            void push(InlineTask task) {
+                tasks.push(std::move(task));
+                if (pending.fetch_add(1, std::memory_order_seq_cst) == 0) {
+                    submitDrain();
+                }
+            }
+
+            void submitDrain() {
+                executor->execute([self = this->shared_from_this()] { self->drain(); });
+            }
+
+            void drain() {
+                // Only the tasks counted by pending are sure to be fully pushed.
+                std::size_t batch = std::min(pending.load(std::memory_order_acquire), MAX_BATCH);
+                for (std::size_t i = 0; i < batch; ++i) {
+                    std::optional<InlineTask> task = tasks.tryPop();
+                    task->run();
+                }
+                tasksRun.fetch_add(batch, std::memory_order_relaxed);
+                std::size_t remaining = pending.fetch_sub(batch, std::memory_order_seq_cst) - batch;
+                if (remaining > 0) {
+                    submitDrain();
+                } else if (waiters.load(std::memory_order_seq_cst) > 0) {
+                    pending.notify_all();
+                }
+            }
+
+            void await() {
+                waiters.fetch_add(1, std::memory_order_seq_cst);
+                std::size_t current = pending.load(std::memory_order_seq_cst);
+                while (current != 0) {
+                    pending.wait(current, std::memory_order_seq_cst);
+                    current = pending.load(std::memory_order_seq_cst);
+                }
+                waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+        };
+
+        std::shared_ptr<Strand> strand;
+        std::shared_ptr<providers::JoinableScheduler> scheduler;
+
+    public:
+        /**
+         * @param executor The executor running the tasks.
+         * @param scheduler The scheduler timing the delayed tasks; they still run on the executor.
+         * @param poolSize The number of preallocated queue nodes.
+         * @throws std::invalid_argument if executor or scheduler is null.
+         */
+        InjectedExecutorMultiplexer(std::shared_ptr<providers::JoinableExecutor> executor,
+                                    std::shared_ptr<providers::JoinableScheduler> scheduler,
+                                    std::size_t poolSize = 1024)
+                : scheduler(std::move(scheduler)) {
+            if (!executor || !this->scheduler) {
+                throw std::invalid_argument("Specify both an executor and a scheduler");
+            }
+            strand = std::make_shared<Strand>(std::move(executor), poolSize);
+        }
+
+        void execute(S, InlineTask runnable) override {
+            strand->push(std::move(runnable));
+        }
+
+        std::shared_ptr<Cancellable> schedule(S, InlineTask task, long delayMillis) override {
+            return scheduler->schedule([strand = strand, task = std::move(task)]() mutable {
+                strand->push(std::move(task));
+            }, delayMillis);
+        }
+
+        /**
+         * Waits until no immediate task is pending or running. Must not be called from a task of this
+         * multiplexer; delayed tasks not yet expired are not waited for.
+         */
+        void await() override {
+            strand->await();
+        }
+
+        /**
+         * @return The number of tasks run so far, delayed ones included.
+         */
+        std::uint64_t getTaskCount() const {
+            return strand->tasksRun.load(std::memory_order_relaxed);
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_INJECTEDEXECUTORMULTIPLEXER_HPP
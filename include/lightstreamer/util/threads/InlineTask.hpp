@@ -0,0 +1,194 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_INLINETASK_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_INLINETASK_HPP
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * Receives the exceptions escaping a task, on the thread that ran it.
+     */
+    class UncaughtExceptionHandler {
+    public:
+        virtual ~UncaughtExceptionHandler() = default;
+
+        virtual void onUncaughtException(const std::exception &e) = 0;
+    };
+
+    /**
+     * Move-only type-erased task with inline storage.
+     *
+     * Callables up to INLINE_SIZE bytes that are nothrow move constructible are stored inside the
+     * object, so wrapping a lambda costs no allocation; bigger ones are moved to the heap. Unlike
+     * std::function, the callable does not need to be copyable.
+     *
+     * A task can carry an UncaughtExceptionHandler; executors call it from their run loop when the
+     * task throws, instead of wrapping the task in another closure.
+     */
+    class InlineTask {
+    public:
+        static constexpr std::size_t INLINE_SIZE = 64;
+
+    private:
+        struct VTable {
+            void (*invoke)(void *storage);
+            void (*move)(void *from, void *to) noexcept;
+            void (*destroy)(void *storage) noexcept;
+        };
+
+        template<typename F>
+        static constexpr bool fitsInline = sizeof(F) <= INLINE_SIZE &&
+                                           alignof(F) <= alignof(std::max_align_t) &&
+                                           std::is_nothrow_move_constructible_v<F>;
+
+        template<typename F>
+        static const VTable *inlineVTable() {
+            static const VTable table{
+                    [](void *storage) { (*static_cast<F *>(storage))(); },
+                    [](void *from, void *to) noexcept {
+                        ::new(to) F(std::move(*static_cast<F *>(from)));
+                        static_cast<F *>(from)->~F();
+                    },
+                    [](void *storage) noexcept { static_cast<F *>(storage)->~F(); }
+            };
+            return &table;
+        }
+
+        template<typename F>
+        static const VTable *heapVTable() {
+            static const VTable table{
+                    [](void *storage) { (**static_cast<F **>(storage))(); },
+                    [](void *from, void *to) noexcept { *static_cast<F **>(to) = *static_cast<F **>(from); },
+                    [](void *storage) noexcept { delete *static_cast<F **>(storage); }
+            };
+            return &table;
+        }
+
+        alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+        const VTable *vtable = nullptr;
+        UncaughtExceptionHandler *exceptionHandler = nullptr;
+
+        void reset() noexcept {
+            if (vtable) {
+                vtable->destroy(storage);
+                vtable = nullptr;
+            }
+        }
+
+    public:
+        InlineTask() noexcept = default;
+
+        InlineTask(std::nullptr_t) noexcept {}
+
+        template<typename F, typename D = std::decay_t<F>,
+                typename = std::enable_if_t<!std::is_same_v<D, InlineTask> && std::is_invocable_v<D &>>>
+        InlineTask(F &&f) {
+            if constexpr (fitsInline<D>) {
+                ::new(static_cast<void *>(storage)) D(std::forward<F>(f));
+                vtable = inlineVTable<D>();
+            } else {
+                *reinterpret_cast<D **>(storage) = new D(std::forward<F>(f));
+                vtable = heapVTable<D>();
+            }
+        }
+
+        InlineTask(InlineTask &&other) noexcept: vtable(other.vtable), exceptionHandler(other.exceptionHandler) {
+            if (vtable) {
+                vtable->move(other.storage, storage);
+                other.vtable = nullptr;
+            }
+        }
+
+        InlineTask &operator=(InlineTask &&other) noexcept {
+            if (this != &other) {
+                reset();
+                vtable = other.vtable;
+                exceptionHandler = other.exceptionHandler;
+                if (vtable) {
+                    vtable->move(other.storage, storage);
+                    other.vtable = nullptr;
+                }
+            }
+            return *this;
+        }
+
+        InlineTask(const InlineTask &) = delete;
+        InlineTask &operator=(const InlineTask &) = delete;
+
+        ~InlineTask() {
+            reset();
+        }
+
+        explicit operator bool() const noexcept {
+            return vtable != nullptr;
+        }
+
+        /**
+         * Runs the task.
+         *
+         * @throws std::bad_function_call if the task is empty.
+         */
+        void operator()() {
+            if (!vtable) {
+                throw std::bad_function_call();
+            }
+            vtable->invoke(storage);
+        }
+
+        void setExceptionHandler(UncaughtExceptionHandler *handler) noexcept {
+            exceptionHandler = handler;
+        }
+
+        UncaughtExceptionHandler *getExceptionHandler() const noexcept {
+            return exceptionHandler;
+        }
+
+        /**
+         * Runs the task from an executor run loop: exceptions are forwarded to the task's handler,
+         * if any, and rethrown otherwise.
+         */
+        void run() {
+            if (!exceptionHandler) {
+                (*this)();
+                return;
+            }
+            try {
+                (*this)();
+            } catch (const std::exception &e) {
+                exceptionHandler->onUncaughtException(e);
+            }
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_INLINETASK_HPP
@@ -23,46 +23,252 @@
 
 #ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_JOINABLEPOOLEXECUTOR_HPP
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_JOINABLEPOOLEXECUTOR_HPP
-#include <thread>
-#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <functional>
-#include <stdexcept>
+#include <cstddef>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 #include <lightstreamer/util/threads/providers/JoinableExecutor.hpp>
+#include <lightstreamer/util/threads/ThreadConfig.hpp>
 
 namespace lightstreamer::util::threads {
 
+    /**
+     * Work-stealing thread pool with up to maxThreads workers.
+     *
+     * Each worker owns a deque: tasks submitted from a worker thread are pushed to the back of its own
+     * deque and popped from the back (LIFO, cache-warm), while tasks submitted from other threads go to a
+     * shared injection queue. An idle worker takes work from its own deque, then from the injection queue,
+     * then steals from the front of the other workers' deques; only when all of them are empty it parks.
+     *
+     * Workers are started on demand, when a task arrives and no worker is idle, and terminate after
+     * keepAliveTime milliseconds without work, so the pool shrinks back to zero threads when unused.
+     */
     class JoinablePoolExecutor : public providers::JoinableExecutor {
     private:
-        std::mutex currentThreadLock;
-        std::condition_variable cv;
-        std::unique_ptr<std::thread> currentThread;
+        struct Worker {
+            std::mutex mutex;
+            std::deque<InlineTask> tasks;
+            std::thread thread;
+            // Guarded by the pool lock.
+            bool active = false;
+        };
+
+        struct Current {
+            JoinablePoolExecutor *pool = nullptr;
+            std::size_t index = 0;
+        };
+
+        static Current &current() {
+            thread_local Current instance;
+            return instance;
+        }
+
+        long keepAliveTime;
+        ThreadRole role;
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        std::mutex lock;
+        std::condition_variable workAvailable;
+        std::condition_variable drained;
+        std::deque<InlineTask> injected;
+        bool stop = false;
+        // Written under lock, read without it on the submission fast path.
+        std::atomic<std::size_t> idle{0};
+        std::atomic<std::size_t> live{0};
+        // Tasks sitting in any queue.
+        std::atomic<std::size_t> queued{0};
+        // Tasks queued or running.
+        std::atomic<std::size_t> outstanding{0};
+
+        // Requires lock.
+        void spawn() {
+            for (std::size_t i = 0; i < workers.size(); ++i) {
+                Worker &worker = *workers[i];
+                if (!worker.active) {
+                    if (worker.thread.joinable()) {
+                        // A worker which has just retired: it no longer needs the lock.
+                        worker.thread.join();
+                    }
+                    worker.active = true;
+                    live.fetch_add(1, std::memory_order_seq_cst);
+                    worker.thread = std::thread([this, i] { work(i); });
+                    return;
+                }
+            }
+        }
+
+        bool popLocal(std::size_t index, InlineTask &task) {
+            Worker &worker = *workers[index];
+            std::lock_guard<std::mutex> guard(worker.mutex);
+            if (worker.tasks.empty()) {
+                return false;
+            }
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            return true;
+        }
+
+        bool popInjected(InlineTask &task) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (injected.empty()) {
+                return false;
+            }
+            task = std::move(injected.front());
+            injected.pop_front();
+            return true;
+        }
+
+        bool steal(std::size_t thief, InlineTask &task) {
+            for (std::size_t step = 1; step < workers.size(); ++step) {
+                Worker &victim = *workers[(thief + step) % workers.size()];
+                std::unique_lock<std::mutex> guard(victim.mutex, std::try_to_lock);
+                if (guard.owns_lock() && !victim.tasks.empty()) {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool findTask(std::size_t index, InlineTask &task) {
+            if (queued.load(std::memory_order_seq_cst) == 0) {
+                return false;
+            }
+            if (popLocal(index, task) || popInjected(task) || steal(index, task)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        void work(std::size_t index) {
+            ThreadConfig::getInstance().applyToCurrentThread(role);
+            current() = {this, index};
+            InlineTask task;
+            while (true) {
+                if (findTask(index, task)) {
+                    task.run();
+                    task = nullptr;
+                    if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        std::lock_guard<std::mutex> guard(lock);
+                        drained.notify_all();
+                    }
+                    continue;
+                }
+                std::unique_lock<std::mutex> ul(lock);
+                if (queued.load(std::memory_order_seq_cst) > 0 && !stop) {
+                    // A steal attempt lost a race with the victim: retry.
+                    continue;
+                }
+                idle.fetch_add(1, std::memory_order_seq_cst);
+                bool woken = workAvailable.wait_for(ul, std::chrono::milliseconds(keepAliveTime), [this] {
+                    return stop || queued.load(std::memory_order_seq_cst) > 0;
+                });
+                idle.fetch_sub(1, std::memory_order_seq_cst);
+                if (stop || !woken) {
+                    workers[index]->active = false;
+                    live.fetch_sub(1, std::memory_order_seq_cst);
+                    current() = {};
+                    return;
+                }
+            }
+        }
 
     public:
-        void execute(std::function<void()> task) override {
-            std::lock_guard<std::mutex> lock(currentThreadLock);
-            if (currentThread && currentThread->joinable()) {
-                // Task execution is pending. Real implementation should queue tasks for execution.
-                throw std::runtime_error("Execution not implemented. Task execution is already in progress.");
-            } else {
-                // Start the task in a new thread.
-                currentThread = std::make_unique<std::thread>(task);
-                cv.notify_one();
+        /**
+         * @param maxThreads The maximum number of workers.
+         * @param threadName Ignored: the workers are named after their role (see ThreadSettings::name).
+         * @param keepAliveTime Milliseconds an idle worker waits for new tasks before terminating.
+         * @param role The role whose ThreadConfig settings apply to the workers.
+         * @throws std::invalid_argument if maxThreads is not positive.
+         */
+        JoinablePoolExecutor(int maxThreads, const std::string &threadName, long keepAliveTime,
+                             ThreadRole role = ThreadRole::TRANSPORT)
+                : keepAliveTime(keepAliveTime), role(role) {
+            (void) threadName;
+            if (maxThreads <= 0) {
+                throw std::invalid_argument("The pool needs at least one thread");
+            }
+            for (int i = 0; i < maxThreads; ++i) {
+                workers.push_back(std::make_unique<Worker>());
             }
         }
 
-        void join() override {
-            std::unique_lock<std::mutex> lock(currentThreadLock);
-            cv.wait(lock, [this] { return currentThread != nullptr; }); // Wait until a task is being executed
+        JoinablePoolExecutor(const JoinablePoolExecutor &) = delete;
+        JoinablePoolExecutor &operator=(const JoinablePoolExecutor &) = delete;
 
-            if (currentThread->joinable()) {
-                currentThread->join(); // Wait for the task to complete
+        ~JoinablePoolExecutor() override {
+            join();
+        }
+
+        void execute(InlineTask task) override {
+            if (!task) {
+                throw std::invalid_argument("Specify a task");
+            }
+            outstanding.fetch_add(1, std::memory_order_relaxed);
+            Current &self = current();
+            if (self.pool == this) {
+                Worker &worker = *workers[self.index];
+                std::lock_guard<std::mutex> guard(worker.mutex);
+                worker.tasks.push_back(std::move(task));
+                queued.fetch_add(1, std::memory_order_seq_cst);
+            } else {
+                std::lock_guard<std::mutex> guard(lock);
+                injected.push_back(std::move(task));
+                queued.fetch_add(1, std::memory_order_seq_cst);
+            }
+            // Either an idle worker takes the task or, if none is idle and the pool is not full, a new
+            // one is started; busy workers find it when they look for their next task.
+            if (idle.load(std::memory_order_seq_cst) > 0 || live.load(std::memory_order_seq_cst) < workers.size()) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (idle.load(std::memory_order_relaxed) > 0) {
+                    workAvailable.notify_one();
+                } else if (live.load(std::memory_order_relaxed) < workers.size()) {
+                    spawn();
+                }
             }
+        }
 
-            while (currentThread && currentThread->joinable()) {
-                // Loop until the current thread has finished execution
+        /**
+         * Waits until every submitted task has run, then stops the workers. The pool can be used again
+         * afterwards. Must not be called from a worker.
+         */
+        void join() override {
+            if (current().pool == this) {
+                throw std::logic_error("A pool cannot be joined by one of its workers");
+            }
+            std::vector<std::thread> threads;
+            {
+                std::unique_lock<std::mutex> ul(lock);
+                drained.wait(ul, [this] { return outstanding.load(std::memory_order_acquire) == 0; });
+                stop = true;
+                workAvailable.notify_all();
+                for (auto &worker: workers) {
+                    if (worker->thread.joinable()) {
+                        threads.push_back(std::move(worker->thread));
+                    }
+                }
+            }
+            for (auto &thread: threads) {
+                thread.join();
             }
+            std::lock_guard<std::mutex> guard(lock);
+            stop = false;
+        }
+
+        /**
+         * @return The number of running workers.
+         */
+        std::size_t getPoolSize() const {
+            return live.load(std::memory_order_relaxed);
         }
     };
 }
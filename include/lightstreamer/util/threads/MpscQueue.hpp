@@ -0,0 +1,227 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_MPSCQUEUE_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_MPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * Intrusive lock-free multi-producer / single-consumer queue.
+     *
+     * Producers link nodes with a single atomic exchange on the head (Vyukov's algorithm), so
+     * enqueuing never takes a lock. Nodes are taken from a bounded pool allocated up front; when the
+     * pool is exhausted the queue falls back to heap nodes, so producers are never blocked, and those
+     * nodes are freed instead of recycled once consumed.
+     *
+     * Only one thread at a time may call the consumer side (tryPop(), drain()).
+     *
+     * @tparam T The element type. It must be move constructible.
+     */
+    template<typename T>
+    class MpscQueue {
+    private:
+        static constexpr std::uint32_t NO_NODE = UINT32_MAX;
+
+        struct Node {
+            std::atomic<Node*> next{nullptr};
+            std::optional<T> value;
+            std::atomic<std::uint32_t> nextFree{NO_NODE};
+            std::uint32_t index = NO_NODE; // NO_NODE for heap nodes
+        };
+
+        // Producer side: last linked node.
+        alignas(64) std::atomic<Node*> head;
+        // Consumer side: current stub, whose successor holds the next value.
+        alignas(64) Node* tail;
+        // Free list of pool nodes, tagged with a counter in the upper 32 bits to avoid ABA.
+        alignas(64) std::atomic<std::uint64_t> freeHead{NO_NODE};
+        std::atomic<std::size_t> overflowCount{0};
+
+        std::unique_ptr<Node[]> pool;
+        std::size_t capacity;
+
+        Node* acquireNode() {
+            std::uint64_t current = freeHead.load(std::memory_order_acquire);
+            while (static_cast<std::uint32_t>(current) != NO_NODE) {
+                Node* candidate = &pool[static_cast<std::uint32_t>(current)];
+                std::uint64_t next = (((current >> 32) + 1) << 32) |
+                                     candidate->nextFree.load(std::memory_order_relaxed);
+                if (freeHead.compare_exchange_weak(current, next, std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+                    return candidate;
+                }
+            }
+            overflowCount.fetch_add(1, std::memory_order_relaxed);
+            return new Node();
+        }
+
+        void releaseNode(Node* node) {
+            if (node->index == NO_NODE) {
+                delete node;
+                return;
+            }
+            std::uint64_t current = freeHead.load(std::memory_order_relaxed);
+            std::uint64_t next;
+            do {
+                node->nextFree.store(static_cast<std::uint32_t>(current), std::memory_order_relaxed);
+                next = (((current >> 32) + 1) << 32) | node->index;
+            } while (!freeHead.compare_exchange_weak(current, next, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+        }
+
+        void link(Node* node) {
+            node->next.store(nullptr, std::memory_order_relaxed);
+            Node* prev = head.exchange(node, std::memory_order_seq_cst);
+            prev->next.store(node, std::memory_order_release);
+        }
+
+        /**
+         * Waits for the successor of the tail when a producer has already swapped the head but has not
+         * linked its node yet. The window is a couple of instructions wide, so spinning is cheap.
+         */
+        Node* awaitNext() {
+            Node* next = tail->next.load(std::memory_order_acquire);
+            while (next == nullptr && head.load(std::memory_order_acquire) != tail) {
+                std::this_thread::yield();
+                next = tail->next.load(std::memory_order_acquire);
+            }
+            return next;
+        }
+
+    public:
+        /**
+         * Creates a queue whose node pool holds the given number of nodes.
+         *
+         * @param poolSize The number of preallocated nodes.
+         */
+        explicit MpscQueue(std::size_t poolSize = 4096) : pool(new Node[poolSize + 1]), capacity(poolSize) {
+            for (std::size_t i = 0; i <= poolSize; ++i) {
+                pool[i].index = static_cast<std::uint32_t>(i);
+            }
+            // The last pool node is the initial stub; the others form the free list.
+            for (std::size_t i = 0; i < poolSize; ++i) {
+                pool[i].nextFree.store(i + 1 < poolSize ? static_cast<std::uint32_t>(i + 1) : NO_NODE,
+                                       std::memory_order_relaxed);
+            }
+            freeHead.store(poolSize > 0 ? 0 : NO_NODE, std::memory_order_relaxed);
+            tail = &pool[poolSize];
+            head.store(tail, std::memory_order_relaxed);
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        ~MpscQueue() {
+            while (tryPop()) {}
+            if (tail->index == NO_NODE) {
+                delete tail;
+            }
+        }
+
+        /**
+         * Enqueues a value. Safe to call from any number of threads concurrently.
+         */
+        template<typename U>
+        void push(U&& value) {
+            Node* node = acquireNode();
+            node->value.emplace(std::forward<U>(value));
+            link(node);
+        }
+
+        /**
+         * Dequeues one value. Consumer thread only.
+         *
+         * @return The value, or an empty optional if the queue is empty.
+         */
+        std::optional<T> tryPop() {
+            Node* next = awaitNext();
+            if (next == nullptr) {
+                return std::nullopt;
+            }
+            std::optional<T> result(std::move(next->value));
+            next->value.reset();
+            Node* old = tail;
+            tail = next;
+            releaseNode(old);
+            return result;
+        }
+
+        /**
+         * Dequeues up to maxBatch values, passing each one to the given function. Consumer thread only.
+         *
+         * @param consumer A callable taking a T&&.
+         * @param maxBatch The maximum number of values to consume.
+         * @return The number of consumed values.
+         */
+        template<typename F>
+        std::size_t drain(F&& consumer, std::size_t maxBatch) {
+            std::size_t count = 0;
+            while (count < maxBatch) {
+                Node* next = awaitNext();
+                if (next == nullptr) {
+                    break;
+                }
+                T value(std::move(*next->value));
+                next->value.reset();
+                Node* old = tail;
+                tail = next;
+                releaseNode(old);
+                ++count;
+                consumer(std::move(value));
+            }
+            return count;
+        }
+
+        /**
+         * Tells whether the queue is empty. Consumer thread only.
+         */
+        bool empty() const {
+            return head.load(std::memory_order_seq_cst) == tail;
+        }
+
+        /**
+         * The number of nodes preallocated in the pool.
+         */
+        std::size_t poolCapacity() const {
+            return capacity;
+        }
+
+        /**
+         * The number of pushes that found the pool exhausted and had to allocate on the heap.
+         */
+        std::size_t overflowAllocations() const {
+            return overflowCount.load(std::memory_order_relaxed);
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_MPSCQUEUE_HPP
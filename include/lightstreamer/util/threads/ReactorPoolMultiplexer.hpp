@@ -0,0 +1,216 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_REACTORPOOLMULTIPLEXER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_REACTORPOOLMULTIPLEXER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include <lightstreamer/util/threads/ThreadMultiplexer.hpp>
+#include <lightstreamer/util/threads/SingleThreadEventExecutor.hpp>
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * How a ReactorPoolMultiplexer assigns a new source to one of its threads.
+     */
+    enum class ReactorAssignment {
+        /**
+         * The thread with the fewest sources (then the least busy one). A source with no pending task is
+         * moved to a less loaded thread when its own has at least two sources more.
+         */
+        LEAST_LOAD,
+        /**
+         * A thread chosen by hashing the source; the assignment never changes.
+         */
+        HASH
+    };
+
+    /**
+     * A snapshot of the load of one thread of a ReactorPoolMultiplexer.
+     */
+    struct ReactorLoad {
+        /** The sources currently assigned to the thread. */
+        std::size_t sources = 0;
+        /** The immediate tasks waiting to run. */
+        std::size_t queueSize = 0;
+        /** The tasks run so far. */
+        std::uint64_t tasks = 0;
+        /** The time spent running tasks. */
+        std::chrono::nanoseconds busyTime{0};
+    };
+
+    /**
+     * Multiplexes many sources over a pool of N SingleThreadEventExecutors.
+     *
+     * Each source is bound to one thread at a time, so its tasks, immediate and delayed, run in FIFO
+     * order on that thread. Sizing N between one thread per source and one thread for all of them keeps
+     * the memory and context switches of thousands of sessions bounded without capping the throughput
+     * to a single core.
+     */
+    template<typename S>
+    class ReactorPoolMultiplexer : public ThreadMultiplexer<S> {
+    private:
+        struct Binding {
+            std::size_t worker;
+            SingleThreadEventExecutor::Counter inFlight;
+        };
+
+        ReactorAssignment assignment;
+        std::vector<std::unique_ptr<SingleThreadEventExecutor>> workers;
+        std::vector<std::size_t> sourceCount;
+        std::unordered_map<S, Binding> bindings;
+        std::uint64_t rebalanced = 0;
+        mutable std::mutex mtx;
+
+        static std::size_t mix(std::size_t hash) {
+            // Pointers hash to themselves: spread their aligned low bits.
+            std::uint64_t x = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(x ^ (x >> 32));
+        }
+
+        // Requires mtx.
+        std::size_t leastLoaded() const {
+            std::size_t best = 0;
+            for (std::size_t i = 1; i < workers.size(); ++i) {
+                if (sourceCount[i] < sourceCount[best] ||
+                    (sourceCount[i] == sourceCount[best] && workers[i]->getBusyTime() < workers[best]->getBusyTime())) {
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+        // Requires mtx.
+        Binding &bind(const S &source) {
+            auto it = bindings.find(source);
+            if (it == bindings.end()) {
+                std::size_t index = assignment == ReactorAssignment::HASH
+                                    ? mix(std::hash<S>{}(source)) % workers.size()
+                                    : leastLoaded();
+                ++sourceCount[index];
+                it = bindings.emplace(source, Binding{index, std::make_shared<std::atomic<std::size_t>>(0)}).first;
+            } else if (assignment == ReactorAssignment::LEAST_LOAD &&
+                       it->second.inFlight->load(std::memory_order_acquire) == 0) {
+                // Nothing of the source is queued or running: it can change thread without reordering.
+                std::size_t target = leastLoaded();
+                if (sourceCount[it->second.worker] >= sourceCount[target] + 2) {
+                    --sourceCount[it->second.worker];
+                    ++sourceCount[target];
+                    it->second.worker = target;
+                    ++rebalanced;
+                }
+            }
+            return it->second;
+        }
+
+    public:
+        /**
+         * @param threads The number of threads of the pool.
+         * @param assignment How sources are assigned to the threads.
+         * @throws std::invalid_argument if threads is zero.
+         */
+        explicit ReactorPoolMultiplexer(std::size_t threads, ReactorAssignment assignment = ReactorAssignment::LEAST_LOAD)
+                : assignment(assignment), sourceCount(threads, 0) {
+            if (threads == 0) {
+                throw std::invalid_argument("The reactor pool needs at least one thread");
+            }
+            workers.reserve(threads);
+            for (std::size_t i = 0; i < threads; ++i) {
+                workers.push_back(std::make_unique<SingleThreadEventExecutor>(ThreadRole::SESSION, static_cast<int>(i)));
+            }
+        }
+
+        void execute(S source, InlineTask runnable) override {
+            std::lock_guard<std::mutex> lock(mtx);
+            Binding &binding = bind(source);
+            // Counted before the lock is released, so that the source cannot be moved meanwhile.
+            workers[binding.worker]->execute(std::move(runnable), binding.inFlight);
+        }
+
+        std::shared_ptr<Cancellable> schedule(S source, InlineTask task, long delayMillis) override {
+            std::lock_guard<std::mutex> lock(mtx);
+            Binding &binding = bind(source);
+            return workers[binding.worker]->schedule(std::move(task), delayMillis, binding.inFlight);
+        }
+
+        /**
+         * Waits until the threads have no pending immediate tasks.
+         */
+        void await() override {
+            for (auto &worker: workers) {
+                if (!worker->isExecutorThread()) {
+                    worker->await();
+                }
+            }
+        }
+
+        void release(S source) override {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = bindings.find(source);
+            if (it != bindings.end()) {
+                --sourceCount[it->second.worker];
+                bindings.erase(it);
+            }
+        }
+
+        /**
+         * @return The load of each thread of the pool.
+         */
+        std::vector<ReactorLoad> getLoad() const {
+            std::vector<ReactorLoad> load(workers.size());
+            std::lock_guard<std::mutex> lock(mtx);
+            for (std::size_t i = 0; i < workers.size(); ++i) {
+                load[i].sources = sourceCount[i];
+                load[i].queueSize = workers[i]->getQueueSize();
+                load[i].tasks = workers[i]->getTaskCount();
+                load[i].busyTime = workers[i]->getBusyTime();
+            }
+            return load;
+        }
+
+        /**
+         * @return How many times a source has been moved to another thread.
+         */
+        std::uint64_t getRebalanceCount() const {
+            std::lock_guard<std::mutex> lock(mtx);
+            return rebalanced;
+        }
+
+        std::size_t getPoolSize() const {
+            return workers.size();
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_REACTORPOOLMULTIPLEXER_HPP
@@ -0,0 +1,262 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_SINGLETHREADEVENTEXECUTOR_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_SINGLETHREADEVENTEXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <lightstreamer/util/threads/InlineTask.hpp>
+#include <lightstreamer/util/threads/ThreadConfig.hpp>
+#include <lightstreamer/util/threads/TimerWheel.hpp>
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * An executor owning exactly one thread, which runs both immediate and delayed tasks.
+     *
+     * Immediate tasks run in submission order. Delayed tasks are kept in a TimerWheel advanced by the
+     * executor thread itself and moved to the immediate queue when they expire, so a source using a
+     * single executor sees all of its tasks run sequentially on the same thread, and timers cost no
+     * thread of their own.
+     *
+     * A task can be submitted with an in-flight counter, incremented on submission and decremented once
+     * the task has run (or a delayed task has been cancelled), so that the submitter can tell when none of
+     * its tasks is pending (e.g. to move it to another executor without breaking their order).
+     */
+    class SingleThreadEventExecutor {
+    public:
+        using Counter = std::shared_ptr<std::atomic<std::size_t>>;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Entry {
+            InlineTask task;
+            Counter inFlight;
+        };
+
+        // A delayed task's share of an in-flight counter, released when the task is destroyed: once it
+        // has run, or as soon as it is cancelled.
+        class InFlightToken {
+        private:
+            Counter counter;
+
+        public:
+            explicit InFlightToken(Counter counter) : counter(std::move(counter)) {
+                this->counter->fetch_add(1, std::memory_order_relaxed);
+            }
+
+            InFlightToken(InFlightToken &&) noexcept = default;
+            InFlightToken &operator=(InFlightToken &&) = delete;
+
+            ~InFlightToken() {
+                if (counter) {
+                    counter->fetch_sub(1, std::memory_order_release);
+                }
+            }
+        };
+
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        std::condition_variable idle;
+        std::deque<Entry> tasks;
+        std::shared_ptr<TimerWheel> timers = std::make_shared<TimerWheel>([this] { rearm(); });
+        bool waiting = false;
+        bool busy = false;
+        bool stop = false;
+        ThreadRole role;
+        int slot;
+        std::atomic<std::uint64_t> tasksRun{0};
+        std::atomic<std::int64_t> busyNanos{0};
+        std::thread worker;
+
+        // Called by the wheel when a timer earlier than the current deadline is scheduled.
+        void rearm() {
+            bool notify;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                notify = waiting;
+            }
+            if (notify) {
+                wakeUp.notify_one();
+            }
+        }
+
+        void run() {
+            ThreadConfig::getInstance().applyToCurrentThread(role, slot);
+            std::deque<Entry> batch;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                if (!stop) {
+                    timers->advance(Clock::now(), [this](InlineTask &&task) {
+                        tasks.push_back({std::move(task), nullptr});
+                    });
+                }
+                if (!tasks.empty()) {
+                    batch.swap(tasks);
+                    busy = true;
+                    lock.unlock();
+                    auto start = Clock::now();
+                    for (auto &entry: batch) {
+                        entry.task.run();
+                        if (entry.inFlight) {
+                            entry.inFlight->fetch_sub(1, std::memory_order_release);
+                        }
+                    }
+                    busyNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(),
+                                        std::memory_order_relaxed);
+                    tasksRun.fetch_add(batch.size(), std::memory_order_relaxed);
+                    batch.clear();
+                    lock.lock();
+                    busy = false;
+                    if (tasks.empty()) {
+                        idle.notify_all();
+                    }
+                    continue;
+                }
+                if (stop) {
+                    return;
+                }
+                waiting = true;
+                if (auto deadline = timers->nextDeadline()) {
+                    wakeUp.wait_until(lock, *deadline);
+                } else {
+                    wakeUp.wait(lock);
+                }
+                waiting = false;
+            }
+        }
+
+    public:
+        /**
+         * @param role The role whose ThreadConfig settings apply to the thread.
+         * @param slot The index of the executor in its pool, used for per-core pinning; -1 for none.
+         */
+        explicit SingleThreadEventExecutor(ThreadRole role = ThreadRole::SESSION, int slot = -1)
+                : role(role), slot(slot), worker(&SingleThreadEventExecutor::run, this) {}
+
+        SingleThreadEventExecutor(const SingleThreadEventExecutor &) = delete;
+        SingleThreadEventExecutor &operator=(const SingleThreadEventExecutor &) = delete;
+
+        /**
+         * Runs the pending immediate tasks, discards the delayed ones and stops the thread.
+         */
+        ~SingleThreadEventExecutor() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            timers->clear();
+            wakeUp.notify_one();
+            worker.join();
+        }
+
+        void execute(InlineTask task, Counter inFlight = nullptr) {
+            if (inFlight) {
+                inFlight->fetch_add(1, std::memory_order_relaxed);
+            }
+            bool notify;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back({std::move(task), std::move(inFlight)});
+                notify = waiting;
+            }
+            if (notify) {
+                wakeUp.notify_one();
+            }
+        }
+
+        /**
+         * Runs the task after the given delay, unless the returned handle cancels it first, which also
+         * removes it from the wheel.
+         */
+        std::shared_ptr<Cancellable> schedule(InlineTask task, long delayMillis, Counter inFlight = nullptr) {
+            auto [guarded, cancel] = makeCancellable(std::move(task));
+            if (inFlight) {
+                UncaughtExceptionHandler *handler = guarded.getExceptionHandler();
+                guarded = [task = std::move(guarded), token = InFlightToken(std::move(inFlight))]() mutable {
+                    task();
+                };
+                guarded.setExceptionHandler(handler);
+            }
+            cancel->bind(timers->schedule(std::move(guarded), std::chrono::milliseconds(delayMillis)));
+            return cancel;
+        }
+
+        /**
+         * Runs the task after the given delay on the executor thread.
+         *
+         * @return A handle whose cancel() removes the task from the wheel.
+         */
+        TimerWheel::Timer scheduleTimer(InlineTask task, std::chrono::milliseconds delay) {
+            return timers->schedule(std::move(task), delay);
+        }
+
+        /**
+         * Waits until no immediate task is pending or running. Must not be called from the executor thread.
+         */
+        void await() {
+            std::unique_lock<std::mutex> lock(mutex);
+            idle.wait(lock, [this] { return tasks.empty() && !busy; });
+        }
+
+        /**
+         * @return The number of immediate tasks waiting to run.
+         */
+        std::size_t getQueueSize() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return tasks.size();
+        }
+
+        /**
+         * @return The number of tasks run so far, delayed ones included.
+         */
+        std::uint64_t getTaskCount() const {
+            return tasksRun.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return The time the thread has spent running tasks.
+         */
+        std::chrono::nanoseconds getBusyTime() const {
+            return std::chrono::nanoseconds(busyNanos.load(std::memory_order_relaxed));
+        }
+
+        bool isExecutorThread() const {
+            return std::this_thread::get_id() == worker.get_id();
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_SINGLETHREADEVENTEXECUTOR_HPP
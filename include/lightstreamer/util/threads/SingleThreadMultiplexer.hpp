@@ -56,15 +56,13 @@ namespace lightstreamer::util::threads {
             std::cout << "Await done." << std::endl;
         }
 
-        void execute(S source, std::function<void()> runnable) override {
-            executor->execute(runnable);
+        void execute(S source, InlineTask runnable) override {
+            executor->execute(std::move(runnable));
             // Alternatively, you can schedule immediately with scheduler, depending on use case
         }
 
-        std::shared_ptr<std::future<void>> schedule(S source, std::function<void()> task, long delayMillis) override {
-            // Implementation depends on how JoinableScheduler's schedule method is defined.
-            // Here's a simple placeholder assuming schedule returns a future.
-            return scheduler->schedule(task, delayMillis);
+        std::shared_ptr<Cancellable> schedule(S source, InlineTask task, long delayMillis) override {
+            return scheduler->schedule(std::move(task), delayMillis);
         }
     };
 
@@ -25,6 +25,9 @@
 #define LIGHTSTREAMER_LIB_CLIENT_CPP_STATICASSIGNMENTMULTIPLEXER_HPP
 
 #include <lightstreamer/util/threads/ThreadMultiplexer.hpp>
+#include <lightstreamer/util/threads/SingleThreadEventExecutor.hpp>
+#include <algorithm>
+#include <memory>
 #include <vector>
 #include <thread>
 #include <functional>
@@ -37,10 +40,17 @@
 
 namespace lightstreamer::util::threads {
 
+    /**
+     * Multiplexes many sources over a fixed pool of SingleThreadEventExecutors, one per core.
+     *
+     * Each source is assigned a worker the first time it submits a task (round robin) and keeps it, so
+     * the tasks of a source, immediate and delayed, run in FIFO order on one thread, while different
+     * sources spread across cores. The pool is shared by all the instances and created on first use.
+     */
     template<typename S>
     class StaticAssignmentMultiplexer : public ThreadMultiplexer<S> {
     private:
-        static std::vector<std::thread> workers;
+        static std::vector<std::unique_ptr<SingleThreadEventExecutor>> workers;
         static std::atomic<int> nextWorkerIndex;
         static std::mutex mtx;
         std::unordered_map<S, size_t> sourceToWorkerMap;
@@ -49,64 +59,72 @@ namespace lightstreamer::util::threads {
         StaticAssignmentMultiplexer() {
             static std::once_flag flag;
             std::call_once(flag, []() {
-                unsigned int cores = std::thread::hardware_concurrency();
+                unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
                 workers.reserve(cores);
-                for (int i = 0; i < cores; ++i) {
-                    // TODO: Implement SingleThreadEventExecutor
+                for (unsigned int i = 0; i < cores; ++i) {
+                    workers.push_back(std::make_unique<SingleThreadEventExecutor>(ThreadRole::SESSION,
+                                                                                  static_cast<int>(i)));
                 }
                 nextWorkerIndex.store(0);
             });
         }
 
-        ~StaticAssignmentMultiplexer() override {
-            for (auto& worker : workers) {
-                if (worker.joinable()) {
-                    worker.join();
-                }
-            }
+        void execute(S source, InlineTask runnable) override {
+            workers[assignWorkerToSource(source)]->execute(std::move(runnable));
         }
 
-        void execute(S source, std::function<void()> runnable) override {
-            size_t workerIndex = assignWorkerToSource(source);
-            // Execute the task immediately in a new thread for simplicity
-            std::thread([runnable]() {
-                runnable();
-            }).detach();
+        std::shared_ptr<Cancellable> schedule(S source, InlineTask task, long delayMillis) override {
+            return workers[assignWorkerToSource(source)]->schedule(std::move(task), delayMillis);
         }
 
-        std::shared_ptr<std::promise<void>> schedule(S source, std::function<void()> task, long delayMillis) override {
-            size_t workerIndex = assignWorkerToSource(source);
-            auto promise = std::make_shared<std::promise<void>>();
-            auto future = promise->get_future();
-            // Schedule task with delay
-            std::thread([task, delayMillis, promise]() {
-                std::this_thread::sleep_for(std::chrono::milliseconds(delayMillis));
-                if (future.wait_for(std::chrono::seconds(0)) == std::future_status::timeout) {
-                    task();
-                }
-                promise->set_value();
-            }).detach();
-            return promise;
+        /**
+         * Forgets the worker of the source. Tasks already submitted still run there; a task submitted
+         * later gets the next worker in round robin.
+         */
+        void release(S source) override {
+            std::lock_guard<std::mutex> lock(mtx);
+            sourceToWorkerMap.erase(source);
         }
 
+        /**
+         * Waits until the workers used by this multiplexer have no pending tasks.
+         */
         void await() override {
-            // Implementation depends on the actual task queuing and completion tracking mechanism
+            std::vector<size_t> used;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                for (const auto &entry: sourceToWorkerMap) {
+                    used.push_back(entry.second);
+                }
+            }
+            std::sort(used.begin(), used.end());
+            used.erase(std::unique(used.begin(), used.end()), used.end());
+            for (size_t index: used) {
+                if (!workers[index]->isExecutorThread()) {
+                    workers[index]->await();
+                }
+            }
+        }
+
+        static size_t getPoolSize() {
+            return workers.size();
         }
 
     private:
         size_t assignWorkerToSource(const S& source) {
             std::lock_guard<std::mutex> lock(mtx);
-            if (sourceToWorkerMap.find(source) == sourceToWorkerMap.end()) {
-                size_t workerIndex = nextWorkerIndex.fetch_add(1) % workers.size();
-                sourceToWorkerMap[source] = workerIndex;
+            auto it = sourceToWorkerMap.find(source);
+            if (it == sourceToWorkerMap.end()) {
+                size_t workerIndex = static_cast<size_t>(nextWorkerIndex.fetch_add(1)) % workers.size();
+                sourceToWorkerMap.emplace(source, workerIndex);
                 return workerIndex;
             }
-            return sourceToWorkerMap[source];
+            return it->second;
         }
     };
 
     template<typename S>
-    std::vector<std::thread> StaticAssignmentMultiplexer<S>::workers;
+    std::vector<std::unique_ptr<SingleThreadEventExecutor>> StaticAssignmentMultiplexer<S>::workers;
 
     template<typename S>
     std::atomic<int> StaticAssignmentMultiplexer<S>::nextWorkerIndex(0);
@@ -116,6 +134,4 @@ namespace lightstreamer::util::threads {
 
 }
 
-
-
 #endif //LIGHTSTREAMER_LIB_CLIENT_CPP_STATICASSIGNMENTMULTIPLEXER_HPP
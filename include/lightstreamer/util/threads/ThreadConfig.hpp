@@ -0,0 +1,174 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_THREADCONFIG_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_THREADCONFIG_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * The roles of the threads started by the library.
+     */
+    enum class ThreadRole {
+        /** The threads delivering events to the listeners. */
+        EVENTS,
+        /** The session thread, running the protocol. */
+        SESSION,
+        /** Threads owned by the transport providers (socket I/O). */
+        TRANSPORT,
+        /** Threads running delayed tasks. */
+        TIMER
+    };
+
+    /**
+     * OS-level settings for the threads of a role. Default values leave the thread as created.
+     */
+    struct ThreadSettings {
+        /**
+         * Name prefix; a sequence number is appended. Linux truncates names to 15 characters.
+         */
+        std::string name;
+        /**
+         * The CPUs the threads may run on; empty for no restriction.
+         */
+        std::vector<int> cpus;
+        /**
+         * SCHED_FIFO priority (1-99); 0 keeps the default time-sharing policy. Requires CAP_SYS_NICE or
+         * an adequate RLIMIT_RTPRIO.
+         */
+        int fifoPriority = 0;
+    };
+
+    /**
+     * Process-wide configuration of the threads started by the library.
+     *
+     * Settings are read when a thread starts, so they must be set before the library is actually used.
+     * Failures (e.g. missing privileges for SCHED_FIFO) do not prevent the thread from running; they are
+     * reported by the return value of applyToCurrentThread().
+     */
+    class ThreadConfig {
+    private:
+        static constexpr std::size_t ROLES = 4;
+
+        mutable std::mutex mutex;
+        std::array<ThreadSettings, ROLES> settings{{
+                {"ls-events", {}, 0},
+                {"ls-session", {}, 0},
+                {"ls-transport", {}, 0},
+                {"ls-timer", {}, 0}
+        }};
+        std::array<std::atomic<unsigned>, ROLES> counters{};
+
+        ThreadConfig() = default;
+
+    public:
+        ThreadConfig(const ThreadConfig &) = delete;
+        ThreadConfig &operator=(const ThreadConfig &) = delete;
+
+        static ThreadConfig &getInstance() {
+            static ThreadConfig instance;
+            return instance;
+        }
+
+        /**
+         * @throws std::invalid_argument if the priority is out of the 0-99 range.
+         */
+        void setSettings(ThreadRole role, ThreadSettings roleSettings) {
+            if (roleSettings.fifoPriority < 0 || roleSettings.fifoPriority > 99) {
+                throw std::invalid_argument("SCHED_FIFO priority must be between 1 and 99 (0 to disable)");
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            settings[static_cast<std::size_t>(role)] = std::move(roleSettings);
+        }
+
+        ThreadSettings getSettings(ThreadRole role) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return settings[static_cast<std::size_t>(role)];
+        }
+
+        /**
+         * Applies the settings of the given role to the calling thread. Called by the library at the
+         * start of each of its threads.
+         *
+         * @param role The role of the thread.
+         * @param slot For per-core pools, the index of the thread in the pool: the thread is pinned to
+         * the slot-th CPU of the role (modulo their number) instead of the whole set. -1 for no slot.
+         * @return false if any of the settings could not be applied.
+         */
+        bool applyToCurrentThread(ThreadRole role, int slot = -1) {
+            ThreadSettings current = getSettings(role);
+            unsigned seq = counters[static_cast<std::size_t>(role)].fetch_add(1, std::memory_order_relaxed);
+            bool ok = true;
+#if defined(__linux__)
+            pthread_t self = pthread_self();
+            if (!current.name.empty()) {
+                std::string name = (current.name + "-" + std::to_string(seq)).substr(0, 15);
+                ok &= pthread_setname_np(self, name.c_str()) == 0;
+            }
+            if (!current.cpus.empty()) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                if (slot >= 0) {
+                    int cpu = current.cpus[static_cast<std::size_t>(slot) % current.cpus.size()];
+                    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                        CPU_SET(cpu, &set);
+                    }
+                } else {
+                    for (int cpu : current.cpus) {
+                        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                            CPU_SET(cpu, &set);
+                        }
+                    }
+                }
+                ok &= pthread_setaffinity_np(self, sizeof(set), &set) == 0;
+            }
+            if (current.fifoPriority > 0) {
+                sched_param param{};
+                param.sched_priority = current.fifoPriority;
+                ok &= pthread_setschedparam(self, SCHED_FIFO, &param) == 0;
+            }
+#else
+            (void) seq;
+            (void) slot;
+            ok = current.cpus.empty() && current.fifoPriority == 0;
+#endif
+            return ok;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_THREADCONFIG_HPP
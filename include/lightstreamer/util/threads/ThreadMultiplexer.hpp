@@ -26,6 +26,8 @@
 #include <functional>
 #include <future>
 #include <memory>
+#include <lightstreamer/util/threads/Cancellable.hpp>
+#include <lightstreamer/util/threads/InlineTask.hpp>
 
 namespace lightstreamer::util::threads {
 
@@ -38,24 +40,32 @@ namespace lightstreamer::util::threads {
          * Executes the given task.
          *
          * @param source The source object associated with the task.
-         * @param runnable The task to execute, represented as a std::function<void()>.
+         * @param runnable The task to execute.
          */
-        virtual void execute(S source, std::function<void()> runnable) = 0;
+        virtual void execute(S source, InlineTask runnable) = 0;
 
         /**
          * Schedules the given task to be executed after a delay.
          *
          * @param source The source object associated with the task.
-         * @param task The task to execute, represented as a std::function<void()>.
+         * @param task The task to execute.
          * @param delayMillis The delay in milliseconds before the task is executed.
-         * @return A shared_ptr to a std::promise<void> that can be used to signal cancellation.
+         * @return A handle cancelling the task, if it has not run yet.
          */
-        virtual std::shared_ptr<std::promise<void>> schedule(S source, std::function<void()> task, long delayMillis) = 0;
+        virtual std::shared_ptr<Cancellable> schedule(S source, InlineTask task, long delayMillis) = 0;
 
         /**
          * Waits for all scheduled tasks to complete.
          */
         virtual void await() = 0;
+
+        /**
+         * Tells the multiplexer that the source will submit no more tasks, so that any state kept for it
+         * can be dropped.
+         *
+         * @param source The source object.
+         */
+        virtual void release([[maybe_unused]] S source) {}
     };
 
 }
@@ -0,0 +1,484 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_TIMERWHEEL_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_TIMERWHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <thread>
+#include <vector>
+#include <lightstreamer/util/threads/Cancellable.hpp>
+#include <lightstreamer/util/threads/InlineTask.hpp>
+#include <lightstreamer/util/threads/ThreadConfig.hpp>
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * Hierarchical timing wheel with millisecond ticks.
+     *
+     * Four levels of 64 slots cover about 4.6 hours; longer timers wait in an overflow list re-examined
+     * every time the top level wraps. A timer is linked in the lowest level whose rotation contains its
+     * expiry, and moved down (cascaded) as time reaches its slot, so scheduling and cancelling are O(1)
+     * and advance() jumps from one occupied slot to the next, its cost depending on the number of
+     * expiring timers rather than on the time elapsed.
+     *
+     * The wheel does not own a thread: its owner calls advance() when nextDeadline() is reached and
+     * receives the expired tasks. All methods are thread safe; tasks are handed over outside the lock.
+     */
+    class TimerWheel : public std::enable_shared_from_this<TimerWheel> {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+    private:
+        static constexpr unsigned LEVELS = 4;
+        static constexpr unsigned SLOT_BITS = 6;
+        static constexpr unsigned SLOTS = 1u << SLOT_BITS;
+        static constexpr std::uint64_t NO_TICK = std::numeric_limits<std::uint64_t>::max();
+
+        struct Node {
+            Node *prev = nullptr;
+            Node *next = nullptr;
+            Node **list = nullptr; // the head of the list the node is linked in, if any
+            std::uint64_t expiry = 0;
+            std::uint64_t sequence = 0;
+            InlineTask task;
+            // Keeps the node alive while it is linked; handles only hold weak references.
+            std::shared_ptr<Node> self;
+        };
+
+        mutable std::mutex mutex;
+        Clock::time_point origin;
+        std::uint64_t current = 0;
+        std::array<std::array<Node *, SLOTS>, LEVELS> slots{};
+        Node *overflow = nullptr;
+        std::size_t count = 0;
+        std::uint64_t nextSequence = 0;
+        // The deadline last reported by nextDeadline(); an earlier timer triggers the rearm hook.
+        std::uint64_t armed = NO_TICK;
+        std::function<void()> rearm;
+
+        static void pushFront(Node *&head, Node *node) {
+            node->prev = nullptr;
+            node->next = head;
+            if (head) {
+                head->prev = node;
+            }
+            head = node;
+            node->list = &head;
+        }
+
+        static void unlink(Node *node) {
+            if (node->prev) {
+                node->prev->next = node->next;
+            } else {
+                *node->list = node->next;
+            }
+            if (node->next) {
+                node->next->prev = node->prev;
+            }
+            node->prev = node->next = nullptr;
+            node->list = nullptr;
+        }
+
+        // Requires node->expiry >= current; a node expiring at current goes to the slot about to be processed.
+        void place(Node *node) {
+            std::uint64_t expiry = node->expiry;
+            for (unsigned level = 0; level < LEVELS; ++level) {
+                unsigned shift = SLOT_BITS * (level + 1);
+                // The lowest level whose current rotation contains the expiry.
+                if ((expiry >> shift) == (current >> shift)) {
+                    pushFront(slots[level][(expiry >> (SLOT_BITS * level)) & (SLOTS - 1)], node);
+                    return;
+                }
+            }
+            pushFront(overflow, node);
+        }
+
+        void cascade(Node *&head) {
+            Node *node = head;
+            head = nullptr;
+            while (node) {
+                Node *next = node->next;
+                place(node);
+                node = next;
+            }
+        }
+
+        std::uint64_t toTick(Clock::time_point time) const {
+            if (time <= origin) {
+                return 0;
+            }
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time - origin).count());
+        }
+
+        std::uint64_t nextTick() const {
+            if (count == 0) {
+                return NO_TICK;
+            }
+            for (unsigned level = 0; level < LEVELS; ++level) {
+                unsigned shift = SLOT_BITS * level;
+                unsigned index = (current >> shift) & (SLOTS - 1);
+                for (unsigned i = index + 1; i < SLOTS; ++i) {
+                    if (slots[level][i]) {
+                        // Exact expiry at level 0, the cascade point above.
+                        std::uint64_t rotation = (current >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+                        return rotation | (static_cast<std::uint64_t>(i) << shift);
+                    }
+                }
+            }
+            return ((current >> (SLOT_BITS * LEVELS)) + 1) << (SLOT_BITS * LEVELS);
+        }
+
+    public:
+        /**
+         * A cancellable reference to a scheduled task.
+         */
+        class Timer {
+        private:
+            friend class TimerWheel;
+            std::weak_ptr<TimerWheel> wheel;
+            std::weak_ptr<Node> node;
+
+        public:
+            Timer() = default;
+
+            /**
+             * Cancels the task if it has not expired yet.
+             *
+             * @return true if the task was cancelled.
+             */
+            bool cancel() {
+                auto owner = wheel.lock();
+                return owner && owner->cancel(*this);
+            }
+        };
+
+        /**
+         * @param rearm Called (outside the lock) when a timer is scheduled earlier than the last deadline
+         * returned by nextDeadline(), so that the owner can wake up and re-read it.
+         */
+        explicit TimerWheel(std::function<void()> rearm = nullptr) : origin(Clock::now()), rearm(std::move(rearm)) {}
+
+        TimerWheel(const TimerWheel &) = delete;
+        TimerWheel &operator=(const TimerWheel &) = delete;
+
+        ~TimerWheel() {
+            clear();
+        }
+
+        Timer schedule(InlineTask task, std::chrono::milliseconds delay) {
+            auto node = std::make_shared<Node>();
+            node->task = std::move(task);
+            bool earlier;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::uint64_t now = toTick(Clock::now());
+                // Rounded up: a timer never fires before its delay.
+                node->expiry = std::max(now, current) + static_cast<std::uint64_t>(std::max<long long>(delay.count(), 0)) + 1;
+                node->sequence = nextSequence++;
+                node->self = node;
+                place(node.get());
+                ++count;
+                earlier = node->expiry < armed;
+                if (earlier) {
+                    armed = node->expiry;
+                }
+            }
+            if (earlier && rearm) {
+                rearm();
+            }
+            Timer timer;
+            timer.wheel = weak_from_this();
+            timer.node = node;
+            return timer;
+        }
+
+        bool cancel(const Timer &timer) {
+            std::shared_ptr<Node> node;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                node = timer.node.lock();
+                if (!node || !node->list) {
+                    return false;
+                }
+                unlink(node.get());
+                --count;
+                node->self.reset();
+            }
+            // The task is destroyed here, outside the lock.
+            return true;
+        }
+
+        /**
+         * Moves the wheel forward to the given time, passing each expired task to sink, in expiry order.
+         *
+         * @param sink A callable taking an InlineTask&&, called outside the lock.
+         * @return The number of expired tasks.
+         */
+        template<typename F>
+        std::size_t advance(Clock::time_point now, F &&sink) {
+            std::vector<std::shared_ptr<Node>> expired;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::uint64_t target = toTick(now);
+                armed = NO_TICK;
+                while (current < target) {
+                    // The ticks in between have no timer to expire or cascade.
+                    std::uint64_t next = nextTick();
+                    if (next > target) {
+                        current = target;
+                        break;
+                    }
+                    current = next;
+                    if ((current & ((1ull << (SLOT_BITS * LEVELS)) - 1)) == 0) {
+                        cascade(overflow);
+                    }
+                    for (unsigned level = LEVELS - 1; level > 0; --level) {
+                        unsigned shift = SLOT_BITS * level;
+                        if ((current & ((1ull << shift) - 1)) == 0) {
+                            cascade(slots[level][(current >> shift) & (SLOTS - 1)]);
+                        }
+                    }
+                    Node *&head = slots[0][current & (SLOTS - 1)];
+                    std::size_t first = expired.size();
+                    while (head) {
+                        Node *node = head;
+                        unlink(node);
+                        --count;
+                        expired.push_back(std::move(node->self));
+                    }
+                    // Timers expiring on the same tick run in scheduling order.
+                    std::sort(expired.begin() + static_cast<std::ptrdiff_t>(first), expired.end(),
+                              [](const auto &a, const auto &b) { return a->sequence < b->sequence; });
+                }
+            }
+            for (auto &node: expired) {
+                sink(std::move(node->task));
+            }
+            return expired.size();
+        }
+
+        /**
+         * The time at which advance() should be called next, if any timer is pending. It may precede the
+         * actual expiry of the next timer when timers have to be cascaded first.
+         */
+        std::optional<Clock::time_point> nextDeadline() {
+            std::lock_guard<std::mutex> lock(mutex);
+            armed = nextTick();
+            if (armed == NO_TICK) {
+                return std::nullopt;
+            }
+            return origin + std::chrono::milliseconds(armed);
+        }
+
+        /**
+         * Drops all pending timers.
+         */
+        void clear() {
+            std::vector<std::shared_ptr<Node>> dropped;
+            std::lock_guard<std::mutex> lock(mutex);
+            auto drain = [&dropped](Node *&head) {
+                while (head) {
+                    Node *node = head;
+                    unlink(node);
+                    dropped.push_back(std::move(node->self));
+                }
+            };
+            for (auto &level: slots) {
+                for (auto &head: level) {
+                    drain(head);
+                }
+            }
+            drain(overflow);
+            count = 0;
+        }
+
+        std::size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return count;
+        }
+    };
+
+    /**
+     * The Cancellable of a task wrapped by makeCancellable(). Once bound to the timer of the task,
+     * cancel() unlinks it from its TimerWheel at once; a task that has already expired, and waits for
+     * its executor, is skipped when it runs.
+     */
+    class CancellableTimer : public Cancellable {
+    private:
+        std::atomic<bool> cancelled{false};
+        TimerWheel::Timer timer;
+
+    public:
+        /**
+         * Binds the timer the task was scheduled with. Must be called before the handle is handed out.
+         */
+        void bind(TimerWheel::Timer scheduled) {
+            timer = std::move(scheduled);
+        }
+
+        void cancel() override {
+            if (!cancelled.exchange(true, std::memory_order_acq_rel)) {
+                timer.cancel();
+            }
+        }
+
+        bool isCancelled() const override {
+            return cancelled.load(std::memory_order_acquire);
+        }
+    };
+
+    /**
+     * Wraps a task for the cancellation of ThreadMultiplexer::schedule: the task does nothing if the
+     * returned handle has been cancelled by the time it runs.
+     */
+    inline std::pair<InlineTask, std::shared_ptr<CancellableTimer>> makeCancellable(InlineTask task) {
+        auto handle = std::make_shared<CancellableTimer>();
+        UncaughtExceptionHandler *handler = task.getExceptionHandler();
+        InlineTask guarded([task = std::move(task), handle]() mutable {
+            if (!handle->isCancelled()) {
+                task();
+            }
+        });
+        guarded.setExceptionHandler(handler);
+        return {std::move(guarded), std::move(handle)};
+    }
+
+    /**
+     * A single process-wide thread advancing the TimerWheels that have no thread of their own. Expired
+     * tasks are handed to the sink given at registration, which should pass them to an executor: the
+     * sink runs on the driver thread and delays every other wheel while it runs.
+     */
+    class TimerDriver {
+    private:
+        struct Entry {
+            std::weak_ptr<TimerWheel> wheel;
+            std::function<void(InlineTask &&)> sink;
+        };
+
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        std::vector<Entry> wheels;
+        bool kicked = false;
+        bool stop = false;
+        std::thread worker;
+
+        void run() {
+            ThreadConfig::getInstance().applyToCurrentThread(ThreadRole::TIMER);
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stop) {
+                kicked = false;
+                std::vector<Entry> snapshot = wheels;
+                lock.unlock();
+                auto now = TimerWheel::Clock::now();
+                std::optional<TimerWheel::Clock::time_point> next;
+                bool expiredWheels = false;
+                for (auto &entry: snapshot) {
+                    auto wheel = entry.wheel.lock();
+                    if (!wheel) {
+                        expiredWheels = true;
+                        continue;
+                    }
+                    wheel->advance(now, entry.sink);
+                    auto deadline = wheel->nextDeadline();
+                    if (deadline && (!next || *deadline < *next)) {
+                        next = deadline;
+                    }
+                }
+                lock.lock();
+                if (expiredWheels) {
+                    wheels.erase(std::remove_if(wheels.begin(), wheels.end(),
+                                                [](const Entry &e) { return e.wheel.expired(); }), wheels.end());
+                }
+                if (kicked || stop) {
+                    continue;
+                }
+                if (next) {
+                    wakeUp.wait_until(lock, *next, [this] { return kicked || stop; });
+                } else {
+                    wakeUp.wait(lock, [this] { return kicked || stop; });
+                }
+            }
+        }
+
+        TimerDriver() : worker(&TimerDriver::run, this) {}
+
+    public:
+        TimerDriver(const TimerDriver &) = delete;
+        TimerDriver &operator=(const TimerDriver &) = delete;
+
+        ~TimerDriver() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            wakeUp.notify_one();
+            worker.join();
+        }
+
+        static TimerDriver &getInstance() {
+            static TimerDriver instance;
+            return instance;
+        }
+
+        /**
+         * Creates a wheel advanced by this driver.
+         *
+         * @param sink Receives the expired tasks.
+         */
+        std::shared_ptr<TimerWheel> createWheel(std::function<void(InlineTask &&)> sink) {
+            auto wheel = std::make_shared<TimerWheel>([this] { kick(); });
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                wheels.push_back(Entry{wheel, std::move(sink)});
+            }
+            return wheel;
+        }
+
+        /**
+         * Makes the driver re-read the deadlines of its wheels.
+         */
+        void kick() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                kicked = true;
+            }
+            wakeUp.notify_one();
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_TIMERWHEEL_HPP
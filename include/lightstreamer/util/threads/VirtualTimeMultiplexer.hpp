@@ -0,0 +1,162 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_VIRTUALTIMEMULTIPLEXER_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_VIRTUALTIMEMULTIPLEXER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <lightstreamer/util/Clock.hpp>
+#include <lightstreamer/util/threads/ThreadMultiplexer.hpp>
+#include <lightstreamer/util/threads/TimerWheel.hpp>
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * A ThreadMultiplexer owning no thread, which runs tasks in simulated time on the thread driving it.
+     *
+     * Submitted tasks are only queued; runFor() and runUntilIdle() run them, in submission order for
+     * immediate tasks and in deadline order (then submission order) for delayed ones, moving the
+     * VirtualClock to the deadline of each delayed task before running it. Together with
+     * Clock::setInstance(clock), session logic sees hours of timeouts elapse in microseconds, and runs
+     * deterministically.
+     */
+    template<typename S>
+    class VirtualTimeMultiplexer : public ThreadMultiplexer<S> {
+    private:
+        struct Delayed {
+            Clock::time_point deadline;
+            std::uint64_t sequence;
+            InlineTask task;
+        };
+
+        // Orders the heap by earliest deadline, then earliest submission.
+        struct Later {
+            bool operator()(const Delayed &a, const Delayed &b) const {
+                return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+            }
+        };
+
+        std::shared_ptr<VirtualClock> clock;
+        std::mutex mutex;
+        std::deque<InlineTask> ready;
+        std::vector<Delayed> delayed;
+        std::uint64_t nextSequence = 0;
+        std::uint64_t tasksRun = 0;
+
+        std::size_t runUntil(Clock::time_point limit, std::size_t maxTasks) {
+            std::size_t count = 0;
+            while (count < maxTasks) {
+                InlineTask task;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!ready.empty()) {
+                        task = std::move(ready.front());
+                        ready.pop_front();
+                    } else if (!delayed.empty() && delayed.front().deadline <= limit) {
+                        std::pop_heap(delayed.begin(), delayed.end(), Later());
+                        clock->advanceTo(delayed.back().deadline);
+                        task = std::move(delayed.back().task);
+                        delayed.pop_back();
+                    } else {
+                        break;
+                    }
+                    ++tasksRun;
+                }
+                task.run();
+                ++count;
+            }
+            return count;
+        }
+
+    public:
+        explicit VirtualTimeMultiplexer(std::shared_ptr<VirtualClock> clock) : clock(std::move(clock)) {}
+
+        void execute(S, InlineTask runnable) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(std::move(runnable));
+        }
+
+        std::shared_ptr<Cancellable> schedule(S, InlineTask task, long delayMillis) override {
+            auto [guarded, cancel] = makeCancellable(std::move(task));
+            std::lock_guard<std::mutex> lock(mutex);
+            delayed.push_back({clock->steadyNow() + std::chrono::milliseconds(std::max(delayMillis, 0L)),
+                               nextSequence++, std::move(guarded)});
+            std::push_heap(delayed.begin(), delayed.end(), Later());
+            return cancel;
+        }
+
+        /**
+         * Runs the immediate tasks, without moving the clock.
+         */
+        void await() override {
+            runUntil(clock->steadyNow(), std::numeric_limits<std::size_t>::max());
+        }
+
+        /**
+         * Runs the tasks due within the given simulated duration, then moves the clock to its end.
+         *
+         * @return The number of tasks run.
+         */
+        std::size_t runFor(std::chrono::nanoseconds duration) {
+            Clock::time_point end = clock->steadyNow() + duration;
+            std::size_t count = runUntil(end, std::numeric_limits<std::size_t>::max());
+            clock->advanceTo(end);
+            return count;
+        }
+
+        /**
+         * Runs tasks, jumping the clock from deadline to deadline, until none is left or maxTasks have
+         * run (periodic tasks, such as heartbeats, never let the multiplexer become idle).
+         *
+         * @return The number of tasks run.
+         */
+        std::size_t runUntilIdle(std::size_t maxTasks = std::numeric_limits<std::size_t>::max()) {
+            return runUntil(Clock::time_point::max(), maxTasks);
+        }
+
+        /**
+         * @return The number of tasks waiting, immediate and delayed.
+         */
+        std::size_t getPendingCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return ready.size() + delayed.size();
+        }
+
+        std::uint64_t getTaskCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return tasksRun;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_VIRTUALTIMEMULTIPLEXER_HPP
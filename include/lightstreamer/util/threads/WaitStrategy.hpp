@@ -0,0 +1,162 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#ifndef LIGHTSTREAMER_LIB_CLIENT_CPP_WAITSTRATEGY_HPP
+#define LIGHTSTREAMER_LIB_CLIENT_CPP_WAITSTRATEGY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace lightstreamer::util::threads {
+
+    /**
+     * How a consumer thread waits when it runs out of work.
+     *
+     * - BLOCKING parks the thread at once; every new task after an idle period pays a wake-up.
+     * - SPIN_THEN_PARK polls for spinDuration before parking, so bursts arriving within that window are
+     *   picked up without any wake-up, at the cost of burning CPU while idle.
+     * - BUSY_SPIN never parks. Only suitable for threads pinned to a dedicated core.
+     */
+    struct WaitStrategy {
+        enum class Type {
+            BLOCKING,
+            SPIN_THEN_PARK,
+            BUSY_SPIN
+        };
+
+        Type type = Type::BLOCKING;
+        std::chrono::nanoseconds spinDuration{0};
+
+        static WaitStrategy blocking() {
+            return {Type::BLOCKING, std::chrono::nanoseconds(0)};
+        }
+
+        static WaitStrategy spinThenPark(std::chrono::nanoseconds spinDuration = std::chrono::microseconds(50)) {
+            return {Type::SPIN_THEN_PARK, spinDuration};
+        }
+
+        static WaitStrategy busySpin() {
+            return {Type::BUSY_SPIN, std::chrono::nanoseconds::max()};
+        }
+    };
+
+    /**
+     * Hints the CPU that the calling thread is in a spin loop.
+     */
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    /**
+     * The idle side of a single consumer thread, applying a WaitStrategy.
+     *
+     * The consumer calls await() with a predicate telling whether there is work (or it must stop);
+     * producers call wake() after publishing work. The consumer advertises whether it is running,
+     * spinning or parked, and wake() only issues a notification (futex) for a parked consumer: a spinning
+     * one will see the work on its own.
+     *
+     * The predicate must read the producer's publication with seq_cst (or stronger) ordering, so that a
+     * consumer about to park and a producer about to skip the notification cannot miss each other.
+     */
+    class IdleWaiter {
+    private:
+        static constexpr std::uint8_t RUNNING = 0;
+        static constexpr std::uint8_t SPINNING = 1;
+        static constexpr std::uint8_t PARKED = 2;
+
+        WaitStrategy strategy;
+        std::atomic<std::uint8_t> state{RUNNING};
+
+    public:
+        explicit IdleWaiter(WaitStrategy strategy = WaitStrategy::blocking()) : strategy(strategy) {}
+
+        /**
+         * Returns once ready() is true. Consumer thread only.
+         */
+        template<typename Ready>
+        void await(Ready&& ready) {
+            if (strategy.type != WaitStrategy::Type::BLOCKING) {
+                state.store(SPINNING, std::memory_order_seq_cst);
+                auto deadline = strategy.type == WaitStrategy::Type::BUSY_SPIN
+                                ? std::chrono::steady_clock::time_point::max()
+                                : std::chrono::steady_clock::now() + strategy.spinDuration;
+                for (unsigned spins = 0; ; ++spins) {
+                    if (ready()) {
+                        state.store(RUNNING, std::memory_order_relaxed);
+                        return;
+                    }
+                    cpuRelax();
+                    // Reading the clock costs more than a pause: check it every few iterations.
+                    if ((spins & 63) == 63 && std::chrono::steady_clock::now() >= deadline) {
+                        break;
+                    }
+                }
+            }
+            while (true) {
+                state.store(PARKED, std::memory_order_seq_cst);
+                if (ready()) {
+                    state.store(RUNNING, std::memory_order_relaxed);
+                    return;
+                }
+                state.wait(PARKED, std::memory_order_acquire);
+                if (ready()) {
+                    state.store(RUNNING, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * Wakes the consumer up if it is parked. Called by producers after publishing work.
+         */
+        void wake() {
+            if (state.load(std::memory_order_seq_cst) == PARKED &&
+                state.exchange(RUNNING, std::memory_order_acq_rel) == PARKED) {
+                state.notify_one();
+            }
+        }
+
+        bool isSpinning() const {
+            return state.load(std::memory_order_relaxed) == SPINNING;
+        }
+
+        const WaitStrategy& getStrategy() const {
+            return strategy;
+        }
+    };
+
+}
+
+#endif //LIGHTSTREAMER_LIB_CLIENT_CPP_WAITSTRATEGY_HPP
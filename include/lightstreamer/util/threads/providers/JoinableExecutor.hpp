@@ -26,6 +26,7 @@
 #include <functional>
 #include <stdexcept>
 #include <lightstreamer/util/threads/providers/Joinable.hpp>
+#include <lightstreamer/util/threads/InlineTask.hpp>
 
 namespace lightstreamer::util::threads::providers {
 
@@ -40,11 +41,12 @@ namespace lightstreamer::util::threads::providers {
         /**
          * Executes the given task at some time in the future.
          *
-         * @param task The runnable task.
+         * @param task The runnable task. If it carries an UncaughtExceptionHandler, exceptions thrown by
+         *             the task are passed to it by the run loop.
          * @throws std::runtime_error if this task cannot be accepted for execution.
          * @throws std::invalid_argument if task is null.
          */
-        virtual void execute(std::function<void()> task) = 0;
+        virtual void execute(InlineTask task) = 0;
     };
 }
 
@@ -26,8 +26,11 @@
 #include <functional>
 #include <future>
 #include <chrono>
+#include <memory>
 #include <stdexcept>
+#include <lightstreamer/util/threads/Cancellable.hpp>
 #include <lightstreamer/util/threads/providers/Joinable.hpp>
+#include <lightstreamer/util/threads/InlineTask.hpp>
 
 namespace lightstreamer::util::threads::providers {
 
@@ -44,11 +47,11 @@ namespace lightstreamer::util::threads::providers {
          *
          * @param task The task to execute.
          * @param delayInMillis The time in milliseconds from now to delay execution.
-         * @return A std::future object representing pending completion of the task.
+         * @return A handle cancelling the task, if it has not run yet.
          * @throws std::invalid_argument if the task is null.
          * @throws std::runtime_error if the task cannot be scheduled for execution.
          */
-        virtual std::shared_ptr<std::future<void>> schedule(std::function<void()> task, long delayInMillis) = 0;
+        virtual std::shared_ptr<Cancellable> schedule(InlineTask task, long delayInMillis) = 0;
     };
 
 }
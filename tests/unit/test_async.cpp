@@ -0,0 +1,277 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/client/async/StateWaiters.hpp>
+#include <lightstreamer/client/async/SubscribedAwaitable.hpp>
+#include <lightstreamer/client/async/UpdateStream.hpp>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace lightstreamer::client::async;
+
+namespace {
+
+    // A coroutine that starts at once and keeps its frame until the Task is destroyed, which destroys a
+    // coroutine still suspended.
+    struct Task {
+        struct promise_type {
+            bool done = false;
+            std::exception_ptr error;
+
+            Task get_return_object() {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_never initial_suspend() noexcept {
+                return {};
+            }
+
+            std::suspend_always final_suspend() noexcept {
+                done = true;
+                return {};
+            }
+
+            void return_void() {}
+
+            void unhandled_exception() {
+                error = std::current_exception();
+            }
+        };
+
+        std::coroutine_handle<promise_type> handle;
+
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+        ~Task() {
+            if (handle) {
+                handle.destroy();
+            }
+        }
+
+        bool done() const {
+            return handle.promise().done;
+        }
+
+        void rethrow() const {
+            if (handle.promise().error) {
+                std::rethrow_exception(handle.promise().error);
+            }
+        }
+    };
+
+    // Waits for the counter to reach a threshold.
+    class AtLeast : private Waiter<int> {
+    private:
+        WaiterList<int> &list;
+        int threshold;
+        int seen = 0;
+
+        bool complete(const int &state) override {
+            seen = state;
+            return state >= threshold;
+        }
+
+    public:
+        AtLeast(WaiterList<int> &list, int threshold) : list(list), threshold(threshold) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return list.suspend(*this, handle, nullptr);
+        }
+
+        int await_resume() const {
+            return seen;
+        }
+    };
+
+    Task waitFor(WaiterList<int> &list, int threshold, std::vector<int> &reached) {
+        reached.push_back(co_await AtLeast(list, threshold));
+    }
+
+    using Stream = UpdateStream<std::string>;
+
+    void deliver(Stream &stream, std::string update) {
+        stream.push(std::span<const std::string>(&update, 1));
+    }
+
+    Task consume(std::shared_ptr<Stream> stream, std::vector<std::string> &received, bool &ended) {
+        while (auto update = co_await stream->next()) {
+            received.push_back(*update);
+        }
+        ended = true;
+    }
+
+}
+
+TEST_CASE("WaiterList resumes a waiter once the state satisfies it", "[Async]") {
+    WaiterList<int> list(0);
+    std::vector<int> reached;
+    Task task = waitFor(list, 2, reached);
+    REQUIRE_FALSE(task.done());
+
+    list.update([](int &state) { state = 1; });
+    REQUIRE_FALSE(task.done());
+    REQUIRE(reached.empty());
+
+    list.update([](int &state) { state = 3; });
+    REQUIRE(task.done());
+    REQUIRE(reached == std::vector<int>{3});
+
+    // A resumed waiter is unlinked: further changes do not reach it.
+    list.update([](int &state) { state = 4; });
+    REQUIRE(reached == std::vector<int>{3});
+}
+
+TEST_CASE("WaiterList does not suspend a waiter already satisfied by the state", "[Async]") {
+    WaiterList<int> list(5);
+    std::vector<int> reached;
+    Task task = waitFor(list, 2, reached);
+    REQUIRE(task.done());
+    REQUIRE(reached == std::vector<int>{5});
+}
+
+TEST_CASE("WaiterList resumes every waiter satisfied by a change", "[Async]") {
+    WaiterList<int> list(0);
+    std::vector<int> reached;
+    Task low = waitFor(list, 1, reached);
+    Task high = waitFor(list, 10, reached);
+    Task middle = waitFor(list, 5, reached);
+
+    list.update([](int &state) { state = 7; });
+    REQUIRE(low.done());
+    REQUIRE(middle.done());
+    REQUIRE_FALSE(high.done());
+    REQUIRE(reached.size() == 2);
+
+    list.update([](int &state) { state = 10; });
+    REQUIRE(high.done());
+    REQUIRE(reached.size() == 3);
+}
+
+TEST_CASE("WaiterList forgets the waiter of a coroutine destroyed while suspended", "[Async]") {
+    WaiterList<int> list(0);
+    std::vector<int> reached;
+    std::optional<Task> cancelled(waitFor(list, 1, reached));
+    Task kept = waitFor(list, 1, reached);
+
+    // Destroying the frame destroys the awaiter in it, which unlinks itself: the update below must
+    // neither touch it nor resume the destroyed coroutine.
+    cancelled.reset();
+    list.update([](int &state) { state = 1; });
+    REQUIRE(kept.done());
+    REQUIRE(reached == std::vector<int>{1});
+}
+
+TEST_CASE("SubscribedAwaitable completes on subscription and throws on a subscription error", "[Async]") {
+    // Updated the way SubscriptionStateBridge does from the subscription events.
+    auto waiters = std::make_shared<WaiterList<SubscriptionState>>();
+    auto subscribe = [&] { waiters->update([](SubscriptionState &state) { state.subscribed = true; }); };
+    bool subscribed = false;
+    auto awaitSubscribed = [](std::shared_ptr<WaiterList<SubscriptionState>> waiters, bool &subscribed) -> Task {
+        co_await SubscribedAwaitable(waiters, nullptr);
+        subscribed = true;
+    };
+
+    Task first = awaitSubscribed(waiters, subscribed);
+    REQUIRE_FALSE(subscribed);
+    subscribe();
+    REQUIRE(subscribed);
+    first.rethrow();
+
+    // Already subscribed: completes without suspending.
+    subscribed = false;
+    Task again = awaitSubscribed(waiters, subscribed);
+    REQUIRE(subscribed);
+
+    waiters->update([](SubscriptionState &state) { state.subscribed = false; });
+    subscribed = false;
+    Task refused = awaitSubscribed(waiters, subscribed);
+    waiters->update([](SubscriptionState &state) {
+        ++state.errors;
+        state.errorCode = 19;
+        state.errorMessage = "Not authorized";
+    });
+    REQUIRE(refused.done());
+    REQUIRE_FALSE(subscribed);
+    try {
+        refused.rethrow();
+        FAIL("The subscription error was not thrown");
+    } catch (const AsyncError &e) {
+        REQUIRE(e.getCode() == 19);
+        REQUIRE(std::string(e.what()) == "Not authorized");
+    }
+}
+
+TEST_CASE("UpdateStream yields the updates in order and ends when closed", "[Async]") {
+    auto stream = std::make_shared<Stream>(4);
+    std::vector<std::string> received;
+    bool ended = false;
+
+    deliver(*stream, "buffered");
+    Task consumer = consume(stream, received, ended);
+    REQUIRE(received == std::vector<std::string>{"buffered"});
+    REQUIRE_FALSE(consumer.done());
+
+    // The consumer is suspended: each delivery resumes it.
+    deliver(*stream, "a");
+    std::vector<std::string> batch{"b", "c"};
+    stream->push(batch);
+    REQUIRE(received == std::vector<std::string>{"buffered", "a", "b", "c"});
+
+    stream->close();
+    REQUIRE(ended);
+    REQUIRE(consumer.done());
+    deliver(*stream, "late");
+    REQUIRE(received.size() == 4);
+    REQUIRE(stream->getDroppedCount() == 0);
+}
+
+TEST_CASE("UpdateStream drops the oldest updates of a slow consumer", "[Async]") {
+    auto stream = std::make_shared<Stream>(2);
+    for (const char *update: {"1", "2", "3", "4", "5"}) {
+        deliver(*stream, update);
+    }
+    stream->close();
+    REQUIRE(stream->getDroppedCount() == 3);
+
+    std::vector<std::string> received;
+    bool ended = false;
+    Task consumer = consume(stream, received, ended);
+    // The buffered updates are still drained after close().
+    REQUIRE(received == std::vector<std::string>{"4", "5"});
+    REQUIRE(ended);
+}
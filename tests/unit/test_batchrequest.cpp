@@ -0,0 +1,95 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/client/protocol/OrderedRequestQueue.hpp>
+#include <string>
+
+using namespace lightstreamer::client::protocol;
+
+namespace {
+
+    // The keys BatchRequest gives to the requests of a Subscription: its id, prefixed for a change of frequency.
+    using Queue = OrderedRequestQueue<std::string>;
+
+    std::string changeKey(int subId) {
+        return Queue::CHANGE_SUB_KEY + std::to_string(subId);
+    }
+}
+
+TEST_CASE("OrderedRequestQueue keeps the requests of a subscription in order with two batches in flight", "[BatchRequest]") {
+    Queue queue;
+    queue.put("1", "subscribe 1");
+    // First batch: the subscription of 1.
+    auto [subscribeKey, subscribed] = queue.shiftReady();
+    REQUIRE(subscribed == "subscribe 1");
+
+    queue.put(changeKey(1), "reconf 1");
+    queue.put("1", "unsubscribe 1");
+    queue.put("2", "subscribe 2");
+
+    // Second batch: the reconfiguration and the unsubscription of 1 wait, the subscription of 2 goes ahead.
+    REQUIRE(*queue.peekReady() == "subscribe 2");
+    auto [otherKey, other] = queue.shiftReady();
+    REQUIRE(otherKey == "2");
+    REQUIRE_FALSE(queue.hasReady());
+    REQUIRE(queue.size() == 2);
+
+    queue.complete(subscribeKey);
+    auto [reconfKey, reconf] = queue.shiftReady();
+    REQUIRE(reconfKey == "X1");
+    REQUIRE(reconf == "reconf 1");
+    // The unsubscription waits for the reconfiguration, although their keys differ.
+    REQUIRE_FALSE(queue.hasReady());
+
+    queue.complete(reconfKey);
+    auto [unsubscribeKey, unsubscribed] = queue.shiftReady();
+    REQUIRE(unsubscribeKey == "1");
+    REQUIRE(unsubscribed == "unsubscribe 1");
+    REQUIRE(queue.size() == 0);
+    REQUIRE(queue.shiftReady().first.empty());
+}
+
+TEST_CASE("OrderedRequestQueue replaces a queued request in place and shifts regardless of requests in flight", "[BatchRequest]") {
+    Queue queue;
+    queue.put("C", "constrain");
+    queue.put("1", "subscribe 1");
+    queue.put("C", "constrain again");
+    REQUIRE(queue.size() == 2);
+    REQUIRE(*queue.find("C") == "constrain again");
+    REQUIRE(queue.find("2") == nullptr);
+    REQUIRE(queue.front() == "constrain again");
+
+    queue.shiftReady();
+    queue.put("C", "constrain later");
+    // shift() ignores the key in flight.
+    REQUIRE(queue.shift().second == "subscribe 1");
+    REQUIRE(queue.shift().second == "constrain later");
+    REQUIRE(queue.shift().first.empty());
+
+    // Only a prefix followed by an id shares the ordering key of the id.
+    REQUIRE(Queue::orderingKey("X12") == "12");
+    REQUIRE(Queue::orderingKey("X") == "X");
+    REQUIRE(Queue::orderingKey("Xa1") == "Xa1");
+}
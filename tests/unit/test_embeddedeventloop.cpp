@@ -0,0 +1,154 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/util/threads/EmbeddedEventLoop.hpp>
+#include <lightstreamer/util/threads/InjectedExecutorMultiplexer.hpp>
+#include <lightstreamer/client/events/EventsThread.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace lightstreamer::util::threads;
+using namespace lightstreamer::client::events;
+
+namespace {
+
+    bool readable(int fd, int timeoutMillis = 0) {
+        pollfd entry{fd, POLLIN, 0};
+        return ::poll(&entry, 1, timeoutMillis) == 1;
+    }
+}
+
+TEST_CASE("EmbeddedEventLoop runs tasks within the budget and keeps its descriptor readable", "[EmbeddedEventLoop]") {
+    EmbeddedEventLoop loop;
+    REQUIRE(loop.getFd() >= 0);
+    REQUIRE_FALSE(readable(loop.getFd()));
+
+    std::vector<int> executed;
+    for (int i = 0; i < 5; ++i) {
+        loop.execute([&executed, i] { executed.push_back(i); });
+    }
+    REQUIRE(readable(loop.getFd()));
+    REQUIRE(loop.poll(3) == 3);
+    REQUIRE(executed == std::vector<int>{0, 1, 2});
+    // Work is left over: the descriptor stays readable.
+    REQUIRE(readable(loop.getFd()));
+    REQUIRE(loop.poll() == 2);
+    REQUIRE(executed == std::vector<int>{0, 1, 2, 3, 4});
+    REQUIRE_FALSE(readable(loop.getFd()));
+
+    // Tasks queued by a task run within the same budget.
+    loop.execute([&] { loop.execute([&executed] { executed.push_back(5); }); });
+    REQUIRE(loop.poll(1) == 1);
+    REQUIRE(readable(loop.getFd()));
+    REQUIRE(loop.poll() == 1);
+    REQUIRE(executed.back() == 5);
+    REQUIRE_FALSE(readable(loop.getFd()));
+    REQUIRE(loop.getTaskCount() == 7);
+}
+
+TEST_CASE("EmbeddedEventLoop wakes its descriptor for timers and other threads", "[EmbeddedEventLoop]") {
+    EmbeddedEventLoop loop;
+    bool fired = false;
+    bool cancelledFired = false;
+    loop.schedule([&fired] { fired = true; }, 20);
+    loop.schedule([&cancelledFired] { cancelledFired = true; }, 20)->cancel();
+    // The first poll reads the deadline and arms the timer.
+    loop.poll();
+    REQUIRE_FALSE(fired);
+    REQUIRE(readable(loop.getFd(), 2000));
+    loop.poll();
+    REQUIRE(fired);
+    REQUIRE_FALSE(cancelledFired);
+    REQUIRE_FALSE(readable(loop.getFd()));
+
+    bool remote = false;
+    std::thread producer([&] { loop.execute([&remote] { remote = true; }); });
+    producer.join();
+    REQUIRE(readable(loop.getFd(), 2000));
+    loop.poll();
+    REQUIRE(remote);
+}
+
+TEST_CASE("EmbeddedEventLoop consumes each expiration of its timer", "[EmbeddedEventLoop]") {
+    EmbeddedEventLoop loop;
+    std::vector<int> fired;
+    loop.schedule([&fired] { fired.push_back(1); }, 20);
+    loop.schedule([&fired] { fired.push_back(2); }, 60);
+    loop.poll();
+    for (int expected = 1; expected <= 2; ++expected) {
+        REQUIRE(readable(loop.getFd(), 2000));
+        // A single poll runs the expired timer and leaves nothing to wake up for until the next one.
+        REQUIRE(loop.poll() == 1);
+        REQUIRE(fired.back() == expected);
+        REQUIRE_FALSE(readable(loop.getFd()));
+    }
+    REQUIRE(fired.size() == 2);
+}
+
+TEST_CASE("EmbeddedEventLoop dispatches socket readiness", "[EmbeddedEventLoop]") {
+    int sockets[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+    EmbeddedEventLoop loop;
+    std::string received;
+    loop.watch(sockets[0], EPOLLIN, [&](std::uint32_t) {
+        char buffer[16];
+        ssize_t n = ::read(sockets[0], buffer, sizeof(buffer));
+        received.append(buffer, static_cast<std::size_t>(n));
+    });
+    REQUIRE_FALSE(readable(loop.getFd()));
+    REQUIRE(::write(sockets[1], "CONOK", 5) == 5);
+    REQUIRE(readable(loop.getFd(), 2000));
+    REQUIRE(loop.poll() == 1);
+    REQUIRE(received == "CONOK");
+    REQUIRE_FALSE(readable(loop.getFd()));
+
+    loop.unwatch(sockets[0]);
+    REQUIRE(::write(sockets[1], "PROBE", 5) == 5);
+    REQUIRE(loop.poll() == 0);
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+}
+
+TEST_CASE("EmbeddedEventLoop drives session and events queues on the polling thread", "[EmbeddedEventLoop]") {
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    InjectedExecutorMultiplexer<int> session(loop, loop);
+    auto events = EventsThread::onExecutor(loop);
+    std::vector<std::thread::id> threads;
+    std::vector<int> delivered;
+    session.execute(0, [&] {
+        threads.push_back(std::this_thread::get_id());
+        events->queue([&] {
+            threads.push_back(std::this_thread::get_id());
+            delivered.push_back(1);
+        });
+    });
+    while (loop->poll() > 0) {}
+    REQUIRE(delivered == std::vector<int>{1});
+    REQUIRE(threads == std::vector<std::thread::id>{std::this_thread::get_id(), std::this_thread::get_id()});
+}
@@ -0,0 +1,459 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/client/transport/providers/epoll/HttpConnectionPool.hpp>
+#include <lightstreamer/client/transport/providers/epoll/RingBuffer.hpp>
+#include <lightstreamer/util/threads/EventLoopThread.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace lightstreamer::client::transport::providers::epoll;
+using namespace lightstreamer::util::threads;
+
+namespace {
+
+    struct RecordingHandler {
+        int status = 0;
+        bool accept = true;
+        bool ended = false;
+        std::vector<std::string> lines;
+
+        bool onHead(int s) {
+            status = s;
+            return accept;
+        }
+
+        void onLine(std::string_view line) {
+            lines.emplace_back(line);
+        }
+
+        void onEnd() {
+            ended = true;
+        }
+    };
+
+    std::string chunked(const std::vector<std::string> &chunks) {
+        std::string out = "HTTP/1.1 200 OK\r\nContent-Type: text/enriched\r\nTransfer-Encoding: chunked\r\n\r\n";
+        for (const auto &chunk: chunks) {
+            char size[16];
+            std::snprintf(size, sizeof(size), "%zx", chunk.size());
+            out.append(size).append("\r\n").append(chunk).append("\r\n");
+        }
+        return out + "0\r\n\r\n";
+    }
+
+    // Feeds the response through a ring in reads of the given size, as the connection does.
+    RecordingHandler feed(const std::string &response, std::size_t readSize, std::size_t capacity = 4096) {
+        RingBuffer ring(capacity);
+        HttpResponseParser parser(ring.getCapacity());
+        RecordingHandler handler;
+        std::size_t pos = 0;
+        while (pos < response.size() && !parser.isDone()) {
+            char *target = ring.writable();
+            std::size_t count = std::min({readSize, ring.writableSize(), response.size() - pos});
+            REQUIRE(count > 0);
+            std::memcpy(target, response.data() + pos, count);
+            pos += count;
+            ring.commit(count);
+            ring.consume(parser.parse(ring.data(), ring.size(), handler));
+        }
+        return handler;
+    }
+
+    class LoopbackHttpServer {
+    private:
+        int listener;
+
+    public:
+        int port = 0;
+        int client = -1;
+
+        LoopbackHttpServer() : listener(::socket(AF_INET, SOCK_STREAM, 0)) {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            ::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+            ::listen(listener, 4);
+            socklen_t size = sizeof(address);
+            ::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &size);
+            port = ntohs(address.sin_port);
+        }
+
+        ~LoopbackHttpServer() {
+            if (client >= 0) {
+                ::close(client);
+            }
+            ::close(listener);
+        }
+
+        std::string url(const std::string &path) const {
+            return "http://127.0.0.1:" + std::to_string(port) + path;
+        }
+
+        // Accepts a connection and reads one request, body included.
+        std::string accept() {
+            if (client >= 0) {
+                ::close(client);
+            }
+            client = ::accept(listener, nullptr, nullptr);
+            timeval timeout{2, 0};
+            ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            return readRequest();
+        }
+
+        // Reads the next request on the current connection.
+        std::string readRequest() {
+            std::string request;
+            char buffer[4096];
+            std::size_t headEnd;
+            while ((headEnd = request.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = ::recv(client, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                    return request;
+                }
+                request.append(buffer, static_cast<std::size_t>(n));
+            }
+            auto lengthStart = request.find("Content-Length: ") + 16;
+            if (lengthStart < 16) {
+                return request;
+            }
+            std::size_t length = std::stoul(request.substr(lengthStart));
+            while (request.size() < headEnd + 4 + length) {
+                ssize_t n = ::recv(client, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                    break;
+                }
+                request.append(buffer, static_cast<std::size_t>(n));
+            }
+            return request;
+        }
+
+        void write(const std::string &bytes) {
+            std::size_t sent = 0;
+            while (sent < bytes.size()) {
+                ssize_t n = ::send(client, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) {
+                    return;
+                }
+                sent += static_cast<std::size_t>(n);
+            }
+        }
+    };
+
+    class RecordingListener : public HttpStreamListener {
+    public:
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::string> lines;
+        int opened = 0;
+        int closed = 0;
+        int broken = 0;
+
+        void onOpen() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++opened;
+        }
+
+        void onLine(std::string_view line) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.emplace_back(line);
+        }
+
+        void onClosed() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++closed;
+            changed.notify_all();
+        }
+
+        void onBroken() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++broken;
+            changed.notify_all();
+        }
+
+        bool awaitEnd() {
+            std::unique_lock<std::mutex> lock(mutex);
+            return changed.wait_for(lock, std::chrono::seconds(5), [this] { return closed + broken > 0; });
+        }
+    };
+}
+
+TEST_CASE("RingBuffer keeps wrapped data contiguous", "[EpollHttp]") {
+    RingBuffer ring(4096);
+    std::size_t capacity = ring.getCapacity();
+    std::string pattern;
+    for (std::size_t i = 0; i < capacity; ++i) {
+        pattern.push_back(static_cast<char>('a' + i % 26));
+    }
+    // Moves the start of the data close to the end of the storage.
+    std::memcpy(ring.writable(), pattern.data(), capacity - 10);
+    ring.commit(capacity - 10);
+    ring.consume(capacity - 20);
+    REQUIRE(ring.size() == 10);
+    char *target = ring.writable();
+    REQUIRE(ring.writableSize() >= 100);
+    std::memcpy(target, pattern.data(), 100);
+    ring.commit(100);
+    REQUIRE(std::string(ring.data(), 10) == pattern.substr(capacity - 20, 10));
+    REQUIRE(std::string(ring.data() + 10, 100) == pattern.substr(0, 100));
+    ring.consume(110);
+    REQUIRE(ring.size() == 0);
+    REQUIRE(ring.writableSize() == capacity);
+}
+
+TEST_CASE("HttpResponseParser decodes chunked streams in place at any read size", "[EpollHttp]") {
+    // Lines crossing chunk boundaries, a chunk with no line end and an empty line.
+    std::string response = chunked({"CONOK,S1,50000,5000,*\r\nPRO", "BE\r", "\nU,1,1,a|b\r\nU,1,1,", "c\r\n",
+                                    "\r\nLOOP,0\r\n"});
+    std::vector<std::string> expected{"CONOK,S1,50000,5000,*", "PROBE", "U,1,1,a|b", "U,1,1,c", "", "LOOP,0"};
+    for (std::size_t readSize: {std::size_t(1), std::size_t(2), std::size_t(5), std::size_t(64), response.size()}) {
+        auto handler = feed(response, readSize);
+        REQUIRE(handler.status == 200);
+        REQUIRE(handler.lines == expected);
+        REQUIRE(handler.ended);
+    }
+}
+
+TEST_CASE("HttpResponseParser ends bodies at Content-Length and skips interim responses", "[EpollHttp]") {
+    std::string body = "CONOK,S1,50000,5000,*\r\nLOOP,0\r\n";
+    std::string response = "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: " +
+                           std::to_string(body.size()) + "\r\n\r\n" + body + "garbage";
+    for (std::size_t readSize: {std::size_t(1), std::size_t(3), response.size()}) {
+        auto handler = feed(response, readSize);
+        REQUIRE(handler.lines == std::vector<std::string>{"CONOK,S1,50000,5000,*", "LOOP,0"});
+        REQUIRE(handler.ended);
+    }
+
+    RingBuffer ring;
+    HttpResponseParser parser;
+    RecordingHandler refusing;
+    refusing.accept = false;
+    std::string error = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 5\r\n\r\nbusy\n";
+    parser.parse(error.data(), error.size(), refusing);
+    REQUIRE(refusing.status == 503);
+    REQUIRE(refusing.lines.empty());
+    REQUIRE(parser.isDone());
+
+    auto fails = [](std::string bytes) {
+        HttpResponseParser rejecting(64);
+        RecordingHandler handler;
+        REQUIRE_THROWS_AS(rejecting.parse(bytes.data(), bytes.size(), handler), HttpProtocolError);
+    };
+    fails("SIP/2.0 200 OK\r\n\r\n");
+    fails("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n");
+    fails("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcXY4\r\n");
+    fails("HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n" + std::string(100, 'x'));
+}
+
+TEST_CASE("HttpStreamConnection streams the lines of a loopback response", "[EpollHttp]") {
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+
+    LoopbackHttpServer server;
+    std::string request;
+    std::thread serverThread([&] {
+        request = server.accept();
+        server.write("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
+        server.write("17\r\nCONOK,S1,50000,5000,*\r\n\r\n");
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        server.write("4\r\nPROB\r\n");
+        server.write("3\r\nE\r\n\r\n0\r\n\r\n");
+    });
+    auto listener = std::make_shared<RecordingListener>();
+    HttpRequest httpRequest;
+    httpRequest.body = "LS_cid=x&LS_adapter_set=DEMO";
+    httpRequest.headers["X-Test"] = "1";
+    HttpStreamConnection::open(loop, nullptr, server.url("/lightstreamer/create_session.txt?LS_protocol=TLCP-2.1.0"),
+                               httpRequest, listener, 5000, 5000);
+    REQUIRE(listener->awaitEnd());
+    serverThread.join();
+    REQUIRE(request.find("POST /lightstreamer/create_session.txt?LS_protocol=TLCP-2.1.0 HTTP/1.1\r\n") == 0);
+    REQUIRE(request.find("X-Test: 1\r\n") != std::string::npos);
+    REQUIRE(request.substr(request.size() - httpRequest.body.size()) == httpRequest.body);
+    REQUIRE(listener->opened == 1);
+    REQUIRE(listener->closed == 1);
+    REQUIRE(listener->broken == 0);
+    REQUIRE(listener->lines == std::vector<std::string>{"CONOK,S1,50000,5000,*", "PROBE"});
+}
+
+TEST_CASE("HttpStreamConnection reports errors, timeouts and truncated bodies as broken", "[EpollHttp]") {
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+
+    auto run = [&](const std::string &response, long readTimeout) {
+        LoopbackHttpServer server;
+        auto listener = std::make_shared<RecordingListener>();
+        std::thread serverThread([&] {
+            server.accept();
+            server.write(response);
+            if (readTimeout == 0) {
+                ::shutdown(server.client, SHUT_WR);
+            }
+            listener->awaitEnd();
+        });
+        HttpStreamConnection::open(loop, nullptr, server.url("/"), HttpRequest(), listener, 5000, readTimeout);
+        REQUIRE(listener->awaitEnd());
+        serverThread.join();
+        return listener;
+    };
+    REQUIRE(run("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n", 0)->broken == 1);
+    REQUIRE(run("HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\nshort\r\n", 0)->broken == 1);
+    auto silent = run("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n", 50);
+    REQUIRE(silent->broken == 1);
+    // A body delimited by the end of the connection is complete when the server closes.
+    auto delimited = run("HTTP/1.0 200 OK\r\n\r\nLOOP,0\r\n", 0);
+    REQUIRE(delimited->closed == 1);
+    REQUIRE(delimited->lines == std::vector<std::string>{"LOOP,0"});
+}
+
+TEST_CASE("HttpStreamConnection loopback streaming throughput", "[.][benchmark][EpollHttp]") {
+    constexpr int chunks = 20000;
+    constexpr int linesPerChunk = 10;
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+
+    struct CountingListener : HttpStreamListener {
+        std::atomic<long> lines{0};
+        std::atomic<bool> done{false};
+        void onOpen() override {}
+        void onLine(std::string_view) override { lines.fetch_add(1, std::memory_order_relaxed); }
+        void onClosed() override { done.store(true, std::memory_order_release); }
+        void onBroken() override { done.store(true, std::memory_order_release); }
+    };
+    auto listener = std::make_shared<CountingListener>();
+    LoopbackHttpServer server;
+    std::thread serverThread([&] {
+        server.accept();
+        std::string chunk;
+        for (int i = 0; i < linesPerChunk; ++i) {
+            chunk += "U,1,1,101.25|1000|20260101 10:00:00.000|BID\r\n";
+        }
+        std::vector<std::string> all(chunks, chunk);
+        server.write(chunked(all));
+    });
+    auto start = std::chrono::steady_clock::now();
+    HttpStreamConnection::open(loop, nullptr, server.url("/"), HttpRequest(), listener, 5000, 0);
+    while (!listener->done.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    serverThread.join();
+    REQUIRE(listener->lines == static_cast<long>(chunks) * linesPerChunk);
+    std::cout << "HttpStreamConnection: " << static_cast<long>(listener->lines / seconds) << " lines/s" << std::endl;
+}
+
+TEST_CASE("HttpConnectionPool sends successive requests on one keep-alive connection", "[EpollHttp]") {
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+    auto pool = std::make_shared<HttpConnectionPool>(loop);
+
+    LoopbackHttpServer server;
+    std::vector<std::string> requests;
+    std::thread serverThread([&] {
+        requests.push_back(server.accept());
+        server.write("HTTP/1.1 200 OK\r\nContent-Length: 18\r\n\r\nREQOK,1\r\nREQOK,2\r\n");
+        // Read on the same socket: a second connection would leave this waiting until the timeout.
+        requests.push_back(server.readRequest());
+        server.write("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n9\r\nREQOK,3\r\n\r\n0\r\n\r\n");
+    });
+    std::vector<std::shared_ptr<RecordingListener>> listeners;
+    for (int i = 0; i < 2; ++i) {
+        auto listener = std::make_shared<RecordingListener>();
+        HttpRequest request;
+        request.body = "LS_reqId=" + std::to_string(i);
+        pool->send(server.url("/lightstreamer/control.txt"), request, listener, 5000, 5000);
+        REQUIRE(listener->awaitEnd());
+        listeners.push_back(listener);
+    }
+    serverThread.join();
+    REQUIRE(requests.size() == 2);
+    REQUIRE(requests[1].find("POST /lightstreamer/control.txt HTTP/1.1\r\n") == 0);
+    REQUIRE(requests[1].substr(requests[1].size() - 10) == "LS_reqId=1");
+    REQUIRE(listeners[0]->closed == 1);
+    REQUIRE(listeners[0]->lines == std::vector<std::string>{"REQOK,1", "REQOK,2"});
+    REQUIRE(listeners[1]->closed == 1);
+    REQUIRE(listeners[1]->lines == std::vector<std::string>{"REQOK,3"});
+    REQUIRE(pool->getIdleCount() == 1);
+}
+
+TEST_CASE("HttpConnectionPool drops non-reusable connections and retries stale ones once", "[EpollHttp]") {
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+    auto pool = std::make_shared<HttpConnectionPool>(loop);
+    LoopbackHttpServer server;
+
+    SECTION("Connection: close") {
+        std::thread serverThread([&] {
+            server.accept();
+            server.write("HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 9\r\n\r\nREQOK,1\r\n");
+        });
+        auto listener = std::make_shared<RecordingListener>();
+        pool->send(server.url("/"), HttpRequest(), listener, 5000, 5000);
+        REQUIRE(listener->awaitEnd());
+        serverThread.join();
+        REQUIRE(listener->closed == 1);
+        REQUIRE(pool->getIdleCount() == 0);
+    }
+
+    SECTION("closed by the server while the request is sent") {
+        bool resent = false;
+        std::thread serverThread([&] {
+            server.accept();
+            server.write("HTTP/1.1 200 OK\r\nContent-Length: 9\r\n\r\nREQOK,1\r\n");
+            // The second request arrives on the pooled connection, which is dropped without a response.
+            server.readRequest();
+            ::close(server.client);
+            server.client = -1;
+            resent = server.accept().find("LS_reqId=2") != std::string::npos;
+            server.write("HTTP/1.1 200 OK\r\nContent-Length: 9\r\n\r\nREQOK,2\r\n");
+        });
+        auto first = std::make_shared<RecordingListener>();
+        pool->send(server.url("/"), HttpRequest(), first, 5000, 5000);
+        REQUIRE(first->awaitEnd());
+        auto second = std::make_shared<RecordingListener>();
+        HttpRequest request;
+        request.body = "LS_reqId=2";
+        pool->send(server.url("/"), request, second, 5000, 5000);
+        REQUIRE(second->awaitEnd());
+        serverThread.join();
+        REQUIRE(resent);
+        REQUIRE(second->opened == 1);
+        REQUIRE(second->closed == 1);
+        REQUIRE(second->broken == 0);
+        REQUIRE(second->lines == std::vector<std::string>{"REQOK,2"});
+    }
+}
@@ -0,0 +1,699 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/client/transport/providers/epoll/EpollWebSocketProvider.hpp>
+#include <lightstreamer/client/transport/providers/epoll/PerMessageDeflate.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace lightstreamer::client::transport;
+using namespace lightstreamer::client::transport::providers::epoll;
+using namespace lightstreamer::util::threads;
+
+namespace {
+
+    // An unmasked frame, as sent by a server.
+    std::string serverFrame(WebSocketOpcode opcode, const std::string &payload, bool fin = true,
+                            bool compressed = false) {
+        std::string frame;
+        frame.push_back(static_cast<char>((fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | static_cast<int>(opcode)));
+        if (payload.size() < 126) {
+            frame.push_back(static_cast<char>(payload.size()));
+        } else if (payload.size() <= 0xFFFF) {
+            frame.push_back(126);
+            frame.push_back(static_cast<char>(payload.size() >> 8));
+            frame.push_back(static_cast<char>(payload.size()));
+        } else {
+            frame.push_back(127);
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                frame.push_back(static_cast<char>(static_cast<std::uint64_t>(payload.size()) >> shift));
+            }
+        }
+        return frame + payload;
+    }
+
+    struct Received {
+        std::vector<std::pair<WebSocketOpcode, std::string>> messages;
+
+        auto sink() {
+            return [this](WebSocketOpcode opcode, std::string_view payload) {
+                messages.emplace_back(opcode, std::string(payload));
+            };
+        }
+    };
+
+    /**
+     * A single-connection WebSocket server on the loopback interface, using blocking sockets.
+     */
+    class LoopbackServer {
+    private:
+        int listener;
+        int client = -1;
+        WebSocketFrameParser parser;
+        Received received;
+        std::vector<bool> compressed;
+        std::size_t delivered = 0;
+
+    public:
+        int port = 0;
+
+        LoopbackServer() : listener(::socket(AF_INET, SOCK_STREAM, 0)) {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            REQUIRE(::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+            REQUIRE(::listen(listener, 4) == 0);
+            socklen_t size = sizeof(address);
+            ::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &size);
+            port = ntohs(address.sin_port);
+        }
+
+        ~LoopbackServer() {
+            if (client >= 0) {
+                ::close(client);
+            }
+            ::close(listener);
+        }
+
+        std::string url() const {
+            return "ws://127.0.0.1:" + std::to_string(port) + "/lightstreamer";
+        }
+
+        // Accepts the connection and answers the upgrade; returns the request head.
+        std::string accept(const std::string &extensions = "") {
+            client = ::accept(listener, nullptr, nullptr);
+            std::string request;
+            char buffer[4096];
+            while (request.find("\r\n\r\n") == std::string::npos) {
+                ssize_t n = ::recv(client, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                    return request;
+                }
+                request.append(buffer, static_cast<std::size_t>(n));
+            }
+            auto keyStart = request.find("Sec-WebSocket-Key: ") + 19;
+            std::string key = request.substr(keyStart, request.find("\r\n", keyStart) - keyStart);
+            write("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  "Sec-WebSocket-Accept: " + WebSocketHandshake::acceptKey(key) + "\r\n" +
+                  (extensions.empty() ? "" : "Sec-WebSocket-Extensions: " + extensions + "\r\n") + "\r\n");
+            return request;
+        }
+
+        void write(const std::string &bytes) {
+            std::size_t sent = 0;
+            while (sent < bytes.size()) {
+                ssize_t n = ::send(client, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) {
+                    return;
+                }
+                sent += static_cast<std::size_t>(n);
+            }
+        }
+
+        // Reads the next client frame.
+        void allowCompression() {
+            parser.setCompressionAllowed(true);
+        }
+
+        bool lastFrameCompressed() {
+            return compressed[delivered - 1];
+        }
+
+        std::pair<WebSocketOpcode, std::string> readFrame() {
+            char buffer[4096];
+            while (delivered == received.messages.size()) {
+                ssize_t n = ::recv(client, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                    return {WebSocketOpcode::CLOSE, ""};
+                }
+                parser.parse(buffer, static_cast<std::size_t>(n), [this](WebSocketOpcode opcode, std::string_view payload) {
+                    received.messages.emplace_back(opcode, std::string(payload));
+                    compressed.push_back(parser.isCompressed());
+                });
+            }
+            return received.messages[delivered++];
+        }
+    };
+
+    class RecordingListener : public SessionRequestListener {
+    public:
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::string> messages;
+        int opened = 0;
+        int closed = 0;
+        int broken = 0;
+
+        void onMessage(const std::string &message) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.push_back(message);
+            changed.notify_all();
+        }
+
+        void onOpen() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++opened;
+            changed.notify_all();
+        }
+
+        void onClosed() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++closed;
+            changed.notify_all();
+        }
+
+        void onBroken() override {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++broken;
+            changed.notify_all();
+        }
+
+        template<typename P>
+        bool waitFor(P predicate) {
+            std::unique_lock<std::mutex> lock(mutex);
+            return changed.wait_for(lock, std::chrono::seconds(5), predicate);
+        }
+    };
+}
+
+TEST_CASE("WebSocketFrameParser reassembles frames split at any byte", "[EpollWebSocket]") {
+    std::string big(70000, 'x');
+    std::string stream;
+    encodeFrame(stream, WebSocketOpcode::TEXT, "hello", 0x12345678);
+    encodeFrame(stream, WebSocketOpcode::TEXT, std::string(300, 'y'), 0x9abcdef0);
+    stream += serverFrame(WebSocketOpcode::TEXT, big);
+
+    for (std::size_t chunk: {std::size_t(1), std::size_t(7), std::size_t(4096), stream.size()}) {
+        WebSocketFrameParser parser;
+        Received received;
+        std::string copy = stream;
+        for (std::size_t pos = 0; pos < copy.size(); pos += chunk) {
+            parser.parse(copy.data() + pos, std::min(chunk, copy.size() - pos), received.sink());
+        }
+        REQUIRE(received.messages.size() == 3);
+        REQUIRE(received.messages[0].second == "hello");
+        REQUIRE(received.messages[1].second == std::string(300, 'y'));
+        REQUIRE(received.messages[2].second == big);
+    }
+}
+
+TEST_CASE("WebSocketFrameParser delivers control frames interleaved with fragments", "[EpollWebSocket]") {
+    std::string stream = serverFrame(WebSocketOpcode::TEXT, "abc", false)
+                         + serverFrame(WebSocketOpcode::PING, "p")
+                         + serverFrame(WebSocketOpcode::CONTINUATION, "def", false)
+                         + serverFrame(WebSocketOpcode::CONTINUATION, "ghi");
+    WebSocketFrameParser parser;
+    Received received;
+    parser.parse(stream.data(), stream.size(), received.sink());
+    REQUIRE(received.messages.size() == 2);
+    REQUIRE(received.messages[0].first == WebSocketOpcode::PING);
+    REQUIRE(received.messages[1].first == WebSocketOpcode::TEXT);
+    REQUIRE(received.messages[1].second == "abcdefghi");
+
+    auto fails = [](std::string bytes, std::size_t max = WebSocketFrameParser::DEFAULT_MAX_MESSAGE_SIZE) {
+        WebSocketFrameParser rejecting(max);
+        Received ignored;
+        REQUIRE_THROWS_AS(rejecting.parse(bytes.data(), bytes.size(), ignored.sink()), WebSocketProtocolError);
+    };
+    fails(serverFrame(WebSocketOpcode::CONTINUATION, "x"));
+    fails(serverFrame(WebSocketOpcode::PING, "x", false));
+    fails(serverFrame(WebSocketOpcode::PING, std::string(126, 'x')));
+    fails(std::string("\xC1\x00", 2));
+    fails(serverFrame(WebSocketOpcode::TEXT, std::string(100, 'x')), 10);
+}
+
+TEST_CASE("maskPayload matches byte-wise masking at any size and offset", "[EpollWebSocket]") {
+    const unsigned char key[4] = {0x12, 0x9a, 0xf0, 0x3c};
+    std::string original;
+    for (int i = 0; i < 300; ++i) {
+        original.push_back(static_cast<char>(i * 7));
+    }
+    for (std::size_t size: {0, 1, 3, 8, 15, 16, 31, 32, 33, 63, 64, 65, 127, 300}) {
+        for (std::size_t offset = 0; offset < 4; ++offset) {
+            for (std::size_t start: {0, 1}) {
+                std::size_t length = std::min(size, original.size() - start);
+                std::string masked = original;
+                maskPayload(masked.data() + start, length, key, offset);
+                std::string expected = original;
+                for (std::size_t i = 0; i < length; ++i) {
+                    expected[start + i] = static_cast<char>(expected[start + i] ^ key[(offset + i) & 3]);
+                }
+                REQUIRE(masked == expected);
+                maskPayload(masked.data() + start, length, key, offset);
+                REQUIRE(masked == original);
+            }
+        }
+    }
+}
+
+TEST_CASE("WebSocketHandshake computes the RFC 6455 accept key", "[EpollWebSocket]") {
+    REQUIRE(WebSocketHandshake::acceptKey("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+    REQUIRE(WebSocketAddress::parse("wss://push.example.com/ls").secure);
+    REQUIRE(WebSocketAddress::parse("wss://push.example.com/ls").port == 443);
+    REQUIRE(WebSocketAddress::parse("ws://[::1]:8080").host == "::1");
+    REQUIRE(WebSocketAddress::parse("ws://[::1]:8080").port == 8080);
+    REQUIRE(WebSocketAddress::parse("http://host:81/a/b").path == "/a/b");
+}
+
+TEST_CASE("LineAssembler splits lines in place and copies only the ones spanning segments", "[EpollWebSocket]") {
+    auto pool = std::make_shared<ReceiveBufferPool>(64, 2);
+    LineAssembler assembler(pool);
+    {
+        auto buffer = pool->acquire();
+        std::string bytes = "U,1,1|a\r\nU,1,2|b\r\nPRO";
+        std::memcpy(buffer->data(), bytes.data(), bytes.size());
+        std::string_view data(buffer->data(), bytes.size());
+        // A segment contiguous with the pending tail extends it in place.
+        assembler.append(buffer, data.substr(0, 3));
+        assembler.append(buffer, data.substr(3));
+        std::string more = "BE\r\nCONO";
+        std::memcpy(buffer->data() + bytes.size(), more.data(), more.size());
+        assembler.append(buffer, std::string_view(buffer->data() + bytes.size(), more.size()));
+    }
+    // The tail continues in another buffer, then in a third segment: the line is copied.
+    assembler.append("K,S1,");
+    assembler.append("50\r\n");
+    LineBatch batch = assembler.take();
+    REQUIRE(batch.size() == 4);
+    REQUIRE(batch[0] == "U,1,1|a");
+    REQUIRE(batch[1] == "U,1,2|b");
+    REQUIRE(batch[2] == "PROBE");
+    REQUIRE(batch[3] == "CONOK,S1,50");
+    REQUIRE(batch.getCopiedCount() == 1);
+    REQUIRE_FALSE(assembler.hasLines());
+
+    // Lines longer than a buffer span several of them.
+    std::string longLine(150, 'x');
+    assembler.append(longLine + "\n\r\n");
+    LineBatch second = assembler.take();
+    REQUIRE(second.size() == 2);
+    REQUIRE(second[0] == longLine);
+    REQUIRE(second[1].empty());
+
+    // The buffers go back to the pool once the batches and the assembler let them go.
+    batch = LineBatch();
+    second = LineBatch();
+    assembler.reset();
+    REQUIRE(pool->getPooledCount() == 2);
+}
+
+TEST_CASE("ReceiveBufferChain moves to a fresh buffer while batches refer to the current one", "[EpollWebSocket]") {
+    auto pool = std::make_shared<ReceiveBufferPool>(16, 4);
+    ReceiveBufferChain chain(pool);
+    LineAssembler assembler(pool);
+    auto receive = [&](const std::string &bytes) {
+        char *target = chain.writable();
+        REQUIRE(chain.writableSize() >= bytes.size());
+        std::memcpy(target, bytes.data(), bytes.size());
+        chain.commit(bytes.size());
+        assembler.append(chain.getBuffer(), std::string_view(chain.data(), chain.size()));
+        chain.consume(chain.size());
+    };
+    receive("abc\ndefgh\nij");
+    auto first = chain.getBuffer();
+    LineBatch batch = assembler.take();
+    receive("k\n");
+    // Joined in place: the buffer still had room.
+    REQUIRE(chain.getBuffer() == first);
+    LineBatch next = assembler.take();
+    REQUIRE(next.size() == 1);
+    REQUIRE(next[0] == "ijk");
+    REQUIRE(next.getCopiedCount() == 0);
+    receive("lm");
+    REQUIRE(chain.getBuffer() != first);
+    REQUIRE(batch[0] == "abc");
+    REQUIRE(batch[1] == "defgh");
+
+    // Once nobody refers to it, the buffer is compacted in place.
+    batch = LineBatch();
+    next = LineBatch();
+    auto second = chain.getBuffer();
+    assembler.reset();
+    second.reset();
+    receive("nopqrstuvwxyz\n");
+    REQUIRE(assembler.take().size() == 1);
+    ReceiveBuffer *current = chain.getBuffer().get();
+    receive("0123\n");
+    REQUIRE(chain.getBuffer().get() == current);
+    LineBatch last = assembler.take();
+    REQUIRE(last.size() == 1);
+    REQUIRE(last[0] == "0123");
+}
+
+TEST_CASE("EpollWebSocketProvider exchanges TLCP lines with a loopback server", "[EpollWebSocket]") {
+    LoopbackServer server;
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+    auto listener = std::make_shared<RecordingListener>();
+    EpollWebSocketProvider provider(loop);
+
+    // Catch2 assertions are not thread-safe: the server thread only records what it saw.
+    std::string request;
+    std::pair<WebSocketOpcode, std::string> pong;
+    std::pair<WebSocketOpcode, std::string> sent;
+    std::pair<WebSocketOpcode, std::string> closing;
+    std::thread serverThread([&] {
+        request = server.accept();
+        // A line split across frames, two lines in one frame and a ping in between.
+        server.write(serverFrame(WebSocketOpcode::TEXT, "CONOK,S1,50000,5000,*\r\nPRO"));
+        server.write(serverFrame(WebSocketOpcode::PING, "hb"));
+        server.write(serverFrame(WebSocketOpcode::TEXT, "BE\r\nLOOP,0\r\n"));
+        // The message may be written before or after the pong, depending on when the handshake ends.
+        sent = server.readFrame();
+        pong = server.readFrame();
+        if (sent.first == WebSocketOpcode::PONG) {
+            std::swap(sent, pong);
+        }
+        server.write(serverFrame(WebSocketOpcode::TEXT, "echo," + sent.second + "\r\n"));
+        server.write(serverFrame(WebSocketOpcode::CLOSE, std::string("\x03\xE8", 2)));
+        closing = server.readFrame();
+    });
+
+    provider.connect(server.url(), listener, {}, "a=1", nullptr, 5000);
+    provider.send("wsok", nullptr);
+    REQUIRE(listener->waitFor([&] { return listener->closed == 1; }));
+    serverThread.join();
+    REQUIRE(request.find("GET /lightstreamer HTTP/1.1") == 0);
+    REQUIRE(request.find("Sec-WebSocket-Protocol: TLCP-2.1.0.lightstreamer.com") != std::string::npos);
+    REQUIRE(request.find("Cookie: a=1") != std::string::npos);
+    REQUIRE(pong == std::make_pair(WebSocketOpcode::PONG, std::string("hb")));
+    REQUIRE(sent == std::make_pair(WebSocketOpcode::TEXT, std::string("wsok")));
+    REQUIRE(closing.first == WebSocketOpcode::CLOSE);
+    REQUIRE(listener->opened == 1);
+    REQUIRE(listener->broken == 0);
+    REQUIRE(listener->messages == std::vector<std::string>{"CONOK,S1,50000,5000,*", "PROBE", "LOOP,0", "echo,wsok"});
+}
+
+TEST_CASE("EpollWebSocketProvider writes a batch of messages in order and notifies once", "[EpollWebSocket]") {
+    LoopbackServer server;
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+    auto listener = std::make_shared<RecordingListener>();
+    auto written = std::make_shared<RecordingListener>();
+    EpollWebSocketProvider provider(loop);
+
+    std::vector<std::pair<WebSocketOpcode, std::string>> frames;
+    std::thread serverThread([&] {
+        server.accept();
+        for (int i = 0; i < 5; ++i) {
+            frames.push_back(server.readFrame());
+        }
+        server.write(serverFrame(WebSocketOpcode::CLOSE, std::string("\x03\xE8", 2)));
+        server.readFrame();
+    });
+
+    provider.connect(server.url(), listener, {}, "", nullptr, 5000);
+    // Deferred until the end of the handshake, then written once open.
+    provider.sendBatch({"control\r\nLS_reqId=1\r\nLS_reqId=2", "msg\r\nLS_reqId=3"}, written);
+    REQUIRE(listener->waitFor([&] { return listener->opened == 1; }));
+    provider.sendBatch({"control\r\nLS_reqId=4", "heartbeat\r\n", "control\r\nLS_reqId=5"}, written);
+    REQUIRE(listener->waitFor([&] { return listener->closed == 1; }));
+    serverThread.join();
+    REQUIRE(frames == std::vector<std::pair<WebSocketOpcode, std::string>>{
+            {WebSocketOpcode::TEXT, "control\r\nLS_reqId=1\r\nLS_reqId=2"},
+            {WebSocketOpcode::TEXT, "msg\r\nLS_reqId=3"},
+            {WebSocketOpcode::TEXT, "control\r\nLS_reqId=4"},
+            {WebSocketOpcode::TEXT, "heartbeat\r\n"},
+            {WebSocketOpcode::TEXT, "control\r\nLS_reqId=5"}});
+    REQUIRE(written->opened == 2);
+}
+
+TEST_CASE("EpollWebSocketProvider reports refused connections, timeouts and proxies as broken", "[EpollWebSocket]") {
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+
+    int closedPort;
+    {
+        LoopbackServer unused;
+        closedPort = unused.port;
+    }
+    auto refused = std::make_shared<RecordingListener>();
+    EpollWebSocketProvider first(loop);
+    first.connect("ws://127.0.0.1:" + std::to_string(closedPort), refused, {}, "", nullptr, 5000);
+    REQUIRE(refused->waitFor([&] { return refused->broken == 1; }));
+
+    // Accepted by the kernel, never upgraded.
+    LoopbackServer silent;
+    auto timedOut = std::make_shared<RecordingListener>();
+    EpollWebSocketProvider second(loop);
+    second.connect(silent.url(), timedOut, {}, "", nullptr, 50);
+    REQUIRE(timedOut->waitFor([&] { return timedOut->broken == 1; }));
+    REQUIRE(timedOut->opened == 0);
+
+    auto proxied = std::make_shared<RecordingListener>();
+    EpollWebSocketProvider third(loop);
+    third.connect(silent.url(), proxied, {}, "", std::make_shared<lightstreamer::client::Proxy>("HTTP", "127.0.0.1", 3128, "", ""), 50);
+    REQUIRE(proxied->broken == 1);
+}
+
+#if defined(LIGHTSTREAMER_USE_ZLIB)
+TEST_CASE("permessage-deflate negotiation follows RFC 7692", "[EpollWebSocket]") {
+    DeflateOptions options;
+    options.serverNoContextTakeover = true;
+    REQUIRE(DeflateParameters::offer(options) ==
+            "permessage-deflate; client_max_window_bits; server_no_context_takeover");
+    options.enabled = false;
+    REQUIRE(DeflateParameters::offer(options).empty());
+    REQUIRE_THROWS_AS(DeflateParameters::negotiate("permessage-deflate", options), WebSocketProtocolError);
+
+    options = DeflateOptions();
+    REQUIRE_FALSE(DeflateParameters::negotiate("", options));
+    auto parameters = DeflateParameters::negotiate(
+            "permessage-deflate; server_no_context_takeover; client_max_window_bits=\"10\"", options);
+    REQUIRE(parameters);
+    REQUIRE(parameters->serverNoContextTakeover);
+    REQUIRE_FALSE(parameters->clientNoContextTakeover);
+    REQUIRE(parameters->clientMaxWindowBits == 10);
+    REQUIRE_THROWS_AS(DeflateParameters::negotiate("x-webkit-deflate-frame", options), WebSocketProtocolError);
+    REQUIRE_THROWS_AS(DeflateParameters::negotiate("permessage-deflate; foo", options), WebSocketProtocolError);
+    REQUIRE_THROWS_AS(DeflateParameters::negotiate("permessage-deflate; client_max_window_bits=8", options),
+                      WebSocketProtocolError);
+    REQUIRE_THROWS_AS(DeflateParameters::negotiate("permessage-deflate; server_max_window_bits=16", options),
+                      WebSocketProtocolError);
+}
+
+TEST_CASE("PerMessageDeflate keeps its contexts across messages", "[EpollWebSocket]") {
+    // RFC 7692, 7.2.3.1: "Hello" compressed.
+    PerMessageDeflate client{DeflateParameters()};
+    std::string out = "tail:";
+    client.inflate(std::string("\xf2\x48\xcd\xc9\xc9\x07\x00", 7), out);
+    REQUIRE(out == "tail:Hello");
+
+    PerMessageDeflate server{DeflateParameters()};
+    std::string update = "U,3,1,101.25|1000|20260101 10:00:00.000|BID|ASK|MID\r\n";
+    std::string first(server.deflate(update));
+    std::string second(server.deflate(update));
+    // The second message refers back to the first one.
+    REQUIRE(second.size() < first.size() / 2);
+    std::string inflated;
+    client.inflate(first, inflated);
+    client.inflate(second, inflated);
+    REQUIRE(inflated == update + update);
+
+    DeflateParameters resetting;
+    resetting.clientNoContextTakeover = true;
+    PerMessageDeflate independent{resetting};
+    std::string a(independent.deflate(update));
+    std::string b(independent.deflate(update));
+    REQUIRE(a == b);
+
+    PerMessageDeflate bounded{DeflateParameters(), -1, 1000};
+    std::string bomb(server.deflate(std::string(100000, 'z')));
+    std::string sink;
+    REQUIRE_THROWS_AS(bounded.inflate(bomb, sink), WebSocketProtocolError);
+}
+
+TEST_CASE("PerMessageDeflate inflates into the pooled buffers of a LineAssembler", "[EpollWebSocket]") {
+    PerMessageDeflate server{DeflateParameters()};
+    PerMessageDeflate client{DeflateParameters()};
+    auto pool = std::make_shared<ReceiveBufferPool>(256, 4);
+    LineAssembler assembler(pool);
+    std::string update = "U,3,1,101.25|1000|20260101 10:00:00.000|BID|ASK|MID\r\n";
+    std::string message;
+    for (int i = 0; i < 8; ++i) {
+        message += update;
+    }
+    client.inflate(std::string(server.deflate(message)), assembler);
+    client.inflate(std::string(server.deflate(update)), assembler);
+    LineBatch batch = assembler.take();
+    REQUIRE(batch.size() == 9);
+    for (std::string_view line: batch) {
+        REQUIRE(line == update.substr(0, update.size() - 2));
+    }
+    // Lines are views on the pooled buffers; only the one crossing a buffer boundary is copied.
+    REQUIRE(batch.getCopiedCount() == message.size() / 256);
+
+    PerMessageDeflate bounded{DeflateParameters(), -1, 1000};
+    REQUIRE_THROWS_AS(bounded.inflate(std::string(server.deflate(std::string(100000, 'z'))), assembler),
+                      WebSocketProtocolError);
+}
+
+TEST_CASE("EpollWebSocketProvider exchanges compressed messages", "[EpollWebSocket]") {
+    LoopbackServer server;
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+    auto listener = std::make_shared<RecordingListener>();
+    EpollWebSocketProvider provider(loop);
+
+    std::string request;
+    std::string longMessage = "control\r\nLS_reqId=1&LS_op=add&LS_subId=1&LS_mode=MERGE&LS_group=item1&LS_schema=a";
+    std::pair<WebSocketOpcode, std::string> shortSent;
+    std::pair<WebSocketOpcode, std::string> longSent;
+    bool shortCompressed = true;
+    bool longCompressed = false;
+    std::thread serverThread([&] {
+        request = server.accept("permessage-deflate; client_max_window_bits=15");
+        server.allowCompression();
+        PerMessageDeflate context{DeflateParameters()};
+        server.write(serverFrame(WebSocketOpcode::TEXT, std::string(context.deflate("CONOK,S1,50000,5000,*\r\nU,1,1,a")),
+                                 true, true));
+        server.write(serverFrame(WebSocketOpcode::TEXT, "|b\r\n"));
+        server.write(serverFrame(WebSocketOpcode::TEXT, std::string(context.deflate("U,1,1,a|b\r\n")), true, true));
+        shortSent = server.readFrame();
+        shortCompressed = server.lastFrameCompressed();
+        longSent = server.readFrame();
+        longCompressed = server.lastFrameCompressed();
+        if (longCompressed) {
+            std::string inflated;
+            context.inflate(longSent.second, inflated);
+            longSent.second = inflated;
+        }
+        server.write(serverFrame(WebSocketOpcode::CLOSE, std::string("\x03\xE8", 2)));
+        server.readFrame();
+    });
+
+    provider.connect(server.url(), listener, {}, "", nullptr, 5000);
+    REQUIRE(listener->waitFor([&] { return listener->messages.size() == 3; }));
+    provider.send("wsok", nullptr);
+    provider.send(longMessage, nullptr);
+    REQUIRE(listener->waitFor([&] { return listener->closed == 1; }));
+    serverThread.join();
+    REQUIRE(request.find("Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n") != std::string::npos);
+    REQUIRE(listener->messages == std::vector<std::string>{"CONOK,S1,50000,5000,*", "U,1,1,a|b", "U,1,1,a|b"});
+    REQUIRE(shortSent.second == "wsok");
+    REQUIRE_FALSE(shortCompressed);
+    REQUIRE(longCompressed);
+    REQUIRE(longSent.second == longMessage);
+}
+#endif
+
+TEST_CASE("EpollWebSocketProvider loopback throughput and round-trip latency", "[.][benchmark][EpollWebSocket]") {
+    constexpr int frames = 20000;
+    constexpr int linesPerFrame = 10;
+    constexpr int roundTrips = 10000;
+    LoopbackServer server;
+    auto loop = std::make_shared<EmbeddedEventLoop>();
+    EventLoopThread loopThread(loop);
+
+    struct CountingListener : SessionRequestListener {
+        std::atomic<long> lines{0};
+        void onMessage(const std::string &) override { lines.fetch_add(1, std::memory_order_release); }
+        void onOpen() override {}
+        void onClosed() override {}
+        void onBroken() override {}
+    };
+    auto listener = std::make_shared<CountingListener>();
+    EpollWebSocketProvider provider(loop);
+
+    std::thread serverThread([&] {
+        server.accept();
+        std::string frame;
+        for (int i = 0; i < linesPerFrame; ++i) {
+            frame += "U,1,1,101.25|1000|20260101 10:00:00.000|BID\r\n";
+        }
+        std::string burst;
+        for (int i = 0; i < frames; ++i) {
+            burst += serverFrame(WebSocketOpcode::TEXT, frame);
+        }
+        server.write(burst);
+        for (int i = 0; i < roundTrips; ++i) {
+            auto request = server.readFrame();
+            server.write(serverFrame(WebSocketOpcode::TEXT, request.second + "\r\n"));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    provider.connect(server.url(), listener, {}, "", nullptr, 5000);
+    constexpr long totalLines = static_cast<long>(frames) * linesPerFrame;
+    while (listener->lines.load(std::memory_order_acquire) < totalLines) {
+        std::this_thread::yield();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<long> latencies;
+    latencies.reserve(roundTrips);
+    for (int i = 0; i < roundTrips; ++i) {
+        long expected = totalLines + i + 1;
+        auto sent = std::chrono::steady_clock::now();
+        provider.send("MSG," + std::to_string(i), nullptr);
+        while (listener->lines.load(std::memory_order_acquire) < expected) {
+            std::this_thread::yield();
+        }
+        latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - sent).count());
+    }
+    serverThread.join();
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "EpollWebSocketProvider: " << static_cast<long>(totalLines / seconds) << " lines/s, round trip ns p50="
+              << latencies[latencies.size() / 2] << " p99=" << latencies[latencies.size() * 99 / 100]
+              << " max=" << latencies.back() << std::endl;
+}
+
+TEST_CASE("maskPayload throughput against byte-wise masking", "[.][benchmark][EpollWebSocket]") {
+    const unsigned char key[4] = {0x12, 0x9a, 0xf0, 0x3c};
+    std::string payload(64 * 1024, 'x');
+    constexpr int rounds = 20000;
+    auto measure = [&](auto &&mask) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            mask(payload.data(), payload.size());
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(payload.size()) * rounds / seconds / (1 << 30);
+    };
+    double bytewise = measure([&](char *data, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<char>(data[i] ^ key[i & 3]);
+        }
+        asm volatile("" : : "r"(data) : "memory");
+    });
+    double wide = measure([&](char *data, std::size_t size) {
+        maskPayload(data, size, key);
+        asm volatile("" : : "r"(data) : "memory");
+    });
+    std::cout << "maskPayload: " << wide << " GiB/s, byte-wise: " << bytewise << " GiB/s" << std::endl;
+}
@@ -0,0 +1,765 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/util/threads/MpscQueue.hpp>
+#include <lightstreamer/client/events/EventsThread.hpp>
+#include <lightstreamer/client/events/EventDispatcher.hpp>
+#include <lightstreamer/client/events/EventsThreadPool.hpp>
+#include <lightstreamer/client/events/InlineListeners.hpp>
+#include <lightstreamer/client/events/ItemUpdateBatcher.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace lightstreamer::util::threads;
+using namespace lightstreamer::client::events;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    /**
+     * The mutex + condition variable events thread that EventsThread replaced, kept as the benchmark baseline.
+     */
+    class MutexEventsThread {
+        std::queue<std::function<void()>> tasks;
+        std::mutex queue_mutex;
+        std::condition_variable condition;
+        bool stop = false;
+        std::thread worker_thread;
+
+        void worker() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(queue_mutex);
+                    condition.wait(lock, [this] { return stop || !tasks.empty(); });
+                    if (stop && tasks.empty()) return;
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+
+    public:
+        MutexEventsThread() : worker_thread(&MutexEventsThread::worker, this) {}
+
+        ~MutexEventsThread() {
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                stop = true;
+            }
+            condition.notify_all();
+            worker_thread.join();
+        }
+
+        void queue(const std::function<void()>& task) {
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                tasks.emplace(task);
+            }
+            condition.notify_one();
+        }
+    };
+
+    struct BenchResult {
+        double seconds;
+        std::vector<long long> latenciesNs;
+    };
+
+    /**
+     * Two producers each offering ratePerProducer events/s (0 = as fast as possible) for eventsPerProducer events.
+     * Latency is measured from enqueue to execution on the events thread.
+     */
+    template<typename Thread>
+    BenchResult runBench(long eventsPerProducer, long ratePerProducer) {
+        BenchResult result;
+        result.latenciesNs.assign(2 * eventsPerProducer, 0);
+        auto start = Clock::now();
+        {
+            Thread thread;
+            auto producer = [&](long offset) {
+                auto period = ratePerProducer > 0 ? std::chrono::nanoseconds(1000000000L / ratePerProducer)
+                                                  : std::chrono::nanoseconds(0);
+                auto next = Clock::now();
+                for (long i = 0; i < eventsPerProducer; ++i) {
+                    if (ratePerProducer > 0) {
+                        while (Clock::now() < next) {}
+                        next += period;
+                    }
+                    auto enqueued = Clock::now();
+                    long slot = offset + i;
+                    thread.queue([&result, slot, enqueued] {
+                        result.latenciesNs[slot] =
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - enqueued).count();
+                    });
+                }
+            };
+            std::thread p1(producer, 0L);
+            std::thread p2(producer, eventsPerProducer);
+            p1.join();
+            p2.join();
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+
+    void report(const std::string& name, BenchResult result) {
+        auto& l = result.latenciesNs;
+        std::sort(l.begin(), l.end());
+        auto pct = [&l](double p) { return l[static_cast<size_t>(p * (l.size() - 1))]; };
+        std::cout << name << ": " << static_cast<long>(l.size() / result.seconds) << " events/s, latency ns p50="
+                  << pct(0.5) << " p99=" << pct(0.99) << " p99.9=" << pct(0.999) << " max=" << l.back() << std::endl;
+    }
+}
+
+TEST_CASE("MpscQueue preserves FIFO order", "[EventsThread]") {
+    MpscQueue<int> queue(4);
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i);
+    }
+    REQUIRE(queue.overflowAllocations() > 0);
+    for (int i = 0; i < 10; ++i) {
+        auto value = queue.tryPop();
+        REQUIRE(value.has_value());
+        REQUIRE(*value == i);
+    }
+    REQUIRE(queue.empty());
+    REQUIRE_FALSE(queue.tryPop().has_value());
+}
+
+TEST_CASE("MpscQueue delivers every element from concurrent producers", "[EventsThread]") {
+    constexpr int perProducer = 100000;
+    MpscQueue<std::pair<int, int>> queue(256);
+    std::thread p1([&] { for (int i = 0; i < perProducer; ++i) queue.push(std::make_pair(0, i)); });
+    std::thread p2([&] { for (int i = 0; i < perProducer; ++i) queue.push(std::make_pair(1, i)); });
+
+    int last[2] = {-1, -1};
+    int received = 0;
+    bool ordered = true;
+    while (received < 2 * perProducer) {
+        received += static_cast<int>(queue.drain([&](std::pair<int, int>&& v) {
+            ordered = ordered && v.second == last[v.first] + 1;
+            last[v.first] = v.second;
+        }, 64));
+    }
+    p1.join();
+    p2.join();
+    REQUIRE(ordered);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("EventsThread runs queued tasks in order and drains on destruction", "[EventsThread]") {
+    std::vector<int> executed;
+    {
+        EventsThread thread(8);
+        for (int i = 0; i < 1000; ++i) {
+            thread.queue([&executed, i] { executed.push_back(i); });
+        }
+    }
+    REQUIRE(executed.size() == 1000);
+    REQUIRE(std::is_sorted(executed.begin(), executed.end()));
+}
+
+TEST_CASE("EventsThread vs mutex queue at 1M events/s from two producers", "[.][benchmark][EventsThread]") {
+    constexpr long perProducer = 1000000;
+    report("EventsThread (paced 1M/s)", runBench<EventsThread>(perProducer, 500000));
+    report("MutexEventsThread (paced 1M/s)", runBench<MutexEventsThread>(perProducer, 500000));
+    report("EventsThread (saturated)", runBench<EventsThread>(perProducer, 0));
+    report("MutexEventsThread (saturated)", runBench<MutexEventsThread>(perProducer, 0));
+}
+
+TEST_CASE("EventsThread reports depth and watermark crossings", "[EventsThread]") {
+    struct Recorder : EventQueueListener {
+        std::atomic<int> highs{0};
+        std::atomic<int> lows{0};
+        void onHighWatermark(std::size_t) override { ++highs; }
+        void onLowWatermark(std::size_t) override { ++lows; }
+    };
+    auto recorder = std::make_shared<Recorder>();
+    std::promise<void> gate;
+    auto released = gate.get_future().share();
+    {
+        EventsThread thread(64);
+        REQUIRE_THROWS_AS(thread.setWatermarks(recorder, 4, 4), std::invalid_argument);
+        thread.setWatermarks(recorder, 8, 2);
+        thread.queue([released] { released.wait(); });
+        for (int i = 0; i < 16; ++i) {
+            thread.queue([] {});
+        }
+        REQUIRE(thread.getQueueDepth() >= 16);
+        REQUIRE(recorder->highs == 1);
+        gate.set_value();
+        thread.awaitDepthBelow(1);
+        REQUIRE(thread.getQueueDepth() == 0);
+    }
+    REQUIRE(recorder->lows == 1);
+}
+
+TEST_CASE("EventsThread delivers every task and stops with the spinning wait strategies", "[EventsThread]") {
+    for (auto strategy: {WaitStrategy::spinThenPark(std::chrono::microseconds(20)), WaitStrategy::busySpin()}) {
+        constexpr int tasks = 20000;
+        std::atomic<int> run{0};
+        auto thread = std::make_unique<EventsThread>(EventsThread::DEFAULT_POOL_SIZE, strategy);
+        auto producer = [&] {
+            for (int i = 0; i < tasks; ++i) {
+                thread->queue([&run] { run.fetch_add(1, std::memory_order_relaxed); });
+                // Pauses let the consumer run dry, so that it spins and, with SPIN_THEN_PARK, parks.
+                if (i % 1000 == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        };
+        std::thread p1(producer);
+        std::thread p2(producer);
+        p1.join();
+        p2.join();
+        thread->awaitDepthBelow(1);
+        int delivered = run.load();
+
+        // Destroying the instance stops the thread, even while it is spinning.
+        auto stopped = std::async(std::launch::async, [&thread] { thread.reset(); });
+        bool joined = stopped.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+        REQUIRE(delivered == 2 * tasks);
+        REQUIRE(joined);
+    }
+}
+
+namespace {
+
+    struct CountingListener {
+        std::mutex mutex;
+        std::vector<int> values;
+        std::vector<std::thread::id> threads;
+        std::function<void(int)> onValue;
+
+        void record(int value) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                values.push_back(value);
+                threads.push_back(std::this_thread::get_id());
+            }
+            if (onValue) {
+                onValue(value);
+            }
+        }
+
+        std::vector<int> snapshot() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return values;
+        }
+    };
+
+    struct ValueEvent : Event<CountingListener> {
+        int value;
+
+        explicit ValueEvent(int value) : value(value) {}
+
+        void applyTo(CountingListener &listener) const override {
+            listener.record(value);
+        }
+    };
+}
+
+TEST_CASE("EventDispatcher applies listener changes made during a delivery to later dispatches", "[EventsThread]") {
+    auto thread = std::make_shared<EventsThread>();
+    EventDispatcher<CountingListener> dispatcher(thread);
+    auto first = std::make_shared<CountingListener>();
+    auto removed = std::make_shared<CountingListener>();
+    auto added = std::make_shared<CountingListener>();
+    // The first listener changes the list while event 1 is being delivered.
+    first->onValue = [&](int value) {
+        if (value == 1) {
+            dispatcher.removeListener(removed);
+            dispatcher.addListener(added);
+        }
+    };
+    dispatcher.addListener(first);
+    dispatcher.addListener(removed);
+    dispatcher.dispatchEvent(ValueEvent(1));
+    dispatcher.dispatchEvent(ValueEvent(2));
+    thread->awaitDepthBelow(1);
+    dispatcher.dispatchEvent(ValueEvent(3));
+    thread->awaitDepthBelow(1);
+
+    REQUIRE(first->snapshot() == std::vector<int>{1, 2, 3});
+    // Removed before its turn in event 1: the events already dispatched are not delivered either.
+    REQUIRE(removed->snapshot().empty());
+    // Events 1 and 2 were dispatched with the old snapshot.
+    REQUIRE(added->snapshot() == std::vector<int>{3});
+    REQUIRE(dispatcher.size() == 2);
+}
+
+TEST_CASE("EventDispatcher events still queued on a shared thread outlive the dispatcher", "[EventsThread]") {
+    auto thread = std::make_shared<EventsThread>();
+    auto shared = std::make_shared<CountingListener>();
+    auto own = std::make_shared<CountingListener>();
+    auto ownThread = std::make_shared<EventsThread>();
+    // A failing listener makes the delivery log, which must not need the dispatcher either.
+    shared->onValue = [](int) { throw std::runtime_error("Listener failure"); };
+    std::promise<void> gate;
+    auto opened = gate.get_future().share();
+    thread->queue([opened] { opened.wait(); });
+    ownThread->queue([opened] { opened.wait(); });
+    {
+        EventDispatcher<CountingListener> dispatcher(thread);
+        dispatcher.addListener(shared);
+        dispatcher.addListener(own, nullptr, ownThread);
+        dispatcher.dispatchEvent(ValueEvent(1));
+        dispatcher.removeListener(shared, std::make_shared<const ValueEvent>(2));
+    }
+    // The dispatcher is gone, as when a Subscription is destroyed with events pending on its shard.
+    gate.set_value();
+    thread->awaitDepthBelow(1);
+    ownThread->awaitDepthBelow(1);
+    REQUIRE(shared->snapshot() == std::vector<int>{2});
+    REQUIRE(own->snapshot() == std::vector<int>{1});
+}
+
+TEST_CASE("EventDispatcher delivers in order while listeners are added and removed concurrently", "[EventsThread]") {
+    constexpr int events = 20000;
+    auto thread = std::make_shared<EventsThread>();
+    EventDispatcher<CountingListener> dispatcher(thread);
+    auto stable = std::make_shared<CountingListener>();
+    dispatcher.addListener(stable);
+    std::vector<std::shared_ptr<CountingListener>> churn;
+    for (int i = 0; i < 8; ++i) {
+        churn.push_back(std::make_shared<CountingListener>());
+    }
+
+    std::atomic<bool> done{false};
+    std::thread changer([&] {
+        for (int round = 0; !done.load(); ++round) {
+            auto &listener = churn[round % churn.size()];
+            if (round % 2 == 0) {
+                dispatcher.addListener(listener);
+            } else {
+                dispatcher.removeListener(listener);
+            }
+        }
+    });
+    for (int i = 0; i < events; ++i) {
+        dispatcher.dispatchEvent(ValueEvent(i));
+    }
+    done = true;
+    changer.join();
+    thread->awaitDepthBelow(1);
+
+    std::vector<int> all(events);
+    for (int i = 0; i < events; ++i) {
+        all[i] = i;
+    }
+    REQUIRE(stable->snapshot() == all);
+    for (auto &listener: churn) {
+        auto values = listener->snapshot();
+        REQUIRE(std::is_sorted(values.begin(), values.end()));
+        REQUIRE(std::adjacent_find(values.begin(), values.end()) == values.end());
+    }
+}
+
+TEST_CASE("EventsThreadPool keeps the order of each subscription across shards", "[EventsThread]") {
+    constexpr int subscriptions = 8;
+    constexpr int events = 5000;
+    auto &pool = EventsThreadPool::getInstance();
+    // The pool is process-wide: it can only be sized before its first use.
+    pool.setSize(4);
+    REQUIRE(pool.getSize() == 4);
+
+    std::vector<std::unique_ptr<EventDispatcher<CountingListener>>> dispatchers;
+    std::vector<std::shared_ptr<CountingListener>> listeners;
+    std::vector<std::shared_ptr<EventsThread>> shards;
+    for (int i = 0; i < subscriptions; ++i) {
+        shards.push_back(pool.nextShard());
+        dispatchers.push_back(std::make_unique<EventDispatcher<CountingListener>>(shards.back()));
+        listeners.push_back(std::make_shared<CountingListener>());
+        dispatchers.back()->addListener(listeners.back());
+    }
+    REQUIRE_THROWS_AS(pool.setSize(2), std::logic_error);
+    int key = 0;
+    REQUIRE(pool.shardFor(&key) == pool.shardFor(&key));
+
+    // Two producers, each feeding half of the subscriptions, interleaving them.
+    auto producer = [&](int first) {
+        for (int i = 0; i < events; ++i) {
+            for (int s = first; s < subscriptions; s += 2) {
+                dispatchers[s]->dispatchEvent(ValueEvent(i));
+            }
+        }
+    };
+    std::thread p1(producer, 0);
+    std::thread p2(producer, 1);
+    p1.join();
+    p2.join();
+    for (auto &shard: shards) {
+        shard->awaitDepthBelow(1);
+    }
+
+    std::vector<int> all(events);
+    for (int i = 0; i < events; ++i) {
+        all[i] = i;
+    }
+    std::vector<std::thread::id> used;
+    for (auto &listener: listeners) {
+        REQUIRE(listener->snapshot() == all);
+        std::lock_guard<std::mutex> lock(listener->mutex);
+        // Each subscription is delivered by a single thread...
+        REQUIRE(std::all_of(listener->threads.begin(), listener->threads.end(),
+                            [&](std::thread::id id) { return id == listener->threads.front(); }));
+        used.push_back(listener->threads.front());
+    }
+    std::sort(used.begin(), used.end());
+    // ...and round-robin pinning spreads them over all the shards.
+    REQUIRE(std::unique(used.begin(), used.end()) - used.begin() == 4);
+}
+
+namespace {
+
+    struct FakeUpdate {
+        int item;
+        int value;
+
+        int getItemPos() const {
+            return item;
+        }
+
+        void conflate(FakeUpdate &&newer) {
+            value = newer.value;
+        }
+    };
+
+    struct UpdatesListener {
+        std::mutex mutex;
+        std::vector<int> values;
+        std::map<int, int> lost;
+
+        void onItemUpdates(std::span<const FakeUpdate> updates) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto &update: updates) {
+                values.push_back(update.value);
+            }
+        }
+
+        void onLost(int item, int count) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lost[item] += count;
+        }
+    };
+
+    struct LostEvent : Event<UpdatesListener> {
+        int item;
+        int count;
+
+        LostEvent(int item, int count) : item(item), count(count) {}
+
+        void applyTo(UpdatesListener &listener) const override {
+            listener.onLost(item, count);
+        }
+    };
+
+    using Batcher = ItemUpdateBatcher<UpdatesListener, FakeUpdate>;
+
+    Batcher::LostEventFactory lostEvents() {
+        return [](int item, int count) {
+            return std::shared_ptr<const Event<UpdatesListener>>(std::make_shared<const LostEvent>(item, count));
+        };
+    }
+}
+
+TEST_CASE("ItemUpdateBatcher does not accumulate updates without listeners", "[EventsThread]") {
+    auto thread = std::make_shared<EventsThread>();
+    auto dispatcher = std::make_shared<EventDispatcher<UpdatesListener>>(thread);
+    Batcher batcher(dispatcher, thread, lostEvents());
+    for (int i = 0; i < 1000; ++i) {
+        batcher.dispatch(FakeUpdate{0, i}, false);
+    }
+    REQUIRE(batcher.getPendingCount() == 0);
+    REQUIRE(thread->getQueueDepth() == 0);
+}
+
+TEST_CASE("ItemUpdateBatcher seals a queued batch whose listener was removed", "[EventsThread]") {
+    auto thread = std::make_shared<EventsThread>();
+    auto dispatcher = std::make_shared<EventDispatcher<UpdatesListener>>(thread);
+    Batcher batcher(dispatcher, thread, lostEvents());
+    auto listener = std::make_shared<UpdatesListener>();
+    dispatcher->addListener(listener);
+
+    // Hold the events thread so that the batch stays queued while the listener goes away.
+    std::promise<void> gate;
+    auto opened = gate.get_future().share();
+    thread->queue([opened] { opened.wait(); });
+    batcher.dispatch(FakeUpdate{0, 1}, false);
+    dispatcher->removeListener(listener);
+    batcher.dispatch(FakeUpdate{0, 2}, false);
+    REQUIRE(batcher.getPendingCount() == 2);
+    gate.set_value();
+    thread->awaitDepthBelow(1);
+
+    // The batch was sealed when its queue entry ran, so the next update is not appended to it.
+    batcher.dispatch(FakeUpdate{0, 3}, false);
+    REQUIRE(batcher.getPendingCount() == 0);
+    REQUIRE(listener->values.empty());
+}
+
+TEST_CASE("EventsThread lets watermark listeners change the watermarks from their callbacks", "[EventsThread]") {
+    struct Reconfiguring : EventQueueListener {
+        EventsThread *thread = nullptr;
+        std::weak_ptr<EventQueueListener> self;
+        std::atomic<int> highs{0};
+        std::atomic<int> lows{0};
+        void onHighWatermark(std::size_t) override {
+            ++highs;
+            thread->setWatermarks(self.lock(), 6, 2);
+        }
+        void onLowWatermark(std::size_t) override {
+            ++lows;
+            thread->removeWatermarks(self.lock());
+        }
+    };
+    auto listener = std::make_shared<Reconfiguring>();
+    std::promise<void> gate;
+    auto opened = gate.get_future().share();
+    EventsThread thread(64);
+    listener->thread = &thread;
+    listener->self = listener;
+    thread.setWatermarks(listener, 4, 1);
+    thread.queue([opened] { opened.wait(); });
+    for (int i = 0; i < 8; ++i) {
+        thread.queue([] {});
+    }
+    gate.set_value();
+    thread.awaitDepthBelow(1);
+    REQUIRE(listener->highs == 1);
+    REQUIRE(listener->lows == 1);
+}
+
+namespace {
+
+    /**
+     * Floods one subscription while its events thread is held, the way a slow listener would.
+     */
+    struct Flood {
+        static constexpr std::size_t capacity = 10;
+        std::shared_ptr<EventsThread> thread = std::make_shared<EventsThread>();
+        std::shared_ptr<UpdateBacklog> backlog = std::make_shared<UpdateBacklog>();
+        std::shared_ptr<EventDispatcher<UpdatesListener>> dispatcher =
+                std::make_shared<EventDispatcher<UpdatesListener>>(thread);
+        Batcher batcher{dispatcher, thread, lostEvents()};
+        std::shared_ptr<UpdatesListener> listener = std::make_shared<UpdatesListener>();
+        std::promise<void> gate;
+
+        explicit Flood(EventQueueOverflowPolicy policy) {
+            dispatcher->addListener(listener);
+            batcher.setOverflow(capacity, policy, backlog);
+            thread->queue([opened = gate.get_future().share()] { opened.wait(); });
+        }
+
+        void release() {
+            gate.set_value();
+            thread->awaitDepthBelow(1);
+        }
+    };
+}
+
+TEST_CASE("ItemUpdateBatcher counts batched updates towards the queue capacity", "[EventsThread]") {
+    SECTION("DROP discards the updates beyond capacity and reports them") {
+        Flood flood(EventQueueOverflowPolicy::DROP);
+        for (int i = 0; i < 100; ++i) {
+            flood.batcher.dispatch(FakeUpdate{0, i}, false);
+        }
+        REQUIRE(flood.backlog->getDepth() == Flood::capacity);
+        REQUIRE(flood.batcher.getPendingCount() == Flood::capacity);
+        // The held task, plus one update per depth unit.
+        REQUIRE(flood.thread->getQueueDepth() == Flood::capacity + 1);
+        flood.release();
+        REQUIRE(flood.thread->getQueueDepth() == 0);
+        REQUIRE(flood.backlog->getDepth() == 0);
+        // The drops are reported before the next update.
+        flood.batcher.dispatch(FakeUpdate{0, 100}, false);
+        flood.thread->awaitDepthBelow(1);
+
+        std::lock_guard<std::mutex> lock(flood.listener->mutex);
+        REQUIRE(flood.listener->values == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 100});
+        REQUIRE(flood.listener->lost == std::map<int, int>{{0, 90}});
+    }
+
+    SECTION("CONFLATE merges the updates beyond capacity into the queued batch") {
+        Flood flood(EventQueueOverflowPolicy::CONFLATE);
+        for (int i = 0; i < 100; ++i) {
+            flood.batcher.dispatch(FakeUpdate{i % 4, i}, true);
+        }
+        REQUIRE(flood.backlog->getDepth() == Flood::capacity);
+        flood.release();
+
+        std::lock_guard<std::mutex> lock(flood.listener->mutex);
+        REQUIRE(flood.listener->lost.empty());
+        REQUIRE(flood.listener->values.size() == Flood::capacity);
+        // The latest update of every item is there.
+        for (int value = 96; value < 100; ++value) {
+            REQUIRE(std::find(flood.listener->values.begin(), flood.listener->values.end(), value) !=
+                    flood.listener->values.end());
+        }
+    }
+
+    SECTION("BLOCK holds the producer at capacity") {
+        Flood flood(EventQueueOverflowPolicy::BLOCK);
+        std::atomic<int> sent{0};
+        std::thread producer([&] {
+            for (int i = 0; i < 100; ++i) {
+                flood.batcher.dispatch(FakeUpdate{0, i}, false);
+                ++sent;
+            }
+        });
+        while (flood.backlog->getDepth() < Flood::capacity) {
+            std::this_thread::yield();
+        }
+        bool heldAtCapacity = sent < 100 && flood.backlog->getDepth() == Flood::capacity;
+        flood.release();
+        producer.join();
+        flood.thread->awaitDepthBelow(1);
+        REQUIRE(heldAtCapacity);
+
+        std::vector<int> all(100);
+        for (int i = 0; i < 100; ++i) {
+            all[i] = i;
+        }
+        std::lock_guard<std::mutex> lock(flood.listener->mutex);
+        REQUIRE(flood.listener->values == all);
+        REQUIRE(flood.listener->lost.empty());
+    }
+}
+
+TEST_CASE("ItemUpdateBatcher applies the overflow policy to the backlog of its own client", "[EventsThread]") {
+    // Two clients whose Subscriptions share an events thread: the flood of the first one must not make the
+    // second one drop.
+    Flood flooded(EventQueueOverflowPolicy::DROP);
+    auto otherBacklog = std::make_shared<UpdateBacklog>();
+    auto otherDispatcher = std::make_shared<EventDispatcher<UpdatesListener>>(flooded.thread);
+    Batcher other(otherDispatcher, flooded.thread, lostEvents());
+    auto otherListener = std::make_shared<UpdatesListener>();
+    otherDispatcher->addListener(otherListener);
+    other.setOverflow(Flood::capacity, EventQueueOverflowPolicy::DROP, otherBacklog);
+
+    for (int i = 0; i < 100; ++i) {
+        flooded.batcher.dispatch(FakeUpdate{0, i}, false);
+    }
+    REQUIRE(flooded.thread->getQueueDepth() > Flood::capacity);
+    for (int i = 0; i < 5; ++i) {
+        other.dispatch(FakeUpdate{0, i}, false);
+    }
+    REQUIRE(otherBacklog->getDepth() == 5);
+    flooded.release();
+
+    std::lock_guard<std::mutex> lock(otherListener->mutex);
+    REQUIRE(otherListener->values == std::vector<int>{0, 1, 2, 3, 4});
+    REQUIRE(otherListener->lost.empty());
+    REQUIRE(otherBacklog->getDepth() == 0);
+}
+
+namespace {
+
+    struct InlineListener {
+        std::vector<int> values;
+        std::chrono::nanoseconds delay{0};
+        bool throws = false;
+
+        void onItemUpdate(const FakeUpdate &update) {
+            if (delay.count() > 0) {
+                std::this_thread::sleep_for(delay);
+            }
+            if (throws) {
+                throw std::runtime_error("inline listener failure");
+            }
+            values.push_back(update.value);
+        }
+    };
+
+    using Inlines = InlineListeners<InlineListener, FakeUpdate>;
+}
+
+TEST_CASE("InlineListeners adds and removes listeners", "[EventsThread]") {
+    Inlines inlines;
+    auto first = std::make_shared<InlineListener>();
+    auto second = std::make_shared<InlineListener>();
+    auto firstAdapter = std::make_shared<InlineListener>();
+
+    REQUIRE(inlines.add(first, firstAdapter, std::chrono::seconds(1)));
+    REQUIRE(inlines.add(second, std::make_shared<InlineListener>(), std::chrono::seconds(1)));
+    // A listener already there is not added twice.
+    REQUIRE_FALSE(inlines.add(first, std::make_shared<InlineListener>(), std::chrono::seconds(1)));
+    REQUIRE(inlines.size() == 2);
+
+    inlines.dispatch(FakeUpdate{0, 1});
+    REQUIRE(first->values == std::vector<int>{1});
+    REQUIRE(second->values == std::vector<int>{1});
+
+    // The adapter is handed back, so that it can be removed from the dispatcher.
+    REQUIRE(inlines.remove(first) == firstAdapter);
+    REQUIRE(inlines.remove(first) == nullptr);
+    REQUIRE(inlines.size() == 1);
+
+    inlines.dispatch(FakeUpdate{0, 2});
+    REQUIRE(first->values == std::vector<int>{1});
+    REQUIRE(second->values == std::vector<int>{1, 2});
+}
+
+TEST_CASE("InlineListeners counts the calls exceeding their budget", "[EventsThread]") {
+    Inlines inlines;
+    auto slow = std::make_shared<InlineListener>();
+    slow->delay = std::chrono::milliseconds(2);
+    auto fast = std::make_shared<InlineListener>();
+    inlines.add(slow, std::make_shared<InlineListener>(), std::chrono::microseconds(100));
+    inlines.add(fast, std::make_shared<InlineListener>(), std::chrono::seconds(1));
+
+    for (int i = 0; i < 3; ++i) {
+        inlines.dispatch(FakeUpdate{0, i});
+    }
+
+    REQUIRE(inlines.getBudgetOverruns() == 3);
+    REQUIRE(slow->values == std::vector<int>{0, 1, 2});
+    REQUIRE(fast->values == std::vector<int>{0, 1, 2});
+}
+
+TEST_CASE("InlineListeners isolates a listener that throws", "[EventsThread]") {
+    Inlines inlines;
+    auto failing = std::make_shared<InlineListener>();
+    failing->throws = true;
+    auto next = std::make_shared<InlineListener>();
+    inlines.add(failing, std::make_shared<InlineListener>(), std::chrono::seconds(1));
+    inlines.add(next, std::make_shared<InlineListener>(), std::chrono::seconds(1));
+
+    REQUIRE_NOTHROW(inlines.dispatch(FakeUpdate{0, 7}));
+    REQUIRE_NOTHROW(inlines.dispatch(FakeUpdate{0, 8}));
+
+    REQUIRE(next->values == std::vector<int>{7, 8});
+    REQUIRE(inlines.getBudgetOverruns() == 0);
+}
@@ -0,0 +1,242 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/client/events/EventsThread.hpp>
+#include <lightstreamer/util/threads/InjectedExecutorMultiplexer.hpp>
+#include <lightstreamer/util/threads/TimerWheel.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace lightstreamer::util::threads;
+using namespace lightstreamer::client::events;
+
+namespace {
+
+    /**
+     * An application executor whose tasks run only when the test says so, like an event loop.
+     */
+    class ManualExecutor : public providers::JoinableExecutor, public providers::JoinableScheduler {
+    public:
+        std::deque<InlineTask> ready;
+        std::vector<std::pair<long, InlineTask>> delayed;
+
+        void execute(InlineTask task) override {
+            ready.push_back(std::move(task));
+        }
+
+        std::shared_ptr<Cancellable> schedule(InlineTask task, long delayInMillis) override {
+            auto [guarded, cancel] = makeCancellable(std::move(task));
+            delayed.emplace_back(delayInMillis, std::move(guarded));
+            return cancel;
+        }
+
+        void join() override {}
+
+        bool runOne() {
+            if (ready.empty()) {
+                return false;
+            }
+            InlineTask task = std::move(ready.front());
+            ready.pop_front();
+            task.run();
+            return true;
+        }
+
+        void fireDelayed() {
+            auto expired = std::move(delayed);
+            delayed.clear();
+            for (auto &entry: expired) {
+                entry.second.run();
+            }
+        }
+    };
+
+    /**
+     * A plain multi-threaded pool, standing in for an application pool.
+     */
+    class PoolExecutor : public providers::JoinableExecutor {
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        std::deque<InlineTask> tasks;
+        bool stop = false;
+        std::vector<std::thread> workers;
+
+    public:
+        explicit PoolExecutor(int threads) {
+            for (int i = 0; i < threads; ++i) {
+                workers.emplace_back([this] {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while (true) {
+                        wakeUp.wait(lock, [this] { return stop || !tasks.empty(); });
+                        if (tasks.empty()) {
+                            return;
+                        }
+                        InlineTask task = std::move(tasks.front());
+                        tasks.pop_front();
+                        lock.unlock();
+                        task.run();
+                        lock.lock();
+                    }
+                });
+            }
+        }
+
+        ~PoolExecutor() override {
+            join();
+        }
+
+        void execute(InlineTask task) override {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back(std::move(task));
+            }
+            wakeUp.notify_one();
+        }
+
+        void join() override {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            wakeUp.notify_all();
+            for (auto &worker: workers) {
+                if (worker.joinable()) {
+                    worker.join();
+                }
+            }
+        }
+    };
+}
+
+TEST_CASE("EventsThread on an executor delivers in batches on the executor thread", "[InjectedExecutor]") {
+    auto executor = std::make_shared<ManualExecutor>();
+    auto events = EventsThread::onExecutor(executor, 16);
+    std::vector<int> delivered;
+    for (int i = 0; i < 600; ++i) {
+        events->queue([&delivered, i] { delivered.push_back(i); });
+    }
+    // One drain task at a time, however many events are queued.
+    REQUIRE(executor->ready.size() == 1);
+    REQUIRE(events->getQueueDepth() == 600);
+
+    REQUIRE(executor->runOne());
+    REQUIRE(delivered.size() == EventsThread::MAX_BATCH);
+    REQUIRE(executor->ready.size() == 1);
+    while (executor->runOne()) {}
+    REQUIRE(delivered.size() == 600);
+    REQUIRE(std::is_sorted(delivered.begin(), delivered.end()));
+    REQUIRE(events->getQueueDepth() == 0);
+    REQUIRE(events->getOldestEventAge() == std::chrono::nanoseconds::zero());
+
+    // Idle again: the next event submits a new drain task.
+    events->queue([] {});
+    REQUIRE(executor->ready.size() == 1);
+    executor->runOne();
+    REQUIRE_THROWS_AS(EventsThread::onExecutor(nullptr), std::invalid_argument);
+}
+
+TEST_CASE("EventsThread on a pool never runs two events at once", "[InjectedExecutor]") {
+    constexpr int perProducer = 20000;
+    std::atomic<int> inside{0};
+    std::atomic<bool> overlapped{false};
+    int last[2] = {-1, -1};
+    bool ordered = true;
+    {
+        auto pool = std::make_shared<PoolExecutor>(4);
+        auto events = EventsThread::onExecutor(pool);
+        auto producer = [&](int id) {
+            for (int i = 0; i < perProducer; ++i) {
+                events->queue([&, id, i] {
+                    if (inside.fetch_add(1) != 0) {
+                        overlapped = true;
+                    }
+                    ordered = ordered && last[id] + 1 == i;
+                    last[id] = i;
+                    inside.fetch_sub(1);
+                });
+            }
+        };
+        std::thread p1(producer, 0);
+        std::thread p2(producer, 1);
+        p1.join();
+        p2.join();
+        events->awaitDepthBelow(1);
+        events.reset();
+        pool->join();
+    }
+    REQUIRE_FALSE(overlapped);
+    REQUIRE(ordered);
+    REQUIRE(last[0] == perProducer - 1);
+    REQUIRE(last[1] == perProducer - 1);
+}
+
+TEST_CASE("InjectedExecutorMultiplexer runs immediate and delayed tasks on the injected executor", "[InjectedExecutor]") {
+    auto executor = std::make_shared<ManualExecutor>();
+    InjectedExecutorMultiplexer<int> multiplexer(executor, executor);
+    std::vector<int> executed;
+    multiplexer.execute(0, [&executed] { executed.push_back(1); });
+    multiplexer.schedule(0, [&executed] { executed.push_back(3); }, 100);
+    multiplexer.execute(0, [&executed] { executed.push_back(2); });
+    REQUIRE(executor->ready.size() == 1);
+    REQUIRE(executor->delayed.size() == 1);
+    REQUIRE(executor->delayed[0].first == 100);
+
+    executor->runOne();
+    REQUIRE(executed == std::vector<int>{1, 2});
+    // An expired timer only enqueues its task: it runs within the serialized queue.
+    executor->fireDelayed();
+    REQUIRE(executed.size() == 2);
+    executor->runOne();
+    REQUIRE(executed == std::vector<int>{1, 2, 3});
+    REQUIRE(multiplexer.getTaskCount() == 3);
+    REQUIRE_THROWS_AS(InjectedExecutorMultiplexer<int>(executor, nullptr), std::invalid_argument);
+}
+
+TEST_CASE("InjectedExecutorMultiplexer serializes tasks on a pool and awaits them", "[InjectedExecutor]") {
+    auto pool = std::make_shared<PoolExecutor>(4);
+    auto timers = std::make_shared<ManualExecutor>();
+    InjectedExecutorMultiplexer<int> multiplexer(pool, timers);
+    std::atomic<int> inside{0};
+    std::atomic<bool> overlapped{false};
+    long sum = 0;
+    for (int i = 1; i <= 10000; ++i) {
+        multiplexer.execute(0, [&, i] {
+            if (inside.fetch_add(1) != 0) {
+                overlapped = true;
+            }
+            sum += i;
+            inside.fetch_sub(1);
+        });
+    }
+    multiplexer.await();
+    REQUIRE_FALSE(overlapped);
+    REQUIRE(sum == 10000L * 10001 / 2);
+    pool->join();
+}
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/util/threads/InlineTask.hpp>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace lightstreamer::util::threads;
+
+namespace {
+    class RecordingHandler : public UncaughtExceptionHandler {
+    public:
+        std::string message;
+
+        void onUncaughtException(const std::exception &e) override {
+            message = e.what();
+        }
+    };
+}
+
+TEST_CASE("InlineTask runs move-only callables", "[InlineTask]") {
+    auto value = std::make_unique<int>(41);
+    int result = 0;
+    InlineTask task([value = std::move(value), &result]() { result = *value + 1; });
+    InlineTask moved(std::move(task));
+    REQUIRE_FALSE(static_cast<bool>(task));
+    REQUIRE(static_cast<bool>(moved));
+    moved();
+    REQUIRE(result == 42);
+}
+
+TEST_CASE("InlineTask falls back to the heap for big callables", "[InlineTask]") {
+    std::array<char, 2 * InlineTask::INLINE_SIZE> big{};
+    big[0] = 'x';
+    char seen = 0;
+    InlineTask task([big, &seen]() { seen = big[0]; });
+    InlineTask other;
+    other = std::move(task);
+    other();
+    REQUIRE(seen == 'x');
+}
+
+TEST_CASE("InlineTask forwards exceptions to its handler", "[InlineTask]") {
+    RecordingHandler handler;
+    InlineTask task([]() { throw std::runtime_error("boom"); });
+    task.setExceptionHandler(&handler);
+    REQUIRE_NOTHROW(task.run());
+    REQUIRE(handler.message == "boom");
+
+    InlineTask unhandled([]() { throw std::runtime_error("boom"); });
+    REQUIRE_THROWS_AS(unhandled.run(), std::runtime_error);
+    REQUIRE_THROWS_AS(InlineTask()(), std::bad_function_call);
+}
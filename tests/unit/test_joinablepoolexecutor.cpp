@@ -0,0 +1,84 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/util/threads/JoinablePoolExecutor.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace lightstreamer::util::threads;
+
+TEST_CASE("JoinablePoolExecutor runs tasks in parallel and join waits for them", "[JoinablePoolExecutor]") {
+    JoinablePoolExecutor pool(4, "test", 1000);
+    std::atomic<int> done{0};
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+
+    for (int i = 0; i < 8; ++i) {
+        pool.execute([&] {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            done++;
+        });
+    }
+    pool.join();
+    REQUIRE(done == 8);
+    REQUIRE(threads.size() > 1);
+    REQUIRE(threads.size() <= 4);
+    REQUIRE(pool.getPoolSize() == 0);
+
+    // Tasks spawned by workers are stolen by the idle ones.
+    for (int i = 0; i < 4; ++i) {
+        pool.execute([&pool, &done] {
+            for (int j = 0; j < 100; ++j) {
+                pool.execute([&done] { done++; });
+            }
+        });
+    }
+    pool.join();
+    REQUIRE(done == 408);
+}
+
+TEST_CASE("JoinablePoolExecutor workers retire after the keep-alive time", "[JoinablePoolExecutor]") {
+    JoinablePoolExecutor pool(2, "test", 20);
+    std::atomic<int> done{0};
+    pool.execute([&done] { done++; });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while ((done == 0 || pool.getPoolSize() > 0) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    REQUIRE(done == 1);
+    REQUIRE(pool.getPoolSize() == 0);
+
+    pool.execute([&done] { done++; });
+    pool.join();
+    REQUIRE(done == 2);
+}
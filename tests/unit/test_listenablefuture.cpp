@@ -0,0 +1,72 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/util/ListenableFuture.hpp>
+#include <memory>
+#include <stdexcept>
+
+using namespace lightstreamer::util;
+
+TEST_CASE("ListenableFuture runs continuations outside its lock", "[ListenableFuture]") {
+    auto future = std::make_shared<ListenableFuture>();
+    int calls = 0;
+    // Registering from a continuation would deadlock if it ran under the lock.
+    future->onFulfilled([&] {
+        ++calls;
+        future->onFulfilled([&] { calls += 10; });
+        REQUIRE(future->getState() == ListenableFuture::State::FULFILLED);
+    });
+    future->onRejected([&] { calls += 1000; });
+    for (int i = 0; i < 3; ++i) {
+        future->onFulfilled([&] { ++calls; });
+    }
+    future->fulfill();
+    future->reject();
+    REQUIRE(calls == 14);
+    REQUIRE(future->getState() == ListenableFuture::State::FULFILLED);
+}
+
+TEST_CASE("ListenableFuture chains steps with then", "[ListenableFuture]") {
+    auto first = std::make_shared<ListenableFuture>();
+    auto inner = std::make_shared<ListenableFuture>();
+    bool ran = false;
+    auto last = first->then([&] { ran = true; })->then([inner] { return inner; });
+    auto failed = first->then([] { throw std::runtime_error("step failed"); });
+    // Anything thrown rejects the next step, not only std::exception.
+    auto thrown = first->then([] { throw 42; });
+
+    first->fulfill();
+    REQUIRE(ran);
+    REQUIRE(last->getState() == ListenableFuture::State::NOT_RESOLVED);
+    REQUIRE(failed->getState() == ListenableFuture::State::REJECTED);
+    REQUIRE(thrown->getState() == ListenableFuture::State::REJECTED);
+    inner->fulfill();
+    REQUIRE(last->getState() == ListenableFuture::State::FULFILLED);
+
+    auto rejected = ListenableFuture::rejected()->then([&] { ran = false; });
+    REQUIRE(rejected->getState() == ListenableFuture::State::REJECTED);
+    REQUIRE(ran);
+}
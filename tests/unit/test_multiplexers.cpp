@@ -0,0 +1,226 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/util/threads/ReactorPoolMultiplexer.hpp>
+#include <lightstreamer/util/threads/SingleThreadEventExecutor.hpp>
+#include <lightstreamer/util/threads/StaticAssignmentMultiplexer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace lightstreamer::util::threads;
+
+namespace {
+
+    /**
+     * What the tasks of one source observed: the order they ran in and on which threads.
+     */
+    struct SourceLog {
+        std::mutex mutex;
+        std::vector<int> order;
+        std::vector<std::thread::id> threads;
+
+        void record(int value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(value);
+            threads.push_back(std::this_thread::get_id());
+        }
+
+        bool singleThread() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return std::all_of(threads.begin(), threads.end(),
+                               [this](std::thread::id id) { return id == threads.front(); });
+        }
+    };
+
+    /**
+     * The thread the next task of the source runs on. Waits for the multiplexer to be idle, so that the
+     * source has nothing in flight afterwards.
+     */
+    template<typename M>
+    std::thread::id threadOf(M &multiplexer, int source) {
+        std::promise<std::thread::id> id;
+        auto future = id.get_future();
+        multiplexer.execute(source, [&id] { id.set_value(std::this_thread::get_id()); });
+        auto result = future.get();
+        multiplexer.await();
+        return result;
+    }
+
+    std::size_t sourcesOf(const std::vector<ReactorLoad> &load) {
+        std::size_t total = 0;
+        for (const auto &thread: load) {
+            total += thread.sources;
+        }
+        return total;
+    }
+
+    std::vector<int> sequence(int n) {
+        std::vector<int> values(n);
+        for (int i = 0; i < n; ++i) {
+            values[i] = i;
+        }
+        return values;
+    }
+}
+
+TEST_CASE("SingleThreadEventExecutor runs immediate and delayed tasks on its thread", "[Multiplexer]") {
+    SingleThreadEventExecutor executor;
+    SourceLog log;
+    auto inFlight = std::make_shared<std::atomic<std::size_t>>(0);
+    for (int i = 0; i < 1000; ++i) {
+        executor.execute([&log, i] { log.record(i); }, inFlight);
+    }
+    std::atomic<bool> delayedRun{false};
+    std::thread::id delayedThread;
+    executor.schedule([&] {
+        delayedThread = std::this_thread::get_id();
+        delayedRun = true;
+    }, 10, inFlight);
+    while (!delayedRun) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    executor.await();
+
+    REQUIRE(log.order == sequence(1000));
+    REQUIRE(log.singleThread());
+    REQUIRE(delayedThread == log.threads.front());
+    REQUIRE(inFlight->load() == 0);
+    REQUIRE(executor.getTaskCount() == 1001);
+}
+
+TEST_CASE("StaticAssignmentMultiplexer keeps each source on one worker, in order", "[Multiplexer]") {
+    constexpr int sources = 8;
+    constexpr int tasks = 2000;
+    StaticAssignmentMultiplexer<int> multiplexer;
+    std::vector<std::unique_ptr<SourceLog>> logs;
+    for (int s = 0; s < sources; ++s) {
+        logs.push_back(std::make_unique<SourceLog>());
+    }
+    // Two producers interleave the sources.
+    auto producer = [&](int first) {
+        for (int i = 0; i < tasks; ++i) {
+            for (int s = first; s < sources; s += 2) {
+                multiplexer.execute(s, [&log = *logs[s], i] { log.record(i); });
+            }
+        }
+    };
+    std::thread p1(producer, 0);
+    std::thread p2(producer, 1);
+    p1.join();
+    p2.join();
+    multiplexer.await();
+
+    std::vector<std::thread::id> used;
+    for (auto &log: logs) {
+        REQUIRE(log->order == sequence(tasks));
+        REQUIRE(log->singleThread());
+        used.push_back(log->threads.front());
+    }
+    std::sort(used.begin(), used.end());
+    std::size_t distinct = std::unique(used.begin(), used.end()) - used.begin();
+    // Round robin: the sources spread over as many workers as the pool has, up to their number.
+    REQUIRE(distinct == std::min<std::size_t>(sources, StaticAssignmentMultiplexer<int>::getPoolSize()));
+
+    // A later task of a source lands on the same worker.
+    std::thread::id again;
+    multiplexer.execute(3, [&again] { again = std::this_thread::get_id(); });
+    multiplexer.await();
+    REQUIRE(again == logs[3]->threads.front());
+}
+
+TEST_CASE("StaticAssignmentMultiplexer assigns a released source again", "[Multiplexer]") {
+    StaticAssignmentMultiplexer<int> multiplexer;
+    auto before = threadOf(multiplexer, 100);
+    REQUIRE(threadOf(multiplexer, 100) == before);
+    multiplexer.release(100);
+    // Round robin moved on meanwhile, so the source gets the next worker, if there is another one.
+    auto after = threadOf(multiplexer, 100);
+    REQUIRE((after != before || StaticAssignmentMultiplexer<int>::getPoolSize() == 1));
+}
+
+TEST_CASE("ReactorPoolMultiplexer LEAST_LOAD spreads sources and HASH pins them", "[Multiplexer]") {
+    SECTION("LEAST_LOAD") {
+        ReactorPoolMultiplexer<int> pool(4, ReactorAssignment::LEAST_LOAD);
+        for (int source = 0; source < 8; ++source) {
+            threadOf(pool, source);
+        }
+        for (const auto &thread: pool.getLoad()) {
+            REQUIRE(thread.sources == 2);
+        }
+        pool.release(0);
+        pool.release(4);
+        REQUIRE(sourcesOf(pool.getLoad()) == 6);
+        pool.release(0);
+        REQUIRE(sourcesOf(pool.getLoad()) == 6);
+    }
+
+    SECTION("HASH") {
+        ReactorPoolMultiplexer<int> pool(4, ReactorAssignment::HASH);
+        std::vector<std::thread::id> first;
+        for (int source = 0; source < 32; ++source) {
+            first.push_back(threadOf(pool, source));
+        }
+        REQUIRE(sourcesOf(pool.getLoad()) == 32);
+        for (int source = 0; source < 32; ++source) {
+            pool.release(source);
+            // The same thread after a release: the hash alone decides.
+            REQUIRE(threadOf(pool, source) == first[source]);
+        }
+        REQUIRE(pool.getRebalanceCount() == 0);
+    }
+}
+
+TEST_CASE("ReactorPoolMultiplexer moves a source only when nothing of it is in flight", "[Multiplexer]") {
+    ReactorPoolMultiplexer<int> pool(2, ReactorAssignment::LEAST_LOAD);
+    auto t1 = threadOf(pool, 1);
+    auto t2 = threadOf(pool, 2);
+    // The second source goes to the empty thread; the third one to either.
+    REQUIRE(t1 != t2);
+    auto t3 = threadOf(pool, 3);
+    int moving = 3;
+    int lone = t3 == t1 ? 2 : 1;
+    std::thread::id crowded = t3;
+
+    auto delayed = pool.schedule(moving, [] {}, 3600000);
+    pool.release(lone);
+    auto load = pool.getLoad();
+    REQUIRE(std::max(load[0].sources, load[1].sources) == 2);
+    REQUIRE(std::min(load[0].sources, load[1].sources) == 0);
+
+    // The pending delayed task keeps the source where it is, although its thread has two sources more.
+    REQUIRE(threadOf(pool, moving) == crowded);
+    REQUIRE(pool.getRebalanceCount() == 0);
+
+    // Once it is cancelled, nothing of the source is in flight and it moves.
+    delayed->cancel();
+    REQUIRE(threadOf(pool, moving) != crowded);
+    REQUIRE(pool.getRebalanceCount() == 1);
+}
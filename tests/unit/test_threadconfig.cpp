@@ -0,0 +1,136 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/util/threads/ThreadConfig.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+
+using namespace lightstreamer::util::threads;
+
+namespace {
+
+    // The CPUs the test may use, so that it also runs in restricted containers.
+    std::vector<int> allowedCpus() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    struct ThreadState {
+        bool applied = false;
+        std::string name;
+        std::vector<int> cpus;
+        int policy = -1;
+    };
+
+    // Applies the role on a fresh thread and reads back what the OS reports for it.
+    ThreadState applyOnThread(ThreadRole role, int slot = -1) {
+        ThreadState state;
+        std::thread([&]() {
+            state.applied = ThreadConfig::getInstance().applyToCurrentThread(role, slot);
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            state.name = name;
+            state.cpus = allowedCpus();
+            sched_param param{};
+            pthread_getschedparam(pthread_self(), &state.policy, &param);
+        }).join();
+        return state;
+    }
+
+    // Restores the settings of a role when the test ends.
+    struct RestoreSettings {
+        ThreadRole role;
+        ThreadSettings saved;
+
+        explicit RestoreSettings(ThreadRole role) : role(role), saved(ThreadConfig::getInstance().getSettings(role)) {}
+
+        ~RestoreSettings() {
+            ThreadConfig::getInstance().setSettings(role, saved);
+        }
+    };
+}
+
+TEST_CASE("ThreadConfig names and pins the threads of a role", "[ThreadConfig]") {
+    RestoreSettings restore(ThreadRole::TRANSPORT);
+    std::vector<int> cpus = allowedCpus();
+    REQUIRE_FALSE(cpus.empty());
+    ThreadConfig::getInstance().setSettings(ThreadRole::TRANSPORT, {"ls-test-role", {cpus.front()}, 0});
+
+    ThreadState state = applyOnThread(ThreadRole::TRANSPORT);
+
+    REQUIRE(state.applied);
+    // A sequence number is appended, and the whole name is truncated to 15 characters.
+    REQUIRE(state.name.rfind("ls-test-role-", 0) == 0);
+    REQUIRE(state.name.size() <= 15);
+    REQUIRE(state.cpus == std::vector<int>{cpus.front()});
+}
+
+TEST_CASE("ThreadConfig pins the thread of a slot to one CPU of the role", "[ThreadConfig]") {
+    RestoreSettings restore(ThreadRole::EVENTS);
+    std::vector<int> cpus = allowedCpus();
+    ThreadConfig::getInstance().setSettings(ThreadRole::EVENTS, {"ls-slot", cpus, 0});
+
+    for (int slot = 0; slot < 3; ++slot) {
+        ThreadState state = applyOnThread(ThreadRole::EVENTS, slot);
+        REQUIRE(state.applied);
+        REQUIRE(state.cpus == std::vector<int>{cpus[static_cast<std::size_t>(slot) % cpus.size()]});
+    }
+}
+
+TEST_CASE("ThreadConfig reports a SCHED_FIFO failure without stopping the thread", "[ThreadConfig]") {
+    RestoreSettings restore(ThreadRole::TIMER);
+    ThreadConfig::getInstance().setSettings(ThreadRole::TIMER, {"ls-fifo", {}, 1});
+
+    ThreadState state = applyOnThread(ThreadRole::TIMER);
+
+    // Without CAP_SYS_NICE the policy is refused: the failure is reported and the other settings kept.
+    if (state.applied) {
+        REQUIRE(state.policy == SCHED_FIFO);
+    } else {
+        REQUIRE(state.policy == SCHED_OTHER);
+    }
+    REQUIRE(state.name.rfind("ls-fifo-", 0) == 0);
+}
+
+TEST_CASE("ThreadConfig rejects priorities out of range", "[ThreadConfig]") {
+    REQUIRE_THROWS_AS(ThreadConfig::getInstance().setSettings(ThreadRole::SESSION, {"ls-session", {}, 100}),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(ThreadConfig::getInstance().setSettings(ThreadRole::SESSION, {"ls-session", {}, -1}),
+                      std::invalid_argument);
+}
+
+#endif
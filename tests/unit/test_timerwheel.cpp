@@ -0,0 +1,102 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/util/threads/TimerWheel.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+using namespace lightstreamer::util::threads;
+using namespace std::chrono;
+
+namespace {
+    std::vector<int> advanceTo(TimerWheel &wheel, steady_clock::time_point now, std::vector<int> &fired) {
+        wheel.advance(now, [](InlineTask &&task) { task(); });
+        return fired;
+    }
+}
+
+TEST_CASE("TimerWheel fires timers in expiry order across levels", "[TimerWheel]") {
+    auto wheel = std::make_shared<TimerWheel>();
+    auto start = steady_clock::now();
+    std::vector<int> fired;
+    wheel->schedule([&fired] { fired.push_back(3); }, milliseconds(5000));
+    wheel->schedule([&fired] { fired.push_back(1); }, milliseconds(10));
+    wheel->schedule([&fired] { fired.push_back(2); }, milliseconds(300));
+    wheel->schedule([&fired] { fired.push_back(4); }, milliseconds(5000));
+    REQUIRE(wheel->size() == 4);
+
+    REQUIRE(advanceTo(*wheel, start + milliseconds(5), fired).empty());
+    REQUIRE(advanceTo(*wheel, start + milliseconds(400), fired) == std::vector<int>{1, 2});
+    REQUIRE(advanceTo(*wheel, start + milliseconds(6000), fired) == std::vector<int>{1, 2, 3, 4});
+    REQUIRE(wheel->size() == 0);
+    REQUIRE_FALSE(wheel->nextDeadline().has_value());
+}
+
+TEST_CASE("TimerWheel cancellation and rearm", "[TimerWheel]") {
+    int rearms = 0;
+    auto wheel = std::make_shared<TimerWheel>([&rearms] { ++rearms; });
+    auto start = steady_clock::now();
+    std::vector<int> fired;
+
+    auto late = wheel->schedule([&fired] { fired.push_back(1); }, milliseconds(1000));
+    REQUIRE(wheel->nextDeadline().has_value());
+    int before = rearms;
+    wheel->schedule([&fired] { fired.push_back(2); }, milliseconds(20));
+    REQUIRE(rearms == before + 1);
+
+    REQUIRE(late.cancel());
+    REQUIRE_FALSE(late.cancel());
+    REQUIRE(advanceTo(*wheel, start + milliseconds(2000), fired) == std::vector<int>{2});
+
+    auto [task, cancel] = makeCancellable([&fired] { fired.push_back(3); });
+    cancel->cancel();
+    task();
+    auto [kept, dropped] = makeCancellable([&fired] { fired.push_back(4); });
+    dropped.reset();
+    kept();
+    REQUIRE(fired == std::vector<int>{2, 4});
+}
+
+TEST_CASE("TimerWheel advances over hours of idle ticks to the next timer", "[TimerWheel]") {
+    auto wheel = std::make_shared<TimerWheel>();
+    auto start = steady_clock::now();
+    std::vector<int> fired;
+    wheel->schedule([&fired] { fired.push_back(3); }, hours(6));
+    wheel->schedule([&fired] { fired.push_back(2); }, milliseconds(70000));
+    wheel->schedule([&fired] { fired.push_back(1); }, milliseconds(100));
+
+    auto [task, handle] = makeCancellable([&fired] { fired.push_back(-1); });
+    handle->bind(wheel->schedule(std::move(task), hours(1)));
+    REQUIRE(wheel->size() == 4);
+    // Cancelling the handle takes the timer out of the wheel at once.
+    handle->cancel();
+    REQUIRE(handle->isCancelled());
+    REQUIRE(wheel->size() == 3);
+
+    REQUIRE(advanceTo(*wheel, start + hours(7), fired) == std::vector<int>{1, 2, 3});
+    REQUIRE(wheel->size() == 0);
+}
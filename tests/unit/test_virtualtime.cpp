@@ -0,0 +1,127 @@
+/*******************************************************************************
+ Copyright (c) 2024.
+
+ This program is free software: you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the
+ Free Software Foundation, either version 3 of the License, or (at your
+ option) any later version.
+
+ This program is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program. If not, see <https://www.gnu.org/licenses/>..
+ ******************************************************************************/
+
+/******************************************************************************
+    Author: Joaquin Bejar Garcia
+    Email: jb@taunais.com
+    Date: 18/10/26
+ ******************************************************************************/
+
+
+
+#include <catch2/catch_test_macros.hpp>
+#include <lightstreamer/client/session/RetryDelayCounter.hpp>
+#include <lightstreamer/util/Clock.hpp>
+#include <lightstreamer/util/threads/VirtualTimeMultiplexer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace lightstreamer::util;
+using namespace lightstreamer::util::threads;
+using namespace std::chrono;
+
+TEST_CASE("VirtualTimeMultiplexer runs delayed tasks in simulated time", "[VirtualTime]") {
+    auto clock = std::make_shared<VirtualClock>();
+    Clock::setInstance(clock);
+    VirtualTimeMultiplexer<int> multiplexer(clock);
+    auto start = Clock::now();
+    std::vector<int> order;
+
+    multiplexer.schedule(1, [&] { order.push_back(3); }, 60000);
+    multiplexer.schedule(1, [&] { order.push_back(2); }, 1000);
+    auto cancelled = multiplexer.schedule(1, [&] { order.push_back(-1); }, 1000);
+    multiplexer.execute(1, [&] { order.push_back(1); });
+    cancelled->cancel();
+
+    REQUIRE(multiplexer.runFor(seconds(2)) == 3);
+    REQUIRE(order == std::vector<int>{1, 2});
+    REQUIRE(Clock::now() - start == seconds(2));
+    REQUIRE(multiplexer.runUntilIdle() == 1);
+    REQUIRE(order == std::vector<int>{1, 2, 3});
+    REQUIRE(Clock::now() - start == minutes(1));
+
+    Clock::setInstance(nullptr);
+}
+
+TEST_CASE("VirtualTimeMultiplexer runs many retry cycles quickly", "[VirtualTime]") {
+    auto clock = std::make_shared<VirtualClock>();
+    VirtualTimeMultiplexer<int> multiplexer(clock);
+    int cycles = 0;
+    std::function<void()> retry = [&] {
+        if (++cycles < 10000) {
+            multiplexer.schedule(1, [&] { retry(); }, 4000);
+        }
+    };
+    multiplexer.execute(1, [&] { retry(); });
+
+    auto wallStart = steady_clock::now();
+    multiplexer.runUntilIdle();
+    REQUIRE(cycles == 10000);
+    REQUIRE(steady_clock::now() - wallStart < seconds(5));
+    REQUIRE(multiplexer.getPendingCount() == 0);
+    REQUIRE(multiplexer.getTaskCount() == 10000);
+}
+
+TEST_CASE("VirtualTimeMultiplexer drives the session retry delays", "[VirtualTime]") {
+    using lightstreamer::client::session::RetryDelayCounter;
+    auto clock = std::make_shared<VirtualClock>();
+    Clock::setInstance(clock);
+    VirtualTimeMultiplexer<int> multiplexer(clock);
+    RetryDelayCounter retryDelay(4000);
+    constexpr long failureMillis = 1500;
+    std::vector<std::int64_t> attempts;
+    std::vector<long> delays;
+
+    // As Session does on a socket error: the retry waits for what is left of the current retry delay
+    // since the attempt was sent, then the delay is increased for the next failure.
+    std::function<void()> connect = [&] {
+        std::int64_t sentTime = Clock::currentTimeMillis();
+        attempts.push_back(sentTime);
+        if (attempts.size() == 16) {
+            return;
+        }
+        multiplexer.schedule(1, [&, sentTime] {
+            long spent = static_cast<long>(Clock::currentTimeMillis() - sentTime);
+            long current = retryDelay.getCurrentRetryDelay();
+            long delay = spent > current ? 0 : current - spent;
+            delays.push_back(delay);
+            multiplexer.schedule(1, [&] { connect(); }, delay);
+            retryDelay.increase();
+        }, failureMillis);
+    };
+    multiplexer.execute(1, [&] { connect(); });
+    multiplexer.runUntilIdle();
+
+    std::vector<long> expectedDelays(10, 4000 - failureMillis);
+    for (long current: {8000L, 16000L, 32000L, 60000L, 60000L}) {
+        expectedDelays.push_back(current - failureMillis);
+    }
+    REQUIRE(delays == expectedDelays);
+
+    // Consecutive attempts are spaced by the current retry delay, failure time included.
+    REQUIRE(attempts.size() == 16);
+    for (std::size_t i = 1; i < attempts.size(); ++i) {
+        REQUIRE(attempts[i] - attempts[i - 1] == expectedDelays[i - 1] + failureMillis);
+    }
+    REQUIRE(retryDelay.getCurrentRetryDelay() == 60000);
+
+    Clock::setInstance(nullptr);
+}